@@ -16,7 +16,7 @@ echo.
 echo 开始测试...
 echo.
 
-set test_files=test_optimization_enhanced.c test_advanced_optimization.c test_arithmetic_optimization.c test_chain_optimization.c test_array_optimization.c
+set test_files=test_optimization_enhanced.c test_advanced_optimization.c test_arithmetic_optimization.c test_chain_optimization.c test_array_optimization.c test_loop_invariant.c test_induction_variable.c test_loop_rotation.c test_compare_branch.c test_cfg_simplify.c test_inline.c test_specialization.c test_tail_recursion.c test_copy_propagation.c test_peephole.c test_loop_unroll.c test_array_alias.c test_pre.c test_range.c
 
 for %%f in (%test_files%) do (
     echo ========================================
@@ -39,6 +39,12 @@ for %%f in (%test_files%) do (
     echo.
 )
 
+echo ========================================
+echo 测试文件: test_dead_function.c（删除不可达函数）
+echo ========================================
+./parser.exe -O --remove-dead-functions test_dead_function.c
+echo.
+
 echo ========================================
 echo 所有测试完成！
 echo ========================================
@@ -52,6 +52,42 @@ echo 测试9: 逻辑运算
 echo 测试10: 嵌套控制结构
 %COMPILER% %TEST_DIR%\test_10_nested_control.c > %RESULT_DIR%\test_10_output.txt 2>&1
 
+echo 测试11: x86-64 汇编生成
+%COMPILER% -S -o %RESULT_DIR%\test_11.s %TEST_DIR%\test_11_native_backend.c > %RESULT_DIR%\test_11_output.txt 2>&1
+
+echo 测试12: 寄存器分配
+%COMPILER% -S -o %RESULT_DIR%\test_12.s %TEST_DIR%\test_12_register_allocation.c > %RESULT_DIR%\test_12_output.txt 2>&1
+
+echo 测试13: 中间代码解释执行
+%COMPILER% --run %TEST_DIR%\test_13_interpreter.c > %RESULT_DIR%\test_13_output.txt 2>&1
+
+echo 测试14: 即时编译执行
+%COMPILER% --jit %TEST_DIR%\test_14_jit.c > %RESULT_DIR%\test_14_output.txt 2>&1
+
+echo 测试15: 生成 C 源代码
+%COMPILER% -O --emit-c=%RESULT_DIR%\test_15.c %TEST_DIR%\test_15_c_backend.c > %RESULT_DIR%\test_15_output.txt 2>&1
+
+echo 测试16: 生成 LLVM IR
+%COMPILER% -O --emit-llvm=%RESULT_DIR%\test_16.ll %TEST_DIR%\test_16_llvm_ir.c > %RESULT_DIR%\test_16_output.txt 2>&1
+
+echo 测试17: 生成 ELF 目标文件
+%COMPILER% -O -c -o %RESULT_DIR%\test_17.o %TEST_DIR%\test_17_elf_object.c > %RESULT_DIR%\test_17_output.txt 2>&1
+
+echo 测试18: 树模式指令选择
+%COMPILER% -S -o %RESULT_DIR%\test_18.s %TEST_DIR%\test_18_instruction_selection.c > %RESULT_DIR%\test_18_output.txt 2>&1
+
+echo 测试19: 机器级窥孔优化与分支缩短
+%COMPILER% -c -o %RESULT_DIR%\test_19.o %TEST_DIR%\test_19_machine_peephole.c > %RESULT_DIR%\test_19_output.txt 2>&1
+
+echo 测试20: 数组循环的自动向量化
+%COMPILER% -S -o %RESULT_DIR%\test_20.s %TEST_DIR%\test_20_vectorization.c > %RESULT_DIR%\test_20_output.txt 2>&1
+
+echo 测试21: 全局变量与全局数组
+%COMPILER% --run %TEST_DIR%\test_21_global_variables.c > %RESULT_DIR%\test_21_output.txt 2>&1
+
+echo 测试22: 浮点比较与 NaN
+%COMPILER% -S -o %RESULT_DIR%\test_22.s %TEST_DIR%\test_22_float_nan.c > %RESULT_DIR%\test_22_output.txt 2>&1
+
 echo.
 echo === 错误测试用例 ===
 
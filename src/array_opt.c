@@ -0,0 +1,554 @@
+#include "array_opt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 块内已知的数组元素内容：读取得到的值或写入的值
+typedef struct MemoryEntry
+{
+    ArrayAccess access;
+    Operand *value;
+    Instruction *store; // 写入该值的 ARRAY_SET，读取得到的为NULL
+    bool read;          // 写入之后可能被读取过
+} MemoryEntry;
+
+// 块内已知的仿射下标定义：temp = base + offset
+typedef struct IndexDef
+{
+    Operand *var;
+    ArrayIndex index;
+} IndexDef;
+
+// 单个函数的扫描状态
+typedef struct ArrayState
+{
+    Instruction *func_def;
+    char **shared_names;   // 形参名（形参数组可能与其他形参数组是同一块存储）
+    int shared_count;
+    char **escaped_names;  // 作为实参传给过其他函数的数组
+    int escaped_count;
+    MemoryEntry *entries;
+    int entry_count;
+    int entry_capacity;
+    IndexDef *index_defs;
+    int index_def_count;
+    int index_def_capacity;
+} ArrayState;
+
+// ========================= 别名判断 =========================
+
+static bool index_equal(ArrayIndex *a, ArrayIndex *b)
+{
+    if (a->base == NULL || b->base == NULL)
+        return a->base == b->base;
+    return operands_equal(a->base, b->base);
+}
+
+// 不同名的数组只有都是形参或全局数组时才可能重叠；同名数组比较仿射下标
+AliasResult array_alias(ArrayAccess *a, ArrayAccess *b)
+{
+    if (strcmp(a->array->u.name, b->array->u.name) != 0)
+        return a->shared && b->shared ? ALIAS_MAY : ALIAS_NO;
+
+    if (index_equal(&a->index, &b->index))
+        return a->index.offset == b->index.offset ? ALIAS_MUST : ALIAS_NO;
+    return ALIAS_MAY;
+}
+
+// ========================= 辅助函数 =========================
+
+static bool name_in(char **names, int count, const char *name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void add_name(char ***names, int *count, const char *name)
+{
+    if (name_in(*names, *count, name))
+        return;
+    *names = (char **)realloc(*names, (*count + 1) * sizeof(char *));
+    (*names)[(*count)++] = strdup(name);
+}
+
+static bool is_array_variable(Operand *op)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE;
+}
+
+// 收集形参与逃逸数组
+static void collect_array_names(ArrayState *state)
+{
+    for (Instruction *inst = state->func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_PARAM)
+            add_name(&state->shared_names, &state->shared_count, inst->result->u.name);
+    }
+
+    // 数组名作为实参时被调函数可以读写它
+    for (Instruction *inst = state->func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op != OP_ARG || !is_array_variable(inst->result))
+            continue;
+        for (Instruction *use = state->func_def->next; use != NULL && use->op != OP_FUNC_END; use = use->next)
+        {
+            if ((use->op == OP_ARRAY_GET && operands_equal(use->arg1, inst->result)) ||
+                (use->op == OP_ARRAY_SET && operands_equal(use->result, inst->result)))
+            {
+                add_name(&state->escaped_names, &state->escaped_count, inst->result->u.name);
+                break;
+            }
+        }
+    }
+}
+
+// 下标的仿射形式，base 指向状态中保存的副本或指令中的操作数
+static ArrayIndex affine_index(ArrayState *state, Operand *index)
+{
+    ArrayIndex result = {NULL, 0};
+    if (index->type == OPERAND_CONSTANT)
+    {
+        result.offset = index->u.int_value;
+        return result;
+    }
+    for (int i = state->index_def_count - 1; i >= 0; i--)
+    {
+        if (operands_equal(state->index_defs[i].var, index))
+            return state->index_defs[i].index;
+    }
+    result.base = index;
+    return result;
+}
+
+static ArrayAccess make_access(ArrayState *state, Operand *array, Operand *index)
+{
+    ArrayAccess access;
+    access.array = array;
+    access.index = affine_index(state, index);
+    access.shared = is_global_variable(array->u.name) ||
+                    name_in(state->shared_names, state->shared_count, array->u.name);
+    return access;
+}
+
+static void free_access(ArrayAccess *access)
+{
+    free_operand(access->array);
+    free_operand(access->index.base);
+}
+
+// 保存访问信息的副本，使其不依赖于指令的生存期
+static ArrayAccess copy_access(ArrayAccess *access)
+{
+    ArrayAccess copy = *access;
+    copy.array = copy_operand(access->array);
+    copy.index.base = copy_operand(access->index.base);
+    return copy;
+}
+
+static void remove_entry(ArrayState *state, int i)
+{
+    free_access(&state->entries[i].access);
+    free_operand(state->entries[i].value);
+    state->entries[i] = state->entries[--state->entry_count];
+}
+
+static void add_entry(ArrayState *state, ArrayAccess *access, Operand *value, Instruction *store)
+{
+    if (state->entry_count == state->entry_capacity)
+    {
+        state->entry_capacity = state->entry_capacity ? state->entry_capacity * 2 : 16;
+        state->entries = (MemoryEntry *)realloc(state->entries, state->entry_capacity * sizeof(MemoryEntry));
+    }
+    MemoryEntry *entry = &state->entries[state->entry_count++];
+    entry->access = copy_access(access);
+    entry->value = copy_operand(value);
+    entry->store = store;
+    entry->read = false;
+}
+
+static void clear_state(ArrayState *state)
+{
+    while (state->entry_count > 0)
+        remove_entry(state, state->entry_count - 1);
+    for (int i = 0; i < state->index_def_count; i++)
+    {
+        free_operand(state->index_defs[i].var);
+        free_operand(state->index_defs[i].index.base);
+    }
+    state->index_def_count = 0;
+}
+
+// 把以 def 为基址的下标改用 subst 表示（def = subst - delta），subst 为NULL时返回false
+static bool rebase_index(ArrayIndex *index, Operand *def, Operand *subst, int delta)
+{
+    if (!operands_equal(index->base, def))
+        return true;
+    if (subst == NULL)
+        return false;
+    free_operand(index->base);
+    index->base = copy_operand(subst);
+    index->offset -= delta;
+    return true;
+}
+
+// 变量被重新定义：以它为值的已知内容失效；以它为基址的下标如果还有别的变量
+// 与它相差常量（如 t := i + 1; i := t），改用那个变量表示，否则失效。
+// pending 为新定义的仿射值（可能以 def 的旧值为基址），同样改写，无法表示时返回false
+static bool kill_definition_rebase(ArrayState *state, Operand *def, ArrayIndex *pending)
+{
+    if (def == NULL)
+        return true;
+
+    Operand *subst = NULL;
+    int delta = 0;
+    for (int i = 0; i < state->index_def_count; i++)
+    {
+        IndexDef *index_def = &state->index_defs[i];
+        if (operands_equal(index_def->index.base, def) && !operands_equal(index_def->var, def))
+        {
+            subst = copy_operand(index_def->var);
+            delta = index_def->index.offset;
+            break;
+        }
+    }
+    // i := i + c：旧值等于新值减 c，以 i 为基址的下标改用新值表示，i 本身不需要记录
+    bool self = false;
+    if (subst == NULL && pending != NULL && operands_equal(pending->base, def))
+    {
+        subst = copy_operand(def);
+        delta = pending->offset;
+        self = true;
+    }
+
+    for (int i = state->entry_count - 1; i >= 0; i--)
+    {
+        MemoryEntry *entry = &state->entries[i];
+        if (operands_equal(entry->value, def) || !rebase_index(&entry->access.index, def, subst, delta))
+            remove_entry(state, i);
+    }
+
+    int kept = 0;
+    for (int i = 0; i < state->index_def_count; i++)
+    {
+        IndexDef *index_def = &state->index_defs[i];
+        if (operands_equal(index_def->var, def) || (!self && operands_equal(index_def->var, subst)) ||
+            !rebase_index(&index_def->index, def, subst, delta))
+        {
+            free_operand(index_def->var);
+            free_operand(index_def->index.base);
+            continue;
+        }
+        state->index_defs[kept++] = *index_def;
+    }
+    state->index_def_count = kept;
+
+    bool ok = !self && (pending == NULL || rebase_index(pending, def, subst, delta));
+    free_operand(subst);
+    return ok;
+}
+
+static void kill_definition(ArrayState *state, Operand *def)
+{
+    kill_definition_rebase(state, def, NULL);
+}
+
+// 处理一条定义变量的指令：先按旧值求出新值的仿射形式，再使旧值失效。
+// 识别 x := y + c、x := c + y、x := y - c、x := y、x := c 形式的下标定义
+static void define_variable(ArrayState *state, Instruction *inst)
+{
+    Operand *def = instruction_def(inst);
+    if (def == NULL)
+        return;
+
+    bool affine = true;
+    Operand *base = NULL;
+    int offset = 0;
+    if (def->type != OPERAND_TEMP && def->type != OPERAND_VARIABLE)
+    {
+        affine = false;
+    }
+    else if (inst->op == OP_ASSIGN && inst->arg1->type == OPERAND_CONSTANT)
+    {
+        offset = inst->arg1->u.int_value;
+    }
+    else if (inst->op == OP_ASSIGN && (inst->arg1->type == OPERAND_TEMP || inst->arg1->type == OPERAND_VARIABLE))
+    {
+        base = inst->arg1;
+    }
+    else if ((inst->op == OP_ADD || inst->op == OP_SUB) && inst->arg2->type == OPERAND_CONSTANT &&
+             (inst->arg1->type == OPERAND_TEMP || inst->arg1->type == OPERAND_VARIABLE))
+    {
+        base = inst->arg1;
+        offset = inst->op == OP_ADD ? inst->arg2->u.int_value : -inst->arg2->u.int_value;
+    }
+    else if (inst->op == OP_ADD && inst->arg1->type == OPERAND_CONSTANT &&
+             (inst->arg2->type == OPERAND_TEMP || inst->arg2->type == OPERAND_VARIABLE))
+    {
+        base = inst->arg2;
+        offset = inst->arg1->u.int_value;
+    }
+    else
+    {
+        affine = false;
+    }
+
+    // 基址本身也是已知的仿射下标时展开一层
+    ArrayIndex index = {NULL, offset};
+    if (affine && base != NULL)
+    {
+        ArrayIndex inner = affine_index(state, base);
+        index.base = copy_operand(inner.base);
+        index.offset = inner.offset + offset;
+    }
+
+    if (!kill_definition_rebase(state, def, affine ? &index : NULL) || !affine)
+    {
+        free_operand(index.base);
+        return;
+    }
+
+    if (state->index_def_count == state->index_def_capacity)
+    {
+        state->index_def_capacity = state->index_def_capacity ? state->index_def_capacity * 2 : 16;
+        state->index_defs = (IndexDef *)realloc(state->index_defs, state->index_def_capacity * sizeof(IndexDef));
+    }
+    IndexDef *index_def = &state->index_defs[state->index_def_count++];
+    index_def->var = copy_operand(def);
+    index_def->index = index;
+}
+
+// ========================= 读取与写入 =========================
+
+// x := a[i]：已知 a[i] 的内容时改为复制；返回true表示指令已被删除
+static bool process_load(ArrayState *state, Instruction *prev, Instruction *inst)
+{
+    // 经临时变量间接访问的数组（多维数组的行）无法判断别名，视为读取全部内存
+    if (!is_array_variable(inst->arg1))
+    {
+        for (int i = 0; i < state->entry_count; i++)
+            state->entries[i].read = true;
+        kill_definition(state, inst->result);
+        return false;
+    }
+
+    ArrayAccess access = make_access(state, inst->arg1, inst->arg2);
+
+    for (int i = state->entry_count - 1; i >= 0; i--)
+    {
+        MemoryEntry *entry = &state->entries[i];
+        if (array_alias(&access, &entry->access) != ALIAS_MUST)
+            continue;
+
+        if (entry->store != NULL)
+            opt_stats.store_forwarding_count++;
+        else
+            opt_stats.redundant_load_count++;
+
+        if (operands_equal(entry->value, inst->result))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            return true;
+        }
+
+        free_operand(inst->arg1);
+        free_operand(inst->arg2);
+        inst->op = OP_ASSIGN;
+        inst->arg1 = copy_operand(entry->value);
+        inst->arg2 = NULL;
+        define_variable(state, inst);
+        return false;
+    }
+
+    // 读取内存：可能重叠的写入不再是死存储
+    for (int i = 0; i < state->entry_count; i++)
+    {
+        if (array_alias(&access, &state->entries[i].access) != ALIAS_NO)
+            state->entries[i].read = true;
+    }
+
+    ArrayAccess saved = copy_access(&access);
+    kill_definition(state, inst->result);
+    // x := a[x] 这类读取之后下标已被改写，不能再记录
+    if (!operands_equal(saved.index.base, inst->result))
+        add_entry(state, &saved, inst->result, NULL);
+    free_access(&saved);
+    return false;
+}
+
+// a[i] := v：写入已知内容时删除本条；覆盖未被读取的写入时删除前一条。返回true表示本条已被删除
+static bool process_store(ArrayState *state, Instruction *prev, Instruction *inst)
+{
+    if (!is_array_variable(inst->result))
+    {
+        while (state->entry_count > 0)
+            remove_entry(state, state->entry_count - 1);
+        return false;
+    }
+
+    ArrayAccess access = make_access(state, inst->result, inst->arg1);
+
+    for (int i = state->entry_count - 1; i >= 0; i--)
+    {
+        MemoryEntry *entry = &state->entries[i];
+        if (array_alias(&access, &entry->access) == ALIAS_MUST && operands_equal(entry->value, inst->arg2))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            opt_stats.dead_store_count++;
+            return true;
+        }
+    }
+
+    for (int i = state->entry_count - 1; i >= 0; i--)
+    {
+        MemoryEntry *entry = &state->entries[i];
+        AliasResult alias = array_alias(&access, &entry->access);
+        if (alias == ALIAS_NO)
+            continue;
+
+        if (alias == ALIAS_MUST && entry->store != NULL && !entry->read)
+        {
+            Instruction *dead = entry->store;
+            unlink_instruction(find_prev_instruction(state->func_def, dead), dead);
+            free_instruction(dead);
+            opt_stats.dead_store_count++;
+        }
+        remove_entry(state, i);
+    }
+
+    add_entry(state, &access, inst->arg2, inst);
+    return false;
+}
+
+// 函数调用可能读写全局数组和作为实参传出的数组
+static void process_call(ArrayState *state, Instruction *inst)
+{
+    for (int i = state->entry_count - 1; i >= 0; i--)
+    {
+        MemoryEntry *entry = &state->entries[i];
+        const char *name = entry->access.array->u.name;
+        if (is_global_variable(name) || name_in(state->escaped_names, state->escaped_count, name) ||
+            (entry->value->type == OPERAND_VARIABLE && is_global_variable(entry->value->u.name)) ||
+            (entry->access.index.base != NULL && entry->access.index.base->type == OPERAND_VARIABLE &&
+             is_global_variable(entry->access.index.base->u.name)))
+            remove_entry(state, i);
+    }
+    kill_definition(state, inst->result);
+}
+
+// 局部数组在函数内从未被读取、也没有传给其他函数时，写入它的指令都是死存储
+static bool array_never_read(ArrayState *state, Operand *array)
+{
+    if (is_global_variable(array->u.name) || name_in(state->shared_names, state->shared_count, array->u.name))
+        return false;
+    for (Instruction *inst = state->func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if ((inst->op == OP_ARRAY_GET && operands_equal(inst->arg1, array)) ||
+            (inst->op == OP_ARG && operands_equal(inst->result, array)))
+            return false;
+    }
+    return true;
+}
+
+static void remove_unread_stores(ArrayState *state)
+{
+    Instruction *prev = state->func_def;
+    Instruction *inst = state->func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *next = inst->next;
+        if (inst->op == OP_ARRAY_SET && is_array_variable(inst->result) && array_never_read(state, inst->result))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            opt_stats.dead_store_count++;
+        }
+        else
+        {
+            prev = inst;
+        }
+        inst = next;
+    }
+}
+
+// ========================= 扫描 =========================
+
+static int optimize_function(Instruction *func_def)
+{
+    int before = opt_stats.store_forwarding_count + opt_stats.redundant_load_count + opt_stats.dead_store_count;
+
+    ArrayState state;
+    memset(&state, 0, sizeof(ArrayState));
+    state.func_def = func_def;
+    collect_array_names(&state);
+
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *next = inst->next;
+        bool removed = false;
+
+        switch (inst->op)
+        {
+        case OP_LABEL:
+            clear_state(&state);
+            break;
+        case OP_ARRAY_GET:
+            removed = process_load(&state, prev, inst);
+            break;
+        case OP_ARRAY_SET:
+            removed = process_store(&state, prev, inst);
+            break;
+        case OP_CALL:
+            process_call(&state, inst);
+            break;
+        default:
+            define_variable(&state, inst);
+            break;
+        }
+
+        // 基本块结束
+        if (!removed && is_block_terminator(inst))
+            clear_state(&state);
+
+        // 删除前一条写入时 prev 可能失效，重新定位
+        if (!removed)
+            prev = inst;
+        else if (prev->next != next)
+            prev = find_prev_instruction(func_def, next);
+        inst = next;
+    }
+
+    clear_state(&state);
+    remove_unread_stores(&state);
+    free(state.entries);
+    free(state.index_defs);
+    for (int i = 0; i < state.shared_count; i++)
+        free(state.shared_names[i]);
+    free(state.shared_names);
+    for (int i = 0; i < state.escaped_count; i++)
+        free(state.escaped_names[i]);
+    free(state.escaped_names);
+
+    return opt_stats.store_forwarding_count + opt_stats.redundant_load_count + opt_stats.dead_store_count - before;
+}
+
+// 数组存取优化：转发与冗余读取消除在每个基本块内进行，死存储消除另外处理
+// 整个函数内从未被读取的局部数组。返回消除的读取和写入条数
+int array_load_store_optimization()
+{
+    int total = 0;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            total += optimize_function(inst);
+    }
+    opt_stats.array_access_optimization_count += total;
+    return total;
+}
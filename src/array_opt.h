@@ -0,0 +1,34 @@
+#ifndef ARRAY_OPT_H
+#define ARRAY_OPT_H
+
+#include "cfg.h"
+
+// 两次数组访问之间的别名关系
+typedef enum
+{
+    ALIAS_NO,   // 一定访问不同元素
+    ALIAS_MAY,  // 可能访问同一元素
+    ALIAS_MUST  // 一定访问同一元素
+} AliasResult;
+
+// 数组下标的仿射形式：base + offset，base 为空表示常量下标
+typedef struct ArrayIndex
+{
+    Operand *base;
+    int offset;
+} ArrayIndex;
+
+// 一次数组访问：数组名及下标
+typedef struct ArrayAccess
+{
+    Operand *array;
+    ArrayIndex index;
+    bool shared;    // 形参或全局数组，可能与其他同类数组是同一块存储
+} ArrayAccess;
+
+AliasResult array_alias(ArrayAccess *a, ArrayAccess *b);
+
+// 基于别名分析的数组存取优化：存储到读取的转发、冗余读取消除、死存储消除
+int array_load_store_optimization();
+
+#endif
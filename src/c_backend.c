@@ -0,0 +1,767 @@
+#include "c_backend.h"
+#include "cfg.h"
+#include "type_infer.h"
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 函数的翻译信息：第一遍收集用到的局部变量、临时变量与标签，第二遍输出
+typedef struct CFunction
+{
+    Instruction *def;
+    const char *name;
+    DataType return_type;
+    int param_count;
+    CFG *cfg;
+    signed char **block_types;
+    bool *used;           // 按 cfg->vars 下标：用到的变量与整数临时变量
+    bool *used_float;     // 按 cfg->vars 下标：用到的浮点临时变量
+    bool *labels;         // 按标签编号：被跳转引用的标签
+    DataType *arg_types;  // 实参暂存变量 a<k> 的类型
+    int arg_count;
+} CFunction;
+
+// 等待 CALL 的实参：暂存变量编号，或直接使用的常量与数组
+typedef struct PendingArg
+{
+    Operand *op;
+    DataType type;
+    int local;            // 暂存变量编号，-1 表示直接使用 op
+} PendingArg;
+
+// 全局变量（前端目前不产生，与 x86-64 后端一样支持）
+typedef struct CGlobal
+{
+    const char *name;
+    DataType type;
+    int array_size;
+} CGlobal;
+
+typedef struct CEmitter
+{
+    FILE *fp;             // NULL 表示第一遍，只收集声明
+    CFunction *fn;
+    signed char *types;   // 当前位置上各临时变量的类型
+    PendingArg *args;
+    int arg_count;
+    int arg_capacity;
+    bool failed;
+} CEmitter;
+
+static CFunction *functions = NULL;
+static int function_count = 0;
+static CGlobal *globals = NULL;
+static int global_count = 0;
+static const char **externals = NULL;   // 程序中未定义的被调函数
+static int external_count = 0;
+
+static void emitter_error(CEmitter *E, const char *message)
+{
+    if (!E->failed)
+        fprintf(stderr, "Error: C backend: %s in function %s\n", message, E->fn->name);
+    E->failed = true;
+}
+
+static void cprintf(CEmitter *E, const char *format, ...)
+{
+    if (E->fp == NULL)
+        return;
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(E->fp, format, ap);
+    va_end(ap);
+}
+
+static CFunction *find_function(const char *name)
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        if (strcmp(functions[i].name, name) == 0)
+            return &functions[i];
+    }
+    return NULL;
+}
+
+static const char *c_type(DataType type)
+{
+    return type == TYPE_FLOAT ? "float" : "int";
+}
+
+// C 中的函数名：返回 float 的 main 改名，由生成的 int main 调用并转换返回值
+static const char *c_function_name(const char *name)
+{
+    if (strcmp(name, "main") == 0 && lookup_function_type(name) == TYPE_FLOAT)
+        return "float_main";
+    return name;
+}
+
+// ========================= 变量与操作数 =========================
+
+static bool is_global(CEmitter *E, const char *name, VariableInfo **info_out)
+{
+    VariableInfo *info = lookup_variable_info(E->fn->name, name);
+    *info_out = info;
+    return info != NULL ? info->function == NULL : is_global_variable(name);
+}
+
+static void note_global(const char *name, VariableInfo *info)
+{
+    for (int i = 0; i < global_count; i++)
+    {
+        if (strcmp(globals[i].name, name) == 0)
+            return;
+    }
+    globals = (CGlobal *)realloc(globals, (global_count + 1) * sizeof(CGlobal));
+    globals[global_count].name = name;
+    globals[global_count].type = info != NULL && info->type == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+    globals[global_count].array_size = info != NULL ? info->array_size : 0;
+    global_count++;
+}
+
+// 记录用到的变量；多维数组不支持
+static void note_variable(CEmitter *E, Operand *op)
+{
+    VariableInfo *info;
+    if (is_global(E, op->u.name, &info))
+        note_global(op->u.name, info);
+    else
+    {
+        int index = operand_table_lookup(&E->fn->cfg->vars, op);
+        if (index >= 0)
+            E->fn->used[index] = true;
+    }
+    if (info != NULL && info->array_size < 0)
+        emitter_error(E, "multi-dimensional array access is not supported");
+}
+
+static DataType value_type(CEmitter *E, Operand *op)
+{
+    return operand_value_type(E->fn->cfg, E->fn->name, E->types, op);
+}
+
+// 临时变量按类型分为 t<n>（int）与 f<n>（float）两个 C 变量
+static void print_temp(CEmitter *E, Operand *op, DataType type)
+{
+    int index = operand_table_lookup(&E->fn->cfg->vars, op);
+    if (index >= 0)
+    {
+        if (type == TYPE_FLOAT)
+            E->fn->used_float[index] = true;
+        else
+            E->fn->used[index] = true;
+    }
+    cprintf(E, "%c%d", type == TYPE_FLOAT ? 'f' : 't', op->u.temp_no);
+}
+
+static void print_int_literal(CEmitter *E, int value)
+{
+    if (value == INT_MIN)
+        cprintf(E, "(-2147483647 - 1)");
+    else if (value < 0)
+        cprintf(E, "(%d)", value);
+    else
+        cprintf(E, "%d", value);
+}
+
+static void print_float_literal(CEmitter *E, float value)
+{
+    if (isnan(value))
+        cprintf(E, "__builtin_nanf(\"\")");
+    else if (isinf(value))
+        cprintf(E, value > 0 ? "__builtin_inff()" : "(-__builtin_inff())");
+    else
+    {
+        // 9 位有效数字足以精确还原单精度值
+        char text[64];
+        snprintf(text, sizeof(text), "%.9g", value);
+        const char *suffix = strpbrk(text, ".e") != NULL ? "f" : ".0f";
+        cprintf(E, value < 0 ? "(%s%s)" : "%s%s", text, suffix);
+    }
+}
+
+// 按 type 读取操作数的 C 表达式，类型不同时显式转换
+static void c_operand(CEmitter *E, Operand *op, DataType type)
+{
+    switch (op->type)
+    {
+    case OPERAND_CONSTANT:
+        if (type == TYPE_FLOAT)
+            print_float_literal(E, (float)op->u.int_value);
+        else
+            print_int_literal(E, op->u.int_value);
+        break;
+    case OPERAND_CONSTANT_FLOAT:
+        if (type == TYPE_FLOAT)
+            print_float_literal(E, op->u.float_value);
+        else
+            print_int_literal(E, (int)op->u.float_value);
+        break;
+    case OPERAND_TEMP:
+    case OPERAND_VARIABLE:
+    {
+        DataType have = value_type(E, op);
+        if (have != type)
+            cprintf(E, "(%s)", c_type(type));
+        if (op->type == OPERAND_TEMP)
+            print_temp(E, op, have);
+        else
+        {
+            note_variable(E, op);
+            cprintf(E, "v_%s", op->u.name);
+        }
+        break;
+    }
+    default:
+        emitter_error(E, "unsupported operand");
+        break;
+    }
+}
+
+// 结果的 C 左值：变量按声明类型（赋值时隐式转换），临时变量按结果类型
+static void print_result(CEmitter *E, Operand *x, DataType type)
+{
+    if (x->type == OPERAND_TEMP)
+        print_temp(E, x, type);
+    else if (x->type == OPERAND_VARIABLE)
+    {
+        note_variable(E, x);
+        cprintf(E, "v_%s", x->u.name);
+    }
+    else
+        emitter_error(E, "unsupported result operand");
+}
+
+static void print_array(CEmitter *E, Operand *op)
+{
+    VariableInfo *info = op->type == OPERAND_VARIABLE ? lookup_variable_info(E->fn->name, op->u.name) : NULL;
+    if (info == NULL || info->array_size == 0)
+    {
+        emitter_error(E, "unknown array access is not supported");
+        return;
+    }
+    note_variable(E, op);
+    cprintf(E, "v_%s", op->u.name);
+}
+
+static void note_label(CEmitter *E, Operand *label)
+{
+    if (label->type == OPERAND_LABEL && label->u.temp_no >= 0 && label->u.temp_no <= label_count)
+        E->fn->labels[label->u.temp_no] = true;
+}
+
+// ========================= 指令翻译 =========================
+
+static DataType common_type(CEmitter *E, Operand *a, Operand *b)
+{
+    return value_type(E, a) == TYPE_FLOAT || value_type(E, b) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+}
+
+static const char *relation_operator(OpType op)
+{
+    switch (op)
+    {
+    case OP_GT:
+    case OP_IF_GT:
+        return ">";
+    case OP_LT:
+    case OP_IF_LT:
+        return "<";
+    case OP_GE:
+    case OP_IF_GE:
+        return ">=";
+    case OP_LE:
+    case OP_IF_LE:
+        return "<=";
+    case OP_EQ:
+    case OP_IF_EQ:
+        return "==";
+    default:
+        return "!=";
+    }
+}
+
+static void print_relation(CEmitter *E, OpType op, Operand *a, Operand *b)
+{
+    DataType type = common_type(E, a, b);
+    c_operand(E, a, type);
+    cprintf(E, " %s ", relation_operator(op));
+    c_operand(E, b, type);
+}
+
+// 整数加减乘经 unsigned 计算，按补码回绕而不是触发 C 的有符号溢出未定义行为
+static void translate_binary(CEmitter *E, Instruction *inst, const char *operator)
+{
+    DataType type = common_type(E, inst->arg1, inst->arg2);
+    bool wrap = type == TYPE_INT && inst->op != OP_DIV;
+    cprintf(E, "    ");
+    print_result(E, inst->result, type);
+    cprintf(E, wrap ? " = (int)((unsigned)" : " = ");
+    c_operand(E, inst->arg1, type);
+    cprintf(E, wrap ? " %s (unsigned)" : " %s ", operator);
+    c_operand(E, inst->arg2, type);
+    cprintf(E, wrap ? ");\n" : ";\n");
+}
+
+static void translate_logical(CEmitter *E, Instruction *inst, const char *operator)
+{
+    cprintf(E, "    ");
+    print_result(E, inst->result, TYPE_INT);
+    cprintf(E, " = ");
+    c_operand(E, inst->arg1, value_type(E, inst->arg1));
+    cprintf(E, " %s ", operator);
+    c_operand(E, inst->arg2, value_type(E, inst->arg2));
+    cprintf(E, ";\n");
+}
+
+// 实参在 ARG 处求值：变量与临时变量先存入暂存变量，避免 CALL 之前被改写
+static void translate_arg(CEmitter *E, Instruction *inst)
+{
+    Operand *op = inst->result;
+    if (E->arg_count == E->arg_capacity)
+    {
+        E->arg_capacity = E->arg_capacity ? E->arg_capacity * 2 : 8;
+        E->args = (PendingArg *)realloc(E->args, E->arg_capacity * sizeof(PendingArg));
+    }
+    PendingArg *arg = &E->args[E->arg_count++];
+    arg->op = op;
+    arg->local = -1;
+    arg->type = value_type(E, op);
+
+    VariableInfo *info = op->type == OPERAND_VARIABLE ? lookup_variable_info(E->fn->name, op->u.name) : NULL;
+    if (op->type == OPERAND_CONSTANT || op->type == OPERAND_CONSTANT_FLOAT || (info != NULL && info->array_size != 0))
+        return;
+
+    CFunction *fn = E->fn;
+    arg->local = fn->arg_count++;
+    if (E->fp == NULL)
+    {
+        fn->arg_types = (DataType *)realloc(fn->arg_types, fn->arg_count * sizeof(DataType));
+        fn->arg_types[arg->local] = arg->type;
+    }
+    cprintf(E, "    a%d = ", arg->local);
+    c_operand(E, op, arg->type);
+    cprintf(E, ";\n");
+}
+
+static void add_external(const char *name)
+{
+    for (int i = 0; i < external_count; i++)
+    {
+        if (strcmp(externals[i], name) == 0)
+            return;
+    }
+    externals = (const char **)realloc(externals, (external_count + 1) * sizeof(const char *));
+    externals[external_count++] = name;
+}
+
+// 被调函数的形参个数决定消耗多少个待传实参，形参类型由原型隐式转换
+static void translate_call(CEmitter *E, Instruction *inst)
+{
+    const char *name = inst->arg1->u.name;
+    CFunction *callee = find_function(name);
+    int count = callee != NULL ? callee->param_count : E->arg_count;
+    if (callee == NULL)
+        add_external(name);
+    if (count > E->arg_count)
+    {
+        emitter_error(E, "call has fewer arguments than parameters");
+        return;
+    }
+
+    cprintf(E, "    ");
+    if (inst->result != NULL)
+    {
+        print_result(E, inst->result, lookup_function_type(name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT);
+        cprintf(E, " = ");
+    }
+    cprintf(E, "%s(", c_function_name(name));
+    PendingArg *args = E->args + (E->arg_count - count);
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0)
+            cprintf(E, ", ");
+        if (args[i].local >= 0)
+            cprintf(E, "a%d", args[i].local);
+        else if (args[i].op->type == OPERAND_VARIABLE)
+            print_array(E, args[i].op);
+        else
+            c_operand(E, args[i].op, args[i].type);
+    }
+    cprintf(E, ");\n");
+    E->arg_count -= count;
+}
+
+static void translate_instruction(CEmitter *E, Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_LABEL:
+        // 只输出被引用的标签（第一遍收集引用）
+        if (inst->result->type == OPERAND_LABEL && inst->result->u.temp_no <= label_count &&
+            E->fn->labels[inst->result->u.temp_no])
+            cprintf(E, "L%d:\n", inst->result->u.temp_no);
+        break;
+    case OP_GOTO:
+        note_label(E, inst->arg1);
+        cprintf(E, "    goto L%d;\n", inst->arg1->u.temp_no);
+        break;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+        note_label(E, inst->arg2);
+        cprintf(E, inst->op == OP_IF_GOTO ? "    if (" : "    if (!");
+        c_operand(E, inst->arg1, value_type(E, inst->arg1));
+        cprintf(E, ")\n        goto L%d;\n", inst->arg2->u.temp_no);
+        break;
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        note_label(E, inst->result);
+        cprintf(E, "    if (");
+        print_relation(E, inst->op, inst->arg1, inst->arg2);
+        cprintf(E, ")\n        goto L%d;\n", inst->result->u.temp_no);
+        break;
+    case OP_ASSIGN:
+    {
+        DataType type = inst->result->type == OPERAND_VARIABLE
+                            ? declared_variable_type(E->fn->name, inst->result->u.name)
+                            : value_type(E, inst->arg1);
+        cprintf(E, "    ");
+        print_result(E, inst->result, type);
+        cprintf(E, " = ");
+        c_operand(E, inst->arg1, type);
+        cprintf(E, ";\n");
+        break;
+    }
+    case OP_ADD:
+        translate_binary(E, inst, "+");
+        break;
+    case OP_SUB:
+        translate_binary(E, inst, "-");
+        break;
+    case OP_MUL:
+        translate_binary(E, inst, "*");
+        break;
+    case OP_DIV:
+        translate_binary(E, inst, "/");
+        break;
+    case OP_AND:
+        translate_logical(E, inst, "&&");
+        break;
+    case OP_OR:
+        translate_logical(E, inst, "||");
+        break;
+    case OP_NEG:
+    {
+        DataType type = value_type(E, inst->arg1);
+        cprintf(E, "    ");
+        print_result(E, inst->result, type);
+        cprintf(E, type == TYPE_FLOAT ? " = -" : " = (int)-(unsigned)");
+        c_operand(E, inst->arg1, type);
+        cprintf(E, ";\n");
+        break;
+    }
+    case OP_NOT:
+        cprintf(E, "    ");
+        print_result(E, inst->result, TYPE_INT);
+        cprintf(E, " = !");
+        c_operand(E, inst->arg1, value_type(E, inst->arg1));
+        cprintf(E, ";\n");
+        break;
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        cprintf(E, "    ");
+        print_result(E, inst->result, TYPE_INT);
+        cprintf(E, " = ");
+        print_relation(E, inst->op, inst->arg1, inst->arg2);
+        cprintf(E, ";\n");
+        break;
+    case OP_ARRAY_GET:
+    {
+        DataType type = inst->arg1->type == OPERAND_VARIABLE
+                            ? declared_variable_type(E->fn->name, inst->arg1->u.name)
+                            : TYPE_INT;
+        cprintf(E, "    ");
+        print_result(E, inst->result, type);
+        cprintf(E, " = ");
+        print_array(E, inst->arg1);
+        cprintf(E, "[");
+        c_operand(E, inst->arg2, TYPE_INT);
+        cprintf(E, "];\n");
+        break;
+    }
+    case OP_ARRAY_SET:
+    {
+        DataType type = inst->result->type == OPERAND_VARIABLE
+                            ? declared_variable_type(E->fn->name, inst->result->u.name)
+                            : TYPE_INT;
+        cprintf(E, "    ");
+        print_array(E, inst->result);
+        cprintf(E, "[");
+        c_operand(E, inst->arg1, TYPE_INT);
+        cprintf(E, "] = ");
+        c_operand(E, inst->arg2, type);
+        cprintf(E, ";\n");
+        break;
+    }
+    case OP_ARG:
+        translate_arg(E, inst);
+        break;
+    case OP_CALL:
+        translate_call(E, inst);
+        break;
+    case OP_PARAM:
+        // 形参出现在函数签名中
+        break;
+    case OP_RETURN:
+        cprintf(E, "    return ");
+        if (inst->result != NULL)
+            c_operand(E, inst->result, E->fn->return_type);
+        else
+            cprintf(E, "0");
+        cprintf(E, ";\n");
+        break;
+    case OP_FUNC_DEF:
+    case OP_FUNC_END:
+        break;
+    default:
+        emitter_error(E, "unsupported instruction");
+        break;
+    }
+}
+
+// 按指令顺序逐块翻译函数体，块入口处恢复到达的临时变量类型
+static bool translate_body(CFunction *fn, FILE *fp)
+{
+    CEmitter E;
+    memset(&E, 0, sizeof(E));
+    E.fp = fp;
+    E.fn = fn;
+    fn->arg_count = 0;
+
+    int count = fn->cfg->vars.count + 1;
+    E.types = (signed char *)malloc(count);
+    for (int b = 0; b < fn->cfg->block_count && !E.failed; b++)
+    {
+        BasicBlock *block = fn->cfg->blocks[b];
+        memcpy(E.types, fn->block_types[b], count);
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            translate_instruction(&E, inst);
+            transfer_temp_types(fn->cfg, fn->name, E.types, inst);
+            if (inst == block->last || E.failed)
+                break;
+        }
+    }
+    free(E.types);
+    free(E.args);
+    return !E.failed;
+}
+
+// ========================= 输出 =========================
+
+// 形参以 PARAM 指令为准（删除无用形参后变量登记中仍标记为形参）
+static bool is_param(CFunction *fn, const char *name)
+{
+    for (Instruction *p = fn->def->next; p != NULL && p->op == OP_PARAM; p = p->next)
+    {
+        if (strcmp(p->result->u.name, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void print_prototype(FILE *fp, CFunction *fn)
+{
+    fprintf(fp, "%s %s(", c_type(fn->return_type), c_function_name(fn->name));
+    int k = 0;
+    for (Instruction *p = fn->def->next; p != NULL && p->op == OP_PARAM; p = p->next, k++)
+    {
+        const char *name = p->result->u.name;
+        VariableInfo *info = lookup_variable_info(fn->name, name);
+        DataType type = declared_variable_type(fn->name, name);
+        bool array = info != NULL && info->array_size != 0;
+        fprintf(fp, "%s%s %sv_%s", k > 0 ? ", " : "", c_type(type), array ? "*" : "", name);
+    }
+    if (k == 0)
+        fprintf(fp, "void");
+    fprintf(fp, ")");
+}
+
+// 局部声明：标量变量清零（与解释器一致），数组为定长数组，临时变量与实参暂存变量不初始化。
+// 返回是否输出了声明
+static bool print_locals(FILE *fp, CFunction *fn)
+{
+    long start = ftell(fp);
+    OperandTable *vars = &fn->cfg->vars;
+    for (int i = 0; i < vars->count; i++)
+    {
+        Operand *op = vars->keys[i];
+        if (!fn->used[i] || op->type != OPERAND_VARIABLE || is_param(fn, op->u.name))
+            continue;
+        VariableInfo *info = lookup_variable_info(fn->name, op->u.name);
+        if (info == NULL ? is_global_variable(op->u.name) : info->function == NULL)
+            continue;
+        DataType type = declared_variable_type(fn->name, op->u.name);
+        if (info != NULL && info->array_size > 0)
+            fprintf(fp, "    %s v_%s[%d];\n", c_type(type), op->u.name, info->array_size);
+        else
+            fprintf(fp, "    %s v_%s = 0;\n", c_type(type), op->u.name);
+    }
+    for (int i = 0; i < vars->count; i++)
+    {
+        Operand *op = vars->keys[i];
+        if (op->type != OPERAND_TEMP)
+            continue;
+        if (fn->used[i])
+            fprintf(fp, "    int t%d;\n", op->u.temp_no);
+        if (fn->used_float[i])
+            fprintf(fp, "    float f%d;\n", op->u.temp_no);
+    }
+    for (int k = 0; k < fn->arg_count; k++)
+        fprintf(fp, "    %s a%d;\n", c_type(fn->arg_types[k]), k);
+    return ftell(fp) != start;
+}
+
+// 函数体是否以 return 结束（否则补上 return 0）
+static bool ends_with_return(CFunction *fn)
+{
+    Instruction *last = NULL;
+    for (Instruction *inst = fn->def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+        last = inst;
+    return last != NULL && last->op == OP_RETURN;
+}
+
+static void collect_functions()
+{
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+        functions = (CFunction *)realloc(functions, (function_count + 1) * sizeof(CFunction));
+        CFunction *fn = &functions[function_count++];
+        memset(fn, 0, sizeof(CFunction));
+        fn->def = inst;
+        fn->name = inst->result->u.name;
+        fn->return_type = lookup_function_type(fn->name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+        for (Instruction *p = inst->next; p != NULL && p->op == OP_PARAM; p = p->next)
+            fn->param_count++;
+    }
+}
+
+static void free_functions()
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        CFunction *fn = &functions[i];
+        if (fn->cfg != NULL)
+        {
+            free_temp_types(fn->cfg, fn->block_types);
+            free_cfg(fn->cfg);
+        }
+        free(fn->used);
+        free(fn->used_float);
+        free(fn->labels);
+        free(fn->arg_types);
+    }
+    free(functions);
+    free(globals);
+    free(externals);
+    functions = NULL;
+    function_count = 0;
+    globals = NULL;
+    global_count = 0;
+    externals = NULL;
+    external_count = 0;
+}
+
+static void print_program(FILE *fp)
+{
+    fprintf(fp, "/* Generated from three-address code; compile with gcc -O2 */\n");
+    fprintf(fp, "#include <stdlib.h>\n\n");
+
+    for (int i = 0; i < global_count; i++)
+    {
+        CGlobal *g = &globals[i];
+        if (g->array_size > 0)
+            fprintf(fp, "static %s v_%s[%d];\n", c_type(g->type), g->name, g->array_size);
+        else
+            fprintf(fp, "static %s v_%s;\n", c_type(g->type), g->name);
+    }
+    if (global_count > 0)
+        fprintf(fp, "\n");
+
+    // 越界处理函数未由程序定义时提供缺省实现；其他外部函数按返回 int 声明
+    for (int i = 0; i < external_count; i++)
+    {
+        if (strcmp(externals[i], BOUNDS_CHECK_FAIL_FUNCTION) == 0)
+            fprintf(fp, "static int %s(void)\n{\n    abort();\n}\n\n", externals[i]);
+        else
+            fprintf(fp, "int %s();\n", externals[i]);
+    }
+    for (int i = 0; i < function_count; i++)
+    {
+        print_prototype(fp, &functions[i]);
+        fprintf(fp, ";\n");
+    }
+
+    for (int i = 0; i < function_count; i++)
+    {
+        CFunction *fn = &functions[i];
+        fprintf(fp, "\n");
+        print_prototype(fp, fn);
+        fprintf(fp, "\n{\n");
+        if (print_locals(fp, fn))
+            fprintf(fp, "\n");
+        translate_body(fn, fp);
+        // 函数体可能顺序执行到末尾
+        if (!ends_with_return(fn))
+            fprintf(fp, "    return 0;\n");
+        fprintf(fp, "}\n");
+    }
+
+    CFunction *main_fn = find_function("main");
+    if (main_fn != NULL && main_fn->return_type == TYPE_FLOAT)
+        fprintf(fp, "\nint main(void)\n{\n    return (int)float_main();\n}\n");
+}
+
+bool write_c_source(const char *filename)
+{
+    collect_functions();
+
+    // 第一遍：推断临时变量类型，收集用到的变量、临时变量、标签与实参暂存变量
+    bool ok = true;
+    for (int i = 0; i < function_count && ok; i++)
+    {
+        CFunction *fn = &functions[i];
+        fn->cfg = build_cfg(fn->def);
+        fn->block_types = infer_temp_types(fn->cfg, fn->name);
+        fn->used = (bool *)calloc(fn->cfg->vars.count + 1, sizeof(bool));
+        fn->used_float = (bool *)calloc(fn->cfg->vars.count + 1, sizeof(bool));
+        fn->labels = (bool *)calloc(label_count + 1, sizeof(bool));
+        ok = translate_body(fn, NULL);
+    }
+
+    FILE *fp = ok ? fopen(filename, "w") : NULL;
+    if (ok && fp == NULL)
+    {
+        perror(filename);
+        ok = false;
+    }
+    if (ok)
+    {
+        print_program(fp);
+        fclose(fp);
+    }
+    free_functions();
+    return ok;
+}
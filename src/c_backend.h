@@ -0,0 +1,12 @@
+#ifndef C_BACKEND_H
+#define C_BACKEND_H
+
+#include "codegen.h"
+
+// 把三地址代码翻译为可移植的 C 源文件：每个函数对应一个 C 函数，变量与数组成为局部变量
+// （数组为定长数组，数组形参为指针），临时变量按到达的类型成为 int/float 局部变量，
+// 控制流用标签与 goto 表示。整数运算按补码回绕，与解释器和 x86-64 后端一致。
+// 输出可直接用 gcc -O2 编译；不支持的构造（多维数组）报错并返回false
+bool write_c_source(const char *filename);
+
+#endif
@@ -0,0 +1,368 @@
+#include "callgraph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========================= 函数属性 =========================
+
+// 形参个数
+int function_param_count(Instruction *func_def)
+{
+    int count = 0;
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op == OP_PARAM; inst = inst->next)
+        count++;
+    return count;
+}
+
+// 函数体大小：不计PARAM和标签的指令数
+int function_size(Instruction *func_def)
+{
+    int size = 0;
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op != OP_PARAM && inst->op != OP_LABEL)
+            size++;
+    }
+    return size;
+}
+
+// ========================= 调用图构建 =========================
+
+static unsigned int name_hash(const char *name)
+{
+    unsigned int hash = 5381;
+    for (const char *p = name; *p; p++)
+        hash = hash * 33 + (unsigned char)*p;
+    return hash;
+}
+
+// 按函数名查找结点下标，不存在返回-1
+int call_graph_find(CallGraph *graph, const char *name)
+{
+    if (graph->bucket_count == 0)
+        return -1;
+
+    unsigned int mask = graph->bucket_count - 1;
+    for (unsigned int b = name_hash(name) & mask; graph->buckets[b] != 0; b = (b + 1) & mask)
+    {
+        int index = graph->buckets[b] - 1;
+        if (strcmp(graph->nodes[index].name, name) == 0)
+            return index;
+    }
+    return -1;
+}
+
+static void build_name_index(CallGraph *graph)
+{
+    graph->bucket_count = 16;
+    while (graph->bucket_count < graph->node_count * 2)
+        graph->bucket_count *= 2;
+    graph->buckets = (int *)calloc(graph->bucket_count, sizeof(int));
+
+    unsigned int mask = graph->bucket_count - 1;
+    for (int i = 0; i < graph->node_count; i++)
+    {
+        unsigned int b = name_hash(graph->nodes[i].name) & mask;
+        while (graph->buckets[b] != 0)
+            b = (b + 1) & mask;
+        graph->buckets[b] = i + 1;
+    }
+}
+
+static void add_callee(CallGraphNode *node, int callee)
+{
+    for (int i = 0; i < node->callee_count; i++)
+    {
+        if (node->callees[i] == callee)
+            return;
+    }
+    if (node->callee_count == node->callee_capacity)
+    {
+        node->callee_capacity = node->callee_capacity ? node->callee_capacity * 2 : 4;
+        node->callees = (int *)realloc(node->callees, node->callee_capacity * sizeof(int));
+    }
+    node->callees[node->callee_count++] = callee;
+}
+
+// Tarjan 强连通分量算法的状态
+typedef struct SccState
+{
+    int *index;
+    int *lowlink;
+    bool *on_stack;
+    int *stack;
+    int stack_top;
+    int next_index;
+    int order_count;
+} SccState;
+
+static void strong_connect(CallGraph *graph, SccState *state, int v)
+{
+    state->index[v] = state->lowlink[v] = state->next_index++;
+    state->stack[state->stack_top++] = v;
+    state->on_stack[v] = true;
+
+    CallGraphNode *node = &graph->nodes[v];
+    for (int i = 0; i < node->callee_count; i++)
+    {
+        int w = node->callees[i];
+        if (state->index[w] < 0)
+        {
+            strong_connect(graph, state, w);
+            if (state->lowlink[w] < state->lowlink[v])
+                state->lowlink[v] = state->lowlink[w];
+        }
+        else if (state->on_stack[w] && state->index[w] < state->lowlink[v])
+        {
+            state->lowlink[v] = state->index[w];
+        }
+    }
+
+    if (state->lowlink[v] != state->index[v])
+        return;
+
+    // v 是分量的根：弹出整个分量。Tarjan 按逆拓扑序产生分量，即被调者在前
+    int scc = graph->scc_count++;
+    int first = state->order_count;
+    int w;
+    do
+    {
+        w = state->stack[--state->stack_top];
+        state->on_stack[w] = false;
+        graph->nodes[w].scc = scc;
+        graph->bottom_up[state->order_count++] = w;
+    } while (w != v);
+
+    bool recursive = state->order_count - first > 1;
+    for (int i = 0; i < node->callee_count && !recursive; i++)
+    {
+        if (node->callees[i] == v)
+            recursive = true;
+    }
+    for (int i = first; i < state->order_count; i++)
+        graph->nodes[graph->bottom_up[i]].recursive = recursive;
+}
+
+// 根据 OP_CALL 构建整个程序的调用图，并计算强连通分量
+CallGraph *build_call_graph()
+{
+    CallGraph *graph = (CallGraph *)calloc(1, sizeof(CallGraph));
+
+    int capacity = 0;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+        if (graph->node_count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 8;
+            graph->nodes = (CallGraphNode *)realloc(graph->nodes, capacity * sizeof(CallGraphNode));
+        }
+        CallGraphNode *node = &graph->nodes[graph->node_count++];
+        memset(node, 0, sizeof(CallGraphNode));
+        node->name = inst->result->u.name;
+        node->func_def = inst;
+        node->param_count = function_param_count(inst);
+    }
+
+    build_name_index(graph);
+
+    int current = -1;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+        {
+            current++;
+        }
+        else if (inst->op == OP_CALL && current >= 0 && inst->arg1 != NULL)
+        {
+            int callee = call_graph_find(graph, inst->arg1->u.name);
+            if (callee >= 0)
+            {
+                add_callee(&graph->nodes[current], callee);
+                graph->nodes[callee].call_site_count++;
+            }
+        }
+    }
+
+    SccState state;
+    int n = graph->node_count;
+    state.index = (int *)malloc((n + 1) * sizeof(int));
+    state.lowlink = (int *)malloc((n + 1) * sizeof(int));
+    state.on_stack = (bool *)calloc(n + 1, sizeof(bool));
+    state.stack = (int *)malloc((n + 1) * sizeof(int));
+    state.stack_top = 0;
+    state.next_index = 0;
+    state.order_count = 0;
+    graph->bottom_up = (int *)malloc((n + 1) * sizeof(int));
+    for (int i = 0; i < n; i++)
+        state.index[i] = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (state.index[i] < 0)
+            strong_connect(graph, &state, i);
+    }
+
+    free(state.index);
+    free(state.lowlink);
+    free(state.on_stack);
+    free(state.stack);
+    return graph;
+}
+
+void free_call_graph(CallGraph *graph)
+{
+    if (graph == NULL)
+        return;
+
+    for (int i = 0; i < graph->node_count; i++)
+        free(graph->nodes[i].callees);
+    free(graph->nodes);
+    free(graph->bottom_up);
+    free(graph->buckets);
+    free(graph);
+}
+
+// ========================= 调用点 =========================
+
+// 收集调用点。ARG 按从左到右的顺序压栈，CALL 弹出被调函数形参个数的实参，
+// 因此实参列表中嵌套调用的 ARG 会先被内层 CALL 弹出
+int collect_call_sites(CallGraph *graph, CallSite **sites_out)
+{
+    int count = 0;
+    int capacity = 16;
+    CallSite *sites = (CallSite *)malloc(capacity * sizeof(CallSite));
+    int stack_capacity = 16;
+    Instruction **stack = (Instruction **)malloc(stack_capacity * sizeof(Instruction *));
+
+    for (int f = 0; f < graph->node_count; f++)
+    {
+        int depth = 0;
+        for (Instruction *inst = graph->nodes[f].func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+        {
+            if (inst->op == OP_ARG)
+            {
+                if (depth == stack_capacity)
+                {
+                    stack_capacity *= 2;
+                    stack = (Instruction **)realloc(stack, stack_capacity * sizeof(Instruction *));
+                }
+                stack[depth++] = inst;
+                continue;
+            }
+            if (inst->op != OP_CALL)
+                continue;
+
+            int callee = inst->arg1 ? call_graph_find(graph, inst->arg1->u.name) : -1;
+            int arg_count = callee >= 0 ? graph->nodes[callee].param_count : depth;
+            if (arg_count > depth)
+            {
+                depth = 0;
+                continue;
+            }
+            depth -= arg_count;
+            if (callee < 0)
+                continue;
+
+            if (count == capacity)
+            {
+                capacity *= 2;
+                sites = (CallSite *)realloc(sites, capacity * sizeof(CallSite));
+            }
+            CallSite *site = &sites[count++];
+            site->call = inst;
+            site->caller = f;
+            site->callee = callee;
+            site->arg_count = arg_count;
+            site->args = (Instruction **)malloc((arg_count + 1) * sizeof(Instruction *));
+            memcpy(site->args, &stack[depth], arg_count * sizeof(Instruction *));
+        }
+    }
+
+    free(stack);
+    *sites_out = sites;
+    return count;
+}
+
+void free_call_sites(CallSite *sites, int site_count)
+{
+    for (int i = 0; i < site_count; i++)
+        free(sites[i].args);
+    free(sites);
+}
+
+// ========================= 无用函数删除 =========================
+
+static void mark_reachable(CallGraph *graph, int v, bool *reachable)
+{
+    if (reachable[v])
+        return;
+    reachable[v] = true;
+    for (int i = 0; i < graph->nodes[v].callee_count; i++)
+        mark_reachable(graph, graph->nodes[v].callees[i], reachable);
+}
+
+// 删除从根函数不可达的函数，返回删除的函数个数。
+// 一个根函数都找不到时（如不含main的库文件）不做任何删除
+int remove_unreachable_functions()
+{
+    CallGraph *graph = build_call_graph();
+    bool *reachable = (bool *)calloc(graph->node_count + 1, sizeof(bool));
+
+    int roots_found = 0;
+    if (opt_options.function_root_count == 0)
+    {
+        int root = call_graph_find(graph, "main");
+        if (root >= 0)
+        {
+            mark_reachable(graph, root, reachable);
+            roots_found++;
+        }
+    }
+    for (int i = 0; i < opt_options.function_root_count; i++)
+    {
+        int root = call_graph_find(graph, opt_options.function_roots[i]);
+        if (root >= 0)
+        {
+            mark_reachable(graph, root, reachable);
+            roots_found++;
+        }
+    }
+
+    int removed = 0;
+    for (int i = 0; i < graph->node_count && roots_found > 0; i++)
+    {
+        if (reachable[i])
+            continue;
+
+        Instruction *func_def = graph->nodes[i].func_def;
+        Instruction *prev = NULL;
+        if (func_def != code_head)
+        {
+            prev = code_head;
+            while (prev->next != func_def)
+                prev = prev->next;
+        }
+
+        bool last = false;
+        while (!last)
+        {
+            Instruction *inst = prev ? prev->next : code_head;
+            last = inst->op == OP_FUNC_END;
+            if (prev)
+                prev->next = inst->next;
+            else
+                code_head = inst->next;
+            if (inst == code_tail)
+                code_tail = prev;
+            free_instruction(inst);
+        }
+        removed++;
+    }
+
+    free(reachable);
+    free_call_graph(graph);
+    opt_stats.dead_function_count += removed;
+    return removed;
+}
@@ -0,0 +1,58 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "codegen.h"
+#include <stdbool.h>
+
+// 调用图结点（每个函数一个）
+typedef struct CallGraphNode
+{
+    const char *name;      // 函数名（指向FUNCTION指令的操作数）
+    Instruction *func_def; // FUNCTION 指令
+    int param_count;       // 形参个数
+    int *callees;          // 被调函数下标（已去重）
+    int callee_count;
+    int callee_capacity;
+    int call_site_count;   // 被调用的次数
+    int scc;               // 所在强连通分量编号
+    bool recursive;        // 处于调用环中（含直接递归）
+} CallGraphNode;
+
+// 调用图
+typedef struct CallGraph
+{
+    CallGraphNode *nodes;
+    int node_count;
+    int *bottom_up;        // 自底向上顺序：被调函数排在调用者之前
+    int scc_count;
+    int *buckets;          // 函数名哈希表（开放寻址，存放下标+1）
+    int bucket_count;
+} CallGraph;
+
+// 调用点：CALL 指令及按形参顺序排列的 ARG 指令
+typedef struct CallSite
+{
+    Instruction *call;
+    Instruction **args;
+    int arg_count;
+    int caller;            // 调用者结点下标
+    int callee;            // 被调者结点下标
+} CallSite;
+
+// 调用图构建与释放
+CallGraph *build_call_graph();
+void free_call_graph(CallGraph *graph);
+int call_graph_find(CallGraph *graph, const char *name);
+
+// 收集所有实参个数与形参一致的调用点
+int collect_call_sites(CallGraph *graph, CallSite **sites_out);
+void free_call_sites(CallSite *sites, int site_count);
+
+// 删除从根函数（opt_options.function_roots，默认main）不可达的函数
+int remove_unreachable_functions();
+
+// 函数属性
+int function_param_count(Instruction *func_def);
+int function_size(Instruction *func_def);
+
+#endif
@@ -0,0 +1,913 @@
+#include "cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========================= 位集合 =========================
+
+#define BITS_PER_WORD (8 * (int)sizeof(BitWord))
+
+BitWord *bitset_new(int words)
+{
+    return (BitWord *)calloc(words > 0 ? words : 1, sizeof(BitWord));
+}
+
+bool bitset_test(BitWord *set, int index)
+{
+    return (set[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1u;
+}
+
+void bitset_set(BitWord *set, int index)
+{
+    set[index / BITS_PER_WORD] |= 1u << (index % BITS_PER_WORD);
+}
+
+void bitset_clear(BitWord *set, int index)
+{
+    set[index / BITS_PER_WORD] &= ~(1u << (index % BITS_PER_WORD));
+}
+
+// ========================= 操作数编号表 =========================
+
+static unsigned int operand_hash(Operand *op)
+{
+    if (op->type == OPERAND_TEMP)
+        return (unsigned int)op->u.temp_no * 2654435761u;
+
+    unsigned int h = 5381;
+    for (const char *p = op->u.name; *p; p++)
+        h = h * 33 + (unsigned char)*p;
+    return h ^ 0x9e3779b9u;
+}
+
+static bool is_tracked_operand(Operand *op)
+{
+    return op != NULL && (op->type == OPERAND_VARIABLE || op->type == OPERAND_TEMP);
+}
+
+static void operand_table_grow(OperandTable *table)
+{
+    int new_bucket_count = table->bucket_count ? table->bucket_count * 2 : 64;
+    int *new_buckets = (int *)calloc(new_bucket_count, sizeof(int));
+
+    for (int i = 0; i < table->count; i++)
+    {
+        unsigned int slot = operand_hash(table->keys[i]) & (new_bucket_count - 1);
+        while (new_buckets[slot] != 0)
+            slot = (slot + 1) & (new_bucket_count - 1);
+        new_buckets[slot] = i + 1;
+    }
+
+    free(table->buckets);
+    table->buckets = new_buckets;
+    table->bucket_count = new_bucket_count;
+}
+
+// 查找操作数下标，未登记时返回-1
+int operand_table_lookup(OperandTable *table, Operand *op)
+{
+    if (!is_tracked_operand(op) || table->bucket_count == 0)
+        return -1;
+
+    unsigned int slot = operand_hash(op) & (table->bucket_count - 1);
+    while (table->buckets[slot] != 0)
+    {
+        int index = table->buckets[slot] - 1;
+        if (operands_equal(table->keys[index], op))
+            return index;
+        slot = (slot + 1) & (table->bucket_count - 1);
+    }
+    return -1;
+}
+
+// 获取操作数下标，未登记时分配新下标
+int operand_table_index(OperandTable *table, Operand *op)
+{
+    if (!is_tracked_operand(op))
+        return -1;
+
+    int index = operand_table_lookup(table, op);
+    if (index >= 0)
+        return index;
+
+    if ((table->count + 1) * 2 > table->bucket_count)
+        operand_table_grow(table);
+    if (table->count == table->capacity)
+    {
+        table->capacity = table->capacity ? table->capacity * 2 : 32;
+        table->keys = (Operand **)realloc(table->keys, table->capacity * sizeof(Operand *));
+    }
+
+    index = table->count++;
+    table->keys[index] = op;
+
+    unsigned int slot = operand_hash(op) & (table->bucket_count - 1);
+    while (table->buckets[slot] != 0)
+        slot = (slot + 1) & (table->bucket_count - 1);
+    table->buckets[slot] = index + 1;
+    return index;
+}
+
+// ========================= 指令属性 =========================
+
+// 获取指令定义的操作数（没有则返回NULL）
+Operand *instruction_def(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+    case OP_NEG:
+    case OP_NOT:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_AND:
+    case OP_OR:
+    case OP_CALL:
+    case OP_PARAM:
+    case OP_ARRAY_GET:
+    case OP_ADDR:
+    case OP_DEREF:
+        return inst->result;
+    default:
+        return NULL;
+    }
+}
+
+// 获取指令使用的操作数，返回个数（最多3个）
+int instruction_uses(Instruction *inst, Operand **uses)
+{
+    int count = 0;
+
+    switch (inst->op)
+    {
+    case OP_ARG:
+    case OP_RETURN:
+        if (inst->result)
+            uses[count++] = inst->result;
+        break;
+    case OP_ARRAY_SET:
+        if (inst->result)
+            uses[count++] = inst->result;
+        if (inst->arg1)
+            uses[count++] = inst->arg1;
+        if (inst->arg2)
+            uses[count++] = inst->arg2;
+        break;
+    case OP_GOTO:
+    case OP_LABEL:
+    case OP_CALL:
+    case OP_PARAM:
+    case OP_FUNC_DEF:
+    case OP_FUNC_END:
+        break;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+        if (inst->arg1)
+            uses[count++] = inst->arg1;
+        break;
+    default:
+        if (inst->arg1)
+            uses[count++] = inst->arg1;
+        if (inst->arg2)
+            uses[count++] = inst->arg2;
+        break;
+    }
+
+    return count;
+}
+
+// 无副作用、结果未被使用时可以删除的指令
+bool is_pure_instruction(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+    case OP_NEG:
+    case OP_NOT:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_AND:
+    case OP_OR:
+    case OP_ARRAY_GET:
+    case OP_ADDR:
+    case OP_DEREF:
+        return inst->result != NULL;
+    default:
+        return false;
+    }
+}
+
+// 结束基本块的指令
+bool is_block_terminator(Instruction *inst)
+{
+    return inst->op == OP_GOTO || inst->op == OP_RETURN ||
+           is_conditional_branch(inst->op);
+}
+
+// 跳转指令的目标标签
+Operand *branch_target(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_GOTO:
+        return inst->arg1;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+        return inst->arg2;
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        return inst->result;
+    default:
+        return NULL;
+    }
+}
+
+// 修改跳转指令的目标标签（接管target）
+void set_branch_target(Instruction *inst, Operand *target)
+{
+    Operand **slot = NULL;
+    if (inst->op == OP_GOTO)
+        slot = &inst->arg1;
+    else if (inst->op == OP_IF_GOTO || inst->op == OP_IF_NOT_GOTO)
+        slot = &inst->arg2;
+    else if (is_relational_branch(inst->op))
+        slot = &inst->result;
+    if (slot == NULL)
+        return;
+
+    free_operand(*slot);
+    *slot = target;
+}
+
+static bool is_dead_marker(Instruction *inst)
+{
+    return inst->op == OP_LABEL && inst->result &&
+           (inst->result->type == OPERAND_VARIABLE || inst->result->type == OPERAND_TEMP);
+}
+
+// ========================= 指令链表辅助 =========================
+
+// 从from开始向后查找inst的前一条指令
+Instruction *find_prev_instruction(Instruction *from, Instruction *inst)
+{
+    if (from == NULL || from == inst)
+        return NULL;
+
+    Instruction *current = from;
+    while (current != NULL && current->next != inst)
+        current = current->next;
+    return current;
+}
+
+// 在pos之后插入指令（pos为NULL时插入到链表头）
+void insert_instruction_after(Instruction *pos, Instruction *inst)
+{
+    if (pos == NULL)
+    {
+        inst->next = code_head;
+        code_head = inst;
+        if (code_tail == NULL)
+            code_tail = inst;
+        return;
+    }
+
+    inst->next = pos->next;
+    pos->next = inst;
+    if (pos == code_tail)
+        code_tail = inst;
+}
+
+// 将inst从链表中摘下（不释放），prev为其前一条指令
+void unlink_instruction(Instruction *prev, Instruction *inst)
+{
+    if (prev == NULL)
+        code_head = inst->next;
+    else
+        prev->next = inst->next;
+
+    if (inst == code_tail)
+        code_tail = prev;
+    inst->next = NULL;
+}
+
+// 清除旧死代码消除留下的标记指令
+void purge_dead_markers()
+{
+    Instruction *prev = NULL;
+    Instruction *inst = code_head;
+
+    while (inst != NULL)
+    {
+        Instruction *next = inst->next;
+        if (is_dead_marker(inst))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+        }
+        else
+        {
+            prev = inst;
+        }
+        inst = next;
+    }
+}
+
+// ========================= 控制流图构建 =========================
+
+static BasicBlock *new_basic_block(int id, Instruction *first)
+{
+    BasicBlock *block = (BasicBlock *)calloc(1, sizeof(BasicBlock));
+    block->id = id;
+    block->first = first;
+    block->last = first;
+    block->succs = (BasicBlock **)calloc(2, sizeof(BasicBlock *));
+    block->rpo = -1;
+    return block;
+}
+
+static void add_edge(BasicBlock *from, BasicBlock *to)
+{
+    if (to == NULL)
+        return;
+    for (int i = 0; i < from->succ_count; i++)
+    {
+        if (from->succs[i] == to)
+            return;
+    }
+
+    from->succs[from->succ_count++] = to;
+
+    if (to->pred_count == to->pred_capacity)
+    {
+        to->pred_capacity = to->pred_capacity ? to->pred_capacity * 2 : 4;
+        to->preds = (BasicBlock **)realloc(to->preds, to->pred_capacity * sizeof(BasicBlock *));
+    }
+    to->preds[to->pred_count++] = from;
+}
+
+static void compute_rpo(CFG *cfg)
+{
+    if (cfg->block_count == 0)
+        return;
+
+    // 迭代式深度优先遍历，得到后序后再反转
+    BasicBlock **stack = (BasicBlock **)malloc(cfg->block_count * sizeof(BasicBlock *));
+    int *next_succ = (int *)calloc(cfg->block_count, sizeof(int));
+    bool *visited = (bool *)calloc(cfg->block_count, sizeof(bool));
+    BasicBlock **postorder = (BasicBlock **)malloc(cfg->block_count * sizeof(BasicBlock *));
+    int post_count = 0;
+    int top = 0;
+
+    stack[top++] = cfg->blocks[0];
+    visited[0] = true;
+
+    while (top > 0)
+    {
+        BasicBlock *block = stack[top - 1];
+        if (next_succ[block->id] < block->succ_count)
+        {
+            BasicBlock *succ = block->succs[next_succ[block->id]++];
+            if (!visited[succ->id])
+            {
+                visited[succ->id] = true;
+                stack[top++] = succ;
+            }
+        }
+        else
+        {
+            postorder[post_count++] = block;
+            top--;
+        }
+    }
+
+    cfg->rpo_order = (BasicBlock **)malloc(post_count * sizeof(BasicBlock *));
+    cfg->rpo_count = post_count;
+    for (int i = 0; i < post_count; i++)
+    {
+        cfg->rpo_order[i] = postorder[post_count - 1 - i];
+        cfg->rpo_order[i]->rpo = i;
+    }
+
+    free(stack);
+    free(next_succ);
+    free(visited);
+    free(postorder);
+}
+
+// 为FUNCTION指令开始的函数构建控制流图
+CFG *build_cfg(Instruction *func_def)
+{
+    CFG *cfg = (CFG *)calloc(1, sizeof(CFG));
+    cfg->func_def = func_def;
+    cfg->label_limit = label_count + 1;
+    cfg->label_block = (BasicBlock **)calloc(cfg->label_limit, sizeof(BasicBlock *));
+
+    int capacity = 16;
+    cfg->blocks = (BasicBlock **)malloc(capacity * sizeof(BasicBlock *));
+
+    // 第一遍：划分基本块
+    BasicBlock *current = NULL;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        bool is_label = inst->op == OP_LABEL && inst->result &&
+                        inst->result->type == OPERAND_LABEL;
+
+        if (current == NULL || is_label)
+        {
+            if (cfg->block_count == capacity)
+            {
+                capacity *= 2;
+                cfg->blocks = (BasicBlock **)realloc(cfg->blocks, capacity * sizeof(BasicBlock *));
+            }
+            current = new_basic_block(cfg->block_count, inst);
+            cfg->blocks[cfg->block_count++] = current;
+        }
+        current->last = inst;
+
+        if (is_label && inst->result->u.temp_no < cfg->label_limit)
+            cfg->label_block[inst->result->u.temp_no] = current;
+
+        Operand *uses[3];
+        int use_count = instruction_uses(inst, uses);
+        for (int i = 0; i < use_count; i++)
+            operand_table_index(&cfg->vars, uses[i]);
+        operand_table_index(&cfg->vars, instruction_def(inst));
+
+        if (is_block_terminator(inst))
+            current = NULL;
+        inst = inst->next;
+    }
+    cfg->func_end = inst;
+
+    // 第二遍：连接边
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        BasicBlock *fallthrough = i + 1 < cfg->block_count ? cfg->blocks[i + 1] : NULL;
+        Instruction *last = block->last;
+        Operand *target = branch_target(last);
+
+        if (target != NULL && target->type == OPERAND_LABEL &&
+            target->u.temp_no < cfg->label_limit)
+        {
+            add_edge(block, cfg->label_block[target->u.temp_no]);
+        }
+
+        if (last->op != OP_GOTO && last->op != OP_RETURN)
+            add_edge(block, fallthrough);
+    }
+
+    cfg->bitset_words = (cfg->vars.count + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    compute_rpo(cfg);
+    return cfg;
+}
+
+void free_cfg(CFG *cfg)
+{
+    if (cfg == NULL)
+        return;
+
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        free(block->succs);
+        free(block->preds);
+        free(block->live_in);
+        free(block->live_out);
+        free(block);
+    }
+    free(cfg->blocks);
+    free(cfg->rpo_order);
+    free(cfg->label_block);
+    free(cfg->vars.keys);
+    free(cfg->vars.buckets);
+    free(cfg);
+}
+
+// ========================= 支配关系 =========================
+
+static BasicBlock *intersect(BasicBlock *a, BasicBlock *b)
+{
+    while (a != b)
+    {
+        while (a->rpo > b->rpo)
+            a = a->idom;
+        while (b->rpo > a->rpo)
+            b = b->idom;
+    }
+    return a;
+}
+
+// Cooper-Harvey-Kennedy 迭代算法计算直接支配者
+void compute_dominators(CFG *cfg)
+{
+    if (cfg->rpo_count == 0)
+        return;
+
+    for (int i = 0; i < cfg->block_count; i++)
+        cfg->blocks[i]->idom = NULL;
+
+    BasicBlock *entry = cfg->rpo_order[0];
+    entry->idom = entry;
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int i = 1; i < cfg->rpo_count; i++)
+        {
+            BasicBlock *block = cfg->rpo_order[i];
+            BasicBlock *new_idom = NULL;
+
+            for (int p = 0; p < block->pred_count; p++)
+            {
+                BasicBlock *pred = block->preds[p];
+                if (pred->idom == NULL)
+                    continue;
+                new_idom = new_idom == NULL ? pred : intersect(pred, new_idom);
+            }
+
+            if (new_idom != NULL && block->idom != new_idom)
+            {
+                block->idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+}
+
+// 判断a是否支配b
+bool dominates(BasicBlock *a, BasicBlock *b)
+{
+    if (a->rpo < 0 || b->rpo < 0)
+        return false;
+
+    while (b != a)
+    {
+        if (b->idom == b || b->idom == NULL)
+            return false;
+        b = b->idom;
+    }
+    return true;
+}
+
+// ========================= 自然循环 =========================
+
+bool loop_contains(Loop *loop, BasicBlock *block)
+{
+    return block != NULL && loop->contains[block->id];
+}
+
+static void loop_add_block(Loop *loop, BasicBlock *block)
+{
+    if (!loop->contains[block->id])
+    {
+        loop->contains[block->id] = true;
+        loop->blocks[loop->block_count++] = block;
+    }
+}
+
+static int compare_loop_size(const void *a, const void *b)
+{
+    const Loop *la = *(const Loop *const *)a;
+    const Loop *lb = *(const Loop *const *)b;
+    return la->block_count - lb->block_count;
+}
+
+// 通过回边（目标支配源的边）识别自然循环，按从内到外排序
+int find_natural_loops(CFG *cfg, Loop ***loops_out)
+{
+    int loop_count = 0;
+    int capacity = 4;
+    Loop **loops = (Loop **)malloc(capacity * sizeof(Loop *));
+    BasicBlock **worklist = (BasicBlock **)malloc((cfg->block_count + 1) * sizeof(BasicBlock *));
+
+    for (int i = 0; i < cfg->rpo_count; i++)
+    {
+        BasicBlock *latch = cfg->rpo_order[i];
+        for (int s = 0; s < latch->succ_count; s++)
+        {
+            BasicBlock *header = latch->succs[s];
+            if (!dominates(header, latch))
+                continue;
+
+            // 同一循环头的多条回边合并为一个循环
+            Loop *loop = NULL;
+            for (int l = 0; l < loop_count; l++)
+            {
+                if (loops[l]->header == header)
+                    loop = loops[l];
+            }
+            if (loop == NULL)
+            {
+                if (loop_count == capacity)
+                {
+                    capacity *= 2;
+                    loops = (Loop **)realloc(loops, capacity * sizeof(Loop *));
+                }
+                loop = (Loop *)calloc(1, sizeof(Loop));
+                loop->header = header;
+                loop->contains = (bool *)calloc(cfg->block_count, sizeof(bool));
+                loop->blocks = (BasicBlock **)malloc(cfg->block_count * sizeof(BasicBlock *));
+                loop_add_block(loop, header);
+                loops[loop_count++] = loop;
+            }
+
+            // 从回边源逆向搜索到循环头为止
+            int top = 0;
+            if (!loop->contains[latch->id])
+            {
+                loop_add_block(loop, latch);
+                worklist[top++] = latch;
+            }
+            while (top > 0)
+            {
+                BasicBlock *block = worklist[--top];
+                for (int p = 0; p < block->pred_count; p++)
+                {
+                    BasicBlock *pred = block->preds[p];
+                    if (pred->rpo >= 0 && !loop->contains[pred->id])
+                    {
+                        loop_add_block(loop, pred);
+                        worklist[top++] = pred;
+                    }
+                }
+            }
+        }
+    }
+    free(worklist);
+
+    qsort(loops, loop_count, sizeof(Loop *), compare_loop_size);
+
+    // 计算嵌套关系：包含该循环头的最小外层循环
+    for (int i = 0; i < loop_count; i++)
+    {
+        for (int j = i + 1; j < loop_count; j++)
+        {
+            if (loops[j]->contains[loops[i]->header->id])
+            {
+                loops[i]->parent = loops[j];
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < loop_count; i++)
+    {
+        int depth = 0;
+        for (Loop *l = loops[i]; l != NULL; l = l->parent)
+            depth++;
+        loops[i]->depth = depth;
+    }
+
+    *loops_out = loops;
+    return loop_count;
+}
+
+void free_loops(Loop **loops, int loop_count)
+{
+    for (int i = 0; i < loop_count; i++)
+    {
+        free(loops[i]->contains);
+        free(loops[i]->blocks);
+        free(loops[i]);
+    }
+    free(loops);
+}
+
+// ========================= 活跃变量分析 =========================
+
+// 全局变量在函数出口和函数调用处视为活跃
+static void mark_globals(CFG *cfg, BitWord *set)
+{
+    for (int i = 0; i < cfg->vars.count; i++)
+    {
+        Operand *op = cfg->vars.keys[i];
+        if (op->type == OPERAND_VARIABLE && is_global_variable(op->u.name))
+            bitset_set(set, i);
+    }
+}
+
+// 对一条指令做逆向传递：live = (live - def) ∪ use
+static void transfer_instruction(CFG *cfg, Instruction *inst, BitWord *live, BitWord *globals)
+{
+    int def = operand_table_lookup(&cfg->vars, instruction_def(inst));
+    if (def >= 0)
+        bitset_clear(live, def);
+
+    Operand *uses[3];
+    int use_count = instruction_uses(inst, uses);
+    for (int i = 0; i < use_count; i++)
+    {
+        int index = operand_table_lookup(&cfg->vars, uses[i]);
+        if (index >= 0)
+            bitset_set(live, index);
+    }
+
+    if (inst->op == OP_CALL || inst->op == OP_RETURN)
+    {
+        for (int w = 0; w < cfg->bitset_words; w++)
+            live[w] |= globals[w];
+    }
+}
+
+static int collect_block_instructions(BasicBlock *block, Instruction ***buffer, int *capacity)
+{
+    int count = 0;
+    for (Instruction *inst = block->first;; inst = inst->next)
+    {
+        if (count == *capacity)
+        {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            *buffer = (Instruction **)realloc(*buffer, *capacity * sizeof(Instruction *));
+        }
+        (*buffer)[count++] = inst;
+        if (inst == block->last)
+            break;
+    }
+    return count;
+}
+
+// 迭代求解活跃变量（逆向数据流）
+void compute_liveness(CFG *cfg)
+{
+    int words = cfg->bitset_words;
+    BitWord *globals = bitset_new(words);
+    BitWord *live = bitset_new(words);
+    mark_globals(cfg, globals);
+
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        free(block->live_in);
+        free(block->live_out);
+        block->live_in = bitset_new(words);
+        block->live_out = bitset_new(words);
+    }
+
+    Instruction **buffer = NULL;
+    int capacity = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int i = cfg->block_count - 1; i >= 0; i--)
+        {
+            BasicBlock *block = cfg->blocks[i];
+
+            // live_out = ∪ succ.live_in；落到函数末尾时全局变量活跃
+            memset(block->live_out, 0, words * sizeof(BitWord));
+            for (int s = 0; s < block->succ_count; s++)
+            {
+                for (int w = 0; w < words; w++)
+                    block->live_out[w] |= block->succs[s]->live_in[w];
+            }
+            if (block->succ_count == 0)
+            {
+                for (int w = 0; w < words; w++)
+                    block->live_out[w] |= globals[w];
+            }
+
+            memcpy(live, block->live_out, words * sizeof(BitWord));
+            int count = collect_block_instructions(block, &buffer, &capacity);
+            for (int k = count - 1; k >= 0; k--)
+                transfer_instruction(cfg, buffer[k], live, globals);
+
+            if (memcmp(live, block->live_in, words * sizeof(BitWord)) != 0)
+            {
+                memcpy(block->live_in, live, words * sizeof(BitWord));
+                changed = true;
+            }
+        }
+    }
+
+    free(buffer);
+    free(globals);
+    free(live);
+}
+
+bool is_live_in(CFG *cfg, BasicBlock *block, Operand *op)
+{
+    int index = operand_table_lookup(&cfg->vars, op);
+    return index >= 0 && block->live_in != NULL && bitset_test(block->live_in, index);
+}
+
+// ========================= 死代码消除 =========================
+
+// 删除单个函数中结果不再活跃的无副作用指令，返回删除条数
+static int eliminate_dead_in_function(CFG *cfg)
+{
+    int removed = 0;
+    int words = cfg->bitset_words;
+    BitWord *globals = bitset_new(words);
+    BitWord *live = bitset_new(words);
+    Instruction **buffer = NULL;
+    int capacity = 0;
+    // 变量表的键指向指令中的操作数，被删指令须等全部块处理完再释放
+    Instruction *garbage = NULL;
+
+    mark_globals(cfg, globals);
+    compute_liveness(cfg);
+
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        int count = collect_block_instructions(block, &buffer, &capacity);
+        bool *dead = (bool *)calloc(count, sizeof(bool));
+
+        memcpy(live, block->live_out, words * sizeof(BitWord));
+        for (int k = count - 1; k >= 0; k--)
+        {
+            Instruction *inst = buffer[k];
+            int def = operand_table_lookup(&cfg->vars, instruction_def(inst));
+            // 不可达块中只删除无副作用的指令，控制流指令原样保留
+            if (is_pure_instruction(inst) &&
+                (block->rpo < 0 || (def >= 0 && !bitset_test(live, def))))
+            {
+                dead[k] = true;
+                continue;
+            }
+            transfer_instruction(cfg, inst, live, globals);
+        }
+
+        // 从后向前摘除，保持块首指令指针有效
+        Instruction *prev = find_prev_instruction(cfg->func_def, block->first);
+        for (int k = 0; k < count; k++)
+        {
+            if (dead[k])
+            {
+                unlink_instruction(prev, buffer[k]);
+                buffer[k]->next = garbage;
+                garbage = buffer[k];
+                removed++;
+            }
+            else
+            {
+                prev = buffer[k];
+            }
+        }
+        free(dead);
+    }
+
+    while (garbage != NULL)
+    {
+        Instruction *next = garbage->next;
+        free_instruction(garbage);
+        garbage = next;
+    }
+
+    free(buffer);
+    free(globals);
+    free(live);
+    return removed;
+}
+
+// 基于活跃变量的全局死代码消除，迭代到不动点
+int liveness_dead_code_elimination()
+{
+    int total = 0;
+    bool changed = true;
+
+    purge_dead_markers();
+    while (changed)
+    {
+        changed = false;
+        for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+        {
+            if (inst->op != OP_FUNC_DEF)
+                continue;
+
+            CFG *cfg = build_cfg(inst);
+            int removed = eliminate_dead_in_function(cfg);
+            free_cfg(cfg);
+
+            if (removed > 0)
+            {
+                total += removed;
+                changed = true;
+            }
+        }
+    }
+
+    return total;
+}
@@ -0,0 +1,105 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "codegen.h"
+#include <stdbool.h>
+
+// 位集合（用于数据流分析）
+typedef unsigned int BitWord;
+
+// 基本块
+typedef struct BasicBlock
+{
+    int id;                     // 块编号（按指令顺序）
+    Instruction *first;         // 块内第一条指令
+    Instruction *last;          // 块内最后一条指令
+    struct BasicBlock **succs;  // 后继块（最多两个）
+    int succ_count;
+    struct BasicBlock **preds;  // 前驱块
+    int pred_count;
+    int pred_capacity;
+    struct BasicBlock *idom;    // 直接支配者
+    int rpo;                    // 逆后序编号（不可达块为-1）
+    BitWord *live_in;           // 入口活跃变量
+    BitWord *live_out;          // 出口活跃变量
+} BasicBlock;
+
+// 操作数编号表：变量/临时变量 -> 稠密下标
+typedef struct OperandTable
+{
+    Operand **keys;  // 每个下标对应的代表操作数
+    int count;
+    int capacity;
+    int *buckets;    // 开放寻址哈希桶，存放下标+1
+    int bucket_count;
+} OperandTable;
+
+// 单个函数的控制流图
+typedef struct CFG
+{
+    Instruction *func_def;   // FUNCTION 指令
+    Instruction *func_end;   // END FUNCTION 指令
+    BasicBlock **blocks;     // 按指令顺序排列的基本块
+    int block_count;
+    BasicBlock **rpo_order;  // 按逆后序排列的可达块
+    int rpo_count;
+    BasicBlock **label_block; // 标签编号 -> 所在基本块
+    int label_limit;
+    OperandTable vars;       // 函数内出现的变量和临时变量
+    int bitset_words;        // 活跃变量位集合的字数
+} CFG;
+
+// 自然循环
+typedef struct Loop
+{
+    BasicBlock *header;      // 循环头
+    bool *contains;          // 按块编号索引的成员标记
+    BasicBlock **blocks;     // 循环内的基本块
+    int block_count;
+    struct Loop *parent;     // 直接外层循环
+    int depth;               // 嵌套深度（最外层为1）
+} Loop;
+
+// 控制流图构建与释放
+CFG *build_cfg(Instruction *func_def);
+void free_cfg(CFG *cfg);
+void purge_dead_markers();
+
+// 支配关系与循环
+void compute_dominators(CFG *cfg);
+bool dominates(BasicBlock *a, BasicBlock *b);
+int find_natural_loops(CFG *cfg, Loop ***loops_out);
+void free_loops(Loop **loops, int loop_count);
+bool loop_contains(Loop *loop, BasicBlock *block);
+
+// 活跃变量分析
+void compute_liveness(CFG *cfg);
+bool is_live_in(CFG *cfg, BasicBlock *block, Operand *op);
+
+// 操作数编号
+int operand_table_lookup(OperandTable *table, Operand *op);
+int operand_table_index(OperandTable *table, Operand *op);
+
+// 指令属性
+Operand *instruction_def(Instruction *inst);
+int instruction_uses(Instruction *inst, Operand **uses);
+bool is_pure_instruction(Instruction *inst);
+bool is_block_terminator(Instruction *inst);
+Operand *branch_target(Instruction *inst);
+void set_branch_target(Instruction *inst, Operand *target);
+
+// 指令链表辅助
+Instruction *find_prev_instruction(Instruction *from, Instruction *inst);
+void insert_instruction_after(Instruction *pos, Instruction *inst);
+void unlink_instruction(Instruction *prev, Instruction *inst);
+
+// 基于活跃变量的死代码消除
+int liveness_dead_code_elimination();
+
+// 位集合辅助
+BitWord *bitset_new(int words);
+bool bitset_test(BitWord *set, int index);
+void bitset_set(BitWord *set, int index);
+void bitset_clear(BitWord *set, int index);
+
+#endif
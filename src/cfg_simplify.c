@@ -0,0 +1,431 @@
+#include "cfg_simplify.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 跳转穿透时最多跟随的跳转数（防止 GOTO 环）
+#define JUMP_THREAD_MAX_HOPS 8
+
+// 单个函数化简的最大轮数
+#define CFG_SIMPLIFY_MAX_ROUNDS 100
+
+// ========================= 辅助函数 =========================
+
+static bool is_label_instruction(Instruction *inst)
+{
+    return inst->op == OP_LABEL && inst->result && inst->result->type == OPERAND_LABEL;
+}
+
+static bool is_jump(Instruction *inst)
+{
+    return inst->op == OP_GOTO || is_conditional_branch(inst->op);
+}
+
+static bool is_label_operand(Operand *op)
+{
+    return op != NULL && op->type == OPERAND_LABEL && op->u.temp_no <= label_count;
+}
+
+// 建立标签编号 -> 标签指令的映射
+static Instruction **map_labels(Instruction *func_def)
+{
+    Instruction **labels = (Instruction **)calloc(label_count + 1, sizeof(Instruction *));
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (is_label_instruction(inst) && inst->result->u.temp_no <= label_count)
+            labels[inst->result->u.temp_no] = inst;
+    }
+    return labels;
+}
+
+// 统计每个标签被跳转引用的次数
+static int *count_label_refs(Instruction *func_def)
+{
+    int *refs = (int *)calloc(label_count + 1, sizeof(int));
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        Operand *target = is_jump(inst) ? branch_target(inst) : NULL;
+        if (is_label_operand(target))
+            refs[target->u.temp_no]++;
+    }
+    return refs;
+}
+
+// 跳过连续的标签，返回第一条非标签指令
+static Instruction *skip_labels(Instruction *inst)
+{
+    while (inst != NULL && inst->op == OP_LABEL)
+        inst = inst->next;
+    return inst;
+}
+
+// 跳转目标标签所在位置之后的第一条实际指令
+static Instruction *jump_destination(Instruction **labels, Operand *target)
+{
+    if (!is_label_operand(target) || labels[target->u.temp_no] == NULL)
+        return NULL;
+    return skip_labels(labels[target->u.temp_no]);
+}
+
+// 标签target是否紧跟在inst之后（中间只隔着其他标签）
+static bool label_follows(Instruction *inst, Operand *target)
+{
+    for (Instruction *p = inst->next; p != NULL && p->op == OP_LABEL; p = p->next)
+    {
+        if (operands_equal(p->result, target))
+            return true;
+    }
+    return false;
+}
+
+static bool constant_value(Operand *op, double *value)
+{
+    if (op == NULL)
+        return false;
+    if (op->type == OPERAND_CONSTANT)
+    {
+        *value = op->u.int_value;
+        return true;
+    }
+    if (op->type == OPERAND_CONSTANT_FLOAT)
+    {
+        *value = op->u.float_value;
+        return true;
+    }
+    return false;
+}
+
+// 常量条件跳转的求值：1总是跳转，0从不跳转，-1无法确定
+static int evaluate_constant_branch(Instruction *inst)
+{
+    double a, b;
+
+    if (inst->op == OP_IF_GOTO || inst->op == OP_IF_NOT_GOTO)
+    {
+        if (!constant_value(inst->arg1, &a))
+            return -1;
+        int truth = a != 0;
+        return inst->op == OP_IF_GOTO ? truth : !truth;
+    }
+
+    if (!is_relational_branch(inst->op) ||
+        !constant_value(inst->arg1, &a) || !constant_value(inst->arg2, &b))
+        return -1;
+
+    switch (inst->op)
+    {
+    case OP_IF_GT:
+        return a > b;
+    case OP_IF_LT:
+        return a < b;
+    case OP_IF_GE:
+        return a >= b;
+    case OP_IF_LE:
+        return a <= b;
+    case OP_IF_EQ:
+        return a == b;
+    case OP_IF_NE:
+        return a != b;
+    default:
+        return -1;
+    }
+}
+
+// ========================= 化简规则 =========================
+
+// 常量条件：总成立的改为 GOTO，总不成立的删除
+static int fold_constant_branches(Instruction *func_def)
+{
+    int changes = 0;
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *next = inst->next;
+        int taken = is_conditional_branch(inst->op) ? evaluate_constant_branch(inst) : -1;
+
+        if (taken == 1)
+        {
+            Operand *target = copy_operand(branch_target(inst));
+            free_operand(inst->result);
+            free_operand(inst->arg1);
+            free_operand(inst->arg2);
+            inst->op = OP_GOTO;
+            inst->result = NULL;
+            inst->arg1 = target;
+            inst->arg2 = NULL;
+            changes++;
+        }
+        else if (taken == 0)
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            changes++;
+            inst = next;
+            continue;
+        }
+
+        prev = inst;
+        inst = next;
+    }
+
+    return changes;
+}
+
+// 跳转穿透：跳到 GOTO 的跳转直接跳到最终目标，跳到 RETURN 的 GOTO 直接返回
+static int thread_jumps(Instruction *func_def, Instruction **labels)
+{
+    int changes = 0;
+
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (!is_jump(inst))
+            continue;
+
+        Operand *target = branch_target(inst);
+        Operand *final = target;
+        for (int hops = 0; hops < JUMP_THREAD_MAX_HOPS; hops++)
+        {
+            Instruction *dest = jump_destination(labels, final);
+            if (dest == NULL || dest->op != OP_GOTO || dest == inst)
+                break;
+            final = dest->arg1;
+        }
+        if (!operands_equal(final, target))
+        {
+            set_branch_target(inst, copy_operand(final));
+            changes++;
+        }
+
+        if (inst->op == OP_GOTO)
+        {
+            Instruction *dest = jump_destination(labels, inst->arg1);
+            if (dest != NULL && dest->op == OP_RETURN)
+            {
+                free_operand(inst->arg1);
+                inst->op = OP_RETURN;
+                inst->result = copy_operand(dest->result);
+                inst->arg1 = NULL;
+                changes++;
+            }
+        }
+    }
+
+    return changes;
+}
+
+// 删除跳到紧随其后标签的跳转
+static int remove_fallthrough_jumps(Instruction *func_def)
+{
+    int changes = 0;
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *next = inst->next;
+        if (is_jump(inst) && label_follows(inst, branch_target(inst)))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            changes++;
+            inst = next;
+            continue;
+        }
+        prev = inst;
+        inst = next;
+    }
+
+    return changes;
+}
+
+// 删除从入口不可达的基本块
+static int remove_unreachable_blocks(Instruction *func_def)
+{
+    int changes = 0;
+    CFG *cfg = build_cfg(func_def);
+
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        if (block->rpo >= 0)
+            continue;
+
+        Instruction *prev = find_prev_instruction(func_def, block->first);
+        Instruction *inst = block->first;
+        while (true)
+        {
+            Instruction *next = inst->next;
+            bool last = inst == block->last;
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            if (last)
+                break;
+            inst = next;
+        }
+        changes++;
+    }
+
+    free_cfg(cfg);
+    return changes;
+}
+
+// 合并连续标签（跳转统一指向第一个），删除没有被引用的标签
+static int remove_redundant_labels(Instruction *func_def)
+{
+    int changes = 0;
+    int *canonical = (int *)calloc(label_count + 1, sizeof(int));
+
+    int run_head = 0;
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (!is_label_instruction(inst))
+        {
+            run_head = 0;
+            continue;
+        }
+        if (run_head == 0)
+            run_head = inst->result->u.temp_no;
+        if (inst->result->u.temp_no <= label_count)
+            canonical[inst->result->u.temp_no] = run_head;
+    }
+
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        Operand *target = is_jump(inst) ? branch_target(inst) : NULL;
+        if (is_label_operand(target) && canonical[target->u.temp_no] != 0 &&
+            canonical[target->u.temp_no] != target->u.temp_no)
+        {
+            target->u.temp_no = canonical[target->u.temp_no];
+            changes++;
+        }
+    }
+
+    int *refs = count_label_refs(func_def);
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *next = inst->next;
+        if (is_label_instruction(inst) && inst->result->u.temp_no <= label_count &&
+            refs[inst->result->u.temp_no] == 0)
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            changes++;
+            inst = next;
+            continue;
+        }
+        prev = inst;
+        inst = next;
+    }
+
+    free(refs);
+    free(canonical);
+    return changes;
+}
+
+// 基本块合并：GOTO L 是 L 唯一的入口、且 L 所在块以 GOTO/RETURN 结束时，
+// 把该块搬到跳转处，省去一次跳转
+static int merge_blocks(Instruction *func_def)
+{
+    int changes = 0;
+    Instruction **labels = map_labels(func_def);
+    int *refs = count_label_refs(func_def);
+
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        if (inst->op != OP_GOTO || !is_label_operand(inst->arg1) || refs[inst->arg1->u.temp_no] != 1)
+        {
+            prev = inst;
+            inst = inst->next;
+            continue;
+        }
+
+        Instruction *label = labels[inst->arg1->u.temp_no];
+        Instruction *label_prev = label ? find_prev_instruction(func_def, label) : NULL;
+        if (label_prev == NULL || (label_prev->op != OP_GOTO && label_prev->op != OP_RETURN))
+        {
+            prev = inst;
+            inst = inst->next;
+            continue;
+        }
+
+        // 找到块尾，块内不能包含这条跳转本身
+        Instruction *end = label;
+        bool contains_jump = false;
+        while (!is_block_terminator(end) && end->next->op != OP_FUNC_END && end->next->op != OP_LABEL)
+        {
+            end = end->next;
+            if (end == inst)
+                contains_jump = true;
+        }
+        if (contains_jump || end == inst || (end->op != OP_GOTO && end->op != OP_RETURN))
+        {
+            prev = inst;
+            inst = inst->next;
+            continue;
+        }
+
+        // 摘下 [label, end] 放到跳转的位置
+        label_prev->next = end->next;
+        prev = find_prev_instruction(func_def, inst);
+        end->next = inst->next;
+        prev->next = label;
+        free_instruction(inst);
+        changes++;
+
+        prev = end;
+        inst = end->next;
+    }
+
+    free(refs);
+    free(labels);
+    return changes;
+}
+
+// 单个函数的一轮化简
+static int simplify_function(Instruction *func_def)
+{
+    int changes = 0;
+
+    changes += fold_constant_branches(func_def);
+
+    Instruction **labels = map_labels(func_def);
+    changes += thread_jumps(func_def, labels);
+    free(labels);
+
+    changes += remove_fallthrough_jumps(func_def);
+    changes += remove_unreachable_blocks(func_def);
+    changes += remove_redundant_labels(func_def);
+    changes += merge_blocks(func_def);
+
+    return changes;
+}
+
+// 控制流图化简，每个函数迭代到不动点
+int simplify_cfg()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    for (Instruction *func = code_head; func != NULL; func = func->next)
+    {
+        if (func->op != OP_FUNC_DEF)
+            continue;
+
+        for (int round = 0; round < CFG_SIMPLIFY_MAX_ROUNDS; round++)
+        {
+            int changes = simplify_function(func);
+            if (changes == 0)
+                break;
+            total += changes;
+        }
+    }
+
+    opt_stats.cfg_simplification_count += total;
+    return total;
+}
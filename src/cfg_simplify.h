@@ -0,0 +1,9 @@
+#ifndef CFG_SIMPLIFY_H
+#define CFG_SIMPLIFY_H
+
+#include "cfg.h"
+
+// 控制流图化简：跳转穿透、常量条件折叠、不可达块删除、基本块合并、冗余标签删除
+int simplify_cfg();
+
+#endif
@@ -1,4 +1,16 @@
 #include "codegen.h"
+#include "cfg.h"
+#include "loop_opt.h"
+#include "cfg_simplify.h"
+#include "tail_recursion.h"
+#include "inliner.h"
+#include "ipcp.h"
+#include "copy_prop.h"
+#include "peephole.h"
+#include "array_opt.h"
+#include "pre.h"
+#include "range.h"
+#include "type_infer.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +21,28 @@ Instruction *code_tail = NULL;
 int temp_count = 1;
 int label_count = 1;
 
+// 全局变量名表（全局变量在函数之间共享，优化时需要保守处理）
+static char **global_variables = NULL;
+static int global_variable_count = 0;
+
+// 变量声明信息表
+static VariableInfo *variable_infos = NULL;
+static int variable_info_count = 0;
+static int variable_info_capacity = 0;
+
+// 函数返回类型表
+static char **function_type_names = NULL;
+static DataType *function_types = NULL;
+static int function_type_count = 0;
+
+// 生成数组下标越界检查
+bool array_bounds_check = false;
+
+// 正在翻译的函数、当前声明的类型、当前函数的越界处理标签
+static char *current_function = NULL;
+static DataType current_decl_type = TYPE_INT;
+static Operand *bounds_fail_label = NULL;
+
 // 初始化代码生成器
 void init_codegen()
 {
@@ -16,6 +50,231 @@ void init_codegen()
     code_tail = NULL;
     temp_count = 1;
     label_count = 1;
+
+    for (int i = 0; i < global_variable_count; i++)
+    {
+        free(global_variables[i]);
+    }
+    free(global_variables);
+    global_variables = NULL;
+    global_variable_count = 0;
+
+    for (int i = 0; i < variable_info_count; i++)
+    {
+        free(variable_infos[i].function);
+        free(variable_infos[i].name);
+    }
+    free(variable_infos);
+    variable_infos = NULL;
+    variable_info_count = 0;
+    variable_info_capacity = 0;
+
+    for (int i = 0; i < function_type_count; i++)
+        free(function_type_names[i]);
+    free(function_type_names);
+    free(function_types);
+    function_type_names = NULL;
+    function_types = NULL;
+    function_type_count = 0;
+}
+
+// 登记全局变量名
+static void add_global_variable(const char *name)
+{
+    global_variables = (char **)realloc(global_variables, (global_variable_count + 1) * sizeof(char *));
+    global_variables[global_variable_count++] = strdup(name);
+}
+
+// 判断变量是否为全局变量
+bool is_global_variable(const char *name)
+{
+    for (int i = 0; i < global_variable_count; i++)
+    {
+        if (strcmp(global_variables[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool same_function(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+// 登记变量声明，同一函数内重复声明时以后者为准
+void declare_variable(const char *function, const char *name, DataType type, int array_size, bool is_param)
+{
+    VariableInfo *info = NULL;
+    for (int i = 0; i < variable_info_count && info == NULL; i++)
+    {
+        if (same_function(variable_infos[i].function, function) && strcmp(variable_infos[i].name, name) == 0)
+            info = &variable_infos[i];
+    }
+
+    if (info == NULL)
+    {
+        if (variable_info_count == variable_info_capacity)
+        {
+            variable_info_capacity = variable_info_capacity ? variable_info_capacity * 2 : 32;
+            variable_infos = (VariableInfo *)realloc(variable_infos, variable_info_capacity * sizeof(VariableInfo));
+        }
+        info = &variable_infos[variable_info_count++];
+        info->function = function ? strdup(function) : NULL;
+        info->name = strdup(name);
+    }
+    info->type = type;
+    info->array_size = array_size;
+    info->is_param = is_param;
+}
+
+// 查找函数内的变量，找不到时查找全局变量
+VariableInfo *lookup_variable_info(const char *function, const char *name)
+{
+    VariableInfo *global = NULL;
+    for (int i = 0; i < variable_info_count; i++)
+    {
+        if (strcmp(variable_infos[i].name, name) != 0)
+            continue;
+        if (function != NULL && same_function(variable_infos[i].function, function))
+            return &variable_infos[i];
+        if (variable_infos[i].function == NULL)
+            global = &variable_infos[i];
+    }
+    return global;
+}
+
+// 内联、特化等变换复制变量时同步登记新名字
+void copy_variable_info(const char *from_function, const char *from_name,
+                        const char *to_function, const char *to_name, bool is_param)
+{
+    VariableInfo *info = lookup_variable_info(from_function, from_name);
+    if (info == NULL || info->function == NULL)
+        return;
+    declare_variable(to_function, to_name, info->type, info->array_size, is_param);
+}
+
+void copy_function_variables(const char *from_function, const char *to_function)
+{
+    int count = variable_info_count;
+    for (int i = 0; i < count; i++)
+    {
+        if (same_function(variable_infos[i].function, from_function))
+        {
+            // declare_variable 可能扩容，先复制名字
+            char *name = strdup(variable_infos[i].name);
+            declare_variable(to_function, name, variable_infos[i].type, variable_infos[i].array_size,
+                             variable_infos[i].is_param);
+            free(name);
+        }
+    }
+    declare_function_type(to_function, lookup_function_type(from_function));
+}
+
+// 登记函数返回类型
+void declare_function_type(const char *name, DataType return_type)
+{
+    for (int i = 0; i < function_type_count; i++)
+    {
+        if (strcmp(function_type_names[i], name) == 0)
+        {
+            function_types[i] = return_type;
+            return;
+        }
+    }
+    function_type_names = (char **)realloc(function_type_names, (function_type_count + 1) * sizeof(char *));
+    function_types = (DataType *)realloc(function_types, (function_type_count + 1) * sizeof(DataType));
+    function_type_names[function_type_count] = strdup(name);
+    function_types[function_type_count++] = return_type;
+}
+
+DataType lookup_function_type(const char *name)
+{
+    for (int i = 0; i < function_type_count; i++)
+    {
+        if (strcmp(function_type_names[i], name) == 0)
+            return function_types[i];
+    }
+    return TYPE_INT;
+}
+
+// 变量是否为整型标量（未登记的变量按未知类型处理）
+bool is_int_scalar(const char *function, const char *name)
+{
+    VariableInfo *info = lookup_variable_info(function, name);
+    return info != NULL && info->type == TYPE_INT && info->array_size == 0;
+}
+
+// 声明的类型：结构体类型与 int/float 区分开
+static DataType declared_type(TreeNode *specifier)
+{
+    if (specifier == NULL || specifier->child == NULL || specifier->child->type != NODE_TYPE)
+        return TYPE_STRUCT;
+    return get_specifier_type(specifier);
+}
+
+// 登记 VarDec -> ID | VarDec LB INT RB 声明的变量
+static void declare_vardec(TreeNode *vardec, DataType type, bool is_param)
+{
+    TreeNode *id = vardec;
+    int dims = 0;
+    int size = 0;
+    while (id != NULL && id->type == NODE_VARDEC)
+    {
+        // 数组维度：VarDec LB INT RB
+        TreeNode *lb = id->child ? id->child->sibling : NULL;
+        if (lb != NULL && lb->type == NODE_LB && lb->sibling != NULL && lb->sibling->type == NODE_INT)
+        {
+            size = lb->sibling->value.int_value;
+            dims++;
+        }
+        id = id->child;
+    }
+    if (id == NULL || id->type != NODE_ID)
+        return;
+
+    declare_variable(current_function, id->value.string_value, type, dims == 0 ? 0 : (dims == 1 ? size : -1),
+                     is_param);
+}
+
+// 当前函数的越界处理标签，第一次使用时创建
+static Operand *get_bounds_fail_label()
+{
+    if (bounds_fail_label == NULL)
+        bounds_fail_label = new_operand_label();
+    return copy_operand(bounds_fail_label);
+}
+
+// 为局部或全局一维数组的访问生成下标检查：下标越界时跳到函数末尾的越界处理块。
+// 数组形参声明的大小不一定是实参的大小，不检查
+static void emit_bounds_check(Operand *array, Operand *index)
+{
+    if (!array_bounds_check || array == NULL || array->type != OPERAND_VARIABLE)
+        return;
+    VariableInfo *info = lookup_variable_info(current_function, array->u.name);
+    if (info == NULL || info->array_size <= 0 || info->is_param)
+        return;
+
+    emit(OP_IF_LT, get_bounds_fail_label(), copy_operand(index), new_operand_constant_int(0));
+    emit(OP_IF_GE, get_bounds_fail_label(), copy_operand(index), new_operand_constant_int(info->array_size));
+}
+
+// 函数末尾的越界处理块：调用运行时函数报告错误，不再返回
+static void emit_bounds_fail_block()
+{
+    if (bounds_fail_label == NULL)
+        return;
+
+    // 函数体可能顺序执行到末尾，不能落入越界处理块
+    if (code_tail != NULL && code_tail->op != OP_RETURN && code_tail->op != OP_GOTO)
+        emit(OP_RETURN, NULL, NULL, NULL);
+
+    emit(OP_LABEL, bounds_fail_label, NULL, NULL);
+    Operand *result = new_operand_temp();
+    emit(OP_CALL, result, new_operand_function(BOUNDS_CHECK_FAIL_FUNCTION), NULL);
+    emit(OP_RETURN, copy_operand(result), NULL, NULL);
+    bounds_fail_label = NULL;
 }
 
 // 创建变量操作数
@@ -72,6 +331,21 @@ Operand *new_operand_function(const char *name)
     return op;
 }
 
+// 复制操作数
+Operand *copy_operand(Operand *op)
+{
+    if (op == NULL)
+        return NULL;
+
+    Operand *copy = (Operand *)malloc(sizeof(Operand));
+    *copy = *op;
+    if (op->type == OPERAND_VARIABLE || op->type == OPERAND_FUNCTION)
+    {
+        copy->u.name = strdup(op->u.name);
+    }
+    return copy;
+}
+
 // 创建新指令
 Instruction *new_instruction(OpType op, Operand *result, Operand *arg1, Operand *arg2)
 {
@@ -85,9 +359,11 @@ Instruction *new_instruction(OpType op, Operand *result, Operand *arg1, Operand
 }
 
 // 发射一条指令
+// 翻译过程中同一个操作数会被多条指令引用，这里为每条指令复制一份，
+// 使优化时可以独立修改或释放指令的操作数
 void emit(OpType op, Operand *result, Operand *arg1, Operand *arg2)
 {
-    Instruction *inst = new_instruction(op, result, arg1, arg2);
+    Instruction *inst = new_instruction(op, copy_operand(result), copy_operand(arg1), copy_operand(arg2));
 
     if (code_head == NULL)
     {
@@ -278,6 +554,7 @@ Operand *translate_exp(TreeNode *exp)
                         Operand *value = translate_exp(right);
 
                         // 生成数组赋值指令：arr[index] := value
+                        emit_bounds_check(array_name, index);
                         emit(OP_ARRAY_SET, array_name, index, value);
                         return array_name;
                     }
@@ -356,6 +633,7 @@ Operand *translate_exp(TreeNode *exp)
                             emit(OP_OR, result, t1, t2);
                             break;
                         case NODE_LB: // 数组访问 exp[exp]
+                            emit_bounds_check(t1, t2);
                             emit(OP_ARRAY_GET, result, t1, t2);
                             break;
                         case NODE_DOT: // 结构体成员访问 exp.id
@@ -432,6 +710,90 @@ Operand *translate_exp(TreeNode *exp)
     return NULL;
 }
 
+// ========================= 条件跳转辅助 =========================
+
+// 是否为比较跳转指令（IF x relop y GOTO L）
+bool is_relational_branch(OpType op)
+{
+    return op >= OP_IF_GT && op <= OP_IF_NE;
+}
+
+// 是否为条件跳转指令
+bool is_conditional_branch(OpType op)
+{
+    return op == OP_IF_GOTO || op == OP_IF_NOT_GOTO || is_relational_branch(op);
+}
+
+// 关系运算对应的比较跳转，非关系运算返回OP_LABEL
+OpType relation_to_branch(OpType op)
+{
+    switch (op)
+    {
+    case OP_GT:
+        return OP_IF_GT;
+    case OP_LT:
+        return OP_IF_LT;
+    case OP_GE:
+        return OP_IF_GE;
+    case OP_LE:
+        return OP_IF_LE;
+    case OP_EQ:
+        return OP_IF_EQ;
+    case OP_NE:
+        return OP_IF_NE;
+    default:
+        return OP_LABEL;
+    }
+}
+
+// 条件取反后的跳转指令。浮点关系在有 NaN 时两个方向都不成立，调用者只对整数比较取反关系
+OpType negate_branch(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GOTO:
+        return OP_IF_NOT_GOTO;
+    case OP_IF_NOT_GOTO:
+        return OP_IF_GOTO;
+    case OP_IF_GT:
+        return OP_IF_LE;
+    case OP_IF_LE:
+        return OP_IF_GT;
+    case OP_IF_LT:
+        return OP_IF_GE;
+    case OP_IF_GE:
+        return OP_IF_LT;
+    case OP_IF_EQ:
+        return OP_IF_NE;
+    case OP_IF_NE:
+        return OP_IF_EQ;
+    default:
+        return op;
+    }
+}
+
+// 比较跳转的关系运算符
+const char *branch_relop_symbol(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return ">";
+    case OP_IF_LT:
+        return "<";
+    case OP_IF_GE:
+        return ">=";
+    case OP_IF_LE:
+        return "<=";
+    case OP_IF_EQ:
+        return "==";
+    case OP_IF_NE:
+        return "!=";
+    default:
+        return "?";
+    }
+}
+
 // 翻译条件表达式（用于if和while语句）
 void translate_cond(TreeNode *exp, Operand *label_true, Operand *label_false)
 {
@@ -441,6 +803,22 @@ void translate_cond(TreeNode *exp, Operand *label_true, Operand *label_false)
     if (exp->type == NODE_EXP)
     {
         TreeNode *child = exp->child;
+
+        // 括号表达式：LP Exp RP
+        if (child != NULL && child->type == NODE_LP && child->sibling != NULL &&
+            child->sibling->sibling != NULL && child->sibling->sibling->type == NODE_RP)
+        {
+            translate_cond(child->sibling, label_true, label_false);
+            return;
+        }
+
+        // 逻辑非：交换真假出口
+        if (child != NULL && child->type == NODE_NOT && child->sibling != NULL && child->sibling->sibling == NULL)
+        {
+            translate_cond(child->sibling, label_false, label_true);
+            return;
+        }
+
         if (child != NULL && child->sibling != NULL && child->sibling->sibling != NULL)
         {
             TreeNode *left = child;
@@ -467,36 +845,33 @@ void translate_cond(TreeNode *exp, Operand *label_true, Operand *label_false)
             // 处理关系运算符
             else if (op->type == NODE_RELOP)
             {
+                // 直接生成比较跳转：IF t1 relop t2 GOTO label_true
                 Operand *t1 = translate_exp(left);
                 Operand *t2 = translate_exp(right);
-                Operand *temp_result = new_operand_temp();
+                OpType branch_op = OP_IF_NE;
 
                 if (strcmp(op->name, ">") == 0)
                 {
-                    emit(OP_GT, temp_result, t1, t2);
+                    branch_op = OP_IF_GT;
                 }
                 else if (strcmp(op->name, "<") == 0)
                 {
-                    emit(OP_LT, temp_result, t1, t2);
+                    branch_op = OP_IF_LT;
                 }
                 else if (strcmp(op->name, ">=") == 0)
                 {
-                    emit(OP_GE, temp_result, t1, t2);
+                    branch_op = OP_IF_GE;
                 }
                 else if (strcmp(op->name, "<=") == 0)
                 {
-                    emit(OP_LE, temp_result, t1, t2);
+                    branch_op = OP_IF_LE;
                 }
                 else if (strcmp(op->name, "==") == 0)
                 {
-                    emit(OP_EQ, temp_result, t1, t2);
-                }
-                else if (strcmp(op->name, "!=") == 0)
-                {
-                    emit(OP_NE, temp_result, t1, t2);
+                    branch_op = OP_IF_EQ;
                 }
 
-                emit(OP_IF_GOTO, NULL, temp_result, label_true);
+                emit(branch_op, label_true, t1, t2);
                 emit(OP_GOTO, NULL, label_false, NULL);
                 return;
             }
@@ -539,6 +914,9 @@ void translate_def(TreeNode *def)
     if (def == NULL || def->type != NODE_DEF)
         return;
 
+    // Def -> Specifier DecList SEMI
+    current_decl_type = declared_type(def->child);
+
     TreeNode *child = def->child;
     while (child != NULL)
     {
@@ -581,6 +959,9 @@ void translate_dec(TreeNode *dec)
     if (child == NULL)
         return;
 
+    // 登记变量的类型与数组大小
+    declare_vardec(child, current_decl_type, false);
+
     // 检查是否有初始化: VarDec ASSIGNOP Exp
     if (child->sibling != NULL && child->sibling->type == NODE_ASSIGNOP)
     {
@@ -772,8 +1153,12 @@ void translate_varlist(TreeNode *varlist)
             TreeNode *vardec = paramdec->child->sibling; // 跳过Specifier
             if (vardec != NULL && vardec->type == NODE_VARDEC)
             {
-                // VarDec -> ID (简单情况)
+                declare_vardec(vardec, declared_type(paramdec->child), true);
+
+                // VarDec -> ID | VarDec LB INT RB（数组形参取最内层的ID）
                 TreeNode *param_id = vardec->child;
+                while (param_id != NULL && param_id->type == NODE_VARDEC)
+                    param_id = param_id->child;
                 if (param_id != NULL && param_id->type == NODE_ID)
                 {
                     Operand *param = new_operand_variable(param_id->value.string_value);
@@ -811,6 +1196,8 @@ void translate_function_def(TreeNode *extdef)
     {
         Operand *func = new_operand_function(func_name->value.string_value);
         emit(OP_FUNC_DEF, func, NULL, NULL);
+        current_function = func_name->value.string_value;
+        declare_function_type(current_function, declared_type(specifier));
 
         // 处理函数参数：FunDec -> ID LP VarList RP 或 ID LP RP
         TreeNode *lp = func_name->sibling;
@@ -827,8 +1214,34 @@ void translate_function_def(TreeNode *extdef)
 
         // 翻译函数体
         translate_stmt(compst);
+        emit_bounds_fail_block();
 
         emit(OP_FUNC_END, func, NULL, NULL);
+        current_function = NULL;
+    }
+}
+
+// 登记全局变量声明列表：ExtDecList -> VarDec | VarDec COMMA ExtDecList
+void record_global_variables(TreeNode *extdeclist)
+{
+    while (extdeclist != NULL && extdeclist->type == NODE_EXTDECLIST)
+    {
+        TreeNode *vardec = extdeclist->child;
+        TreeNode *id = vardec;
+
+        // VarDec -> ID | VarDec LB INT RB
+        while (id != NULL && id->type == NODE_VARDEC)
+        {
+            id = id->child;
+        }
+        if (id != NULL && id->type == NODE_ID)
+        {
+            add_global_variable(id->value.string_value);
+            declare_vardec(vardec, current_decl_type, false);
+        }
+
+        TreeNode *comma = vardec ? vardec->sibling : NULL;
+        extdeclist = (comma != NULL && comma->type == NODE_COMMA) ? comma->sibling : NULL;
     }
 }
 
@@ -849,7 +1262,12 @@ void translate_extdeflist(TreeNode *extdeflist)
             // 函数定义
             translate_function_def(extdef);
         }
-        // 变量定义不需要生成代码
+        else if (second != NULL && second->type == NODE_EXTDECLIST)
+        {
+            // 全局变量定义不需要生成代码，只登记变量名和类型
+            current_decl_type = declared_type(specifier);
+            record_global_variables(second);
+        }
 
         // 处理下一个ExtDefList（通过sibling连接）
         TreeNode *next_extdeflist = extdef->sibling;
@@ -1043,6 +1461,19 @@ void print_code()
             printf(" GOTO ");
             print_operand(inst->arg2);
             break;
+        case OP_IF_GT:
+        case OP_IF_LT:
+        case OP_IF_GE:
+        case OP_IF_LE:
+        case OP_IF_EQ:
+        case OP_IF_NE:
+            printf("IF ");
+            print_operand(inst->arg1);
+            printf(" %s ", branch_relop_symbol(inst->op));
+            print_operand(inst->arg2);
+            printf(" GOTO ");
+            print_operand(inst->result);
+            break;
         case OP_LABEL:
             print_operand(inst->result);
             printf(" :");
@@ -1270,6 +1701,19 @@ void save_code_to_file(const char *filename)
             fprintf(file, " GOTO ");
             fprint_operand(file, inst->arg2);
             break;
+        case OP_IF_GT:
+        case OP_IF_LT:
+        case OP_IF_GE:
+        case OP_IF_LE:
+        case OP_IF_EQ:
+        case OP_IF_NE:
+            fprintf(file, "IF ");
+            fprint_operand(file, inst->arg1);
+            fprintf(file, " %s ", branch_relop_symbol(inst->op));
+            fprint_operand(file, inst->arg2);
+            fprintf(file, " GOTO ");
+            fprint_operand(file, inst->result);
+            break;
         case OP_LABEL:
             fprint_operand(file, inst->result);
             fprintf(file, " :");
@@ -1408,6 +1852,10 @@ int translate_args(TreeNode *args)
 // 优化统计全局变量
 OptimizationStats opt_stats;
 
+// 优化选项
+OptimizationOptions opt_options = {DEFAULT_INLINE_THRESHOLD, false, NULL, 0, DEFAULT_SPECIALIZE_BUDGET,
+                                   DEFAULT_UNROLL_FACTOR, DEFAULT_UNROLL_LIMIT};
+
 // 初始化优化统计
 void init_optimization_stats()
 {
@@ -1417,6 +1865,32 @@ void init_optimization_stats()
     opt_stats.common_subexpression_count = 0;
     opt_stats.redundant_assignment_count = 0;
     opt_stats.array_access_optimization_count = 0;
+    opt_stats.loop_invariant_hoist_count = 0;
+    opt_stats.strength_reduction_count = 0;
+    opt_stats.induction_variable_elimination_count = 0;
+    opt_stats.loop_rotation_count = 0;
+    opt_stats.branch_fusion_count = 0;
+    opt_stats.cfg_simplification_count = 0;
+    opt_stats.tail_recursion_count = 0;
+    opt_stats.inline_count = 0;
+    opt_stats.dead_function_count = 0;
+    opt_stats.ipcp_count = 0;
+    opt_stats.specialization_count = 0;
+    opt_stats.copy_propagation_count = 0;
+    opt_stats.temp_coalescing_count = 0;
+    opt_stats.peephole_count = 0;
+    opt_stats.loop_unroll_count = 0;
+    opt_stats.store_forwarding_count = 0;
+    opt_stats.redundant_load_count = 0;
+    opt_stats.dead_store_count = 0;
+    opt_stats.pre_count = 0;
+    opt_stats.range_branch_count = 0;
+    opt_stats.allocated_value_count = 0;
+    opt_stats.spilled_value_count = 0;
+    opt_stats.spill_access_count = 0;
+    opt_stats.isel_fold_count = 0;
+    opt_stats.machine_peephole_count = 0;
+    opt_stats.vectorized_loop_count = 0;
     opt_stats.total_instructions_before = 0;
     opt_stats.total_instructions_after = 0;
 }
@@ -1455,9 +1929,42 @@ void print_optimization_stats()
     printf("- Common subexpression:       %d\n", opt_stats.common_subexpression_count);
     printf("- Redundant assignment:       %d\n", opt_stats.redundant_assignment_count);
     printf("- Array access optimization:  %d\n", opt_stats.array_access_optimization_count);
+    printf("  - Store-to-load forwarding: %d\n", opt_stats.store_forwarding_count);
+    printf("  - Redundant loads removed:  %d\n", opt_stats.redundant_load_count);
+    printf("  - Dead stores removed:      %d\n", opt_stats.dead_store_count);
+    printf("- Partial redundancy elim.:   %d\n", opt_stats.pre_count);
+    printf("- Loop-invariant code motion: %d\n", opt_stats.loop_invariant_hoist_count);
+    printf("- Strength reduction:         %d\n", opt_stats.strength_reduction_count);
+    printf("- Induction var elimination:  %d\n", opt_stats.induction_variable_elimination_count);
+    printf("- Loop rotation:              %d\n", opt_stats.loop_rotation_count);
+    printf("- Loop unrolling:             %d\n", opt_stats.loop_unroll_count);
+    printf("- Compare-branch fusion:      %d\n", opt_stats.branch_fusion_count);
+    printf("- Range-decided branches:     %d\n", opt_stats.range_branch_count);
+    printf("- CFG simplification:         %d\n", opt_stats.cfg_simplification_count);
+    printf("- Tail-recursion elimination: %d\n", opt_stats.tail_recursion_count);
+    printf("- Function inlining:          %d\n", opt_stats.inline_count);
+    printf("- Dead functions removed:     %d\n", opt_stats.dead_function_count);
+    printf("- Interprocedural constants:  %d\n", opt_stats.ipcp_count);
+    printf("- Function specialization:    %d\n", opt_stats.specialization_count);
+    printf("- Copy propagation:           %d\n", opt_stats.copy_propagation_count);
+    printf("- Temps coalesced:            %d\n", opt_stats.temp_coalescing_count);
+    printf("- Peephole rewrites:          %d\n", opt_stats.peephole_count);
     printf("=====================================\n\n");
 }
 
+// 打印寄存器分配统计信息（后端生成机器代码之后）
+void print_register_allocation_stats()
+{
+    printf("\n=== Register Allocation Statistics ===\n");
+    printf("- Values in registers:        %d\n", opt_stats.allocated_value_count);
+    printf("- Values spilled:             %d\n", opt_stats.spilled_value_count);
+    printf("- Spill memory accesses:      %d\n", opt_stats.spill_access_count);
+    printf("- IR instructions folded:     %d\n", opt_stats.isel_fold_count);
+    printf("- Machine instructions removed: %d\n", opt_stats.machine_peephole_count);
+    printf("- Loops vectorized:           %d\n", opt_stats.vectorized_loop_count);
+    printf("======================================\n\n");
+}
+
 // 检查操作数是否为常量
 bool is_constant_operand(Operand *op)
 {
@@ -1514,6 +2021,12 @@ bool is_dead_instruction(Instruction *inst)
     case OP_GOTO:
     case OP_IF_GOTO:
     case OP_IF_NOT_GOTO:
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
     case OP_LABEL:
     case OP_FUNC_DEF:
     case OP_FUNC_END:
@@ -1942,52 +2455,209 @@ void common_subexpression_elimination()
     }
 }
 
-// 数组访问优化
+// 数组访问优化：基于别名分析的存取消除，见 array_opt.c
 void array_access_optimization()
 {
-    Instruction *inst = code_head;
+    array_load_store_optimization();
+}
 
-    while (inst != NULL)
+// 统计每个临时变量被使用的次数
+static int *count_temp_uses()
+{
+    int *uses = (int *)calloc(temp_count + 1, sizeof(int));
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
     {
-        // 查找重复的数组访问模式
-        if (inst->op == OP_ARRAY_GET)
+        Operand *ops[3];
+        int n = instruction_uses(inst, ops);
+        for (int i = 0; i < n; i++)
         {
-            Instruction *next_inst = inst->next;
-            int array_limit = 1000; // 防止无限循环，最多搜索1000条指令
-            int array_count = 0;
+            if (ops[i]->type == OPERAND_TEMP && ops[i]->u.temp_no <= temp_count)
+                uses[ops[i]->u.temp_no]++;
+        }
+    }
+    return uses;
+}
 
-            while (next_inst != NULL && array_count < array_limit)
-            {
-                array_count++;
+// 标签target是否紧跟在inst之后（中间只隔着其他标签）
+static bool label_follows(Instruction *inst, Operand *target)
+{
+    for (Instruction *p = inst->next; p != NULL && p->op == OP_LABEL; p = p->next)
+    {
+        if (operands_equal(p->result, target))
+            return true;
+    }
+    return false;
+}
 
-                // 查找相同的数组访问
-                if (next_inst->op == OP_ARRAY_GET &&
-                    operands_equal(next_inst->arg1, inst->arg1) &&
-                    operands_equal(next_inst->arg2, inst->arg2))
-                {
-                    // 用第一次访问的结果替换第二次访问
-                    replace_operand_references(next_inst->result, inst->result);
-
-                    // 删除重复的数组访问
-                    Instruction *to_remove = next_inst;
-                    next_inst = next_inst->next;
-                    remove_instruction(to_remove);
-                    opt_stats.array_access_optimization_count++;
-                    continue;
-                }
+// 比较与比较跳转的两边是否为浮点值：!(a < b) 不等于 a >= b
+static bool has_float_operands(CFG *cfg, const char *function, const signed char *types, Instruction *inst)
+{
+    return operand_value_type(cfg, function, types, inst->arg1) == TYPE_FLOAT ||
+           operand_value_type(cfg, function, types, inst->arg2) == TYPE_FLOAT;
+}
 
-                // 如果数组被修改，停止优化
-                if (next_inst->op == OP_ARRAY_SET &&
-                    operands_equal(next_inst->result, inst->arg1))
+// 收集两边为浮点值的比较与比较跳转。合并后的临时变量在不同位置可能存放不同类型的值，按位置推断
+static int find_float_relations(Instruction ***relations)
+{
+    int count = 0;
+    *relations = NULL;
+    for (Instruction *func_def = code_head; func_def != NULL; func_def = func_def->next)
+    {
+        if (func_def->op != OP_FUNC_DEF)
+            continue;
+        const char *function = func_def->result->u.name;
+        CFG *cfg = build_cfg(func_def);
+        signed char **block_types = infer_temp_types(cfg, function);
+        signed char *types = (signed char *)malloc(cfg->vars.count + 1);
+        for (int b = 0; b < cfg->block_count; b++)
+        {
+            BasicBlock *block = cfg->blocks[b];
+            memcpy(types, block_types[b], cfg->vars.count + 1);
+            for (Instruction *inst = block->first;; inst = inst->next)
+            {
+                if ((relation_to_branch(inst->op) != OP_LABEL || is_relational_branch(inst->op)) &&
+                    has_float_operands(cfg, function, types, inst))
                 {
-                    break;
+                    *relations = (Instruction **)realloc(*relations, (count + 1) * sizeof(Instruction *));
+                    (*relations)[count++] = inst;
                 }
+                transfer_temp_types(cfg, function, types, inst);
+                if (inst == block->last)
+                    break;
+            }
+        }
+        free(types);
+        free_temp_types(cfg, block_types);
+        free_cfg(cfg);
+    }
+    return count;
+}
 
-                next_inst = next_inst->next;
+static int find_instruction(Instruction **list, int count, Instruction *inst)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (list[i] == inst)
+            return i;
+    }
+    return -1;
+}
+
+// 比较跳转融合：
+// 1. t := a relop b; IF t GOTO L  =>  IF a relop b GOTO L（t只在此处使用）
+// 2. IF c GOTO L1; GOTO L2; L1:   =>  IF !c GOTO L2; L1:
+// 3. 删除跳到紧随其后标签的跳转
+// 取反关系只用于整数比较，浮点比较保持原来的形式
+int fuse_compare_branches()
+{
+    int total = 0;
+    int *uses = count_temp_uses();
+    Instruction **float_relations;
+    int float_relation_count = find_float_relations(&float_relations);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        Instruction *prev = NULL;
+        Instruction *inst = code_head;
+        while (inst != NULL)
+        {
+            Instruction *next = inst->next;
+            int float_relation = find_instruction(float_relations, float_relation_count, inst);
+
+            if (relation_to_branch(inst->op) != OP_LABEL && next != NULL &&
+                (next->op == OP_IF_GOTO || next->op == OP_IF_NOT_GOTO) &&
+                inst->result->type == OPERAND_TEMP && operands_equal(next->arg1, inst->result) &&
+                uses[inst->result->u.temp_no] == 1 && (next->op == OP_IF_GOTO || float_relation < 0))
+            {
+                OpType branch_op = relation_to_branch(inst->op);
+                if (next->op == OP_IF_NOT_GOTO)
+                    branch_op = negate_branch(branch_op);
+
+                free_operand(next->arg1);
+                next->op = branch_op;
+                next->result = next->arg2;
+                next->arg1 = inst->arg1;
+                next->arg2 = inst->arg2;
+                inst->arg1 = NULL;
+                inst->arg2 = NULL;
+                if (float_relation >= 0)
+                    float_relations[float_relation] = next;
+                unlink_instruction(prev, inst);
+                free_instruction(inst);
+                total++;
+                changed = true;
+                inst = next;
+                continue;
             }
+
+            if (is_conditional_branch(inst->op) && next != NULL && next->op == OP_GOTO &&
+                label_follows(next, branch_target(inst)) &&
+                (!is_relational_branch(inst->op) || float_relation < 0))
+            {
+                inst->op = negate_branch(inst->op);
+                set_branch_target(inst, next->arg1);
+                next->arg1 = NULL;
+                unlink_instruction(inst, next);
+                free_instruction(next);
+                total++;
+                changed = true;
+                continue;
+            }
+
+            if ((inst->op == OP_GOTO || is_conditional_branch(inst->op)) &&
+                label_follows(inst, branch_target(inst)))
+            {
+                unlink_instruction(prev, inst);
+                free_instruction(inst);
+                total++;
+                changed = true;
+                inst = next;
+                continue;
+            }
+
+            prev = inst;
+            inst = next;
         }
+    }
 
-        inst = inst->next;
+    free(uses);
+    free(float_relations);
+    opt_stats.branch_fusion_count += total;
+    return total;
+}
+
+// 复制传播与窥孔优化交替进行：传播出的常量可被折叠，折叠结果又可继续传播。
+// 留下的死复制由死代码消除删除
+static void propagate_and_fold()
+{
+    for (int round = 0; round < 4; round++)
+    {
+        int changed = global_copy_propagation();
+        changed += peephole_optimize();
+        if (changed == 0)
+            break;
+    }
+}
+
+// x := y 是否原样保留 y 的值：赋给声明了类型的变量时按变量类型转换（如 int 变量 := float 值）。
+// 这里没有临时变量的类型，来源为临时变量的赋值给变量时按转换处理
+static bool assignment_preserves_value(const char *function, Instruction *inst)
+{
+    if (inst->result->type != OPERAND_VARIABLE)
+        return true;
+    DataType type = declared_variable_type(function, inst->result->u.name);
+    switch (inst->arg1->type)
+    {
+    case OPERAND_CONSTANT:
+        return type == TYPE_INT;
+    case OPERAND_CONSTANT_FLOAT:
+        return type == TYPE_FLOAT;
+    case OPERAND_VARIABLE:
+        return declared_variable_type(function, inst->arg1->u.name) == type;
+    default:
+        return false;
     }
 }
 
@@ -2000,61 +2670,46 @@ void optimize_code()
     printf("=== Starting Code Optimization ===\n");
     printf("Instructions before optimization: %d\n", opt_stats.total_instructions_before);
 
-    // 第一步：常量折叠
-    printf("Applying constant folding...\n");
-    Instruction *inst = code_head;
-    while (inst != NULL)
-    {
-        // 简单的常量折叠：将 x + 0 优化为 x
-        if (inst->op == OP_ADD && inst->arg2 && inst->arg2->type == OPERAND_CONSTANT && inst->arg2->u.int_value == 0)
-        {
-            inst->op = OP_ASSIGN;
-            free_operand(inst->arg2);
-            inst->arg2 = NULL;
-            opt_stats.constant_folding_count++;
-        }
-        // 简单的常量折叠：将 x * 1 优化为 x
-        else if (inst->op == OP_MUL && inst->arg2 && inst->arg2->type == OPERAND_CONSTANT && inst->arg2->u.int_value == 1)
-        {
-            inst->op = OP_ASSIGN;
-            free_operand(inst->arg2);
-            inst->arg2 = NULL;
-            opt_stats.constant_folding_count++;
-        }
-        // 常量折叠：计算常量表达式
-        else if ((inst->op == OP_ADD || inst->op == OP_MUL || inst->op == OP_SUB) &&
-                 inst->arg1 && inst->arg1->type == OPERAND_CONSTANT &&
-                 inst->arg2 && inst->arg2->type == OPERAND_CONSTANT)
-        {
-            int val1 = inst->arg1->u.int_value;
-            int val2 = inst->arg2->u.int_value;
-            int result_val = 0;
+    // 尾递归消除：改写后的函数不再递归，可以被内联
+    printf("Applying tail-recursion elimination...\n");
+    eliminate_tail_recursion();
 
-            if (inst->op == OP_ADD)
-                result_val = val1 + val2;
-            else if (inst->op == OP_SUB)
-                result_val = val1 - val2;
-            else if (inst->op == OP_MUL)
-                result_val = val1 * val2;
+    // 函数内联：使常量实参流入展开后的函数体，后续优化都能看到
+    printf("Applying function inlining...\n");
+    inline_functions();
 
-            inst->op = OP_ASSIGN;
-            free_operand(inst->arg1);
-            free_operand(inst->arg2);
-            inst->arg1 = new_operand_constant_int(result_val);
-            inst->arg2 = NULL;
-            opt_stats.constant_folding_count++;
-        }
+    // 过程间常量传播与函数特化：处理内联后剩下的调用
+    printf("Applying interprocedural constant propagation...\n");
+    interprocedural_constant_propagation();
+    printf("Applying function specialization...\n");
+    specialize_functions();
 
-        inst = inst->next;
+    // 删除从根函数不可达的函数（内联或特化后不再被调用的函数也在此删除）
+    if (opt_options.remove_dead_functions)
+    {
+        printf("Applying dead function elimination...\n");
+        remove_unreachable_functions();
     }
 
+    // 第一步：窥孔优化（代数恒等式、常量折叠等，规则见 peephole.c 中的规则表）
+    printf("Applying peephole optimization...\n");
+    peephole_optimize();
+
     // 第二步：基本的常量传播
     printf("Applying basic constant propagation...\n");
-    inst = code_head;
+    Instruction *inst = code_head;
+    const char *function = NULL;
     while (inst != NULL)
     {
-        // 查找 x := constant 形式的赋值
-        if (inst->op == OP_ASSIGN && inst->arg1 && inst->arg1->type == OPERAND_CONSTANT)
+        if (inst->op == OP_FUNC_DEF)
+            function = inst->result->u.name;
+
+        // 查找 x := constant 形式的赋值；float 变量保存的是转换后的值，不能替换为整数常量
+        VariableInfo *info = inst->result && inst->result->type == OPERAND_VARIABLE
+                                 ? lookup_variable_info(function, inst->result->u.name)
+                                 : NULL;
+        if (inst->op == OP_ASSIGN && inst->arg1 && inst->arg1->type == OPERAND_CONSTANT &&
+            !(info != NULL && info->type == TYPE_FLOAT))
         {
             Operand *var = inst->result;
             int constant_value = inst->arg1->u.int_value;
@@ -2086,96 +2741,97 @@ void optimize_code()
     while (inst != NULL)
     {
         Instruction *next = inst->next;
+        if (inst->op == OP_FUNC_DEF)
+            function = inst->result->u.name;
 
-        // 查找 x := y 后紧跟 z := x 的模式
+        // 查找 x := y 后紧跟 z := x 的模式；x := y 做了类型转换时 x 与 y 的值不同
         if (inst->op == OP_ASSIGN && next && next->op == OP_ASSIGN &&
-            operands_equal(next->arg1, inst->result))
+            operands_equal(next->arg1, inst->result) && assignment_preserves_value(function, inst))
         {
-            // 将 z := x 改为 z := y
+            // 将 z := x 改为 z := y（浮点常量等其他操作数同样直接复制）
             free_operand(next->arg1);
-            if (inst->arg1->type == OPERAND_CONSTANT)
-            {
-                next->arg1 = new_operand_constant_int(inst->arg1->u.int_value);
-            }
-            else if (inst->arg1->type == OPERAND_VARIABLE)
-            {
-                next->arg1 = new_operand_variable(inst->arg1->u.name);
-            }
-            else if (inst->arg1->type == OPERAND_TEMP)
-            {
-                next->arg1 = new_operand_temp();
-                next->arg1->u.temp_no = inst->arg1->u.temp_no;
-            }
+            next->arg1 = copy_operand(inst->arg1);
             opt_stats.redundant_assignment_count++;
         }
 
         inst = inst->next;
     }
 
-    // 第四步：安全的死代码消除
-    printf("Applying dead code elimination...\n");
+    // 全局复制传播：上面只处理紧邻的 z := x，这里沿控制流图消去整条复制链
+    printf("Applying global copy propagation...\n");
+    global_copy_propagation();
 
-    // 使用标记-清除方法，避免在遍历时修改链表
-    bool found_dead_code = true;
-    int dce_iterations = 0;
-    int max_dce_iterations = 10; // 最多迭代10次
+    // 第四步：比较跳转融合
+    printf("Applying compare-and-branch fusion...\n");
+    fuse_compare_branches();
 
-    while (found_dead_code && dce_iterations < max_dce_iterations)
+    // 值域分析：删除结果已被支配条件确定的条件跳转（包括可证明不越界的边界检查），
+    // 放在循环优化之前，让循环看到的控制流更简单
+    printf("Applying range-based branch elimination...\n");
+    if (range_branch_elimination() > 0)
     {
-        found_dead_code = false;
-        dce_iterations++;
-
-        // 第一遍：标记死代码
-        inst = code_head;
-        while (inst != NULL)
-        {
-            if (inst->result && inst->op == OP_ASSIGN)
-            {
-                // 检查结果是否被使用
-                bool is_used = false;
-                Instruction *check_inst = inst->next;
-                int check_count = 0;
+        simplify_cfg();
+        fuse_compare_branches();
+    }
 
-                while (check_inst != NULL && check_count < 100) // 限制搜索范围
-                {
-                    check_count++;
+    // 第五步：循环不变量外提
+    printf("Applying loop-invariant code motion...\n");
+    loop_invariant_code_motion();
 
-                    if ((check_inst->arg1 && operands_equal(check_inst->arg1, inst->result)) ||
-                        (check_inst->arg2 && operands_equal(check_inst->arg2, inst->result)))
-                    {
-                        is_used = true;
-                        break;
-                    }
-                    if (check_inst->op == OP_RETURN && check_inst->result &&
-                        operands_equal(check_inst->result, inst->result))
-                    {
-                        is_used = true;
-                        break;
-                    }
-                    check_inst = check_inst->next;
-                }
+    // 第六步：归纳变量强度削弱与线性函数测试替换
+    printf("Applying induction variable strength reduction...\n");
+    induction_variable_optimization();
 
-                if (!is_used)
-                {
-                    // 将死代码转换为注释（通过修改操作码为一个无害的值）
-                    // 我们可以重用 OP_LABEL 作为"死代码"标记，因为它不会影响执行
-                    if (inst->op != OP_LABEL) // 避免重复标记
-                    {
-                        inst->op = OP_LABEL; // 标记为死代码
-                        found_dead_code = true;
-                        opt_stats.dead_code_elimination_count++;
-                    }
-                }
-            }
-            inst = inst->next;
-        }
+    // 第七步：循环旋转，把 while 循环改为带守卫的 do-while 形式
+    printf("Applying loop rotation...\n");
+    if (loop_rotation() > 0)
+    {
+        // 旋转后循环体在守卫之后至少执行一次，数组读取可以外提
+        printf("Applying loop-invariant code motion...\n");
+        loop_invariant_code_motion();
     }
 
-    if (dce_iterations >= max_dce_iterations)
+    // 计数循环展开：在旋转得到的 do-while 形式上识别常量迭代次数
+    printf("Applying loop unrolling...\n");
+    loop_unrolling();
+
+    // 部分冗余消除：只在部分路径上重复的计算，在缺少它的路径上补一份，删除汇合后的重复计算。
+    // 放在循环优化之后，避免保存表达式值的复制妨碍归纳变量识别
+    printf("Applying partial redundancy elimination...\n");
+    partial_redundancy_elimination();
+
+    // 循环优化引入的复制再传播一次，并与窥孔优化交替进行
+    propagate_and_fold();
+
+    // 第八步：控制流图化简（跳转穿透、常量条件、不可达块、块合并、冗余标签）
+    // 放在循环优化之后，避免跳转穿透把回边变成条件跳转而妨碍循环旋转
+    printf("Applying CFG simplification...\n");
+    simplify_cfg();
+
+    // 化简后可能出现新的比较跳转组合，再融合一次
+    fuse_compare_branches();
+
+    // 循环优化之后循环变量的取值范围更明确（如展开后的常量下标），再消除一次
+    if (range_branch_elimination() > 0)
     {
-        printf("Dead code elimination stopped after %d iterations.\n", max_dce_iterations);
+        simplify_cfg();
+        fuse_compare_branches();
     }
 
+    // 数组存取优化：块合并之后基本块更长，转发与消除的机会更多
+    printf("Applying array load/store optimization...\n");
+    if (array_load_store_optimization() > 0)
+        propagate_and_fold();
+
+    // 第九步：基于活跃变量的死代码消除
+    // 旧的向后扫描方式看不到循环回边，会误删循环内仍被使用的赋值（如循环变量自增）
+    printf("Applying dead code elimination...\n");
+    opt_stats.dead_code_elimination_count += liveness_dead_code_elimination();
+
+    // 第十步：临时变量合并与重新编号，输出稠密的临时变量集合
+    printf("Applying temp coalescing...\n");
+    coalesce_temps();
+
     opt_stats.total_instructions_after = count_instructions();
 
     printf("Optimization completed.\n");
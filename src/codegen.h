@@ -27,6 +27,12 @@ typedef enum
     OP_GOTO,        // goto L
     OP_IF_GOTO,     // if x goto L
     OP_IF_NOT_GOTO, // if !x goto L
+    OP_IF_GT,       // if x > y goto L（x、y存于arg1、arg2，L存于result）
+    OP_IF_LT,       // if x < y goto L
+    OP_IF_GE,       // if x >= y goto L
+    OP_IF_LE,       // if x <= y goto L
+    OP_IF_EQ,       // if x == y goto L
+    OP_IF_NE,       // if x != y goto L
     OP_LABEL,       // L:
     OP_CALL,        // x = call f
     OP_ARG,         // arg x (for function calls)
@@ -80,10 +86,38 @@ extern Instruction *code_tail; // 指令链表尾
 extern int temp_count;         // 临时变量计数器
 extern int label_count;        // 标签计数器
 
+// 生成数组下标越界检查（由命令行设置）
+extern bool array_bounds_check;
+
+// 越界检查失败时调用的运行时函数
+#define BOUNDS_CHECK_FAIL_FUNCTION "__bounds_check_fail"
+
+// 变量声明信息：按函数登记类型与数组大小，供优化与后端查询
+typedef struct VariableInfo
+{
+    char *function;  // 所在函数，全局变量为NULL
+    char *name;
+    DataType type;   // TYPE_INT / TYPE_FLOAT，数组为元素类型，结构体为TYPE_STRUCT
+    int array_size;  // 一维数组的元素个数，标量为0，多维数组为-1
+    bool is_param;
+} VariableInfo;
+
 // 函数声明
 void init_codegen();
 void generate_code(TreeNode *root);
 
+// 变量声明信息
+void declare_variable(const char *function, const char *name, DataType type, int array_size, bool is_param);
+VariableInfo *lookup_variable_info(const char *function, const char *name);
+void copy_variable_info(const char *from_function, const char *from_name,
+                        const char *to_function, const char *to_name, bool is_param);
+void copy_function_variables(const char *from_function, const char *to_function);
+bool is_int_scalar(const char *function, const char *name);
+
+// 函数返回类型：未登记的函数（外部函数）按 int 处理
+void declare_function_type(const char *name, DataType return_type);
+DataType lookup_function_type(const char *name);
+
 // 操作数操作
 Operand *new_operand_variable(const char *name);
 Operand *new_operand_constant_int(int value);
@@ -91,6 +125,7 @@ Operand *new_operand_constant_float(float value);
 Operand *new_operand_temp();
 Operand *new_operand_label();
 Operand *new_operand_function(const char *name);
+Operand *copy_operand(Operand *op);
 
 // 指令生成
 void emit(OpType op, Operand *result, Operand *arg1, Operand *arg2);
@@ -115,6 +150,8 @@ void translate_dec(TreeNode *dec);
 
 // 外部定义列表翻译函数
 void translate_extdeflist(TreeNode *extdeflist);
+void record_global_variables(TreeNode *extdeclist);
+bool is_global_variable(const char *name);
 
 // 输出函数
 void print_code();
@@ -130,6 +167,13 @@ void free_operand(Operand *op);
 void free_instruction(Instruction *inst);
 void free_all_code();
 
+// 条件跳转辅助函数
+bool is_relational_branch(OpType op);
+bool is_conditional_branch(OpType op);
+OpType relation_to_branch(OpType op);
+OpType negate_branch(OpType op);
+const char *branch_relop_symbol(OpType op);
+
 // 中间代码优化函数
 void optimize_code();
 void constant_folding();
@@ -138,6 +182,7 @@ void dead_code_elimination();
 void common_subexpression_elimination();
 void redundant_assignment_elimination();
 void array_access_optimization();
+int fuse_compare_branches();
 
 // 优化辅助函数
 bool is_constant_operand(Operand *op);
@@ -158,6 +203,32 @@ typedef struct OptimizationStats
     int common_subexpression_count;
     int redundant_assignment_count;
     int array_access_optimization_count;
+    int loop_invariant_hoist_count;
+    int strength_reduction_count;
+    int induction_variable_elimination_count;
+    int loop_rotation_count;
+    int branch_fusion_count;
+    int cfg_simplification_count;
+    int tail_recursion_count;
+    int inline_count;
+    int dead_function_count;
+    int ipcp_count;
+    int specialization_count;
+    int copy_propagation_count;
+    int temp_coalescing_count;
+    int peephole_count;
+    int loop_unroll_count;
+    int store_forwarding_count;
+    int redundant_load_count;
+    int dead_store_count;
+    int pre_count;
+    int range_branch_count;
+    int allocated_value_count;  // 分到寄存器的虚拟寄存器
+    int spilled_value_count;    // 溢出到栈上的虚拟寄存器
+    int spill_access_count;     // 溢出引入的内存访问
+    int isel_fold_count;        // 指令选择并入表达式树的中间代码指令
+    int machine_peephole_count; // 机器级窥孔优化删除的指令
+    int vectorized_loop_count;  // 生成向量循环体的循环
     int total_instructions_before;
     int total_instructions_after;
 } OptimizationStats;
@@ -166,5 +237,25 @@ extern OptimizationStats opt_stats;
 
 void init_optimization_stats();
 void print_optimization_stats();
+void print_register_allocation_stats();
+
+// 优化选项（由命令行设置）
+typedef struct OptimizationOptions
+{
+    int inline_threshold; // 可内联函数体的最大指令数，0表示不内联
+    bool remove_dead_functions; // 删除从根函数不可达的函数
+    char **function_roots;      // 根函数列表（为空时只有main）
+    int function_root_count;
+    int specialize_budget;      // 函数特化允许的代码增长（占程序指令数的百分比），0表示不特化
+    int unroll_factor;          // 部分展开的展开因子，不大于1表示不做部分展开
+    int unroll_limit;           // 完全展开后循环体指令总数的上限，0表示不完全展开
+} OptimizationOptions;
+
+#define DEFAULT_INLINE_THRESHOLD 30
+#define DEFAULT_SPECIALIZE_BUDGET 25
+#define DEFAULT_UNROLL_FACTOR 4
+#define DEFAULT_UNROLL_LIMIT 64
+
+extern OptimizationOptions opt_options;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,592 @@
+#include "copy_prop.h"
+#include "type_infer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORD_BITS ((int)(sizeof(BitWord) * 8))
+
+// 复制传播每个函数的最大迭代轮数（每轮可把复制链缩短一级）
+#define COPY_PROP_MAX_ROUNDS 16
+
+// 复制 dest := src（src为变量、临时变量或整数常量），按(dest, src)去重，
+// 各分支中相同的复制视为同一个，汇合处仍然可用
+typedef struct CopyPair
+{
+    int dest;         // 目标在变量表中的下标
+    int src;          // 源在变量表中的下标，常量为-1
+    Operand *src_op;  // 源操作数副本
+    bool global;      // 涉及全局变量，函数调用会使其失效
+} CopyPair;
+
+// 整数下标列表
+typedef struct IndexList
+{
+    int *items;
+    int count;
+    int capacity;
+} IndexList;
+
+// 单个函数的可用复制分析状态
+typedef struct CopyState
+{
+    CFG *cfg;
+    CopyPair *copies;
+    int copy_count;
+    int copy_capacity;
+    IndexList *copies_of;  // 变量下标 -> 涉及它的复制（作目标或作源）
+    int words;
+    BitWord **avail_in;    // 按块编号索引
+    BitWord **avail_out;
+    Operand **garbage;     // 被替换下来的操作数，变量表的键可能指向它们，最后统一释放
+    int garbage_count;
+    int garbage_capacity;
+} CopyState;
+
+// ========================= 辅助函数 =========================
+
+static void index_list_add(IndexList *list, int value)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = (int *)realloc(list->items, list->capacity * sizeof(int));
+    }
+    list->items[list->count++] = value;
+}
+
+static bool is_copy_source(Operand *op)
+{
+    return op != NULL && (op->type == OPERAND_VARIABLE || op->type == OPERAND_TEMP || op->type == OPERAND_CONSTANT);
+}
+
+static bool is_global_operand(Operand *op)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE && is_global_variable(op->u.name);
+}
+
+// 指令中作为值使用的操作数位置。数组名按名传递，不是值，不参与替换
+static int value_use_slots(Instruction *inst, Operand ***slots)
+{
+    int count = 0;
+    switch (inst->op)
+    {
+    case OP_ARG:
+    case OP_RETURN:
+        if (inst->result)
+            slots[count++] = &inst->result;
+        break;
+    case OP_ARRAY_SET:
+        if (inst->arg1)
+            slots[count++] = &inst->arg1;
+        if (inst->arg2)
+            slots[count++] = &inst->arg2;
+        break;
+    case OP_ARRAY_GET:
+        if (inst->arg2)
+            slots[count++] = &inst->arg2;
+        break;
+    case OP_GOTO:
+    case OP_LABEL:
+    case OP_CALL:
+    case OP_PARAM:
+    case OP_FUNC_DEF:
+    case OP_FUNC_END:
+    case OP_ADDR:
+        break;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+        if (inst->arg1)
+            slots[count++] = &inst->arg1;
+        break;
+    default:
+        if (inst->arg1)
+            slots[count++] = &inst->arg1;
+        if (inst->arg2)
+            slots[count++] = &inst->arg2;
+        break;
+    }
+    return count;
+}
+
+// 查找指令对应的复制编号，不是复制时返回-1
+static int find_copy(CopyState *state, Instruction *inst)
+{
+    if (inst->op != OP_ASSIGN || !is_copy_source(inst->arg1))
+        return -1;
+
+    int dest = operand_table_lookup(&state->cfg->vars, inst->result);
+    if (dest < 0)
+        return -1;
+    int src = inst->arg1->type == OPERAND_CONSTANT ? -1 : operand_table_lookup(&state->cfg->vars, inst->arg1);
+    if (dest == src)
+        return -1;
+
+    IndexList *list = &state->copies_of[dest];
+    for (int i = 0; i < list->count; i++)
+    {
+        CopyPair *copy = &state->copies[list->items[i]];
+        if (copy->dest == dest && copy->src == src && (src >= 0 || operands_equal(copy->src_op, inst->arg1)))
+            return list->items[i];
+    }
+    return -1;
+}
+
+// 赋给声明了类型的变量时按变量类型转换（如 int 变量 := float 值），这样的赋值不是复制。
+// 临时变量没有声明类型，取到达的值的类型
+static bool preserves_value(CopyState *state, const char *function, const signed char *types, Instruction *inst)
+{
+    if (inst->result->type != OPERAND_VARIABLE)
+        return true;
+    return operand_value_type(state->cfg, function, types, inst->arg1) ==
+           declared_variable_type(function, inst->result->u.name);
+}
+
+static void register_copy(CopyState *state, const char *function, const signed char *types, Instruction *inst)
+{
+    if (inst->op != OP_ASSIGN || !is_copy_source(inst->arg1) || find_copy(state, inst) >= 0)
+        return;
+    if (!preserves_value(state, function, types, inst))
+        return;
+
+    int dest = operand_table_lookup(&state->cfg->vars, inst->result);
+    int src = inst->arg1->type == OPERAND_CONSTANT ? -1 : operand_table_lookup(&state->cfg->vars, inst->arg1);
+    if (dest < 0 || dest == src)
+        return;
+
+    if (state->copy_count == state->copy_capacity)
+    {
+        state->copy_capacity = state->copy_capacity ? state->copy_capacity * 2 : 32;
+        state->copies = (CopyPair *)realloc(state->copies, state->copy_capacity * sizeof(CopyPair));
+    }
+    int index = state->copy_count++;
+    CopyPair *copy = &state->copies[index];
+    copy->dest = dest;
+    copy->src = src;
+    copy->src_op = copy_operand(inst->arg1);
+    copy->global = is_global_operand(inst->result) || is_global_operand(inst->arg1);
+
+    index_list_add(&state->copies_of[dest], index);
+    if (src >= 0)
+        index_list_add(&state->copies_of[src], index);
+}
+
+// 正向传递：定值使涉及该变量的复制失效，函数调用使涉及全局变量的复制失效，复制本身生成
+static void transfer_copy(CopyState *state, Instruction *inst, BitWord *avail)
+{
+    int def = operand_table_lookup(&state->cfg->vars, instruction_def(inst));
+    if (def >= 0)
+    {
+        IndexList *list = &state->copies_of[def];
+        for (int i = 0; i < list->count; i++)
+            bitset_clear(avail, list->items[i]);
+    }
+
+    if (inst->op == OP_CALL)
+    {
+        for (int i = 0; i < state->copy_count; i++)
+        {
+            if (state->copies[i].global)
+                bitset_clear(avail, i);
+        }
+    }
+
+    int copy = find_copy(state, inst);
+    if (copy >= 0)
+        bitset_set(avail, copy);
+}
+
+// ========================= 可用复制分析 =========================
+
+// 正向数据流：IN[b] = ∩ OUT[pred]，入口块 IN 为空集
+static void compute_available_copies(CopyState *state)
+{
+    CFG *cfg = state->cfg;
+    int words = state->words;
+    BitWord *avail = bitset_new(words);
+
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        state->avail_in[i] = bitset_new(words);
+        state->avail_out[i] = bitset_new(words);
+        // 非入口块的 OUT 初始化为全集
+        if (cfg->blocks[i]->rpo > 0)
+            memset(state->avail_out[i], 0xff, words * sizeof(BitWord));
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < cfg->rpo_count; r++)
+        {
+            BasicBlock *block = cfg->rpo_order[r];
+            BitWord *in = state->avail_in[block->id];
+
+            if (block->rpo == 0)
+            {
+                memset(in, 0, words * sizeof(BitWord));
+            }
+            else
+            {
+                memset(in, 0xff, words * sizeof(BitWord));
+                for (int p = 0; p < block->pred_count; p++)
+                {
+                    BasicBlock *pred = block->preds[p];
+                    if (pred->rpo < 0)
+                        continue;
+                    for (int w = 0; w < words; w++)
+                        in[w] &= state->avail_out[pred->id][w];
+                }
+            }
+
+            memcpy(avail, in, words * sizeof(BitWord));
+            for (Instruction *inst = block->first;; inst = inst->next)
+            {
+                transfer_copy(state, inst, avail);
+                if (inst == block->last)
+                    break;
+            }
+
+            if (memcmp(avail, state->avail_out[block->id], words * sizeof(BitWord)) != 0)
+            {
+                memcpy(state->avail_out[block->id], avail, words * sizeof(BitWord));
+                changed = true;
+            }
+        }
+    }
+
+    free(avail);
+}
+
+// 按可用复制替换使用，返回替换次数
+static int rewrite_uses(CopyState *state)
+{
+    CFG *cfg = state->cfg;
+    BitWord *avail = bitset_new(state->words);
+    int replaced = 0;
+
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        BasicBlock *block = cfg->rpo_order[r];
+        memcpy(avail, state->avail_in[block->id], state->words * sizeof(BitWord));
+
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            Operand **slots[3];
+            int slot_count = value_use_slots(inst, slots);
+            for (int s = 0; s < slot_count; s++)
+            {
+                int var = operand_table_lookup(&cfg->vars, *slots[s]);
+                if (var < 0)
+                    continue;
+
+                IndexList *list = &state->copies_of[var];
+                for (int i = 0; i < list->count; i++)
+                {
+                    CopyPair *copy = &state->copies[list->items[i]];
+                    if (copy->dest != var || !bitset_test(avail, list->items[i]))
+                        continue;
+
+                    if (state->garbage_count == state->garbage_capacity)
+                    {
+                        state->garbage_capacity = state->garbage_capacity ? state->garbage_capacity * 2 : 32;
+                        state->garbage = (Operand **)realloc(state->garbage, state->garbage_capacity * sizeof(Operand *));
+                    }
+                    state->garbage[state->garbage_count++] = *slots[s];
+                    *slots[s] = copy_operand(copy->src_op);
+                    replaced++;
+                    break;
+                }
+            }
+
+            transfer_copy(state, inst, avail);
+            if (inst == block->last)
+                break;
+        }
+    }
+
+    free(avail);
+    return replaced;
+}
+
+// 单个函数做一轮复制传播，返回替换次数
+static int propagate_in_function(Instruction *func_def)
+{
+    CopyState state;
+    memset(&state, 0, sizeof(CopyState));
+    state.cfg = build_cfg(func_def);
+    CFG *cfg = state.cfg;
+
+    const char *function = func_def->result->u.name;
+    signed char **block_types = infer_temp_types(cfg, function);
+    signed char *types = (signed char *)malloc(cfg->vars.count + 1);
+    state.copies_of = (IndexList *)calloc(cfg->vars.count + 1, sizeof(IndexList));
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        memcpy(types, block_types[i], cfg->vars.count + 1);
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            register_copy(&state, function, types, inst);
+            transfer_temp_types(cfg, function, types, inst);
+            if (inst == block->last)
+                break;
+        }
+    }
+    free(types);
+    free_temp_types(cfg, block_types);
+
+    int replaced = 0;
+    if (state.copy_count > 0)
+    {
+        state.words = (state.copy_count + WORD_BITS - 1) / WORD_BITS;
+        state.avail_in = (BitWord **)calloc(cfg->block_count + 1, sizeof(BitWord *));
+        state.avail_out = (BitWord **)calloc(cfg->block_count + 1, sizeof(BitWord *));
+        compute_available_copies(&state);
+        replaced = rewrite_uses(&state);
+
+        for (int i = 0; i < cfg->block_count; i++)
+        {
+            free(state.avail_in[i]);
+            free(state.avail_out[i]);
+        }
+        free(state.avail_in);
+        free(state.avail_out);
+    }
+
+    for (int i = 0; i < cfg->vars.count; i++)
+        free(state.copies_of[i].items);
+    free(state.copies_of);
+    free_cfg(cfg);
+
+    for (int i = 0; i < state.garbage_count; i++)
+        free_operand(state.garbage[i]);
+    free(state.garbage);
+    for (int i = 0; i < state.copy_count; i++)
+        free_operand(state.copies[i].src_op);
+    free(state.copies);
+    return replaced;
+}
+
+// 全局复制传播，返回替换的使用个数。每个函数迭代到不动点，复制链逐级缩短
+int global_copy_propagation()
+{
+    int total = 0;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+
+        for (int round = 0; round < COPY_PROP_MAX_ROUNDS; round++)
+        {
+            int replaced = propagate_in_function(inst);
+            if (replaced == 0)
+                break;
+            total += replaced;
+        }
+    }
+
+    opt_stats.copy_propagation_count += total;
+    return total;
+}
+
+// ========================= 临时变量合并 =========================
+
+// 冲突矩阵（下三角不单独存放，按 a*n+b 对称置位）
+static void interfere(BitWord *matrix, int n, int a, int b)
+{
+    bitset_set(matrix, a * n + b);
+    bitset_set(matrix, b * n + a);
+}
+
+// 对单个函数的临时变量按冲突图着色，编号从 base+1 开始连续分配。
+// 复制相关且不冲突的临时变量优先取同一颜色（合并），之后 t := t 形式的复制被删除。
+// 返回使用的颜色数，*removed 累加删除的复制条数
+static int coalesce_in_function(Instruction *func_def, int base, int *removed)
+{
+    CFG *cfg = build_cfg(func_def);
+    compute_liveness(cfg);
+
+    // 变量表下标 -> 临时变量局部编号
+    int var_count = cfg->vars.count;
+    int *local = (int *)malloc((var_count + 1) * sizeof(int));
+    int n = 0;
+    for (int v = 0; v < var_count; v++)
+        local[v] = cfg->vars.keys[v]->type == OPERAND_TEMP ? n++ : -1;
+
+    BitWord *matrix = bitset_new((n * n + WORD_BITS - 1) / WORD_BITS);
+    int *partner_a = NULL;
+    int *partner_b = NULL;
+    int partner_count = 0;
+    int partner_capacity = 0;
+
+    // 逆向遍历每个块：定值与此处活跃的其他临时变量冲突（复制的源除外）
+    BitWord *live = bitset_new(cfg->bitset_words);
+    Instruction **buffer = NULL;
+    int capacity = 0;
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        BasicBlock *block = cfg->blocks[i];
+        int count = 0;
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            if (count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 64;
+                buffer = (Instruction **)realloc(buffer, capacity * sizeof(Instruction *));
+            }
+            buffer[count++] = inst;
+            if (inst == block->last)
+                break;
+        }
+
+        memcpy(live, block->live_out, cfg->bitset_words * sizeof(BitWord));
+        for (int k = count - 1; k >= 0; k--)
+        {
+            Instruction *inst = buffer[k];
+            int def = operand_table_lookup(&cfg->vars, instruction_def(inst));
+            int src = inst->op == OP_ASSIGN ? operand_table_lookup(&cfg->vars, inst->arg1) : -1;
+
+            if (def >= 0 && local[def] >= 0)
+            {
+                for (int v = 0; v < var_count; v++)
+                {
+                    if (local[v] >= 0 && v != def && v != src && bitset_test(live, v))
+                        interfere(matrix, n, local[def], local[v]);
+                }
+                if (src >= 0 && local[src] >= 0)
+                {
+                    if (partner_count == partner_capacity)
+                    {
+                        partner_capacity = partner_capacity ? partner_capacity * 2 : 16;
+                        partner_a = (int *)realloc(partner_a, partner_capacity * sizeof(int));
+                        partner_b = (int *)realloc(partner_b, partner_capacity * sizeof(int));
+                    }
+                    partner_a[partner_count] = local[def];
+                    partner_b[partner_count] = local[src];
+                    partner_count++;
+                }
+            }
+
+            if (def >= 0)
+                bitset_clear(live, def);
+            Operand *uses[3];
+            int use_count = instruction_uses(inst, uses);
+            for (int u = 0; u < use_count; u++)
+            {
+                int index = operand_table_lookup(&cfg->vars, uses[u]);
+                if (index >= 0)
+                    bitset_set(live, index);
+            }
+        }
+    }
+
+    // 按变量表顺序（即首次出现顺序）贪心着色
+    int *color = (int *)malloc((n + 1) * sizeof(int));
+    bool *used = (bool *)malloc((n + 1) * sizeof(bool));
+    int color_count = 0;
+    for (int t = 0; t < n; t++)
+    {
+        memset(used, 0, (n + 1) * sizeof(bool));
+        for (int u = 0; u < t; u++)
+        {
+            if (bitset_test(matrix, t * n + u))
+                used[color[u]] = true;
+        }
+
+        color[t] = -1;
+        for (int p = 0; p < partner_count && color[t] < 0; p++)
+        {
+            int other = partner_a[p] == t ? partner_b[p] : (partner_b[p] == t ? partner_a[p] : -1);
+            if (other >= 0 && other < t && !used[color[other]])
+                color[t] = color[other];
+        }
+        if (color[t] < 0)
+        {
+            int c = 0;
+            while (used[c])
+                c++;
+            color[t] = c;
+        }
+        if (color[t] + 1 > color_count)
+            color_count = color[t] + 1;
+    }
+
+    // 原编号 -> 新编号。先建好映射再改写，变量表的键指向指令中的操作数
+    int *remap = (int *)calloc(temp_count + 1, sizeof(int));
+    for (int v = 0; v < var_count; v++)
+    {
+        Operand *key = cfg->vars.keys[v];
+        if (local[v] >= 0 && key->u.temp_no >= 0 && key->u.temp_no <= temp_count)
+            remap[key->u.temp_no] = base + color[local[v]] + 1;
+    }
+    free_cfg(cfg);
+
+    Instruction *prev = func_def;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Operand *ops[3] = {inst->result, inst->arg1, inst->arg2};
+        for (int i = 0; i < 3; i++)
+        {
+            if (ops[i] != NULL && ops[i]->type == OPERAND_TEMP && ops[i]->u.temp_no >= 0 &&
+                ops[i]->u.temp_no <= temp_count && remap[ops[i]->u.temp_no] > 0)
+                ops[i]->u.temp_no = remap[ops[i]->u.temp_no];
+        }
+
+        Instruction *next = inst->next;
+        if (is_redundant_assignment(inst))
+        {
+            unlink_instruction(prev, inst);
+            free_instruction(inst);
+            (*removed)++;
+        }
+        else
+        {
+            prev = inst;
+        }
+        inst = next;
+    }
+
+    free(remap);
+    free(color);
+    free(used);
+    free(partner_a);
+    free(partner_b);
+    free(live);
+    free(buffer);
+    free(matrix);
+    free(local);
+    return color_count;
+}
+
+// 临时变量合并与重新编号，返回减少的临时变量个数。
+// 各函数的临时变量编号连续分配且互不重叠，之后新建的临时变量从最大编号之后开始
+int coalesce_temps()
+{
+    int before = 0;
+    int base = 0;
+    int removed = 0;
+
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+
+        CFG *cfg = build_cfg(inst);
+        for (int v = 0; v < cfg->vars.count; v++)
+        {
+            if (cfg->vars.keys[v]->type == OPERAND_TEMP)
+                before++;
+        }
+        free_cfg(cfg);
+
+        base += coalesce_in_function(inst, base, &removed);
+    }
+
+    temp_count = base + 1;
+    opt_stats.redundant_assignment_count += removed;
+    opt_stats.temp_coalescing_count += before - base;
+    return before - base;
+}
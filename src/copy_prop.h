@@ -0,0 +1,12 @@
+#ifndef COPY_PROP_H
+#define COPY_PROP_H
+
+#include "cfg.h"
+
+// 全局复制传播：基于可用复制数据流，把 x := y 之后对 x 的使用替换为 y
+int global_copy_propagation();
+
+// 临时变量合并与重新编号：按活跃区间冲突图着色，输出稠密的临时变量编号
+int coalesce_temps();
+
+#endif
@@ -0,0 +1,385 @@
+#include "elf_writer.h"
+#include "x86_backend.h"
+#include "x86_encode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ELF64 的常量与结构大小按 System V gABI 与 x86-64 psABI 定义，不依赖 <elf.h>，
+// 文件内容逐字节按小端序写出，在非 Linux 主机上同样可以生成
+#define ET_REL 1
+#define EM_X86_64 62
+#define EV_CURRENT 1
+
+#define SHT_PROGBITS 1
+#define SHT_SYMTAB 2
+#define SHT_STRTAB 3
+#define SHT_RELA 4
+#define SHT_NOBITS 8
+
+#define SHF_WRITE 0x1
+#define SHF_ALLOC 0x2
+#define SHF_EXECINSTR 0x4
+#define SHF_INFO_LINK 0x40
+
+#define STB_GLOBAL 1
+#define STB_WEAK 2
+#define STT_NOTYPE 0
+#define STT_OBJECT 1
+#define STT_FUNC 2
+#define SHN_UNDEF 0
+
+#define R_X86_64_PC32 2
+#define R_X86_64_PLT32 4
+
+#define ELF_HEADER_SIZE 64
+#define SECTION_HEADER_SIZE 64
+#define SYMBOL_ENTRY_SIZE 24
+#define RELA_ENTRY_SIZE 24
+
+// 节的顺序即节头表中的下标
+enum
+{
+    SEC_NULL,
+    SEC_TEXT,
+    SEC_BSS,
+    SEC_RELA_TEXT,
+    SEC_SYMTAB,
+    SEC_STRTAB,
+    SEC_SHSTRTAB,
+    SEC_NOTE_STACK,
+    SECTION_COUNT
+};
+
+static const char *section_names[SECTION_COUNT] = {
+    "", ".text", ".bss", ".rela.text", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack"};
+
+typedef struct ByteBuffer
+{
+    unsigned char *bytes;
+    int size;
+    int capacity;
+} ByteBuffer;
+
+// 节头表中的一项
+typedef struct ElfSection
+{
+    int name;        // 在 .shstrtab 中的位置
+    int type;
+    int flags;
+    long long offset;
+    long long size;
+    int link;
+    int info;
+    int align;
+    int entsize;
+} ElfSection;
+
+// 符号表中的一项；符号名是驻留的名字，按指针比较
+typedef struct ElfSymbol
+{
+    const char *name;
+    int section;     // 所在节，SHN_UNDEF 表示外部符号
+    long long value; // 在所在节中的位置
+    long long size;
+    int binding;
+    int type;
+} ElfSymbol;
+
+typedef struct ElfObject
+{
+    ElfSymbol *symbols;   // 下标 0 为空符号
+    int symbol_count;
+    int bss_size;
+    int bss_align;
+} ElfObject;
+
+// ========================= 字节输出 =========================
+
+static void put_byte(ByteBuffer *b, int value)
+{
+    if (b->size == b->capacity)
+    {
+        b->capacity = b->capacity ? b->capacity * 2 : 4096;
+        b->bytes = (unsigned char *)realloc(b->bytes, b->capacity);
+    }
+    b->bytes[b->size++] = (unsigned char)value;
+}
+
+static void put_bytes(ByteBuffer *b, const void *data, int size)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (int i = 0; i < size; i++)
+        put_byte(b, p[i]);
+}
+
+static void put_le(ByteBuffer *b, unsigned long long value, int size)
+{
+    for (int i = 0; i < size; i++)
+        put_byte(b, (int)((value >> (8 * i)) & 0xFF));
+}
+
+static void put_u16(ByteBuffer *b, int value)
+{
+    put_le(b, (unsigned long long)value, 2);
+}
+
+static void put_u32(ByteBuffer *b, long long value)
+{
+    put_le(b, (unsigned long long)value, 4);
+}
+
+static void put_u64(ByteBuffer *b, long long value)
+{
+    put_le(b, (unsigned long long)value, 8);
+}
+
+static void pad_to(ByteBuffer *b, int align)
+{
+    while (b->size % align != 0)
+        put_byte(b, 0);
+}
+
+// 追加以 NUL 结尾的字符串，返回其在字符串表中的位置
+static int add_string(ByteBuffer *table, const char *text)
+{
+    int offset = table->size;
+    put_bytes(table, text, (int)strlen(text) + 1);
+    return offset;
+}
+
+// ========================= 符号表 =========================
+
+static int find_symbol(ElfObject *obj, const char *name)
+{
+    for (int i = 1; i < obj->symbol_count; i++)
+    {
+        if (obj->symbols[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+static int add_symbol(ElfObject *obj, const char *name, int section, long long value, long long size, int binding,
+                      int type)
+{
+    obj->symbols = (ElfSymbol *)realloc(obj->symbols, (obj->symbol_count + 1) * sizeof(ElfSymbol));
+    ElfSymbol *symbol = &obj->symbols[obj->symbol_count];
+    symbol->name = name;
+    symbol->section = section;
+    symbol->value = value;
+    symbol->size = size;
+    symbol->binding = binding;
+    symbol->type = type;
+    return obj->symbol_count++;
+}
+
+// 函数、全局数据依次登记，重定位引用而未定义的名字登记为外部符号。
+// 与汇编后端一致，所有符号都是全局（或弱）符号，没有局部符号
+static void build_symbols(ElfObject *obj, MProgram *program, CodeBuffer *code)
+{
+    add_symbol(obj, "", SHN_UNDEF, 0, 0, 0, STT_NOTYPE);
+
+    for (int i = 0; i < code->symbol_count; i++)
+    {
+        CodeSymbol *s = &code->symbols[i];
+        add_symbol(obj, s->name, SEC_TEXT, s->offset, s->size, s->weak ? STB_WEAK : STB_GLOBAL, STT_FUNC);
+    }
+
+    obj->bss_align = 1;
+    for (MGlobal *g = program->globals; g != NULL; g = g->next)
+    {
+        obj->bss_size = (obj->bss_size + g->align - 1) / g->align * g->align;
+        add_symbol(obj, intern_symbol(g->name), SEC_BSS, obj->bss_size, g->size, g->weak ? STB_WEAK : STB_GLOBAL,
+                   STT_OBJECT);
+        obj->bss_size += g->size;
+        if (g->align > obj->bss_align)
+            obj->bss_align = g->align;
+    }
+
+    for (int i = 0; i < code->reloc_count; i++)
+    {
+        const char *name = code->relocs[i].symbol;
+        if (find_symbol(obj, name) < 0)
+            add_symbol(obj, name, SHN_UNDEF, 0, 0, STB_GLOBAL, STT_NOTYPE);
+    }
+}
+
+// ========================= 文件输出 =========================
+
+static void write_elf_header(ByteBuffer *b, long long section_header_offset)
+{
+    static const unsigned char ident[16] = {0x7F, 'E', 'L', 'F', 2 /* ELFCLASS64 */, 1 /* ELFDATA2LSB */,
+                                            EV_CURRENT, 0 /* ELFOSABI_SYSV */};
+    put_bytes(b, ident, sizeof(ident));
+    put_u16(b, ET_REL);
+    put_u16(b, EM_X86_64);
+    put_u32(b, EV_CURRENT);
+    put_u64(b, 0); // e_entry
+    put_u64(b, 0); // e_phoff
+    put_u64(b, section_header_offset);
+    put_u32(b, 0); // e_flags
+    put_u16(b, ELF_HEADER_SIZE);
+    put_u16(b, 0); // e_phentsize
+    put_u16(b, 0); // e_phnum
+    put_u16(b, SECTION_HEADER_SIZE);
+    put_u16(b, SECTION_COUNT);
+    put_u16(b, SEC_SHSTRTAB);
+}
+
+// 把节的内容追加到文件中并记录位置与大小
+static void place_section(ByteBuffer *file, ElfSection *section, const ByteBuffer *content)
+{
+    pad_to(file, section->align);
+    section->offset = file->size;
+    section->size = content->size;
+    put_bytes(file, content->bytes, content->size);
+}
+
+static void build_object_file(ByteBuffer *file, ElfObject *obj, CodeBuffer *code)
+{
+    ElfSection sections[SECTION_COUNT];
+    memset(sections, 0, sizeof(sections));
+
+    ByteBuffer shstrtab = {0};
+    for (int i = 0; i < SECTION_COUNT; i++)
+        sections[i].name = add_string(&shstrtab, section_names[i]);
+
+    // 字符串表以空字符串开头，空符号的名字指向它
+    ByteBuffer strtab = {0};
+    put_byte(&strtab, 0);
+    ByteBuffer symtab = {0};
+    for (int i = 0; i < obj->symbol_count; i++)
+    {
+        ElfSymbol *s = &obj->symbols[i];
+        put_u32(&symtab, i == 0 ? 0 : add_string(&strtab, s->name));
+        put_byte(&symtab, (s->binding << 4) | s->type);
+        put_byte(&symtab, 0); // STV_DEFAULT
+        put_u16(&symtab, s->section);
+        put_u64(&symtab, s->value);
+        put_u64(&symtab, s->size);
+    }
+
+    // 外部函数的调用用 PLT32（链接器在需要时经 PLT 间接调用），全局数据的访问用 PC32
+    ByteBuffer rela = {0};
+    for (int i = 0; i < code->reloc_count; i++)
+    {
+        Relocation *r = &code->relocs[i];
+        long long symbol = find_symbol(obj, r->symbol);
+        long long type = r->kind == RELOC_CALL ? R_X86_64_PLT32 : R_X86_64_PC32;
+        put_u64(&rela, r->offset);
+        put_u64(&rela, symbol << 32 | type);
+        put_u64(&rela, r->addend);
+    }
+
+    ByteBuffer text = {code->bytes, code->size, code->capacity};
+    ByteBuffer empty = {0};
+
+    sections[SEC_TEXT].type = SHT_PROGBITS;
+    sections[SEC_TEXT].flags = SHF_ALLOC | SHF_EXECINSTR;
+    sections[SEC_TEXT].align = 16;
+
+    sections[SEC_BSS].type = SHT_NOBITS;
+    sections[SEC_BSS].flags = SHF_WRITE | SHF_ALLOC;
+    sections[SEC_BSS].align = obj->bss_align;
+
+    sections[SEC_RELA_TEXT].type = SHT_RELA;
+    sections[SEC_RELA_TEXT].flags = SHF_INFO_LINK;
+    sections[SEC_RELA_TEXT].link = SEC_SYMTAB;
+    sections[SEC_RELA_TEXT].info = SEC_TEXT;
+    sections[SEC_RELA_TEXT].align = 8;
+    sections[SEC_RELA_TEXT].entsize = RELA_ENTRY_SIZE;
+
+    // sh_info 为第一个非局部符号的下标：只有空符号是局部的
+    sections[SEC_SYMTAB].type = SHT_SYMTAB;
+    sections[SEC_SYMTAB].link = SEC_STRTAB;
+    sections[SEC_SYMTAB].info = 1;
+    sections[SEC_SYMTAB].align = 8;
+    sections[SEC_SYMTAB].entsize = SYMBOL_ENTRY_SIZE;
+
+    sections[SEC_STRTAB].type = SHT_STRTAB;
+    sections[SEC_STRTAB].align = 1;
+    sections[SEC_SHSTRTAB].type = SHT_STRTAB;
+    sections[SEC_SHSTRTAB].align = 1;
+
+    // 空的 .note.GNU-stack 表示不需要可执行栈
+    sections[SEC_NOTE_STACK].type = SHT_PROGBITS;
+    sections[SEC_NOTE_STACK].align = 1;
+
+    // 文件布局：ELF 头，各节内容，节头表
+    for (int i = 0; i < ELF_HEADER_SIZE; i++)
+        put_byte(file, 0);
+    place_section(file, &sections[SEC_TEXT], &text);
+    sections[SEC_BSS].offset = file->size;
+    sections[SEC_BSS].size = obj->bss_size;
+    place_section(file, &sections[SEC_RELA_TEXT], &rela);
+    place_section(file, &sections[SEC_SYMTAB], &symtab);
+    place_section(file, &sections[SEC_STRTAB], &strtab);
+    place_section(file, &sections[SEC_SHSTRTAB], &shstrtab);
+    place_section(file, &sections[SEC_NOTE_STACK], &empty);
+
+    pad_to(file, 8);
+    long long section_header_offset = file->size;
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        ElfSection *s = &sections[i];
+        put_u32(file, s->name);
+        put_u32(file, s->type);
+        put_u64(file, s->flags);
+        put_u64(file, 0); // sh_addr
+        put_u64(file, i == SEC_NULL ? 0 : s->offset);
+        put_u64(file, s->size);
+        put_u32(file, s->link);
+        put_u32(file, s->info);
+        put_u64(file, i == SEC_NULL ? 0 : s->align);
+        put_u64(file, s->entsize);
+    }
+
+    // 回填 ELF 头
+    ByteBuffer header = {0};
+    write_elf_header(&header, section_header_offset);
+    memcpy(file->bytes, header.bytes, ELF_HEADER_SIZE);
+
+    free(header.bytes);
+    free(shstrtab.bytes);
+    free(strtab.bytes);
+    free(symtab.bytes);
+    free(rela.bytes);
+}
+
+bool write_elf_object(const char *filename)
+{
+    MProgram *program = compile_to_x86();
+    if (program == NULL)
+        return false;
+
+    CodeBuffer code;
+    if (!encode_mprogram(program, &code))
+    {
+        free_mprogram(program);
+        return false;
+    }
+
+    ElfObject obj;
+    memset(&obj, 0, sizeof(ElfObject));
+    build_symbols(&obj, program, &code);
+    ByteBuffer file = {0};
+    build_object_file(&file, &obj, &code);
+    free(obj.symbols);
+    free_code_buffer(&code);
+    free_mprogram(program);
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL)
+    {
+        perror(filename);
+        free(file.bytes);
+        return false;
+    }
+    bool ok = fwrite(file.bytes, 1, (size_t)file.size, fp) == (size_t)file.size;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok)
+        fprintf(stderr, "Error: failed to write %s\n", filename);
+    free(file.bytes);
+    return ok;
+}
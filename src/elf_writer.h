@@ -0,0 +1,12 @@
+#ifndef ELF_WRITER_H
+#define ELF_WRITER_H
+
+#include "codegen.h"
+
+// 经 x86-64 后端把程序直接编码为机器代码，写出 ELF64 可重定位目标文件（.o）：
+// .text 存放函数，.bss 存放全局变量与数组，.symtab 登记函数、全局数据与外部符号，
+// .rela.text 记录外部调用与全局数据访问的重定位。输出可直接用 gcc foo.o 链接，不经过汇编器。
+// 无法编码或写文件失败时报错并返回false
+bool write_elf_object(const char *filename);
+
+#endif
@@ -0,0 +1,426 @@
+#include "inliner.h"
+#include "cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 内联后调用者函数体的最大指令数
+#define INLINE_CALLER_SIZE_LIMIT 2000
+
+// 内联点编号，用于生成唯一的局部变量名
+static int inline_site_count = 0;
+
+// 被内联函数的形参及其绑定
+typedef struct ParamBinding
+{
+    const char *name;    // 形参名
+    Operand *value;      // 展开后替换形参的操作数
+    bool assigned;       // 函数体中对形参重新赋值
+    bool array;          // 作为数组使用
+} ParamBinding;
+
+// 一次内联展开的重命名表
+typedef struct InlineContext
+{
+    ParamBinding *params;
+    int param_count;
+    Operand **temp_map;  // 原临时变量编号 -> 新临时变量
+    int temp_limit;
+    Operand **label_map; // 原标签编号 -> 新标签
+    int label_limit;
+    char **local_names;  // 被调函数的局部变量名
+    Operand **local_map; // 对应的新变量
+    int local_count;
+    int local_capacity;
+    int site;
+    const char *caller;  // 调用者与被调函数名，用于登记改名后变量的声明信息
+    const char *callee;
+} InlineContext;
+
+// ========================= 辅助函数 =========================
+
+static bool is_variable_named(Operand *op, const char *name)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE && strcmp(op->u.name, name) == 0;
+}
+
+// 变量是否在[first, last)范围内作为数组使用
+static bool used_as_array(Instruction *first, Instruction *last, const char *name)
+{
+    for (Instruction *inst = first; inst != NULL && inst != last; inst = inst->next)
+    {
+        if ((inst->op == OP_ARRAY_GET && is_variable_named(inst->arg1, name)) ||
+            (inst->op == OP_ARRAY_SET && is_variable_named(inst->result, name)))
+            return true;
+    }
+    return false;
+}
+
+// 变量是否在[first, last)范围内被赋值
+static bool defined_between(Instruction *first, Instruction *last, Operand *op)
+{
+    for (Instruction *inst = first; inst != NULL && inst != last; inst = inst->next)
+    {
+        if (inst->op != OP_PARAM && operands_equal(instruction_def(inst), op))
+            return true;
+    }
+    return false;
+}
+
+// 变量在函数中是否指全局变量：与全局变量同名的局部变量以局部声明为准
+static bool is_global_in(const char *function, const char *name)
+{
+    VariableInfo *info = lookup_variable_info(function, name);
+    return info != NULL ? info->function == NULL : is_global_variable(name);
+}
+
+static bool is_shadowed_global(CallGraphNode *caller, CallGraphNode *callee, Operand *op)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE && is_global_in(callee->name, op->u.name) &&
+           !is_global_in(caller->name, op->u.name);
+}
+
+// 被调函数用到的全局变量在调用者中被同名局部变量遮蔽时，展开后会引用到调用者的局部变量
+static bool uses_shadowed_global(CallGraphNode *caller, CallGraphNode *callee)
+{
+    for (Instruction *inst = callee->func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (is_shadowed_global(caller, callee, inst->result) || is_shadowed_global(caller, callee, inst->arg1) ||
+            is_shadowed_global(caller, callee, inst->arg2))
+            return true;
+    }
+    return false;
+}
+
+static Instruction *function_end(Instruction *func_def)
+{
+    Instruction *end = func_def;
+    while (end != NULL && end->op != OP_FUNC_END)
+        end = end->next;
+    return end;
+}
+
+static bool contains_call(Instruction *func_def)
+{
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_CALL)
+            return true;
+    }
+    return false;
+}
+
+// 实参是否为数组：在调用者中按数组使用，或为在程序中按数组使用的全局变量
+static bool is_array_argument(Instruction *caller_def, Operand *arg)
+{
+    if (arg->type != OPERAND_VARIABLE)
+        return false;
+    if (is_global_variable(arg->u.name))
+        return used_as_array(code_head, NULL, arg->u.name);
+    return used_as_array(caller_def, function_end(caller_def), arg->u.name);
+}
+
+// ========================= 操作数重命名 =========================
+
+static Operand *remap_local(InlineContext *ctx, Operand *op)
+{
+    for (int i = 0; i < ctx->local_count; i++)
+    {
+        if (strcmp(ctx->local_names[i], op->u.name) == 0)
+            return ctx->local_map[i];
+    }
+
+    if (ctx->local_count == ctx->local_capacity)
+    {
+        ctx->local_capacity = ctx->local_capacity ? ctx->local_capacity * 2 : 8;
+        ctx->local_names = (char **)realloc(ctx->local_names, ctx->local_capacity * sizeof(char *));
+        ctx->local_map = (Operand **)realloc(ctx->local_map, ctx->local_capacity * sizeof(Operand *));
+    }
+
+    char name[256];
+    snprintf(name, sizeof(name), "%s__%d", op->u.name, ctx->site);
+    ctx->local_names[ctx->local_count] = strdup(op->u.name);
+    ctx->local_map[ctx->local_count] = new_operand_variable(name);
+    copy_variable_info(ctx->callee, op->u.name, ctx->caller, name, false);
+    return ctx->local_map[ctx->local_count++];
+}
+
+// 返回op在展开后的副本：临时变量和标签重新编号，形参替换为实参，局部变量改名
+static Operand *remap_operand(InlineContext *ctx, Operand *op)
+{
+    if (op == NULL)
+        return NULL;
+
+    switch (op->type)
+    {
+    case OPERAND_TEMP:
+        if (op->u.temp_no < ctx->temp_limit)
+        {
+            if (ctx->temp_map[op->u.temp_no] == NULL)
+                ctx->temp_map[op->u.temp_no] = new_operand_temp();
+            return copy_operand(ctx->temp_map[op->u.temp_no]);
+        }
+        return copy_operand(op);
+    case OPERAND_LABEL:
+        if (op->u.temp_no < ctx->label_limit)
+        {
+            if (ctx->label_map[op->u.temp_no] == NULL)
+                ctx->label_map[op->u.temp_no] = new_operand_label();
+            return copy_operand(ctx->label_map[op->u.temp_no]);
+        }
+        return copy_operand(op);
+    case OPERAND_VARIABLE:
+        for (int i = 0; i < ctx->param_count; i++)
+        {
+            if (strcmp(ctx->params[i].name, op->u.name) == 0)
+                return copy_operand(ctx->params[i].value);
+        }
+        if (is_global_in(ctx->callee, op->u.name))
+            return copy_operand(op);
+        return copy_operand(remap_local(ctx, op));
+    default:
+        return copy_operand(op);
+    }
+}
+
+static void free_inline_context(InlineContext *ctx)
+{
+    for (int i = 0; i < ctx->param_count; i++)
+        free_operand(ctx->params[i].value);
+    for (int i = 0; i < ctx->temp_limit; i++)
+        free_operand(ctx->temp_map[i]);
+    for (int i = 0; i < ctx->label_limit; i++)
+        free_operand(ctx->label_map[i]);
+    for (int i = 0; i < ctx->local_count; i++)
+    {
+        free(ctx->local_names[i]);
+        free_operand(ctx->local_map[i]);
+    }
+    free(ctx->params);
+    free(ctx->temp_map);
+    free(ctx->label_map);
+    free(ctx->local_names);
+    free(ctx->local_map);
+}
+
+// ========================= 内联展开 =========================
+
+// 为每个形参确定绑定：能直接替换的用实参本身，否则在 ARG 处复制到新的局部变量。
+// 返回false表示无法内联（如数组形参对应的实参不是变量）
+static bool bind_params(InlineContext *ctx, Instruction *caller_def, Instruction *callee_def,
+                        Instruction **args, Instruction *call, bool *substitute)
+{
+    Instruction *body = callee_def->next;
+    Instruction *end = function_end(callee_def);
+    bool callee_calls = contains_call(callee_def);
+    int i = 0;
+
+    for (Instruction *inst = body; inst != NULL && inst->op == OP_PARAM; inst = inst->next, i++)
+    {
+        ParamBinding *param = &ctx->params[i];
+        Operand *arg = args[i]->result;
+        param->name = inst->result->u.name;
+        param->array = used_as_array(body, end, param->name) || is_array_argument(caller_def, arg);
+        param->assigned = defined_between(body, end, inst->result);
+
+        if (param->array)
+        {
+            if (arg->type != OPERAND_VARIABLE || param->assigned)
+                return false;
+            substitute[i] = true;
+        }
+        else if (param->assigned)
+        {
+            substitute[i] = false;
+        }
+        else if (arg->type == OPERAND_CONSTANT || arg->type == OPERAND_CONSTANT_FLOAT)
+        {
+            substitute[i] = true;
+        }
+        else
+        {
+            // 实参在 ARG 与 CALL 之间或展开后的函数体内可能被修改时不能直接替换
+            bool may_change = defined_between(args[i]->next, call, arg);
+            if (arg->type == OPERAND_VARIABLE && is_global_variable(arg->u.name))
+                may_change = may_change || callee_calls || defined_between(body, end, arg);
+            substitute[i] = !may_change;
+        }
+    }
+
+    for (i = 0; i < ctx->param_count; i++)
+    {
+        Operand *arg = args[i]->result;
+        if (substitute[i])
+        {
+            ctx->params[i].value = copy_operand(arg);
+        }
+        else
+        {
+            char name[256];
+            snprintf(name, sizeof(name), "%s__%d", ctx->params[i].name, ctx->site);
+            ctx->params[i].value = new_operand_variable(name);
+            copy_variable_info(ctx->callee, ctx->params[i].name, ctx->caller, name, false);
+        }
+    }
+    return true;
+}
+
+// 在调用处展开被调函数，返回展开代码的最后一条指令（返回标签）
+static Instruction *inline_call_site(Instruction *caller_def, Instruction *call, CallGraphNode *callee,
+                                     Instruction **args)
+{
+    InlineContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.site = ++inline_site_count;
+    ctx.caller = caller_def->result->u.name;
+    ctx.callee = callee->name;
+    ctx.param_count = callee->param_count;
+    ctx.params = (ParamBinding *)calloc(ctx.param_count + 1, sizeof(ParamBinding));
+    ctx.temp_limit = temp_count + 1;
+    ctx.temp_map = (Operand **)calloc(ctx.temp_limit, sizeof(Operand *));
+    ctx.label_limit = label_count + 1;
+    ctx.label_map = (Operand **)calloc(ctx.label_limit, sizeof(Operand *));
+
+    bool *substitute = (bool *)calloc(ctx.param_count + 1, sizeof(bool));
+    if (!bind_params(&ctx, caller_def, callee->func_def, args, call, substitute))
+    {
+        free(substitute);
+        free_inline_context(&ctx);
+        return NULL;
+    }
+
+    // 实参：直接替换的删除 ARG，其余改为复制到形参的新名字
+    for (int i = 0; i < ctx.param_count; i++)
+    {
+        Instruction *arg = args[i];
+        if (substitute[i])
+        {
+            unlink_instruction(find_prev_instruction(caller_def, arg), arg);
+            free_instruction(arg);
+        }
+        else
+        {
+            arg->op = OP_ASSIGN;
+            arg->arg1 = arg->result;
+            arg->result = copy_operand(ctx.params[i].value);
+        }
+    }
+    free(substitute);
+
+    // 复制函数体，RETURN 改为给调用结果赋值并跳到返回标签
+    Operand *return_label = new_operand_label();
+    Instruction *pos = find_prev_instruction(caller_def, call);
+    Instruction *body = callee->func_def->next;
+    while (body->op == OP_PARAM)
+        body = body->next;
+
+    for (Instruction *inst = body; inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_RETURN)
+        {
+            if (inst->result != NULL && call->result != NULL)
+            {
+                Instruction *assign = new_instruction(OP_ASSIGN, copy_operand(call->result),
+                                                      remap_operand(&ctx, inst->result), NULL);
+                insert_instruction_after(pos, assign);
+                pos = assign;
+            }
+            Instruction *jump = new_instruction(OP_GOTO, NULL, copy_operand(return_label), NULL);
+            insert_instruction_after(pos, jump);
+            pos = jump;
+            continue;
+        }
+
+        Instruction *copy = new_instruction(inst->op, remap_operand(&ctx, inst->result),
+                                            remap_operand(&ctx, inst->arg1), remap_operand(&ctx, inst->arg2));
+        insert_instruction_after(pos, copy);
+        pos = copy;
+    }
+
+    Instruction *label = new_instruction(OP_LABEL, return_label, NULL, NULL);
+    insert_instruction_after(pos, label);
+
+    unlink_instruction(label, call);
+    free_instruction(call);
+    free_inline_context(&ctx);
+    return label;
+}
+
+// 是否在此调用处内联
+static bool should_inline(CallGraphNode *caller, CallGraphNode *callee, int arg_count)
+{
+    if (opt_options.inline_threshold <= 0 || callee == caller || callee->recursive)
+        return false;
+    if (arg_count != callee->param_count)
+        return false;
+
+    int size = function_size(callee->func_def);
+    if (size > opt_options.inline_threshold || uses_shadowed_global(caller, callee))
+        return false;
+    return function_size(caller->func_def) + size <= INLINE_CALLER_SIZE_LIMIT;
+}
+
+// 内联调用者中所有合适的调用
+static int inline_calls_in(CallGraph *graph, CallGraphNode *caller)
+{
+    int count = 0;
+    int capacity = 16;
+    int depth = 0;
+    Instruction **stack = (Instruction **)malloc(capacity * sizeof(Instruction *));
+
+    // ARG 按从左到右的顺序压栈，CALL 弹出被调函数形参个数的实参（嵌套调用的实参先被弹出）
+    Instruction *inst = caller->func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        if (inst->op == OP_ARG)
+        {
+            if (depth == capacity)
+            {
+                capacity *= 2;
+                stack = (Instruction **)realloc(stack, capacity * sizeof(Instruction *));
+            }
+            stack[depth++] = inst;
+        }
+        else if (inst->op == OP_CALL)
+        {
+            int index = inst->arg1 ? call_graph_find(graph, inst->arg1->u.name) : -1;
+            int arg_count = index >= 0 ? graph->nodes[index].param_count : depth;
+            if (arg_count > depth)
+                arg_count = depth;
+            depth -= arg_count;
+
+            if (index >= 0 && should_inline(caller, &graph->nodes[index], arg_count))
+            {
+                Instruction *last = inline_call_site(caller->func_def, inst, &graph->nodes[index], &stack[depth]);
+                if (last != NULL)
+                {
+                    count++;
+                    inst = last->next;
+                    continue;
+                }
+            }
+        }
+        inst = inst->next;
+    }
+
+    free(stack);
+    return count;
+}
+
+// 函数内联：被调函数先于调用者处理，使已展开的调用链继续向上内联
+int inline_functions()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    CallGraph *graph = build_call_graph();
+    for (int i = 0; i < graph->node_count; i++)
+    {
+        CallGraphNode *caller = &graph->nodes[graph->bottom_up[i]];
+        total += inline_calls_in(graph, caller);
+    }
+    free_call_graph(graph);
+
+    opt_stats.inline_count += total;
+    return total;
+}
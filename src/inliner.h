@@ -0,0 +1,9 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "callgraph.h"
+
+// 函数内联：按调用图自底向上把小函数展开到调用处
+int inline_functions();
+
+#endif
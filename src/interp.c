@@ -0,0 +1,1242 @@
+#include "interp.h"
+#include "type_infer.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 线索化分派需要 GCC 的标签地址扩展，其他编译器退回 switch 分派
+#if defined(__GNUC__)
+#define INTERP_THREADED 1
+#else
+#define INTERP_THREADED 0
+#endif
+
+// 值栈（帧槽位与局部数组）、调用栈与实参栈的容量
+#define INTERP_STACK_SIZE (1 << 22)
+#define INTERP_MAX_CALL_DEPTH (1 << 20)
+#define INTERP_MAX_ARGS (1 << 16)
+
+// 帧内固定槽位：丢弃的结果、类型转换与结果转换用的临时槽位；变量、临时变量从 SLOT_FIRST_VAR 开始，
+// 其后是常量池，再后是局部数组（每个数组前有一个存放长度的槽位）
+#define SLOT_DISCARD 0
+#define SLOT_SCRATCH_A 1
+#define SLOT_SCRATCH_B 2
+#define SLOT_RESULT 3
+#define SLOT_FIRST_VAR 4
+
+// 解释器指令：a、b 为源槽位，c 为目的槽位或跳转目标（指令下标）
+//   CALL: a 为函数编号，c 为结果槽位；AGET: c = a[b]；ASET: a[b] = c；ARG/RET: a 为源槽位
+//   GLOAD: c = 全局变量 a；GSTORE: 全局变量 c = a（全局数组的值为首元素地址）
+#define INTERP_OPCODES(X)                                                                        \
+    X(I_MOV) X(I_I2F) X(I_F2I)                                                                   \
+    X(I_ADD) X(I_SUB) X(I_MUL) X(I_DIV) X(I_NEG)                                                 \
+    X(I_FADD) X(I_FSUB) X(I_FMUL) X(I_FDIV) X(I_FNEG)                                            \
+    X(I_LT) X(I_LE) X(I_EQ) X(I_NE) X(I_FLT) X(I_FLE) X(I_FEQ) X(I_FNE)                          \
+    X(I_NOT) X(I_AND) X(I_OR) X(I_FNOT) X(I_FAND) X(I_FOR)                                       \
+    X(I_JMP) X(I_JNZ) X(I_JZ) X(I_FJNZ) X(I_FJZ)                                                 \
+    X(I_JLT) X(I_JLE) X(I_JEQ) X(I_JNE) X(I_FJLT) X(I_FJLE) X(I_FJEQ) X(I_FJNE)                  \
+    X(I_AGET) X(I_ASET) X(I_GLOAD) X(I_GSTORE)                                                   \
+    X(I_ARG) X(I_ARG_I2F) X(I_ARG_F2I) X(I_CALL) X(I_RET) X(I_RET_ZERO) X(I_BOUNDS_FAIL)
+
+#define OPCODE_ENUM(name) name,
+typedef enum
+{
+    INTERP_OPCODES(OPCODE_ENUM)
+    I_OPCODE_COUNT
+} ICodeOp;
+
+typedef struct ICode
+{
+    ICodeOp op;
+    const void *handler; // 线索化分派时的处理代码地址
+    int a;
+    int b;
+    int c;
+} ICode;
+
+typedef union Value
+{
+    int i;
+    float f;
+    union Value *p; // 数组首元素
+} Value;
+
+// 值的种类：整数、单精度浮点、数组首地址
+typedef enum
+{
+    VALUE_INT,
+    VALUE_FLOAT,
+    VALUE_POINTER
+} ValueKind;
+
+typedef struct LocalArray
+{
+    int slot;   // 存放首地址的槽位
+    int size;
+    int offset; // 存储在帧内的位置（长度槽位）
+} LocalArray;
+
+// 全局变量：每个变量一个存储槽位，全局数组的元素存储在所有变量槽位之后
+typedef struct GlobalVar
+{
+    const char *name;
+    int size;   // 数组元素个数，标量为0
+    int offset; // 数组存储的位置（长度槽位）
+} GlobalVar;
+
+typedef struct IFunction
+{
+    const char *name;
+    Instruction *def;
+    DataType return_type;
+    int param_count;
+    ValueKind *param_kinds;
+    int *param_slots;
+    int entry;          // 首条指令下标
+    int slot_count;     // 固定槽位与变量、临时变量
+    Value *constants;   // 常量池，进入函数时复制到 slot_count 开始的槽位
+    DataType *constant_types;
+    int constant_count;
+    int constant_capacity;
+    LocalArray *arrays;
+    int array_count;
+    int frame_size;     // 槽位、常量池与局部数组的总大小
+} IFunction;
+
+// 已翻译、等待 CALL 的实参
+typedef struct PendingArg
+{
+    int code;
+    ValueKind kind;
+} PendingArg;
+
+// 单个函数的翻译状态
+typedef struct Translator
+{
+    IFunction *fn;
+    CFG *cfg;
+    signed char *types; // 当前位置上各临时变量的类型
+    PendingArg *args;
+    int arg_count;
+    int arg_capacity;
+    int param_index;
+    bool failed;
+} Translator;
+
+typedef struct CallFrame
+{
+    IFunction *function;
+    Value *fp;
+    ICode *return_pc;
+    int result_slot;
+} CallFrame;
+
+static ICode *code = NULL;
+static int code_count = 0;
+static int code_capacity = 0;
+static IFunction *functions = NULL;
+static int function_count = 0;
+static int *label_positions = NULL; // 按标签编号：标签后第一条指令的下标
+static GlobalVar *globals = NULL;
+static int global_count = 0;
+
+static void translation_error(Translator *T, const char *message)
+{
+    if (!T->failed)
+        fprintf(stderr, "Error: interpreter: %s in function %s\n", message, T->fn->name);
+    T->failed = true;
+}
+
+static int emit_i(ICodeOp op, int a, int b, int c)
+{
+    if (code_count == code_capacity)
+    {
+        code_capacity = code_capacity ? code_capacity * 2 : 256;
+        code = (ICode *)realloc(code, code_capacity * sizeof(ICode));
+    }
+    ICode *ic = &code[code_count];
+    ic->op = op;
+    ic->handler = NULL;
+    ic->a = a;
+    ic->b = b;
+    ic->c = c;
+    return code_count++;
+}
+
+static IFunction *find_function(const char *name)
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        if (strcmp(functions[i].name, name) == 0)
+            return &functions[i];
+    }
+    return NULL;
+}
+
+// ========================= 槽位与操作数 =========================
+
+// 数组变量的元素个数，标量为0；多维数组不支持
+static int array_size(Translator *T, Operand *op)
+{
+    if (op->type != OPERAND_VARIABLE)
+        return 0;
+    VariableInfo *info = lookup_variable_info(T->fn->name, op->u.name);
+    if (info == NULL)
+        return 0;
+    if (info->array_size < 0)
+        translation_error(T, "multi-dimensional array access is not supported");
+    return info->array_size;
+}
+
+// 全局变量的编号，不是全局变量时为 -1；首次出现时登记存储
+static int global_index(Translator *T, Operand *op)
+{
+    if (op == NULL || op->type != OPERAND_VARIABLE)
+        return -1;
+    // 与全局变量同名的局部变量以局部声明为准
+    VariableInfo *info = lookup_variable_info(T->fn->name, op->u.name);
+    if (info != NULL ? info->function != NULL : !is_global_variable(op->u.name))
+        return -1;
+
+    for (int i = 0; i < global_count; i++)
+    {
+        if (strcmp(globals[i].name, op->u.name) == 0)
+            return i;
+    }
+    globals = (GlobalVar *)realloc(globals, (global_count + 1) * sizeof(GlobalVar));
+    globals[global_count].name = op->u.name;
+    globals[global_count].size = info != NULL && info->array_size > 0 ? info->array_size : 0;
+    globals[global_count].offset = 0;
+    return global_count++;
+}
+
+// 变量的帧槽位；全局变量在帧内的槽位只是副本，读取前由 GLOAD 装入，写入后由 GSTORE 写回
+static int variable_slot(Translator *T, Operand *op)
+{
+    int index = operand_table_lookup(&T->cfg->vars, op);
+    if (index < 0)
+    {
+        translation_error(T, "unknown variable");
+        return SLOT_DISCARD;
+    }
+    return SLOT_FIRST_VAR + index;
+}
+
+// 读取变量前装入全局变量的当前值
+static int load_variable(Translator *T, Operand *op)
+{
+    int slot = variable_slot(T, op);
+    int global = global_index(T, op);
+    if (global >= 0)
+        emit_i(I_GLOAD, global, 0, slot);
+    return slot;
+}
+
+// 写入变量后把值写回全局变量
+static void store_variable(Translator *T, Operand *op)
+{
+    int global = global_index(T, op);
+    if (global >= 0)
+        emit_i(I_GSTORE, variable_slot(T, op), 0, global);
+}
+
+// 数组变量的槽位：局部数组首次出现时登记存储，全局数组装入首元素地址
+static int array_slot(Translator *T, Operand *op)
+{
+    int size = op->type == OPERAND_VARIABLE ? array_size(T, op) : 0;
+    if (size <= 0)
+    {
+        if (!T->failed)
+            translation_error(T, "multi-dimensional or unknown array access is not supported");
+        return SLOT_DISCARD;
+    }
+    if (global_index(T, op) >= 0)
+        return load_variable(T, op);
+    int slot = variable_slot(T, op);
+    VariableInfo *info = lookup_variable_info(T->fn->name, op->u.name);
+    if (info->is_param)
+        return slot;
+
+    IFunction *fn = T->fn;
+    for (int i = 0; i < fn->array_count; i++)
+    {
+        if (fn->arrays[i].slot == slot)
+            return slot;
+    }
+    fn->arrays = (LocalArray *)realloc(fn->arrays, (fn->array_count + 1) * sizeof(LocalArray));
+    fn->arrays[fn->array_count].slot = slot;
+    fn->arrays[fn->array_count].size = size;
+    fn->arrays[fn->array_count].offset = 0;
+    fn->array_count++;
+    return slot;
+}
+
+// 常量池中的槽位（相同类型与值的常量共用）
+static int constant_slot(Translator *T, DataType type, int int_value, float float_value)
+{
+    IFunction *fn = T->fn;
+    for (int i = 0; i < fn->constant_count; i++)
+    {
+        if (fn->constant_types[i] != type)
+            continue;
+        if (type == TYPE_FLOAT ? memcmp(&fn->constants[i].f, &float_value, sizeof(float)) == 0
+                               : fn->constants[i].i == int_value)
+            return fn->slot_count + i;
+    }
+    if (fn->constant_count == fn->constant_capacity)
+    {
+        fn->constant_capacity = fn->constant_capacity ? fn->constant_capacity * 2 : 8;
+        fn->constants = (Value *)realloc(fn->constants, fn->constant_capacity * sizeof(Value));
+        fn->constant_types = (DataType *)realloc(fn->constant_types, fn->constant_capacity * sizeof(DataType));
+    }
+    Value *value = &fn->constants[fn->constant_count];
+    memset(value, 0, sizeof(Value));
+    if (type == TYPE_FLOAT)
+        value->f = float_value;
+    else
+        value->i = int_value;
+    fn->constant_types[fn->constant_count] = type;
+    return fn->slot_count + fn->constant_count++;
+}
+
+static DataType value_type(Translator *T, Operand *op)
+{
+    return operand_value_type(T->cfg, T->fn->name, T->types, op);
+}
+
+// 按 type 读取的操作数槽位：常量直接放入对应类型的常量池，类型不同的变量先转换到 scratch
+static int operand_slot(Translator *T, Operand *op, DataType type, int scratch)
+{
+    switch (op->type)
+    {
+    case OPERAND_CONSTANT:
+        return constant_slot(T, type, op->u.int_value, (float)op->u.int_value);
+    case OPERAND_CONSTANT_FLOAT:
+        return constant_slot(T, type, (int)op->u.float_value, op->u.float_value);
+    case OPERAND_VARIABLE:
+    case OPERAND_TEMP:
+    {
+        int slot = load_variable(T, op);
+        DataType have = value_type(T, op);
+        if (have == type)
+            return slot;
+        emit_i(have == TYPE_FLOAT ? I_F2I : I_I2F, slot, 0, scratch);
+        return scratch;
+    }
+    default:
+        translation_error(T, "unsupported operand");
+        return SLOT_DISCARD;
+    }
+}
+
+// 结果写入的槽位：声明类型与值类型不同的变量先写入 SLOT_RESULT，再由 finish_result 转换
+static int result_slot(Translator *T, Operand *x, DataType type, bool *convert)
+{
+    *convert = false;
+    if (x == NULL)
+        return SLOT_DISCARD;
+    int slot = variable_slot(T, x);
+    if (x->type == OPERAND_VARIABLE && declared_variable_type(T->fn->name, x->u.name) != type)
+    {
+        *convert = true;
+        return SLOT_RESULT;
+    }
+    return slot;
+}
+
+static void finish_result(Translator *T, Operand *x, DataType type, bool convert)
+{
+    if (convert)
+        emit_i(type == TYPE_FLOAT ? I_F2I : I_I2F, SLOT_RESULT, 0, variable_slot(T, x));
+    if (x != NULL)
+        store_variable(T, x);
+}
+
+// ========================= 指令翻译 =========================
+
+static DataType common_type(Translator *T, Operand *a, Operand *b)
+{
+    return value_type(T, a) == TYPE_FLOAT || value_type(T, b) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+}
+
+static void translate_binary(Translator *T, Instruction *inst, ICodeOp int_op, ICodeOp float_op)
+{
+    DataType type = common_type(T, inst->arg1, inst->arg2);
+    int a = operand_slot(T, inst->arg1, type, SLOT_SCRATCH_A);
+    int b = operand_slot(T, inst->arg2, type, SLOT_SCRATCH_B);
+    bool convert;
+    int c = result_slot(T, inst->result, type, &convert);
+    emit_i(type == TYPE_FLOAT ? float_op : int_op, a, b, c);
+    finish_result(T, inst->result, type, convert);
+}
+
+// 比较：> 与 >= 交换操作数后用 < 与 <=，结果为整数
+static void translate_relation(Translator *T, OpType rel, Operand *x, Operand *y, int target, bool branch)
+{
+    DataType type = common_type(T, x, y);
+    bool is_float = type == TYPE_FLOAT;
+    ICodeOp op;
+    switch (rel)
+    {
+    case OP_GT:
+    case OP_LT:
+        op = branch ? (is_float ? I_FJLT : I_JLT) : (is_float ? I_FLT : I_LT);
+        break;
+    case OP_GE:
+    case OP_LE:
+        op = branch ? (is_float ? I_FJLE : I_JLE) : (is_float ? I_FLE : I_LE);
+        break;
+    case OP_EQ:
+        op = branch ? (is_float ? I_FJEQ : I_JEQ) : (is_float ? I_FEQ : I_EQ);
+        break;
+    default:
+        op = branch ? (is_float ? I_FJNE : I_JNE) : (is_float ? I_FNE : I_NE);
+        break;
+    }
+    if (rel == OP_GT || rel == OP_GE)
+    {
+        Operand *t = x;
+        x = y;
+        y = t;
+    }
+    int a = operand_slot(T, x, type, SLOT_SCRATCH_A);
+    int b = operand_slot(T, y, type, SLOT_SCRATCH_B);
+    emit_i(op, a, b, target);
+}
+
+static OpType branch_relation(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return OP_GT;
+    case OP_IF_LT:
+        return OP_LT;
+    case OP_IF_GE:
+        return OP_GE;
+    case OP_IF_LE:
+        return OP_LE;
+    case OP_IF_EQ:
+        return OP_EQ;
+    default:
+        return OP_NE;
+    }
+}
+
+static void translate_arg(Translator *T, Instruction *inst)
+{
+    Operand *op = inst->result;
+    PendingArg arg;
+    if (array_size(T, op) != 0)
+    {
+        arg.kind = VALUE_POINTER;
+        arg.code = emit_i(I_ARG, array_slot(T, op), 0, 0);
+    }
+    else
+    {
+        DataType type = value_type(T, op);
+        arg.kind = type == TYPE_FLOAT ? VALUE_FLOAT : VALUE_INT;
+        arg.code = emit_i(I_ARG, operand_slot(T, op, type, SLOT_SCRATCH_A), 0, 0);
+    }
+
+    if (T->arg_count == T->arg_capacity)
+    {
+        T->arg_capacity = T->arg_capacity ? T->arg_capacity * 2 : 8;
+        T->args = (PendingArg *)realloc(T->args, T->arg_capacity * sizeof(PendingArg));
+    }
+    T->args[T->arg_count++] = arg;
+}
+
+static void translate_call(Translator *T, Instruction *inst)
+{
+    const char *name = inst->arg1->u.name;
+    IFunction *callee = find_function(name);
+    if (callee == NULL)
+    {
+        // 程序没有定义越界处理函数时，越界终止执行
+        if (strcmp(name, BOUNDS_CHECK_FAIL_FUNCTION) == 0)
+            emit_i(I_BOUNDS_FAIL, 0, 0, 0);
+        else
+            translation_error(T, "call to undefined function");
+        return;
+    }
+
+    // 被调函数的形参个数决定消耗多少个待传实参，实参按形参种类转换
+    if (callee->param_count > T->arg_count)
+    {
+        translation_error(T, "call has fewer arguments than parameters");
+        return;
+    }
+    PendingArg *args = T->args + (T->arg_count - callee->param_count);
+    for (int i = 0; i < callee->param_count; i++)
+    {
+        if (args[i].kind == VALUE_INT && callee->param_kinds[i] == VALUE_FLOAT)
+            code[args[i].code].op = I_ARG_I2F;
+        else if (args[i].kind == VALUE_FLOAT && callee->param_kinds[i] == VALUE_INT)
+            code[args[i].code].op = I_ARG_F2I;
+    }
+    T->arg_count -= callee->param_count;
+
+    bool convert;
+    int c = result_slot(T, inst->result, callee->return_type, &convert);
+    emit_i(I_CALL, (int)(callee - functions), 0, c);
+    finish_result(T, inst->result, callee->return_type, convert);
+}
+
+static void translate_instruction(Translator *T, Instruction *inst)
+{
+    bool convert;
+    switch (inst->op)
+    {
+    case OP_LABEL:
+        // 标签不产生指令，跳转目标在全部函数翻译之后解析
+        if (inst->result->type == OPERAND_LABEL)
+            label_positions[inst->result->u.temp_no] = code_count;
+        break;
+    case OP_GOTO:
+        emit_i(I_JMP, 0, 0, inst->arg1->u.temp_no);
+        break;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+    {
+        bool is_float = value_type(T, inst->arg1) == TYPE_FLOAT;
+        int a = operand_slot(T, inst->arg1, is_float ? TYPE_FLOAT : TYPE_INT, SLOT_SCRATCH_A);
+        ICodeOp op = inst->op == OP_IF_GOTO ? (is_float ? I_FJNZ : I_JNZ) : (is_float ? I_FJZ : I_JZ);
+        emit_i(op, a, 0, inst->arg2->u.temp_no);
+        break;
+    }
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        translate_relation(T, branch_relation(inst->op), inst->arg1, inst->arg2, inst->result->u.temp_no, true);
+        break;
+    case OP_ASSIGN:
+    {
+        DataType type = inst->result->type == OPERAND_VARIABLE
+                            ? declared_variable_type(T->fn->name, inst->result->u.name)
+                            : value_type(T, inst->arg1);
+        int a = operand_slot(T, inst->arg1, type, SLOT_SCRATCH_A);
+        emit_i(I_MOV, a, 0, variable_slot(T, inst->result));
+        store_variable(T, inst->result);
+        break;
+    }
+    case OP_ADD:
+        translate_binary(T, inst, I_ADD, I_FADD);
+        break;
+    case OP_SUB:
+        translate_binary(T, inst, I_SUB, I_FSUB);
+        break;
+    case OP_MUL:
+        translate_binary(T, inst, I_MUL, I_FMUL);
+        break;
+    case OP_DIV:
+        translate_binary(T, inst, I_DIV, I_FDIV);
+        break;
+    case OP_AND:
+        translate_binary(T, inst, I_AND, I_FAND);
+        break;
+    case OP_OR:
+        translate_binary(T, inst, I_OR, I_FOR);
+        break;
+    case OP_NEG:
+    case OP_NOT:
+    {
+        DataType type = value_type(T, inst->arg1);
+        bool is_float = type == TYPE_FLOAT;
+        ICodeOp op = inst->op == OP_NEG ? (is_float ? I_FNEG : I_NEG) : (is_float ? I_FNOT : I_NOT);
+        DataType result = inst->op == OP_NEG ? type : TYPE_INT;
+        int a = operand_slot(T, inst->arg1, type, SLOT_SCRATCH_A);
+        int c = result_slot(T, inst->result, result, &convert);
+        emit_i(op, a, 0, c);
+        finish_result(T, inst->result, result, convert);
+        break;
+    }
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    {
+        int c = result_slot(T, inst->result, TYPE_INT, &convert);
+        translate_relation(T, inst->op, inst->arg1, inst->arg2, c, false);
+        finish_result(T, inst->result, TYPE_INT, convert);
+        break;
+    }
+    case OP_ARRAY_GET:
+    {
+        int array = array_slot(T, inst->arg1);
+        if (T->failed)
+            break;
+        DataType type = declared_variable_type(T->fn->name, inst->arg1->u.name);
+        int index = operand_slot(T, inst->arg2, TYPE_INT, SLOT_SCRATCH_A);
+        int c = result_slot(T, inst->result, type, &convert);
+        emit_i(I_AGET, array, index, c);
+        finish_result(T, inst->result, type, convert);
+        break;
+    }
+    case OP_ARRAY_SET:
+    {
+        int array = array_slot(T, inst->result);
+        if (T->failed)
+            break;
+        DataType type = declared_variable_type(T->fn->name, inst->result->u.name);
+        int index = operand_slot(T, inst->arg1, TYPE_INT, SLOT_SCRATCH_A);
+        int value = operand_slot(T, inst->arg2, type, SLOT_SCRATCH_B);
+        emit_i(I_ASET, array, index, value);
+        break;
+    }
+    case OP_ARG:
+        translate_arg(T, inst);
+        break;
+    case OP_CALL:
+        translate_call(T, inst);
+        break;
+    case OP_PARAM:
+        // 实参在 CALL 时直接复制到形参槽位
+        if (T->param_index < T->fn->param_count)
+            T->fn->param_slots[T->param_index++] = variable_slot(T, inst->result);
+        break;
+    case OP_RETURN:
+        if (inst->result != NULL)
+            emit_i(I_RET, operand_slot(T, inst->result, T->fn->return_type, SLOT_SCRATCH_A), 0, 0);
+        else
+            emit_i(I_RET_ZERO, 0, 0, 0);
+        break;
+    default:
+        translation_error(T, "unsupported instruction");
+        break;
+    }
+}
+
+static bool translate_function(IFunction *fn)
+{
+    Translator T;
+    memset(&T, 0, sizeof(T));
+    T.fn = fn;
+    T.cfg = build_cfg(fn->def);
+    fn->entry = code_count;
+    fn->slot_count = SLOT_FIRST_VAR + T.cfg->vars.count;
+
+    int count = T.cfg->vars.count + 1;
+    T.types = (signed char *)malloc(count);
+    signed char **block_types = infer_temp_types(T.cfg, fn->name);
+
+    // 基本块按指令顺序排列，逐块翻译，块入口处恢复到达的临时变量类型
+    for (int b = 0; b < T.cfg->block_count && !T.failed; b++)
+    {
+        BasicBlock *block = T.cfg->blocks[b];
+        memcpy(T.types, block_types[b], count);
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            translate_instruction(&T, inst);
+            transfer_temp_types(T.cfg, fn->name, T.types, inst);
+            if (inst == block->last || T.failed)
+                break;
+        }
+    }
+
+    // 函数体可能顺序执行到末尾（末尾的标签也指向这里）
+    emit_i(I_RET_ZERO, 0, 0, 0);
+
+    // 帧布局：槽位、常量池、局部数组
+    int offset = fn->slot_count + fn->constant_count;
+    for (int i = 0; i < fn->array_count; i++)
+    {
+        fn->arrays[i].offset = offset;
+        offset += fn->arrays[i].size + 1;
+    }
+    fn->frame_size = offset;
+
+    free_temp_types(T.cfg, block_types);
+    free(T.types);
+    free(T.args);
+    free_cfg(T.cfg);
+    return !T.failed;
+}
+
+// 收集程序中定义的函数与形参种类
+static void collect_functions()
+{
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            function_count++;
+    }
+    functions = (IFunction *)calloc(function_count + 1, sizeof(IFunction));
+
+    int index = 0;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+        IFunction *fn = &functions[index++];
+        fn->name = inst->result->u.name;
+        fn->def = inst;
+        fn->return_type = lookup_function_type(fn->name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+        for (Instruction *p = inst->next; p != NULL && p->op == OP_PARAM; p = p->next)
+            fn->param_count++;
+        fn->param_kinds = (ValueKind *)malloc((fn->param_count + 1) * sizeof(ValueKind));
+        fn->param_slots = (int *)malloc((fn->param_count + 1) * sizeof(int));
+        int k = 0;
+        for (Instruction *p = inst->next; p != NULL && p->op == OP_PARAM; p = p->next, k++)
+        {
+            VariableInfo *info = lookup_variable_info(fn->name, p->result->u.name);
+            if (info != NULL && info->array_size != 0)
+                fn->param_kinds[k] = VALUE_POINTER;
+            else
+                fn->param_kinds[k] = declared_variable_type(fn->name, p->result->u.name) == TYPE_FLOAT
+                                         ? VALUE_FLOAT
+                                         : VALUE_INT;
+            fn->param_slots[k] = -1;
+        }
+    }
+}
+
+static bool is_jump(ICodeOp op)
+{
+    return op >= I_JMP && op <= I_FJNE;
+}
+
+// 跳转目标从标签编号解析为指令下标
+static bool resolve_labels()
+{
+    for (int i = 0; i < code_count; i++)
+    {
+        if (!is_jump(code[i].op))
+            continue;
+        int label = code[i].c;
+        if (label < 0 || label > label_count || label_positions[label] < 0)
+        {
+            fprintf(stderr, "Error: interpreter: undefined label L%d\n", label);
+            return false;
+        }
+        code[i].c = label_positions[label];
+    }
+    return true;
+}
+
+static void free_program()
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        free(functions[i].param_kinds);
+        free(functions[i].param_slots);
+        free(functions[i].constants);
+        free(functions[i].constant_types);
+        free(functions[i].arrays);
+    }
+    free(functions);
+    functions = NULL;
+    function_count = 0;
+    free(globals);
+    globals = NULL;
+    global_count = 0;
+    free(label_positions);
+    label_positions = NULL;
+    free(code);
+    code = NULL;
+    code_count = 0;
+    code_capacity = 0;
+}
+
+// ========================= 执行 =========================
+
+// 进入函数：清零帧，复制常量池与实参，建立局部数组
+static inline void enter_function(IFunction *fn, Value *fp, Value *args)
+{
+    memset(fp, 0, fn->frame_size * sizeof(Value));
+    if (fn->constant_count > 0)
+        memcpy(fp + fn->slot_count, fn->constants, fn->constant_count * sizeof(Value));
+    for (int i = 0; i < fn->param_count; i++)
+    {
+        if (fn->param_slots[i] >= 0)
+            fp[fn->param_slots[i]] = args[i];
+    }
+    for (int i = 0; i < fn->array_count; i++)
+    {
+        Value *storage = fp + fn->arrays[i].offset;
+        storage[0].i = fn->arrays[i].size;
+        fp[fn->arrays[i].slot].p = storage + 1;
+    }
+}
+
+// 全局变量存储：变量槽位之后是各全局数组（每个数组前有一个存放长度的槽位）
+static Value *create_global_storage()
+{
+    int offset = global_count;
+    for (int i = 0; i < global_count; i++)
+    {
+        globals[i].offset = offset;
+        if (globals[i].size > 0)
+            offset += globals[i].size + 1;
+    }
+    Value *storage = (Value *)calloc(offset + 1, sizeof(Value));
+    for (int i = 0; i < global_count; i++)
+    {
+        if (globals[i].size == 0)
+            continue;
+        storage[globals[i].offset].i = globals[i].size;
+        storage[i].p = storage + globals[i].offset + 1;
+    }
+    return storage;
+}
+
+#if INTERP_THREADED
+#define CASE(name) L_##name:
+#define NEXT()                \
+    do                        \
+    {                         \
+        steps++;              \
+        goto *pc->handler;    \
+    } while (0)
+#else
+#define CASE(name) case name:
+#define NEXT()                \
+    do                        \
+    {                         \
+        steps++;              \
+        goto dispatch;        \
+    } while (0)
+#endif
+
+#define RUNTIME_ERROR(message) \
+    do                         \
+    {                          \
+        error = message;       \
+        goto fail;             \
+    } while (0)
+
+// 整数运算按补码回绕，与生成的机器代码一致
+#define WRAP(expr) ((int)(unsigned int)(expr))
+
+static bool execute(IFunction *main_fn, InterpResult *result)
+{
+#if INTERP_THREADED
+#define OPCODE_LABEL(name) &&L_##name,
+    static const void *const handlers[] = {INTERP_OPCODES(OPCODE_LABEL)};
+    for (int i = 0; i < code_count; i++)
+        code[i].handler = handlers[code[i].op];
+#endif
+
+    Value *stack = (Value *)malloc(INTERP_STACK_SIZE * sizeof(Value));
+    Value *stack_end = stack + INTERP_STACK_SIZE;
+    CallFrame *calls = (CallFrame *)malloc(INTERP_MAX_CALL_DEPTH * sizeof(CallFrame));
+    Value *args = (Value *)malloc(INTERP_MAX_ARGS * sizeof(Value));
+    Value *global_values = create_global_storage();
+    int depth = 0;
+    int arg_top = 0;
+    long long steps = 0;
+    const char *error = NULL;
+    bool ok = false;
+    Value ret;
+
+    IFunction *fn = main_fn;
+    Value *fp = stack;
+    Value *sp = fp + fn->frame_size;
+    if (sp > stack_end)
+        RUNTIME_ERROR("stack overflow");
+    enter_function(fn, fp, args);
+    ICode *pc = code + fn->entry;
+
+#if INTERP_THREADED
+    NEXT();
+#else
+dispatch:
+    switch (pc->op)
+    {
+#endif
+    CASE(I_MOV)
+    {
+        fp[pc->c] = fp[pc->a];
+        pc++;
+        NEXT();
+    }
+    CASE(I_I2F)
+    {
+        fp[pc->c].f = (float)fp[pc->a].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_F2I)
+    {
+        fp[pc->c].i = (int)fp[pc->a].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_ADD)
+    {
+        fp[pc->c].i = WRAP((unsigned int)fp[pc->a].i + (unsigned int)fp[pc->b].i);
+        pc++;
+        NEXT();
+    }
+    CASE(I_SUB)
+    {
+        fp[pc->c].i = WRAP((unsigned int)fp[pc->a].i - (unsigned int)fp[pc->b].i);
+        pc++;
+        NEXT();
+    }
+    CASE(I_MUL)
+    {
+        fp[pc->c].i = WRAP((unsigned int)fp[pc->a].i * (unsigned int)fp[pc->b].i);
+        pc++;
+        NEXT();
+    }
+    CASE(I_DIV)
+    {
+        int x = fp[pc->a].i;
+        int y = fp[pc->b].i;
+        if (y == 0)
+            RUNTIME_ERROR("integer division by zero");
+        if (y == -1 && x == INT_MIN)
+            RUNTIME_ERROR("integer overflow in division");
+        fp[pc->c].i = x / y;
+        pc++;
+        NEXT();
+    }
+    CASE(I_NEG)
+    {
+        fp[pc->c].i = WRAP(0u - (unsigned int)fp[pc->a].i);
+        pc++;
+        NEXT();
+    }
+    CASE(I_FADD)
+    {
+        fp[pc->c].f = fp[pc->a].f + fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FSUB)
+    {
+        fp[pc->c].f = fp[pc->a].f - fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FMUL)
+    {
+        fp[pc->c].f = fp[pc->a].f * fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FDIV)
+    {
+        fp[pc->c].f = fp[pc->a].f / fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FNEG)
+    {
+        fp[pc->c].f = -fp[pc->a].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_LT)
+    {
+        fp[pc->c].i = fp[pc->a].i < fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_LE)
+    {
+        fp[pc->c].i = fp[pc->a].i <= fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_EQ)
+    {
+        fp[pc->c].i = fp[pc->a].i == fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_NE)
+    {
+        fp[pc->c].i = fp[pc->a].i != fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FLT)
+    {
+        fp[pc->c].i = fp[pc->a].f < fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FLE)
+    {
+        fp[pc->c].i = fp[pc->a].f <= fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FEQ)
+    {
+        fp[pc->c].i = fp[pc->a].f == fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FNE)
+    {
+        fp[pc->c].i = fp[pc->a].f != fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_NOT)
+    {
+        fp[pc->c].i = !fp[pc->a].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_AND)
+    {
+        fp[pc->c].i = fp[pc->a].i && fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_OR)
+    {
+        fp[pc->c].i = fp[pc->a].i || fp[pc->b].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FNOT)
+    {
+        fp[pc->c].i = !fp[pc->a].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FAND)
+    {
+        fp[pc->c].i = fp[pc->a].f && fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_FOR)
+    {
+        fp[pc->c].i = fp[pc->a].f || fp[pc->b].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_JMP)
+    {
+        pc = code + pc->c;
+        NEXT();
+    }
+    CASE(I_JNZ)
+    {
+        pc = fp[pc->a].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_JZ)
+    {
+        pc = !fp[pc->a].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJNZ)
+    {
+        pc = fp[pc->a].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJZ)
+    {
+        pc = !fp[pc->a].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_JLT)
+    {
+        pc = fp[pc->a].i < fp[pc->b].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_JLE)
+    {
+        pc = fp[pc->a].i <= fp[pc->b].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_JEQ)
+    {
+        pc = fp[pc->a].i == fp[pc->b].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_JNE)
+    {
+        pc = fp[pc->a].i != fp[pc->b].i ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJLT)
+    {
+        pc = fp[pc->a].f < fp[pc->b].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJLE)
+    {
+        pc = fp[pc->a].f <= fp[pc->b].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJEQ)
+    {
+        pc = fp[pc->a].f == fp[pc->b].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_FJNE)
+    {
+        pc = fp[pc->a].f != fp[pc->b].f ? code + pc->c : pc + 1;
+        NEXT();
+    }
+    CASE(I_AGET)
+    {
+        Value *base = fp[pc->a].p;
+        int index = fp[pc->b].i;
+        if ((unsigned int)index >= (unsigned int)base[-1].i)
+            RUNTIME_ERROR("array index out of bounds");
+        fp[pc->c] = base[index];
+        pc++;
+        NEXT();
+    }
+    CASE(I_ASET)
+    {
+        Value *base = fp[pc->a].p;
+        int index = fp[pc->b].i;
+        if ((unsigned int)index >= (unsigned int)base[-1].i)
+            RUNTIME_ERROR("array index out of bounds");
+        base[index] = fp[pc->c];
+        pc++;
+        NEXT();
+    }
+    CASE(I_GLOAD)
+    {
+        fp[pc->c] = global_values[pc->a];
+        pc++;
+        NEXT();
+    }
+    CASE(I_GSTORE)
+    {
+        global_values[pc->c] = fp[pc->a];
+        pc++;
+        NEXT();
+    }
+    CASE(I_ARG)
+    {
+        if (arg_top == INTERP_MAX_ARGS)
+            RUNTIME_ERROR("too many pending arguments");
+        args[arg_top++] = fp[pc->a];
+        pc++;
+        NEXT();
+    }
+    CASE(I_ARG_I2F)
+    {
+        if (arg_top == INTERP_MAX_ARGS)
+            RUNTIME_ERROR("too many pending arguments");
+        args[arg_top++].f = (float)fp[pc->a].i;
+        pc++;
+        NEXT();
+    }
+    CASE(I_ARG_F2I)
+    {
+        if (arg_top == INTERP_MAX_ARGS)
+            RUNTIME_ERROR("too many pending arguments");
+        args[arg_top++].i = (int)fp[pc->a].f;
+        pc++;
+        NEXT();
+    }
+    CASE(I_CALL)
+    {
+        IFunction *callee = &functions[pc->a];
+        if (depth == INTERP_MAX_CALL_DEPTH || callee->frame_size > stack_end - sp)
+            RUNTIME_ERROR("stack overflow");
+        CallFrame *frame = &calls[depth++];
+        frame->function = fn;
+        frame->fp = fp;
+        frame->return_pc = pc + 1;
+        frame->result_slot = pc->c;
+        arg_top -= callee->param_count;
+        fp = sp;
+        sp = fp + callee->frame_size;
+        enter_function(callee, fp, args + arg_top);
+        fn = callee;
+        pc = code + callee->entry;
+        NEXT();
+    }
+    CASE(I_RET)
+    {
+        ret = fp[pc->a];
+        goto do_return;
+    }
+    CASE(I_RET_ZERO)
+    {
+        memset(&ret, 0, sizeof(ret));
+        goto do_return;
+    }
+    CASE(I_BOUNDS_FAIL)
+    {
+        RUNTIME_ERROR("array index out of bounds (" BOUNDS_CHECK_FAIL_FUNCTION ")");
+    }
+#if !INTERP_THREADED
+    default:
+        RUNTIME_ERROR("invalid instruction");
+    }
+#endif
+
+do_return:
+    sp = fp;
+    if (depth > 0)
+    {
+        CallFrame *frame = &calls[--depth];
+        fn = frame->function;
+        fp = frame->fp;
+        fp[frame->result_slot] = ret;
+        pc = frame->return_pc;
+        NEXT();
+    }
+    result->return_value = main_fn->return_type == TYPE_FLOAT ? (int)ret.f : ret.i;
+    result->step_count = steps;
+    ok = true;
+    goto done;
+
+fail:
+    fprintf(stderr, "Runtime error: %s in function %s\n", error, fn->name);
+done:
+    free(stack);
+    free(calls);
+    free(args);
+    free(global_values);
+    return ok;
+}
+
+#undef CASE
+#undef NEXT
+#undef RUNTIME_ERROR
+
+bool run_program(InterpResult *result)
+{
+    memset(result, 0, sizeof(InterpResult));
+    purge_dead_markers();
+    collect_functions();
+
+    label_positions = (int *)malloc((label_count + 1) * sizeof(int));
+    for (int i = 0; i <= label_count; i++)
+        label_positions[i] = -1;
+
+    bool ok = true;
+    for (int i = 0; i < function_count && ok; i++)
+        ok = translate_function(&functions[i]);
+    if (ok)
+        ok = resolve_labels();
+
+    IFunction *main_fn = find_function("main");
+    if (ok && (main_fn == NULL || main_fn->param_count > 0))
+    {
+        fprintf(stderr, "Error: interpreter: no main function without parameters\n");
+        ok = false;
+    }
+    if (ok)
+    {
+        clock_t start = clock();
+        ok = execute(main_fn, result);
+        result->elapsed_ms = 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+    free_program();
+    return ok;
+}
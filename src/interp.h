@@ -0,0 +1,19 @@
+#ifndef INTERP_H
+#define INTERP_H
+
+#include "codegen.h"
+
+// 解释执行的结果
+typedef struct InterpResult
+{
+    int return_value;        // main 的返回值
+    long long step_count;    // 执行的解释器指令条数
+    double elapsed_ms;       // 执行耗时（不含翻译）
+} InterpResult;
+
+// 从 main 开始直接执行内存中的三地址代码。执行前把标签解析为指令下标、变量与临时变量映射到
+// 稠密的帧槽位，并按推断的类型选用整数或浮点专用的解释器指令；执行时用计算 goto 线索化分派。
+// 不支持的构造（多维数组）与运行时错误（除零、数组越界、栈溢出）报错并返回false
+bool run_program(InterpResult *result);
+
+#endif
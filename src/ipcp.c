@@ -0,0 +1,459 @@
+#include "ipcp.h"
+#include "cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 特化的最小增长预算（指令数），避免小程序按比例算出的预算过小
+#define SPECIALIZE_MIN_BUDGET 64
+
+// 每个函数最多的特化版本数
+#define SPECIALIZE_MAX_CLONES 4
+
+// 特化版本编号，用于生成函数名
+static int specialization_site_count = 0;
+
+// ========================= 辅助函数 =========================
+
+static bool is_constant(Operand *op)
+{
+    return op != NULL && (op->type == OPERAND_CONSTANT || op->type == OPERAND_CONSTANT_FLOAT);
+}
+
+// 根函数可能被外部调用，形参不能假定
+static bool is_root_function(const char *name)
+{
+    if (strcmp(name, "main") == 0)
+        return true;
+    for (int i = 0; i < opt_options.function_root_count; i++)
+    {
+        if (strcmp(opt_options.function_roots[i], name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// 形参在函数体内是否被重新赋值
+static bool param_assigned(Instruction *func_def, Operand *param)
+{
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op != OP_PARAM && operands_equal(instruction_def(inst), param))
+            return true;
+    }
+    return false;
+}
+
+// 把函数体中对变量var的使用替换为value
+static void replace_variable_uses(Instruction *func_def, Operand *var, Operand *value)
+{
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_PARAM)
+            continue;
+        if (operands_equal(inst->arg1, var))
+        {
+            free_operand(inst->arg1);
+            inst->arg1 = copy_operand(value);
+        }
+        if (operands_equal(inst->arg2, var))
+        {
+            free_operand(inst->arg2);
+            inst->arg2 = copy_operand(value);
+        }
+        if ((inst->op == OP_ARG || inst->op == OP_RETURN) && operands_equal(inst->result, var))
+        {
+            free_operand(inst->result);
+            inst->result = copy_operand(value);
+        }
+    }
+}
+
+// 把形参绑定为常量并删除对应的 PARAM：形参未被重新赋值时直接替换所有使用，
+// 否则在入口处赋初值
+static void bind_param_constant(Instruction *func_def, Instruction *param_inst, Operand *value)
+{
+    Operand *param = param_inst->result;
+    if (param_assigned(func_def, param))
+    {
+        Instruction *pos = func_def;
+        while (pos->next->op == OP_PARAM)
+            pos = pos->next;
+        insert_instruction_after(pos, new_instruction(OP_ASSIGN, copy_operand(param), copy_operand(value), NULL));
+    }
+    else
+    {
+        replace_variable_uses(func_def, param, value);
+    }
+
+    unlink_instruction(find_prev_instruction(func_def, param_inst), param_inst);
+    free_instruction(param_inst);
+}
+
+// 按形参顺序绑定常量（constants[i]为NULL的形参保留）
+static void bind_param_constants(Instruction *func_def, Operand **constants, int param_count)
+{
+    Instruction **params = (Instruction **)malloc((param_count + 1) * sizeof(Instruction *));
+    Instruction *inst = func_def->next;
+    for (int i = 0; i < param_count; i++, inst = inst->next)
+        params[i] = inst;
+
+    for (int i = 0; i < param_count; i++)
+    {
+        if (constants[i] != NULL)
+            bind_param_constant(func_def, params[i], constants[i]);
+    }
+    free(params);
+}
+
+// 删除调用点上已绑定为常量的实参
+static void remove_constant_args(Instruction *caller_def, CallSite *site, Operand **constants)
+{
+    for (int i = 0; i < site->arg_count; i++)
+    {
+        if (constants[i] == NULL)
+            continue;
+        unlink_instruction(find_prev_instruction(caller_def, site->args[i]), site->args[i]);
+        free_instruction(site->args[i]);
+        site->args[i] = NULL;
+    }
+}
+
+// ========================= 过程间常量传播 =========================
+
+int interprocedural_constant_propagation()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    CallGraph *graph = build_call_graph();
+    CallSite *sites = NULL;
+    int site_count = collect_call_sites(graph, &sites);
+
+    for (int f = 0; f < graph->node_count; f++)
+    {
+        CallGraphNode *node = &graph->nodes[f];
+        if (node->param_count == 0 || node->call_site_count == 0 || is_root_function(node->name))
+            continue;
+
+        // 所有调用点都必须能匹配到实参
+        int matched = 0;
+        for (int s = 0; s < site_count; s++)
+        {
+            if (sites[s].callee == f)
+                matched++;
+        }
+        if (matched != node->call_site_count)
+            continue;
+
+        Operand **constants = (Operand **)calloc(node->param_count + 1, sizeof(Operand *));
+        int bound = 0;
+        Instruction *param_inst = node->func_def->next;
+        for (int i = 0; i < node->param_count; i++, param_inst = param_inst->next)
+        {
+            bool passthrough_ok = !param_assigned(node->func_def, param_inst->result);
+            Operand *value = NULL;
+            bool ok = true;
+            for (int s = 0; s < site_count && ok; s++)
+            {
+                if (sites[s].callee != f)
+                    continue;
+                Operand *arg = sites[s].args[i]->result;
+
+                // 递归调用原样传递未被修改的形参
+                if (sites[s].caller == f && passthrough_ok && operands_equal(arg, param_inst->result))
+                    continue;
+                if (!is_constant(arg) || (value != NULL && !operands_equal(value, arg)))
+                    ok = false;
+                value = arg;
+            }
+            if (ok && value != NULL)
+            {
+                constants[i] = copy_operand(value);
+                bound++;
+            }
+        }
+
+        if (bound > 0)
+        {
+            for (int s = 0; s < site_count; s++)
+            {
+                if (sites[s].callee == f)
+                    remove_constant_args(graph->nodes[sites[s].caller].func_def, &sites[s], constants);
+            }
+            bind_param_constants(node->func_def, constants, node->param_count);
+            total += bound;
+        }
+
+        for (int i = 0; i < node->param_count; i++)
+            free_operand(constants[i]);
+        free(constants);
+    }
+
+    free_call_sites(sites, site_count);
+    free_call_graph(graph);
+
+    opt_stats.ipcp_count += total;
+    return total;
+}
+
+// ========================= 函数特化 =========================
+
+// 一个特化版本
+typedef struct Specialization
+{
+    int callee;
+    Operand **constants; // 按形参顺序，NULL表示该形参未特化
+    char *name;
+} Specialization;
+
+// 调用点所在的循环嵌套深度（不在循环中为0）
+static int call_loop_depth(Instruction *caller_def, Instruction *call)
+{
+    CFG *cfg = build_cfg(caller_def);
+    compute_dominators(cfg);
+    Loop **loops = NULL;
+    int loop_count = find_natural_loops(cfg, &loops);
+
+    int depth = 0;
+    for (int i = 0; i < loop_count; i++)
+    {
+        if (loops[i]->depth <= depth)
+            continue;
+        for (int b = 0; b < loops[i]->block_count; b++)
+        {
+            BasicBlock *block = loops[i]->blocks[b];
+            for (Instruction *inst = block->first;; inst = inst->next)
+            {
+                if (inst == call)
+                    depth = loops[i]->depth;
+                if (inst == block->last)
+                    break;
+            }
+        }
+    }
+
+    free_loops(loops, loop_count);
+    free_cfg(cfg);
+    return depth;
+}
+
+static Operand *clone_operand(Operand *op, Operand **temp_map, int temp_limit, Operand **label_map, int label_limit)
+{
+    if (op != NULL && op->type == OPERAND_TEMP && op->u.temp_no < temp_limit)
+    {
+        if (temp_map[op->u.temp_no] == NULL)
+            temp_map[op->u.temp_no] = new_operand_temp();
+        return copy_operand(temp_map[op->u.temp_no]);
+    }
+    if (op != NULL && op->type == OPERAND_LABEL && op->u.temp_no < label_limit)
+    {
+        if (label_map[op->u.temp_no] == NULL)
+            label_map[op->u.temp_no] = new_operand_label();
+        return copy_operand(label_map[op->u.temp_no]);
+    }
+    return copy_operand(op);
+}
+
+// 在原函数之后克隆出名为name的版本（临时变量和标签重新编号），并绑定常量形参
+static void clone_function(Instruction *func_def, const char *name, Operand **constants, int param_count)
+{
+    int temp_limit = temp_count + 1;
+    int label_limit = label_count + 1;
+    Operand **temp_map = (Operand **)calloc(temp_limit, sizeof(Operand *));
+    Operand **label_map = (Operand **)calloc(label_limit, sizeof(Operand *));
+
+    Instruction *end = func_def;
+    while (end->op != OP_FUNC_END)
+        end = end->next;
+
+    Instruction *pos = end;
+    Instruction *clone_def = NULL;
+    for (Instruction *inst = func_def;; inst = inst->next)
+    {
+        Instruction *copy;
+        if (inst->op == OP_FUNC_DEF || inst->op == OP_FUNC_END)
+        {
+            copy = new_instruction(inst->op, new_operand_function(name), NULL, NULL);
+        }
+        else
+        {
+            copy = new_instruction(inst->op,
+                                   clone_operand(inst->result, temp_map, temp_limit, label_map, label_limit),
+                                   clone_operand(inst->arg1, temp_map, temp_limit, label_map, label_limit),
+                                   clone_operand(inst->arg2, temp_map, temp_limit, label_map, label_limit));
+        }
+        insert_instruction_after(pos, copy);
+        pos = copy;
+        if (clone_def == NULL)
+            clone_def = copy;
+        if (inst == end)
+            break;
+    }
+
+    bind_param_constants(clone_def, constants, param_count);
+    copy_function_variables(func_def->result->u.name, name);
+
+    for (int i = 0; i < temp_limit; i++)
+        free_operand(temp_map[i]);
+    for (int i = 0; i < label_limit; i++)
+        free_operand(label_map[i]);
+    free(temp_map);
+    free(label_map);
+}
+
+// 候选调用点
+typedef struct SpecializeCandidate
+{
+    int site;
+    int depth;           // 所在循环深度
+    int constant_count;  // 常量实参个数
+} SpecializeCandidate;
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const SpecializeCandidate *x = (const SpecializeCandidate *)a;
+    const SpecializeCandidate *y = (const SpecializeCandidate *)b;
+    if (x->depth != y->depth)
+        return y->depth - x->depth;
+    if (x->constant_count != y->constant_count)
+        return y->constant_count - x->constant_count;
+    return x->site - y->site;
+}
+
+static bool same_constants(Operand **a, Operand **b, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if ((a[i] == NULL) != (b[i] == NULL))
+            return false;
+        if (a[i] != NULL && !operands_equal(a[i], b[i]))
+            return false;
+    }
+    return true;
+}
+
+int specialize_functions()
+{
+    if (opt_options.specialize_budget <= 0)
+        return 0;
+
+    purge_dead_markers();
+    CallGraph *graph = build_call_graph();
+    CallSite *sites = NULL;
+    int site_count = collect_call_sites(graph, &sites);
+
+    int program_size = 0;
+    for (int f = 0; f < graph->node_count; f++)
+        program_size += function_size(graph->nodes[f].func_def);
+    int budget = program_size * opt_options.specialize_budget / 100;
+    if (budget < SPECIALIZE_MIN_BUDGET)
+        budget = SPECIALIZE_MIN_BUDGET;
+
+    // 只考虑循环内、带常量实参、被调函数不在调用环中的调用点；越深越优先
+    SpecializeCandidate *candidates = (SpecializeCandidate *)malloc((site_count + 1) * sizeof(SpecializeCandidate));
+    int candidate_count = 0;
+    for (int s = 0; s < site_count; s++)
+    {
+        CallGraphNode *callee = &graph->nodes[sites[s].callee];
+        if (callee->recursive || sites[s].callee == sites[s].caller)
+            continue;
+
+        int constant_count = 0;
+        for (int i = 0; i < sites[s].arg_count; i++)
+        {
+            if (is_constant(sites[s].args[i]->result))
+                constant_count++;
+        }
+        if (constant_count == 0)
+            continue;
+
+        int depth = call_loop_depth(graph->nodes[sites[s].caller].func_def, sites[s].call);
+        if (depth == 0)
+            continue;
+
+        candidates[candidate_count].site = s;
+        candidates[candidate_count].depth = depth;
+        candidates[candidate_count].constant_count = constant_count;
+        candidate_count++;
+    }
+    qsort(candidates, candidate_count, sizeof(SpecializeCandidate), compare_candidates);
+
+    Specialization *specs = (Specialization *)malloc((candidate_count + 1) * sizeof(Specialization));
+    int spec_count = 0;
+    int *clones_per_function = (int *)calloc(graph->node_count + 1, sizeof(int));
+    int growth = 0;
+    int created = 0;
+
+    for (int c = 0; c < candidate_count; c++)
+    {
+        CallSite *site = &sites[candidates[c].site];
+        CallGraphNode *callee = &graph->nodes[site->callee];
+
+        Operand **constants = (Operand **)calloc(site->arg_count + 1, sizeof(Operand *));
+        for (int i = 0; i < site->arg_count; i++)
+        {
+            if (is_constant(site->args[i]->result))
+                constants[i] = copy_operand(site->args[i]->result);
+        }
+
+        // 相同常量组合复用已有的特化版本
+        Specialization *spec = NULL;
+        for (int k = 0; k < spec_count && spec == NULL; k++)
+        {
+            if (specs[k].callee == site->callee && same_constants(specs[k].constants, constants, site->arg_count))
+                spec = &specs[k];
+        }
+
+        if (spec == NULL)
+        {
+            int size = function_size(callee->func_def);
+            if (growth + size > budget || clones_per_function[site->callee] >= SPECIALIZE_MAX_CLONES)
+            {
+                for (int i = 0; i < site->arg_count; i++)
+                    free_operand(constants[i]);
+                free(constants);
+                continue;
+            }
+
+            char name[256];
+            snprintf(name, sizeof(name), "%s__spec%d", callee->name, ++specialization_site_count);
+            clone_function(callee->func_def, name, constants, site->arg_count);
+
+            spec = &specs[spec_count++];
+            spec->callee = site->callee;
+            spec->constants = constants;
+            spec->name = strdup(name);
+            growth += size;
+            clones_per_function[site->callee]++;
+            created++;
+        }
+        else
+        {
+            for (int i = 0; i < site->arg_count; i++)
+                free_operand(constants[i]);
+            free(constants);
+        }
+
+        // 调用点改为调用特化版本，并删除已绑定的实参
+        remove_constant_args(graph->nodes[site->caller].func_def, site, spec->constants);
+        free_operand(site->call->arg1);
+        site->call->arg1 = new_operand_function(spec->name);
+    }
+
+    for (int k = 0; k < spec_count; k++)
+    {
+        for (int i = 0; i < graph->nodes[specs[k].callee].param_count; i++)
+            free_operand(specs[k].constants[i]);
+        free(specs[k].constants);
+        free(specs[k].name);
+    }
+    free(specs);
+    free(clones_per_function);
+    free(candidates);
+    free_call_sites(sites, site_count);
+    free_call_graph(graph);
+
+    opt_stats.specialization_count += created;
+    return created;
+}
@@ -0,0 +1,12 @@
+#ifndef IPCP_H
+#define IPCP_H
+
+#include "callgraph.h"
+
+// 过程间常量传播：所有调用点传入同一常量的形参直接绑定为该常量
+int interprocedural_constant_propagation();
+
+// 函数特化：循环内带常量实参的调用点改为调用按这些常量克隆出的版本
+int specialize_functions();
+
+#endif
@@ -0,0 +1,323 @@
+#include "isel.h"
+#include <stdlib.h>
+
+// 代价上限：无法推导
+#define ISEL_INFINITE 0x3fffffff
+
+// x86-64 的树模式规则表。代价为生成的机器指令条数，地址计算合并进使用它的 lea 或内存操作数，
+// 不计代价。链规则（IN_CHAIN）把一个非终结符转换为另一个
+static const IselRule x86_rules[] = {
+    // 叶子
+    {NT_IMM, IN_CONST, {NT_STMT, NT_STMT}, false, PRED_NONE, 0, ACT_IMM},
+    {NT_REG, IN_REG, {NT_STMT, NT_STMT}, false, PRED_NONE, 0, ACT_LEAF},
+    {NT_MEM, IN_GLOBAL, {NT_STMT, NT_STMT}, false, PRED_NONE, 0, ACT_GLOBAL},
+    // 数组元素：常量下标并入偏移，否则符号扩展为64位变址
+    {NT_MEM, IN_ELEM, {NT_IMM, NT_STMT}, false, PRED_NONE, 0, ACT_ELEM},
+    {NT_MEM, IN_ELEM, {NT_REG, NT_STMT}, false, PRED_NONE, 1, ACT_ELEM},
+
+    // 链规则
+    {NT_REG, IN_CHAIN, {NT_MEM, NT_STMT}, false, PRED_NONE, 1, ACT_LOAD},
+    {NT_REG, IN_CHAIN, {NT_IMM, NT_STMT}, false, PRED_NONE, 1, ACT_LOAD},
+    {NT_REG, IN_CHAIN, {NT_ADDR, NT_STMT}, false, PRED_NONE, 1, ACT_LEA},
+    {NT_REG, IN_CHAIN, {NT_COND, NT_STMT}, false, PRED_NONE, 2, ACT_SETCC},
+    {NT_RMI, IN_CHAIN, {NT_REG, NT_STMT}, false, PRED_NONE, 0, ACT_PASS},
+    {NT_RMI, IN_CHAIN, {NT_MEM, NT_STMT}, false, PRED_NONE, 0, ACT_PASS},
+    {NT_RMI, IN_CHAIN, {NT_IMM, NT_STMT}, false, PRED_NONE, 0, ACT_PASS},
+
+    // 双操作数运算：mov + op
+    {NT_REG, IN_ADD, {NT_RMI, NT_RMI}, false, PRED_NONE, 2, ACT_BINARY},
+    {NT_REG, IN_SUB, {NT_RMI, NT_RMI}, false, PRED_NONE, 2, ACT_BINARY},
+    {NT_REG, IN_MUL, {NT_RMI, NT_RMI}, false, PRED_NONE, 2, ACT_BINARY},
+
+    // 地址模式：base + index * scale + disp
+    {NT_INDEX, IN_MUL, {NT_REG, NT_IMM}, false, PRED_SCALE, 0, ACT_INDEX},
+    {NT_INDEX, IN_MUL, {NT_REG, NT_IMM}, true, PRED_SCALE, 0, ACT_INDEX},
+    {NT_ADDR, IN_ADD, {NT_REG, NT_REG}, false, PRED_INT, 0, ACT_ADDR_BASE},
+    {NT_ADDR, IN_ADD, {NT_REG, NT_INDEX}, false, PRED_INT, 0, ACT_ADDR_BASE},
+    {NT_ADDR, IN_ADD, {NT_REG, NT_INDEX}, true, PRED_INT, 0, ACT_ADDR_BASE},
+    {NT_ADDR, IN_ADD, {NT_REG, NT_IMM}, false, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_ADD, {NT_REG, NT_IMM}, true, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_ADD, {NT_ADDR, NT_IMM}, false, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_ADD, {NT_ADDR, NT_IMM}, true, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_SUB, {NT_REG, NT_IMM}, false, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_SUB, {NT_ADDR, NT_IMM}, false, PRED_INT, 0, ACT_ADDR_DISP},
+    {NT_ADDR, IN_MUL, {NT_REG, NT_IMM}, false, PRED_LEA_MUL, 0, ACT_ADDR_MUL},
+    {NT_ADDR, IN_MUL, {NT_REG, NT_IMM}, true, PRED_LEA_MUL, 0, ACT_ADDR_MUL},
+
+    // 比较：cmp 的目的操作数不能是立即数；浮点比较不交换两边，保持无序时的结果
+    {NT_COND, IN_CMP, {NT_REG, NT_RMI}, false, PRED_NONE, 1, ACT_COMPARE},
+    {NT_COND, IN_CMP, {NT_REG, NT_RMI}, true, PRED_INT, 1, ACT_COMPARE},
+    {NT_COND, IN_CMP, {NT_MEM, NT_IMM}, false, PRED_INT, 1, ACT_COMPARE},
+    {NT_COND, IN_CMP, {NT_MEM, NT_IMM}, true, PRED_INT, 1, ACT_COMPARE},
+
+    // 语句
+    {NT_STMT, IN_BRANCH, {NT_COND, NT_STMT}, false, PRED_NONE, 1, ACT_BRANCH_COND},
+    {NT_STMT, IN_BRANCH, {NT_REG, NT_STMT}, false, PRED_INT, 2, ACT_BRANCH_TEST},
+    {NT_STMT, IN_BRANCH, {NT_MEM, NT_STMT}, false, PRED_INT, 2, ACT_BRANCH_TEST},
+    {NT_STMT, IN_STORE, {NT_MEM, NT_REG}, false, PRED_NONE, 1, ACT_STORE},
+    {NT_STMT, IN_STORE, {NT_MEM, NT_IMM}, false, PRED_INT, 1, ACT_STORE},
+};
+
+#define X86_RULE_COUNT ((int)(sizeof(x86_rules) / sizeof(x86_rules[0])))
+
+// ========================= 折叠分析 =========================
+
+// 定值可以推迟的运算：无副作用，只写临时变量
+static bool is_foldable_def(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_ARRAY_GET:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        return inst->result != NULL && inst->result->type == OPERAND_TEMP;
+    default:
+        return false;
+    }
+}
+
+// 能把操作数展开为子树的使用者
+static bool is_folding_user(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_ARRAY_GET:
+    case OP_ARRAY_SET:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+IselFunction *isel_analyze(CFG *cfg)
+{
+    int count = cfg->vars.count + 1;
+    int *def_count = (int *)calloc(count, sizeof(int));
+    int *use_count = (int *)calloc(count, sizeof(int));
+    Instruction **def_inst = (Instruction **)calloc(count, sizeof(Instruction *));
+    Instruction **use_inst = (Instruction **)calloc(count, sizeof(Instruction *));
+    int *def_block = (int *)malloc(count * sizeof(int));
+    int *use_block = (int *)malloc(count * sizeof(int));
+    int *def_position = (int *)malloc(count * sizeof(int));
+    int *use_position = (int *)malloc(count * sizeof(int));
+
+    int position = 0;
+    for (int b = 0; b < cfg->block_count; b++)
+    {
+        for (Instruction *inst = cfg->blocks[b]->first;; inst = inst->next)
+        {
+            Operand *uses[3];
+            int n = instruction_uses(inst, uses);
+            for (int i = 0; i < n; i++)
+            {
+                int index = operand_table_lookup(&cfg->vars, uses[i]);
+                if (index < 0)
+                    continue;
+                use_count[index]++;
+                use_inst[index] = inst;
+                use_block[index] = b;
+                use_position[index] = position;
+            }
+            int index = operand_table_lookup(&cfg->vars, instruction_def(inst));
+            if (index >= 0)
+            {
+                def_count[index]++;
+                def_inst[index] = inst;
+                def_block[index] = b;
+                def_position[index] = position;
+            }
+            position++;
+            if (inst == cfg->blocks[b]->last)
+                break;
+        }
+    }
+
+    IselFunction *fn = (IselFunction *)calloc(1, sizeof(IselFunction));
+    fn->cfg = cfg;
+    fn->use_inst = (Instruction **)calloc(count, sizeof(Instruction *));
+    for (int i = 0; i < count; i++)
+    {
+        if (def_count[i] == 1 && use_count[i] == 1 && def_block[i] == use_block[i] &&
+            def_position[i] < use_position[i] && is_foldable_def(def_inst[i]) && is_folding_user(use_inst[i]))
+            fn->use_inst[i] = use_inst[i];
+    }
+
+    free(def_count);
+    free(use_count);
+    free(def_inst);
+    free(use_inst);
+    free(def_block);
+    free(use_block);
+    free(def_position);
+    free(use_position);
+    return fn;
+}
+
+void isel_free(IselFunction *fn)
+{
+    if (fn == NULL)
+        return;
+    free(fn->use_inst);
+    free(fn);
+}
+
+Instruction *isel_fold_user(IselFunction *fn, Instruction *inst)
+{
+    if (!is_foldable_def(inst))
+        return NULL;
+    int index = operand_table_lookup(&fn->cfg->vars, inst->result);
+    return index >= 0 ? fn->use_inst[index] : NULL;
+}
+
+// ========================= 树与标注 =========================
+
+IselNode *isel_new_node(IselOp op, RegClass rc)
+{
+    IselNode *node = (IselNode *)calloc(1, sizeof(IselNode));
+    node->op = op;
+    node->rc = rc;
+    node->operand_rc = rc;
+    return node;
+}
+
+void isel_free_tree(IselNode *node)
+{
+    if (node == NULL)
+        return;
+    isel_free_tree(node->kids[0]);
+    isel_free_tree(node->kids[1]);
+    free(node);
+}
+
+static int kid_count(IselOp op)
+{
+    switch (op)
+    {
+    case IN_CONST:
+    case IN_REG:
+    case IN_GLOBAL:
+        return 0;
+    case IN_ELEM:
+    case IN_BRANCH:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+IselNode *isel_kid(const IselRule *rule, IselNode *node, int i)
+{
+    return node->kids[rule->swap ? 1 - i : i];
+}
+
+static bool constant_in(IselNode *node, int a, int b, int c)
+{
+    if (node->op != IN_CONST)
+        return false;
+    int value = node->leaf->u.int_value;
+    return value == a || value == b || value == c;
+}
+
+static bool predicate_holds(const IselRule *rule, IselNode *node)
+{
+    switch (rule->pred)
+    {
+    case PRED_INT:
+        return node->rc == RC_INT && node->operand_rc == RC_INT;
+    case PRED_SCALE:
+        return node->rc == RC_INT && constant_in(isel_kid(rule, node, 1), 2, 4, 8);
+    case PRED_LEA_MUL:
+        return node->rc == RC_INT && constant_in(isel_kid(rule, node, 1), 3, 5, 9);
+    default:
+        return true;
+    }
+}
+
+static void record(IselNode *node, Nonterm nt, int cost, const IselRule *rule)
+{
+    if (cost < node->cost[nt])
+    {
+        node->cost[nt] = cost;
+        node->rule[nt] = rule;
+    }
+}
+
+void isel_label(IselNode *node)
+{
+    if (node == NULL)
+        return;
+    int kids = kid_count(node->op);
+    for (int i = 0; i < kids; i++)
+        isel_label(node->kids[i]);
+
+    for (int nt = 0; nt < NT_COUNT; nt++)
+    {
+        node->cost[nt] = ISEL_INFINITE;
+        node->rule[nt] = NULL;
+    }
+
+    // 与结点运算相同的规则
+    for (int r = 0; r < X86_RULE_COUNT; r++)
+    {
+        const IselRule *rule = &x86_rules[r];
+        if (rule->op != node->op || !predicate_holds(rule, node))
+            continue;
+        int cost = rule->cost;
+        for (int i = 0; i < kids && cost < ISEL_INFINITE; i++)
+        {
+            int kid_cost = isel_kid(rule, node, i)->cost[rule->kids[i]];
+            cost = kid_cost >= ISEL_INFINITE ? ISEL_INFINITE : cost + kid_cost;
+        }
+        if (cost < ISEL_INFINITE)
+            record(node, rule->lhs, cost, rule);
+    }
+
+    // 链规则的闭包：代价都不小于0，反复松弛直到不再变化
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < X86_RULE_COUNT; r++)
+        {
+            const IselRule *rule = &x86_rules[r];
+            if (rule->op != IN_CHAIN || node->cost[rule->kids[0]] >= ISEL_INFINITE)
+                continue;
+            int cost = node->cost[rule->kids[0]] + rule->cost;
+            if (cost < node->cost[rule->lhs])
+            {
+                record(node, rule->lhs, cost, rule);
+                changed = true;
+            }
+        }
+    }
+}
+
+const IselRule *isel_rule(IselNode *node, Nonterm nt)
+{
+    return node->rule[nt];
+}
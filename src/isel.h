@@ -0,0 +1,123 @@
+#ifndef ISEL_H
+#define ISEL_H
+
+#include "cfg.h"
+#include "machine.h"
+
+// 表达式树结点的运算
+typedef enum
+{
+    IN_CONST,   // 整数常量
+    IN_REG,     // 按寄存器读取的叶子：临时变量、局部标量、浮点常量，以及需要类型转换的值
+    IN_GLOBAL,  // 全局标量（RIP 相对的内存）
+    IN_ELEM,    // 数组元素 array[kids[0]]
+    IN_ADD,
+    IN_SUB,
+    IN_MUL,
+    IN_CMP,     // kids[0] relation kids[1]
+    IN_BRANCH,  // 根：按 kids[0] 条件跳转到 label
+    IN_STORE,   // 根：kids[0]（数组元素）:= kids[1]
+    IN_CHAIN    // 仅用于规则表：链规则
+} IselOp;
+
+// 非终结符：结点的值以什么形式交给上层
+typedef enum
+{
+    NT_STMT,   // 根结点的代码已生成
+    NT_REG,    // 寄存器
+    NT_IMM,    // 立即数
+    NT_MEM,    // 内存操作数
+    NT_RMI,    // 寄存器、内存或立即数，作源操作数
+    NT_INDEX,  // 变址寄存器 * 比例因子（2/4/8）
+    NT_ADDR,   // 基址 + 变址 * 比例 + 偏移，由 lea 计算
+    NT_COND,   // 比较已设置标志，值为条件码
+    NT_COUNT
+} Nonterm;
+
+// 规则的代码生成动作，由后端按编号实现
+typedef enum
+{
+    ACT_PASS,          // 链规则：直接沿用子非终结符的结果
+    ACT_IMM,           // 立即数
+    ACT_LEAF,          // 读取叶子到寄存器（按需转换类型）
+    ACT_GLOBAL,        // 全局标量的内存操作数
+    ACT_ELEM,          // 数组元素的内存操作数
+    ACT_LOAD,          // 内存或立即数装入寄存器
+    ACT_BINARY,        // 双操作数运算：target = kid0; target op= kid1
+    ACT_INDEX,         // 变址 * 比例
+    ACT_ADDR_BASE,     // 基址 + 变址（kid1 为寄存器或变址 * 比例）
+    ACT_ADDR_DISP,     // 地址或寄存器 ± 立即数
+    ACT_ADDR_MUL,      // x * 3/5/9 = x + x * 2/4/8
+    ACT_LEA,           // lea 计算地址表达式
+    ACT_COMPARE,       // cmp / ucomiss
+    ACT_SETCC,         // 条件码的 0/1 值
+    ACT_BRANCH_COND,   // 按比较的条件码跳转
+    ACT_BRANCH_TEST,   // 与零比较后跳转
+    ACT_STORE          // 存入数组元素
+} IselAction;
+
+// 规则的附加条件
+typedef enum
+{
+    PRED_NONE,
+    PRED_INT,        // 结点为整数运算
+    PRED_SCALE,      // 整数运算，kids[1] 为常量 2/4/8
+    PRED_LEA_MUL     // 整数运算，kids[1] 为常量 3/5/9
+} IselPredicate;
+
+// 一条树模式规则：lhs <- op(kids[0], kids[1])，链规则为 lhs <- kids[0]。
+// swap 为true时模式的两个子结点与结点的子结点交叉匹配（可交换的运算、交换比较的两边）
+typedef struct IselRule
+{
+    Nonterm lhs;
+    IselOp op;
+    Nonterm kids[2];
+    bool swap;
+    IselPredicate pred;
+    int cost;           // 生成的机器指令条数
+    IselAction action;
+} IselRule;
+
+// 表达式树结点
+typedef struct IselNode
+{
+    IselOp op;
+    RegClass rc;            // 结点值的寄存器类别
+    RegClass operand_rc;    // IN_CMP：比较的操作数类别，其余结点同 rc
+    OpType relation;        // IN_CMP：比较关系（OP_GT 等）
+    Operand *leaf;          // 叶子：IR 操作数；IN_ELEM：数组
+    int label;              // IN_BRANCH：跳转目标
+    bool negate;            // IN_BRANCH：条件为假时跳转
+    struct IselNode *kids[2];
+    int cost[NT_COUNT];                 // 动态规划：推导出各非终结符的最小代价
+    const IselRule *rule[NT_COUNT];     // 取得最小代价的规则
+} IselNode;
+
+// 单个函数的折叠分析：只定值一次、在同一基本块中稍后只使用一次的临时变量，
+// 其定值可以推迟到使用处，与使用者合成一棵表达式树
+typedef struct IselFunction
+{
+    CFG *cfg;
+    Instruction **use_inst;  // 按变量表下标：可折叠的唯一使用者，否则为NULL
+} IselFunction;
+
+IselFunction *isel_analyze(CFG *cfg);
+void isel_free(IselFunction *fn);
+
+// inst 的定值可推迟到唯一的使用者处折叠时返回该使用者，否则返回NULL
+Instruction *isel_fold_user(IselFunction *fn, Instruction *inst);
+
+// 树结点：叶子与运算结点，子结点由调用者填入
+IselNode *isel_new_node(IselOp op, RegClass rc);
+void isel_free_tree(IselNode *node);
+
+// 自底向上用动态规划为整棵树标注各非终结符的最小代价规则
+void isel_label(IselNode *root);
+
+// 结点推导出非终结符 nt 的最优规则，无法推导时返回NULL
+const IselRule *isel_rule(IselNode *node, Nonterm nt);
+
+// 规则的第 i 个模式子结点匹配的树结点
+IselNode *isel_kid(const IselRule *rule, IselNode *node, int i);
+
+#endif
@@ -0,0 +1,289 @@
+#include "jit.h"
+#include "x86_backend.h"
+#include "x86_encode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#define JIT_SUPPORTED 1
+#endif
+
+#ifdef JIT_SUPPORTED
+
+// 生成的代码可能调用的外部函数，按名字解析为本进程中的地址
+typedef struct RuntimeSymbol
+{
+    const char *name;
+    void (*address)(void);
+} RuntimeSymbol;
+
+static const RuntimeSymbol runtime_symbols[] = {
+    {"abort", (void (*)(void))abort},
+};
+
+// 外部函数的跳转桩：jmp *0(%rip) 后紧跟 64 位绝对地址，代码与进程中的函数相距超过 2GB 时仍可到达
+#define STUB_SIZE 14
+
+// 映射中的一个符号：外部函数对应跳转桩，弱定义函数对应代码中的位置，全局数据对应数据区中的位置
+typedef struct JitSymbol
+{
+    const char *name;
+    unsigned char *address;
+} JitSymbol;
+
+typedef struct JitImage
+{
+    unsigned char *base;
+    size_t length;
+    size_t code_length;   // 代码与跳转桩所在的页，执行前改为可读可执行
+    JitSymbol *symbols;
+    int symbol_count;
+} JitImage;
+
+static size_t align_up(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+static double elapsed_ms_since(clock_t start)
+{
+    return 1000.0 * (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static JitSymbol *find_jit_symbol(JitImage *image, const char *name)
+{
+    for (int i = 0; i < image->symbol_count; i++)
+    {
+        if (image->symbols[i].name == name)
+            return &image->symbols[i];
+    }
+    return NULL;
+}
+
+static void add_jit_symbol(JitImage *image, const char *name, unsigned char *address)
+{
+    image->symbols = (JitSymbol *)realloc(image->symbols, (image->symbol_count + 1) * sizeof(JitSymbol));
+    image->symbols[image->symbol_count].name = name;
+    image->symbols[image->symbol_count].address = address;
+    image->symbol_count++;
+}
+
+static CodeSymbol *find_code_symbol(CodeBuffer *code, const char *name)
+{
+    for (int i = 0; i < code->symbol_count; i++)
+    {
+        if (code->symbols[i].name == name)
+            return &code->symbols[i];
+    }
+    return NULL;
+}
+
+static void (*lookup_runtime_symbol(const char *name))(void)
+{
+    for (size_t i = 0; i < sizeof(runtime_symbols) / sizeof(runtime_symbols[0]); i++)
+    {
+        if (strcmp(runtime_symbols[i].name, name) == 0)
+            return runtime_symbols[i].address;
+    }
+    return NULL;
+}
+
+// 布局映射：[机器代码][外部函数跳转桩] 按页对齐后接 [全局数据]。
+// 映射以可读写方式建立，数据区由 mmap 清零，与 .bss 语义一致
+static bool build_image(MProgram *program, CodeBuffer *code, JitImage *image)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    // 需要跳转桩的外部函数
+    const char **externals = NULL;
+    int external_count = 0;
+    for (int i = 0; i < code->reloc_count; i++)
+    {
+        Relocation *r = &code->relocs[i];
+        if (r->kind != RELOC_CALL || find_code_symbol(code, r->symbol) != NULL)
+            continue;
+        bool seen = false;
+        for (int j = 0; j < external_count && !seen; j++)
+            seen = externals[j] == r->symbol;
+        if (seen)
+            continue;
+        if (lookup_runtime_symbol(r->symbol) == NULL)
+        {
+            fprintf(stderr, "Error: JIT: undefined function %s\n", r->symbol);
+            free(externals);
+            return false;
+        }
+        externals = (const char **)realloc(externals, (external_count + 1) * sizeof(const char *));
+        externals[external_count++] = r->symbol;
+    }
+
+    size_t stubs_offset = align_up((size_t)code->size, 16);
+    size_t code_length = align_up(stubs_offset + (size_t)external_count * STUB_SIZE, page);
+    size_t data_length = 0;
+    for (MGlobal *g = program->globals; g != NULL; g = g->next)
+        data_length = align_up(data_length, (size_t)g->align) + (size_t)g->size;
+    size_t length = code_length + align_up(data_length, page);
+
+    void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        perror("Error: JIT: mmap");
+        free(externals);
+        return false;
+    }
+    image->base = (unsigned char *)base;
+    image->length = length;
+    image->code_length = code_length;
+
+    memcpy(image->base, code->bytes, (size_t)code->size);
+    // 代码末尾到跳转桩之间以 int3 填充
+    memset(image->base + code->size, 0xCC, stubs_offset - (size_t)code->size);
+    for (int i = 0; i < external_count; i++)
+    {
+        unsigned char *stub = image->base + stubs_offset + (size_t)i * STUB_SIZE;
+        void (*target)(void) = lookup_runtime_symbol(externals[i]);
+        stub[0] = 0xFF;
+        stub[1] = 0x25;
+        memset(stub + 2, 0, 4);
+        memcpy(stub + 6, &target, sizeof(target));
+        add_jit_symbol(image, externals[i], stub);
+    }
+    free(externals);
+
+    // 弱定义函数的调用留作了重定位，在映射中直接指向代码
+    for (int i = 0; i < code->symbol_count; i++)
+    {
+        if (code->symbols[i].weak)
+            add_jit_symbol(image, code->symbols[i].name, image->base + code->symbols[i].offset);
+    }
+
+    size_t data_offset = 0;
+    for (MGlobal *g = program->globals; g != NULL; g = g->next)
+    {
+        data_offset = align_up(data_offset, (size_t)g->align);
+        add_jit_symbol(image, intern_symbol(g->name), image->base + code_length + data_offset);
+        data_offset += (size_t)g->size;
+    }
+    return true;
+}
+
+// 在内存中填写重定位：32 位字段 = 符号地址 + addend - 字段地址
+static bool apply_relocations(CodeBuffer *code, JitImage *image)
+{
+    for (int i = 0; i < code->reloc_count; i++)
+    {
+        Relocation *r = &code->relocs[i];
+        JitSymbol *symbol = find_jit_symbol(image, r->symbol);
+        if (symbol == NULL)
+        {
+            fprintf(stderr, "Error: JIT: undefined symbol %s\n", r->symbol);
+            return false;
+        }
+        unsigned char *field = image->base + r->offset;
+        long long value = (long long)(symbol->address - field) + r->addend;
+        if (value < -2147483648LL || value > 2147483647LL)
+        {
+            fprintf(stderr, "Error: JIT: relocation to %s out of range\n", r->symbol);
+            return false;
+        }
+        int value32 = (int)value;
+        memcpy(field, &value32, sizeof(value32));
+    }
+    return true;
+}
+
+static void free_image(JitImage *image)
+{
+    if (image->base != NULL)
+        munmap(image->base, image->length);
+    free(image->symbols);
+    memset(image, 0, sizeof(JitImage));
+}
+
+// main 是否声明了形参
+static bool main_has_params()
+{
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF && strcmp(inst->result->u.name, "main") == 0)
+            return inst->next != NULL && inst->next->op == OP_PARAM;
+    }
+    return false;
+}
+
+bool jit_run_program(JitResult *result)
+{
+    memset(result, 0, sizeof(JitResult));
+    clock_t start = clock();
+
+    MProgram *program = compile_to_x86();
+    if (program == NULL)
+        return false;
+    MFunction *main_fn = mprogram_find_function(program, "main");
+    if (main_fn == NULL || main_has_params())
+    {
+        fprintf(stderr, "Error: JIT: no main function without parameters\n");
+        free_mprogram(program);
+        return false;
+    }
+
+    CodeBuffer code;
+    bool ok = encode_mprogram(program, &code);
+    JitImage image;
+    memset(&image, 0, sizeof(JitImage));
+    ok = ok && build_image(program, &code, &image) && apply_relocations(&code, &image);
+    if (ok && mprotect(image.base, image.code_length, PROT_READ | PROT_EXEC) != 0)
+    {
+        perror("Error: JIT: mprotect");
+        ok = false;
+    }
+
+    unsigned char *entry = NULL;
+    for (int i = 0; ok && i < code.symbol_count; i++)
+    {
+        if (code.symbols[i].name == intern_symbol("main"))
+            entry = image.base + code.symbols[i].offset;
+    }
+    result->code_size = code.size;
+    free_code_buffer(&code);
+    free_mprogram(program);
+    result->compile_ms = elapsed_ms_since(start);
+
+    if (ok)
+    {
+        // 数组越界时生成的代码调用 abort，先把已有输出写出
+        fflush(stdout);
+        start = clock();
+        if (lookup_function_type("main") == TYPE_FLOAT)
+        {
+            float (*main_float)(void);
+            memcpy(&main_float, &entry, sizeof(entry));
+            result->return_value = (int)main_float();
+        }
+        else
+        {
+            int (*main_int)(void);
+            memcpy(&main_int, &entry, sizeof(entry));
+            result->return_value = main_int();
+        }
+        result->elapsed_ms = elapsed_ms_since(start);
+    }
+
+    free_image(&image);
+    return ok;
+}
+
+#else
+
+bool jit_run_program(JitResult *result)
+{
+    memset(result, 0, sizeof(JitResult));
+    fprintf(stderr, "Error: JIT: only supported on x86-64 POSIX hosts\n");
+    return false;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "codegen.h"
+
+// 即时编译执行的结果
+typedef struct JitResult
+{
+    int return_value;    // main 的返回值
+    int code_size;       // 机器代码字节数（不含外部函数的跳转桩）
+    double compile_ms;   // 后端编译与编码耗时
+    double elapsed_ms;   // 执行耗时
+} JitResult;
+
+// 经 x86-64 后端把程序直接编码为机器代码，写入 mmap 得到的可读写内存，在内存中填写
+// 外部调用与全局数据的重定位后改为可读可执行，再在本进程中调用 main。不依赖外部汇编器；
+// 非 x86-64 或不支持 mmap 的平台报错并返回false
+bool jit_run_program(JitResult *result);
+
+#endif
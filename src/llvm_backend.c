@@ -0,0 +1,866 @@
+#include "llvm_backend.h"
+#include "cfg.h"
+#include "type_infer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 函数的翻译信息：第一遍收集用到的变量与跨块的临时变量，第二遍输出
+typedef struct LFunction
+{
+    Instruction *def;
+    const char *name;
+    DataType return_type;
+    int param_count;
+    CFG *cfg;
+    signed char **block_types;
+    bool *used;           // 按 cfg->vars 下标：用到的局部变量
+    bool *spilled;        // 按 cfg->vars 下标 * 2 + 类型：经 alloca 跨块传递的临时变量
+    bool needs_exit;      // 最后一个块顺序执行到函数末尾
+} LFunction;
+
+// IR 中的值：SSA 名字或常量
+typedef struct LValue
+{
+    char text[96];
+    DataType type;        // TYPE_INT / TYPE_FLOAT，TYPE_UNKNOWN 表示无值
+    bool pointer;         // 数组首地址
+} LValue;
+
+typedef struct LGlobal
+{
+    const char *name;
+    DataType type;
+    int array_size;
+} LGlobal;
+
+typedef struct LEmitter
+{
+    FILE *fp;             // NULL 表示第一遍，只收集信息
+    LFunction *fn;
+    signed char *types;   // 当前位置上各临时变量的类型
+    LValue *temps;        // 按 cfg->vars 下标：临时变量在当前块中的值
+    LValue *args;         // 等待 CALL 的实参（在 ARG 处求值）
+    int arg_count;
+    int arg_capacity;
+    int next_value;
+    bool failed;
+} LEmitter;
+
+static LFunction *functions = NULL;
+static int function_count = 0;
+static LGlobal *globals = NULL;
+static int global_count = 0;
+static const char **externals = NULL;   // 程序中未定义的被调函数
+static int external_count = 0;
+static bool typed_pointers = false;     // 兼容 LLVM 14 及更早版本的带类型指针语法
+
+static void emitter_error(LEmitter *E, const char *message)
+{
+    if (!E->failed)
+        fprintf(stderr, "Error: LLVM backend: %s in function %s\n", message, E->fn->name);
+    E->failed = true;
+}
+
+static void lprintf(LEmitter *E, const char *format, ...)
+{
+    if (E->fp == NULL)
+        return;
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(E->fp, format, ap);
+    va_end(ap);
+}
+
+static LFunction *find_function(const char *name)
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        if (strcmp(functions[i].name, name) == 0)
+            return &functions[i];
+    }
+    return NULL;
+}
+
+static const char *ir_type(DataType type)
+{
+    return type == TYPE_FLOAT ? "float" : "i32";
+}
+
+// 指向 type 的指针类型：不透明指针为 ptr，带类型指针为 i32* / float*
+static const char *pointer_type(DataType type)
+{
+    if (!typed_pointers)
+        return "ptr";
+    return type == TYPE_FLOAT ? "float*" : "i32*";
+}
+
+static const char *zero_value(DataType type)
+{
+    return type == TYPE_FLOAT ? "0.0" : "0";
+}
+
+// IR 中的函数名：返回 float 的 main 改名，由生成的 i32 main 调用并转换返回值
+static const char *ir_function_name(const char *name)
+{
+    if (strcmp(name, "main") == 0 && lookup_function_type(name) == TYPE_FLOAT)
+        return "float_main";
+    return name;
+}
+
+static void new_value(LEmitter *E, LValue *value, DataType type)
+{
+    snprintf(value->text, sizeof(value->text), "%%r%d", ++E->next_value);
+    value->type = type;
+    value->pointer = false;
+}
+
+static void constant_value(LValue *value, DataType type, int int_value, float float_value)
+{
+    value->type = type;
+    value->pointer = false;
+    if (type == TYPE_FLOAT)
+    {
+        // 浮点常量按双精度的十六进制位模式书写，单精度值总能精确表示
+        double d = (double)float_value;
+        unsigned long long bits;
+        memcpy(&bits, &d, sizeof(bits));
+        snprintf(value->text, sizeof(value->text), "0x%016llX", bits);
+    }
+    else
+        snprintf(value->text, sizeof(value->text), "%d", int_value);
+}
+
+// ========================= 变量 =========================
+
+static bool is_param(LFunction *fn, const char *name)
+{
+    for (Instruction *p = fn->def->next; p != NULL && p->op == OP_PARAM; p = p->next)
+    {
+        if (strcmp(p->result->u.name, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void note_global(const char *name, VariableInfo *info)
+{
+    for (int i = 0; i < global_count; i++)
+    {
+        if (strcmp(globals[i].name, name) == 0)
+            return;
+    }
+    globals = (LGlobal *)realloc(globals, (global_count + 1) * sizeof(LGlobal));
+    globals[global_count].name = name;
+    globals[global_count].type = info != NULL && info->type == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+    globals[global_count].array_size = info != NULL ? info->array_size : 0;
+    global_count++;
+}
+
+// 变量的地址（alloca、全局变量或数组形参），并返回变量登记信息
+static VariableInfo *variable_address(LEmitter *E, Operand *op, char *address, size_t size)
+{
+    VariableInfo *info = lookup_variable_info(E->fn->name, op->u.name);
+    bool global = info != NULL ? info->function == NULL : is_global_variable(op->u.name);
+    if (info != NULL && info->array_size < 0)
+        emitter_error(E, "multi-dimensional array access is not supported");
+    if (global)
+    {
+        note_global(op->u.name, info);
+        snprintf(address, size, "@v.%s", op->u.name);
+    }
+    else
+    {
+        int index = operand_table_lookup(&E->fn->cfg->vars, op);
+        if (index >= 0)
+            E->fn->used[index] = true;
+        snprintf(address, size, "%%v.%s", op->u.name);
+    }
+    return info;
+}
+
+// ========================= 值 =========================
+
+static DataType value_type(LEmitter *E, Operand *op)
+{
+    return operand_value_type(E->fn->cfg, E->fn->name, E->types, op);
+}
+
+static void spill_name(Operand *temp, DataType type, char *name, size_t size)
+{
+    snprintf(name, size, "%%t%d.%c", temp->u.temp_no, type == TYPE_FLOAT ? 'f' : 'i');
+}
+
+// 操作数按自身类型的值：块内已有定值的临时变量直接使用，否则从 alloca 读取
+static void load_operand(LEmitter *E, Operand *op, LValue *value)
+{
+    char address[96];
+    switch (op->type)
+    {
+    case OPERAND_CONSTANT:
+        constant_value(value, TYPE_INT, op->u.int_value, 0);
+        break;
+    case OPERAND_CONSTANT_FLOAT:
+        constant_value(value, TYPE_FLOAT, 0, op->u.float_value);
+        break;
+    case OPERAND_TEMP:
+    {
+        int index = operand_table_lookup(&E->fn->cfg->vars, op);
+        if (index >= 0 && E->temps[index].type != TYPE_UNKNOWN)
+        {
+            *value = E->temps[index];
+            break;
+        }
+        DataType type = value_type(E, op);
+        if (index >= 0)
+            E->fn->spilled[index * 2 + (type == TYPE_FLOAT)] = true;
+        spill_name(op, type, address, sizeof(address));
+        new_value(E, value, type);
+        lprintf(E, "  %s = load %s, %s %s\n", value->text, ir_type(type), pointer_type(type), address);
+        if (index >= 0)
+            E->temps[index] = *value;
+        break;
+    }
+    case OPERAND_VARIABLE:
+    {
+        DataType type = declared_variable_type(E->fn->name, op->u.name);
+        variable_address(E, op, address, sizeof(address));
+        new_value(E, value, type);
+        lprintf(E, "  %s = load %s, %s %s\n", value->text, ir_type(type), pointer_type(type), address);
+        break;
+    }
+    default:
+        emitter_error(E, "unsupported operand");
+        constant_value(value, TYPE_INT, 0, 0);
+        break;
+    }
+}
+
+// 转换为 type：常量直接折叠，其他值用 sitofp/fptosi
+static void convert_value(LEmitter *E, LValue *value, DataType type)
+{
+    if (value->type == type || value->pointer)
+        return;
+    if (value->text[0] != '%')
+    {
+        if (type == TYPE_FLOAT)
+            constant_value(value, type, 0, (float)atoi(value->text));
+        else
+        {
+            unsigned long long bits = strtoull(value->text, NULL, 16);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            constant_value(value, type, (int)(float)d, 0);
+        }
+        return;
+    }
+    LValue result;
+    new_value(E, &result, type);
+    lprintf(E, "  %s = %s %s %s to %s\n", result.text, type == TYPE_FLOAT ? "sitofp" : "fptosi",
+            ir_type(value->type), value->text, ir_type(type));
+    *value = result;
+}
+
+static void operand_as(LEmitter *E, Operand *op, DataType type, LValue *value)
+{
+    load_operand(E, op, value);
+    convert_value(E, value, type);
+}
+
+// 写入结果：变量按声明类型存入 alloca；临时变量记为当前块中的值，跨块使用时同时存入 alloca
+static void store_result(LEmitter *E, Operand *x, LValue *value)
+{
+    if (x == NULL)
+        return;
+    char address[96];
+    if (x->type == OPERAND_VARIABLE)
+    {
+        DataType type = declared_variable_type(E->fn->name, x->u.name);
+        variable_address(E, x, address, sizeof(address));
+        convert_value(E, value, type);
+        lprintf(E, "  store %s %s, %s %s\n", ir_type(type), value->text, pointer_type(type), address);
+    }
+    else if (x->type == OPERAND_TEMP)
+    {
+        int index = operand_table_lookup(&E->fn->cfg->vars, x);
+        if (index < 0)
+            return;
+        E->temps[index] = *value;
+        if (E->fn->spilled[index * 2 + (value->type == TYPE_FLOAT)])
+        {
+            spill_name(x, value->type, address, sizeof(address));
+            lprintf(E, "  store %s %s, %s %s\n", ir_type(value->type), value->text, pointer_type(value->type),
+                    address);
+        }
+    }
+    else
+        emitter_error(E, "unsupported result operand");
+}
+
+// 整数或浮点值是否非零，得到 i1
+static void truth_value(LEmitter *E, LValue *value, LValue *result)
+{
+    new_value(E, result, TYPE_INT);
+    if (value->type == TYPE_FLOAT)
+        lprintf(E, "  %s = fcmp une float %s, 0.0\n", result->text, value->text);
+    else
+        lprintf(E, "  %s = icmp ne i32 %s, 0\n", result->text, value->text);
+}
+
+// i1 零扩展为 i32
+static void widen_bool(LEmitter *E, LValue *flag, LValue *result)
+{
+    new_value(E, result, TYPE_INT);
+    lprintf(E, "  %s = zext i1 %s to i32\n", result->text, flag->text);
+}
+
+// 数组元素的地址
+static DataType element_address(LEmitter *E, Operand *array, Operand *index, LValue *address)
+{
+    char base[96];
+    VariableInfo *info = array->type == OPERAND_VARIABLE ? variable_address(E, array, base, sizeof(base)) : NULL;
+    if (info == NULL || info->array_size == 0)
+    {
+        emitter_error(E, "unknown array access is not supported");
+        return TYPE_INT;
+    }
+    DataType type = declared_variable_type(E->fn->name, array->u.name);
+    LValue i;
+    operand_as(E, index, TYPE_INT, &i);
+    new_value(E, address, TYPE_INT);
+    address->pointer = true;
+    if (info->is_param && info->function != NULL && is_param(E->fn, array->u.name))
+        lprintf(E, "  %s = getelementptr inbounds %s, %s %s, i32 %s\n", address->text, ir_type(type),
+                pointer_type(type), base, i.text);
+    else if (typed_pointers)
+        lprintf(E, "  %s = getelementptr inbounds [%d x %s], [%d x %s]* %s, i32 0, i32 %s\n", address->text,
+                info->array_size, ir_type(type), info->array_size, ir_type(type), base, i.text);
+    else
+        lprintf(E, "  %s = getelementptr inbounds [%d x %s], ptr %s, i32 0, i32 %s\n", address->text,
+                info->array_size, ir_type(type), base, i.text);
+    return type;
+}
+
+// ========================= 指令翻译 =========================
+
+static DataType common_type(LEmitter *E, Operand *a, Operand *b)
+{
+    return value_type(E, a) == TYPE_FLOAT || value_type(E, b) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+}
+
+// 比较的谓词：整数为有符号比较，浮点 != 用无序比较（与 C 对 NaN 的语义一致）
+static const char *predicate(OpType op, bool is_float)
+{
+    switch (op)
+    {
+    case OP_GT:
+    case OP_IF_GT:
+        return is_float ? "ogt" : "sgt";
+    case OP_LT:
+    case OP_IF_LT:
+        return is_float ? "olt" : "slt";
+    case OP_GE:
+    case OP_IF_GE:
+        return is_float ? "oge" : "sge";
+    case OP_LE:
+    case OP_IF_LE:
+        return is_float ? "ole" : "sle";
+    case OP_EQ:
+    case OP_IF_EQ:
+        return is_float ? "oeq" : "eq";
+    default:
+        return is_float ? "une" : "ne";
+    }
+}
+
+// 比较得到 i1
+static void compare(LEmitter *E, OpType op, Operand *x, Operand *y, LValue *flag)
+{
+    DataType type = common_type(E, x, y);
+    LValue a, b;
+    operand_as(E, x, type, &a);
+    operand_as(E, y, type, &b);
+    new_value(E, flag, TYPE_INT);
+    lprintf(E, "  %s = %s %s %s %s, %s\n", flag->text, type == TYPE_FLOAT ? "fcmp" : "icmp",
+            predicate(op, type == TYPE_FLOAT), ir_type(type), a.text, b.text);
+}
+
+static void translate_binary(LEmitter *E, Instruction *inst, const char *int_op, const char *float_op)
+{
+    DataType type = common_type(E, inst->arg1, inst->arg2);
+    LValue a, b, result;
+    operand_as(E, inst->arg1, type, &a);
+    operand_as(E, inst->arg2, type, &b);
+    new_value(E, &result, type);
+    lprintf(E, "  %s = %s %s %s, %s\n", result.text, type == TYPE_FLOAT ? float_op : int_op, ir_type(type),
+            a.text, b.text);
+    store_result(E, inst->result, &result);
+}
+
+static void translate_logical(LEmitter *E, Instruction *inst, const char *op)
+{
+    LValue a, b, fa, fb, flag, result;
+    load_operand(E, inst->arg1, &a);
+    load_operand(E, inst->arg2, &b);
+    truth_value(E, &a, &fa);
+    truth_value(E, &b, &fb);
+    new_value(E, &flag, TYPE_INT);
+    lprintf(E, "  %s = %s i1 %s, %s\n", flag.text, op, fa.text, fb.text);
+    widen_bool(E, &flag, &result);
+    store_result(E, inst->result, &result);
+}
+
+// 块的名字：标签跳转到标签所在的块，顺序执行到末尾时转到 exit 块
+static void block_name(LEmitter *E, BasicBlock *block, char *name, size_t size)
+{
+    if (block == NULL)
+    {
+        E->fn->needs_exit = true;
+        snprintf(name, size, "%%exit");
+    }
+    else
+        snprintf(name, size, "%%b%d", block->id);
+}
+
+static BasicBlock *label_target(LEmitter *E, Operand *label)
+{
+    CFG *cfg = E->fn->cfg;
+    if (label->type != OPERAND_LABEL || label->u.temp_no >= cfg->label_limit ||
+        cfg->label_block[label->u.temp_no] == NULL)
+    {
+        emitter_error(E, "jump to an undefined label");
+        return NULL;
+    }
+    return cfg->label_block[label->u.temp_no];
+}
+
+static void conditional_branch(LEmitter *E, LValue *flag, Operand *label, BasicBlock *next, bool negate)
+{
+    char taken[32], fallthrough[32];
+    block_name(E, label_target(E, label), taken, sizeof(taken));
+    block_name(E, next, fallthrough, sizeof(fallthrough));
+    lprintf(E, "  br i1 %s, label %s, label %s\n", flag->text, negate ? fallthrough : taken,
+            negate ? taken : fallthrough);
+}
+
+static void translate_arg(LEmitter *E, Instruction *inst)
+{
+    if (E->arg_count == E->arg_capacity)
+    {
+        E->arg_capacity = E->arg_capacity ? E->arg_capacity * 2 : 8;
+        E->args = (LValue *)realloc(E->args, E->arg_capacity * sizeof(LValue));
+    }
+    LValue *arg = &E->args[E->arg_count++];
+    Operand *op = inst->result;
+    VariableInfo *info = op->type == OPERAND_VARIABLE ? lookup_variable_info(E->fn->name, op->u.name) : NULL;
+    if (info != NULL && info->array_size != 0)
+    {
+        char base[96];
+        variable_address(E, op, base, sizeof(base));
+        DataType type = declared_variable_type(E->fn->name, op->u.name);
+        // 带类型指针时定长数组先退化为指向首元素的指针
+        if (typed_pointers && info->array_size > 0 && !(info->is_param && is_param(E->fn, op->u.name)))
+        {
+            new_value(E, arg, type);
+            lprintf(E, "  %s = getelementptr inbounds [%d x %s], [%d x %s]* %s, i32 0, i32 0\n", arg->text,
+                    info->array_size, ir_type(type), info->array_size, ir_type(type), base);
+        }
+        else
+            snprintf(arg->text, sizeof(arg->text), "%s", base);
+        arg->type = type;
+        arg->pointer = true;
+    }
+    else
+        load_operand(E, op, arg);
+}
+
+static void add_external(const char *name)
+{
+    for (int i = 0; i < external_count; i++)
+    {
+        if (strcmp(externals[i], name) == 0)
+            return;
+    }
+    externals = (const char **)realloc(externals, (external_count + 1) * sizeof(const char *));
+    externals[external_count++] = name;
+}
+
+// 被调函数的形参个数决定消耗多少个待传实参，实参按形参类型转换
+static void translate_call(LEmitter *E, Instruction *inst)
+{
+    const char *name = inst->arg1->u.name;
+    LFunction *callee = find_function(name);
+    int count = callee != NULL ? callee->param_count : E->arg_count;
+    if (callee == NULL)
+        add_external(name);
+    if (count > E->arg_count)
+    {
+        emitter_error(E, "call has fewer arguments than parameters");
+        return;
+    }
+
+    LValue *args = E->args + (E->arg_count - count);
+    Instruction *param = callee != NULL ? callee->def->next : NULL;
+    for (int i = 0; i < count; i++, param = param != NULL ? param->next : NULL)
+    {
+        if (param != NULL && !args[i].pointer)
+            convert_value(E, &args[i], declared_variable_type(callee->name, param->result->u.name));
+    }
+
+    DataType type = lookup_function_type(name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+    LValue result;
+    new_value(E, &result, type);
+    lprintf(E, "  %s = call %s %s@%s(", result.text, ir_type(type), callee != NULL ? "" : "(...) ",
+            ir_function_name(name));
+    for (int i = 0; i < count; i++)
+        lprintf(E, "%s%s %s", i > 0 ? ", " : "", args[i].pointer ? pointer_type(args[i].type) : ir_type(args[i].type),
+                args[i].text);
+    lprintf(E, ")\n");
+    E->arg_count -= count;
+    store_result(E, inst->result, &result);
+}
+
+// 翻译一条指令，next 为顺序执行的下一个块；返回是否已输出块的终结指令
+static bool translate_instruction(LEmitter *E, Instruction *inst, BasicBlock *next)
+{
+    LValue a, b, flag, result;
+    char target[32];
+    switch (inst->op)
+    {
+    case OP_GOTO:
+        block_name(E, label_target(E, inst->arg1), target, sizeof(target));
+        lprintf(E, "  br label %s\n", target);
+        return true;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+        load_operand(E, inst->arg1, &a);
+        truth_value(E, &a, &flag);
+        conditional_branch(E, &flag, inst->arg2, next, inst->op == OP_IF_NOT_GOTO);
+        return true;
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        compare(E, inst->op, inst->arg1, inst->arg2, &flag);
+        conditional_branch(E, &flag, inst->result, next, false);
+        return true;
+    case OP_ASSIGN:
+        load_operand(E, inst->arg1, &a);
+        store_result(E, inst->result, &a);
+        break;
+    case OP_ADD:
+        translate_binary(E, inst, "add", "fadd");
+        break;
+    case OP_SUB:
+        translate_binary(E, inst, "sub", "fsub");
+        break;
+    case OP_MUL:
+        translate_binary(E, inst, "mul", "fmul");
+        break;
+    case OP_DIV:
+        translate_binary(E, inst, "sdiv", "fdiv");
+        break;
+    case OP_AND:
+        translate_logical(E, inst, "and");
+        break;
+    case OP_OR:
+        translate_logical(E, inst, "or");
+        break;
+    case OP_NEG:
+        load_operand(E, inst->arg1, &a);
+        new_value(E, &result, a.type);
+        if (a.type == TYPE_FLOAT)
+            lprintf(E, "  %s = fneg float %s\n", result.text, a.text);
+        else
+            lprintf(E, "  %s = sub i32 0, %s\n", result.text, a.text);
+        store_result(E, inst->result, &result);
+        break;
+    case OP_NOT:
+        load_operand(E, inst->arg1, &a);
+        new_value(E, &flag, TYPE_INT);
+        if (a.type == TYPE_FLOAT)
+            lprintf(E, "  %s = fcmp oeq float %s, 0.0\n", flag.text, a.text);
+        else
+            lprintf(E, "  %s = icmp eq i32 %s, 0\n", flag.text, a.text);
+        widen_bool(E, &flag, &result);
+        store_result(E, inst->result, &result);
+        break;
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        compare(E, inst->op, inst->arg1, inst->arg2, &flag);
+        widen_bool(E, &flag, &result);
+        store_result(E, inst->result, &result);
+        break;
+    case OP_ARRAY_GET:
+    {
+        DataType type = element_address(E, inst->arg1, inst->arg2, &a);
+        new_value(E, &result, type);
+        lprintf(E, "  %s = load %s, %s %s\n", result.text, ir_type(type), pointer_type(type), a.text);
+        store_result(E, inst->result, &result);
+        break;
+    }
+    case OP_ARRAY_SET:
+    {
+        DataType type = element_address(E, inst->result, inst->arg1, &a);
+        operand_as(E, inst->arg2, type, &b);
+        lprintf(E, "  store %s %s, %s %s\n", ir_type(type), b.text, pointer_type(type), a.text);
+        break;
+    }
+    case OP_ARG:
+        translate_arg(E, inst);
+        break;
+    case OP_CALL:
+        translate_call(E, inst);
+        break;
+    case OP_RETURN:
+        if (inst->result != NULL)
+        {
+            operand_as(E, inst->result, E->fn->return_type, &a);
+            lprintf(E, "  ret %s %s\n", ir_type(E->fn->return_type), a.text);
+        }
+        else
+            lprintf(E, "  ret %s %s\n", ir_type(E->fn->return_type), zero_value(E->fn->return_type));
+        return true;
+    case OP_LABEL:
+    case OP_PARAM:
+    case OP_FUNC_DEF:
+    case OP_FUNC_END:
+        break;
+    default:
+        emitter_error(E, "unsupported instruction");
+        break;
+    }
+    return false;
+}
+
+// 按指令顺序逐块翻译函数体：块入口处恢复到达的临时变量类型，块内的临时变量值从空开始
+static bool translate_body(LFunction *fn, FILE *fp)
+{
+    LEmitter E;
+    memset(&E, 0, sizeof(E));
+    E.fp = fp;
+    E.fn = fn;
+
+    int count = fn->cfg->vars.count + 1;
+    E.types = (signed char *)malloc(count);
+    E.temps = (LValue *)malloc(count * sizeof(LValue));
+    for (int b = 0; b < fn->cfg->block_count && !E.failed; b++)
+    {
+        BasicBlock *block = fn->cfg->blocks[b];
+        BasicBlock *next = b + 1 < fn->cfg->block_count ? fn->cfg->blocks[b + 1] : NULL;
+        memcpy(E.types, fn->block_types[b], count);
+        for (int i = 0; i < count; i++)
+            E.temps[i].type = TYPE_UNKNOWN;
+
+        lprintf(&E, "\nb%d:\n", block->id);
+        bool terminated = false;
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            terminated = translate_instruction(&E, inst, next);
+            transfer_temp_types(fn->cfg, fn->name, E.types, inst);
+            if (inst == block->last || E.failed)
+                break;
+        }
+        if (!terminated)
+        {
+            char target[32];
+            block_name(&E, next, target, sizeof(target));
+            lprintf(&E, "  br label %s\n", target);
+        }
+    }
+    free(E.types);
+    free(E.temps);
+    free(E.args);
+    return !E.failed;
+}
+
+// ========================= 输出 =========================
+
+static void print_signature(FILE *fp, LFunction *fn)
+{
+    fprintf(fp, "define %s%s @%s(", fn->return_type == TYPE_FLOAT && strcmp(fn->name, "main") == 0 ? "internal " : "",
+            ir_type(fn->return_type), ir_function_name(fn->name));
+    int k = 0;
+    for (Instruction *p = fn->def->next; p != NULL && p->op == OP_PARAM; p = p->next, k++)
+    {
+        const char *name = p->result->u.name;
+        VariableInfo *info = lookup_variable_info(fn->name, name);
+        if (info != NULL && info->array_size != 0)
+            fprintf(fp, "%s%s %%v.%s", k > 0 ? ", " : "", pointer_type(declared_variable_type(fn->name, name)), name);
+        else
+            fprintf(fp, "%s%s %%p.%s", k > 0 ? ", " : "", ir_type(declared_variable_type(fn->name, name)), name);
+    }
+    fprintf(fp, ")");
+}
+
+// 入口块：变量、数组与跨块临时变量的 alloca，形参存入 alloca，标量变量清零（与解释器一致）
+static void print_entry(FILE *fp, LFunction *fn)
+{
+    OperandTable *vars = &fn->cfg->vars;
+    fprintf(fp, "entry:\n");
+    for (int i = 0; i < vars->count; i++)
+    {
+        Operand *op = vars->keys[i];
+        if (op->type == OPERAND_TEMP)
+        {
+            for (int t = 0; t < 2; t++)
+            {
+                if (fn->spilled[i * 2 + t])
+                    fprintf(fp, "  %%t%d.%c = alloca %s\n", op->u.temp_no, t ? 'f' : 'i',
+                            ir_type(t ? TYPE_FLOAT : TYPE_INT));
+            }
+            continue;
+        }
+        if (!fn->used[i])
+            continue;
+        VariableInfo *info = lookup_variable_info(fn->name, op->u.name);
+        DataType type = declared_variable_type(fn->name, op->u.name);
+        bool param = is_param(fn, op->u.name);
+        if (info != NULL && info->array_size > 0)
+        {
+            if (!param)
+                fprintf(fp, "  %%v.%s = alloca [%d x %s], align 16\n", op->u.name, info->array_size, ir_type(type));
+        }
+        else
+        {
+            fprintf(fp, "  %%v.%s = alloca %s\n", op->u.name, ir_type(type));
+            if (param)
+                fprintf(fp, "  store %s %%p.%s, %s %%v.%s\n", ir_type(type), op->u.name, pointer_type(type),
+                        op->u.name);
+            else
+                fprintf(fp, "  store %s %s, %s %%v.%s\n", ir_type(type), zero_value(type), pointer_type(type),
+                        op->u.name);
+        }
+    }
+    if (fn->cfg->block_count > 0)
+        fprintf(fp, "  br label %%b0\n");
+    else
+        fprintf(fp, "  br label %%exit\n");
+}
+
+static void collect_functions()
+{
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+        functions = (LFunction *)realloc(functions, (function_count + 1) * sizeof(LFunction));
+        LFunction *fn = &functions[function_count++];
+        memset(fn, 0, sizeof(LFunction));
+        fn->def = inst;
+        fn->name = inst->result->u.name;
+        fn->return_type = lookup_function_type(fn->name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+        for (Instruction *p = inst->next; p != NULL && p->op == OP_PARAM; p = p->next)
+            fn->param_count++;
+    }
+}
+
+static void free_functions()
+{
+    for (int i = 0; i < function_count; i++)
+    {
+        LFunction *fn = &functions[i];
+        if (fn->cfg != NULL)
+        {
+            free_temp_types(fn->cfg, fn->block_types);
+            free_cfg(fn->cfg);
+        }
+        free(fn->used);
+        free(fn->spilled);
+    }
+    free(functions);
+    free(globals);
+    free(externals);
+    functions = NULL;
+    function_count = 0;
+    globals = NULL;
+    global_count = 0;
+    externals = NULL;
+    external_count = 0;
+}
+
+static void print_module(FILE *fp)
+{
+    fprintf(fp, "; Generated from three-address code\n");
+
+    for (int i = 0; i < function_count; i++)
+    {
+        LFunction *fn = &functions[i];
+        fprintf(fp, "\n");
+        print_signature(fp, fn);
+        fprintf(fp, " {\n");
+        print_entry(fp, fn);
+        translate_body(fn, fp);
+        if (fn->needs_exit || fn->cfg->block_count == 0)
+            fprintf(fp, "\nexit:\n  ret %s %s\n", ir_type(fn->return_type), zero_value(fn->return_type));
+        fprintf(fp, "}\n");
+    }
+
+    LFunction *main_fn = find_function("main");
+    if (main_fn != NULL && main_fn->return_type == TYPE_FLOAT)
+        fprintf(fp, "\ndefine i32 @main() {\nentry:\n  %%r = call float @float_main()\n"
+                    "  %%i = fptosi float %%r to i32\n  ret i32 %%i\n}\n");
+
+    if (global_count > 0)
+        fprintf(fp, "\n");
+    for (int i = 0; i < global_count; i++)
+    {
+        LGlobal *g = &globals[i];
+        if (g->array_size > 0)
+            fprintf(fp, "@v.%s = internal global [%d x %s] zeroinitializer, align 16\n", g->name, g->array_size,
+                    ir_type(g->type));
+        else
+            fprintf(fp, "@v.%s = internal global %s %s\n", g->name, ir_type(g->type), zero_value(g->type));
+    }
+
+    // 越界处理函数未由程序定义时提供缺省实现；其他外部函数按返回 i32 的变参函数声明
+    for (int i = 0; i < external_count; i++)
+    {
+        if (strcmp(externals[i], BOUNDS_CHECK_FAIL_FUNCTION) == 0)
+            fprintf(fp, "\ndefine internal i32 @%s(...) {\nentry:\n  call void @abort()\n  unreachable\n}\n\n"
+                        "declare void @abort() noreturn\n", externals[i]);
+        else
+            fprintf(fp, "\ndeclare i32 @%s(...)\n", externals[i]);
+    }
+}
+
+bool write_llvm_ir(const char *filename, bool typed)
+{
+    typed_pointers = typed;
+    collect_functions();
+
+    // 第一遍：推断临时变量类型，收集用到的变量与跨块使用的临时变量
+    bool ok = true;
+    for (int i = 0; i < function_count && ok; i++)
+    {
+        LFunction *fn = &functions[i];
+        fn->cfg = build_cfg(fn->def);
+        fn->block_types = infer_temp_types(fn->cfg, fn->name);
+        fn->used = (bool *)calloc(fn->cfg->vars.count + 1, sizeof(bool));
+        fn->spilled = (bool *)calloc(2 * (fn->cfg->vars.count + 1), sizeof(bool));
+        ok = translate_body(fn, NULL);
+    }
+    for (int i = 0; i < function_count; i++)
+        functions[i].needs_exit = false;
+
+    FILE *fp = ok ? fopen(filename, "w") : NULL;
+    if (ok && fp == NULL)
+    {
+        perror(filename);
+        ok = false;
+    }
+    if (ok)
+    {
+        print_module(fp);
+        fclose(fp);
+    }
+    free_functions();
+    return ok;
+}
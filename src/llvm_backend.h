@@ -0,0 +1,13 @@
+#ifndef LLVM_BACKEND_H
+#define LLVM_BACKEND_H
+
+#include "codegen.h"
+
+// 把三地址代码输出为文本形式的 LLVM IR（.ll，不透明指针 ptr 语法）：变量与数组放在入口块的
+// alloca 中，块内的临时变量成为 SSA 值，跨基本块使用的临时变量经按类型分配的 alloca 传递
+// （mem2reg 会把这些 alloca 提升为 SSA），比较用 icmp/fcmp 配合条件跳转。
+// 输出可交给 opt/llc/clang 优化与编译；typed 为true时改用 LLVM 14 及更早版本的带类型指针语法。
+// 不支持的构造（多维数组）报错并返回false
+bool write_llvm_ir(const char *filename, bool typed);
+
+#endif
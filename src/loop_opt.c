@@ -0,0 +1,1448 @@
+#include "loop_opt.h"
+#include "array_opt.h"
+#include "type_infer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 查找以inst结尾的基本块
+BasicBlock *block_of_instruction(CFG *cfg, Instruction *inst)
+{
+    for (int i = 0; i < cfg->block_count; i++)
+    {
+        if (cfg->blocks[i]->last == inst)
+            return cfg->blocks[i];
+    }
+    return NULL;
+}
+
+// 在循环头之前创建前置块，返回前置块的标签指令（外提的指令插在其后）
+Instruction *create_preheader(CFG *cfg, Loop *loop)
+{
+    Instruction *header_label = loop->header->first;
+    if (header_label->op != OP_LABEL)
+        return NULL;
+
+    Instruction *prev = find_prev_instruction(cfg->func_def, header_label);
+
+    // 循环内的块如果顺序落入循环头，先补一条显式跳转
+    BasicBlock *prev_block = block_of_instruction(cfg, prev);
+    if (prev_block != NULL && loop_contains(loop, prev_block) &&
+        prev->op != OP_GOTO && prev->op != OP_RETURN)
+    {
+        Instruction *jump = new_instruction(OP_GOTO, NULL, copy_operand(header_label->result), NULL);
+        insert_instruction_after(prev, jump);
+        prev = jump;
+    }
+
+    Instruction *label = new_instruction(OP_LABEL, new_operand_label(), NULL, NULL);
+    insert_instruction_after(prev, label);
+
+    // 循环外跳向循环头的边改为跳向前置块
+    for (int p = 0; p < loop->header->pred_count; p++)
+    {
+        BasicBlock *pred = loop->header->preds[p];
+        if (loop_contains(loop, pred))
+            continue;
+
+        Operand *target = branch_target(pred->last);
+        if (target != NULL && operands_equal(target, header_label->result))
+        {
+            target->u.temp_no = label->result->u.temp_no;
+        }
+    }
+
+    return label;
+}
+
+// 按指令顺序收集循环内的指令及其所在块，返回指令数
+int collect_loop_instructions(CFG *cfg, Loop *loop, Instruction ***insts_out, BasicBlock ***blocks_out)
+{
+    int count = 0;
+    int capacity = 64;
+    Instruction **insts = (Instruction **)malloc(capacity * sizeof(Instruction *));
+    BasicBlock **blocks = (BasicBlock **)malloc(capacity * sizeof(BasicBlock *));
+
+    for (int b = 0; b < cfg->block_count; b++)
+    {
+        BasicBlock *block = cfg->blocks[b];
+        if (!loop_contains(loop, block))
+            continue;
+
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            if (count == capacity)
+            {
+                capacity *= 2;
+                insts = (Instruction **)realloc(insts, capacity * sizeof(Instruction *));
+                blocks = (BasicBlock **)realloc(blocks, capacity * sizeof(BasicBlock *));
+            }
+            insts[count] = inst;
+            blocks[count++] = block;
+            if (inst == block->last)
+                break;
+        }
+    }
+
+    *insts_out = insts;
+    *blocks_out = blocks;
+    return count;
+}
+
+// 可以作为循环不变量外提的运算
+static bool is_hoistable_op(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_NEG:
+    case OP_NOT:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_AND:
+    case OP_OR:
+    case OP_ARRAY_GET:
+        return true;
+    case OP_DIV:
+        // 外提后可能在循环一次都不执行时求值，只允许非零常量除数
+        return inst->arg2 && inst->arg2->type == OPERAND_CONSTANT && inst->arg2->u.int_value != 0;
+    default:
+        return false;
+    }
+}
+
+// 形参数组可能与其他形参数组或全局数组是同一块存储（按名传递的数组实参可以相同）
+static bool is_shared_array(Instruction *func_def, Operand *array)
+{
+    if (is_global_variable(array->u.name))
+        return true;
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_PARAM && strcmp(inst->result->u.name, array->u.name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static ArrayAccess make_loop_access(Instruction *func_def, Operand *array, Operand *index)
+{
+    ArrayAccess access;
+    access.array = array;
+    access.index.base = index->type == OPERAND_CONSTANT ? NULL : index;
+    access.index.offset = index->type == OPERAND_CONSTANT ? index->u.int_value : 0;
+    access.shared = is_shared_array(func_def, array);
+    return access;
+}
+
+// 循环内的写入都不会改变读取 load 的元素；数组不是具名变量时无法判断
+static bool load_unaffected(ArrayAccess *stores, int store_count, Instruction *func_def, Instruction *load)
+{
+    if (load->arg1 == NULL || load->arg1->type != OPERAND_VARIABLE)
+        return store_count == 0;
+    ArrayAccess access = make_loop_access(func_def, load->arg1, load->arg2);
+    for (int i = 0; i < store_count; i++)
+    {
+        if (stores[i].array == NULL || array_alias(&access, &stores[i]) != ALIAS_NO)
+            return false;
+    }
+    return true;
+}
+
+// 每次进入循环都会在离开之前执行 block：block 支配所有跳出循环或返回的块。
+// 前置块只在进入循环时执行，这样外提的读取不会在原来不执行它的路径上求值（如一次都不执行的 while 循环）
+static bool runs_on_every_entry(Loop *loop, BasicBlock *block)
+{
+    int exit_count = 0;
+    for (int b = 0; b < loop->block_count; b++)
+    {
+        BasicBlock *from = loop->blocks[b];
+        bool leaves = from->last->op == OP_RETURN;
+        for (int s = 0; s < from->succ_count && !leaves; s++)
+            leaves = !loop_contains(loop, from->succs[s]);
+        if (!leaves)
+            continue;
+        exit_count++;
+        if (!dominates(block, from))
+            return false;
+    }
+    return exit_count > 0;
+}
+
+// 对单个循环做不变量外提，返回外提的指令数
+static int hoist_loop_invariants(CFG *cfg, Loop *loop)
+{
+    int var_count = cfg->vars.count;
+    int *def_count = (int *)calloc(var_count + 1, sizeof(int));
+    bool *invariant = (bool *)calloc(var_count + 1, sizeof(bool));
+    bool has_call = false;
+
+    // 按指令顺序收集循环内的指令
+    BasicBlock **inst_block = NULL;
+    Instruction **insts = NULL;
+    int inst_count = collect_loop_instructions(cfg, loop, &insts, &inst_block);
+
+    // 循环内的数组写入，数组不是具名变量时 array 为NULL
+    ArrayAccess *stores = (ArrayAccess *)malloc((inst_count + 1) * sizeof(ArrayAccess));
+    int store_count = 0;
+    for (int i = 0; i < inst_count; i++)
+    {
+        Instruction *inst = insts[i];
+        int def = operand_table_lookup(&cfg->vars, instruction_def(inst));
+        if (def >= 0)
+            def_count[def]++;
+        if (inst->op == OP_ARRAY_SET)
+        {
+            if (inst->result != NULL && inst->result->type == OPERAND_VARIABLE)
+                stores[store_count++] = make_loop_access(cfg->func_def, inst->result, inst->arg1);
+            else
+                stores[store_count++].array = NULL;
+        }
+        if (inst->op == OP_CALL)
+            has_call = true;
+    }
+
+    bool *marked = (bool *)calloc(inst_count + 1, sizeof(bool));
+    Instruction **order = (Instruction **)malloc((inst_count + 1) * sizeof(Instruction *));
+    int hoisted = 0;
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+        for (int i = 0; i < inst_count; i++)
+        {
+            Instruction *inst = insts[i];
+            if (marked[i] || !is_hoistable_op(inst))
+                continue;
+
+            int def = operand_table_lookup(&cfg->vars, inst->result);
+            if (def < 0 || def_count[def] != 1)
+                continue;
+
+            // 操作数必须是常量、循环外定义的值或已外提的不变量
+            Operand *uses[3];
+            int use_count = instruction_uses(inst, uses);
+            bool operands_invariant = true;
+            for (int u = 0; u < use_count && operands_invariant; u++)
+            {
+                int index = operand_table_lookup(&cfg->vars, uses[u]);
+                if (index < 0)
+                    continue;
+                if (def_count[index] == 0)
+                {
+                    // 全局变量可能被循环内的调用修改
+                    if (has_call && uses[u]->type == OPERAND_VARIABLE &&
+                        is_global_variable(uses[u]->u.name))
+                        operands_invariant = false;
+                }
+                else if (!invariant[index])
+                {
+                    operands_invariant = false;
+                }
+            }
+            if (!operands_invariant)
+                continue;
+
+            // 数组读取要求循环内的写入都不可能改到该元素（形参与全局数组可能是同一块存储），
+            // 也没有可能修改数组的调用
+            if (inst->op == OP_ARRAY_GET &&
+                (has_call || !load_unaffected(stores, store_count, cfg->func_def, inst)))
+                continue;
+
+            // 读取可能越界，只从每次进入都会执行它的位置外提；
+            // while 循环的读取在循环旋转成带守卫的 do-while 形式之后才能外提
+            if (inst->op == OP_ARRAY_GET && !runs_on_every_entry(loop, inst_block[i]))
+                continue;
+
+            // 结果在进入循环时不能活跃，否则外提会覆盖循环前的值
+            if (is_live_in(cfg, loop->header, inst->result))
+                continue;
+
+            // 结果在循环出口活跃时，定义所在块必须支配所有出口
+            bool exits_ok = true;
+            for (int b = 0; b < loop->block_count && exits_ok; b++)
+            {
+                BasicBlock *block = loop->blocks[b];
+                for (int s = 0; s < block->succ_count; s++)
+                {
+                    BasicBlock *succ = block->succs[s];
+                    if (loop_contains(loop, succ))
+                        continue;
+                    if (is_live_in(cfg, succ, inst->result) && !dominates(inst_block[i], block))
+                    {
+                        exits_ok = false;
+                        break;
+                    }
+                }
+            }
+            if (!exits_ok)
+                continue;
+
+            marked[i] = true;
+            invariant[def] = true;
+            order[hoisted++] = inst;
+            changed = true;
+        }
+    }
+
+    if (hoisted > 0)
+    {
+        Instruction *pos = create_preheader(cfg, loop);
+        if (pos == NULL)
+        {
+            hoisted = 0;
+        }
+        else
+        {
+            for (int i = 0; i < hoisted; i++)
+            {
+                Instruction *prev = find_prev_instruction(cfg->func_def, order[i]);
+                unlink_instruction(prev, order[i]);
+                insert_instruction_after(pos, order[i]);
+                pos = order[i];
+            }
+        }
+    }
+
+    free(def_count);
+    free(stores);
+    free(invariant);
+    free(insts);
+    free(inst_block);
+    free(marked);
+    free(order);
+    return hoisted;
+}
+
+// 循环不变量外提：自内向外处理每个自然循环，外提到新建的前置块
+int loop_invariant_code_motion()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    for (Instruction *func = code_head; func != NULL; func = func->next)
+    {
+        if (func->op != OP_FUNC_DEF)
+            continue;
+
+        // 每次外提都会改变控制流图，重建后继续，直到没有可外提的指令
+        bool changed = true;
+        int rounds = 0;
+        while (changed && rounds++ < 100)
+        {
+            changed = false;
+            CFG *cfg = build_cfg(func);
+            compute_dominators(cfg);
+            compute_liveness(cfg);
+
+            Loop **loops = NULL;
+            int loop_count = find_natural_loops(cfg, &loops);
+            for (int i = 0; i < loop_count; i++)
+            {
+                int hoisted = hoist_loop_invariants(cfg, loops[i]);
+                if (hoisted > 0)
+                {
+                    total += hoisted;
+                    changed = true;
+                    break;
+                }
+            }
+
+            free_loops(loops, loop_count);
+            free_cfg(cfg);
+        }
+    }
+
+    opt_stats.loop_invariant_hoist_count += total;
+    return total;
+}
+
+// ========================= 归纳变量与强度削弱 =========================
+
+// 基本归纳变量：每次迭代只在一处按常量步长更新
+typedef struct BasicIV
+{
+    Operand *var;           // 归纳变量
+    int step;               // 每次迭代的增量
+    Instruction *update;    // 更新变量本身的指令（i := i + c 或 i := t）
+    Instruction *increment; // i := t 形式时计算 t := i + c 的指令，否则为NULL
+} BasicIV;
+
+// 归纳变量族：value = scale * basic + offset
+typedef struct IVFamily
+{
+    int basic;  // 基本归纳变量编号（BasicIV数组下标），-1表示不是归纳变量
+    int scale;
+    int offset;
+    int def;    // 定义指令在循环指令数组中的下标
+} IVFamily;
+
+// 强度削弱生成的递推变量
+typedef struct ReducedIV
+{
+    int basic;
+    int scale;
+    int offset;
+    Operand *temp;
+} ReducedIV;
+
+// 解析 x := v + c / x := c + v / x := v - c，成功时返回true并给出步长
+static bool match_add_constant(Instruction *inst, Operand *v, int *step)
+{
+    if (inst->op == OP_ADD)
+    {
+        if (operands_equal(inst->arg1, v) && inst->arg2 && inst->arg2->type == OPERAND_CONSTANT)
+        {
+            *step = inst->arg2->u.int_value;
+            return true;
+        }
+        if (operands_equal(inst->arg2, v) && inst->arg1 && inst->arg1->type == OPERAND_CONSTANT)
+        {
+            *step = inst->arg1->u.int_value;
+            return true;
+        }
+    }
+    else if (inst->op == OP_SUB)
+    {
+        if (operands_equal(inst->arg1, v) && inst->arg2 && inst->arg2->type == OPERAND_CONSTANT)
+        {
+            *step = -inst->arg2->u.int_value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_iv_update(BasicIV *biv, Instruction *inst)
+{
+    return inst == biv->update || inst == biv->increment;
+}
+
+// 对单个循环做归纳变量强度削弱和线性函数测试替换，返回变换次数
+static int reduce_induction_variables(CFG *cfg, Loop *loop)
+{
+    int var_count = cfg->vars.count;
+    Instruction **insts = NULL;
+    BasicBlock **inst_block = NULL;
+    int inst_count = collect_loop_instructions(cfg, loop, &insts, &inst_block);
+
+    int *def_count = (int *)calloc(var_count + 1, sizeof(int));
+    int *def_index = (int *)calloc(var_count + 1, sizeof(int));
+    int *use_count = (int *)calloc(var_count + 1, sizeof(int));
+    bool has_call = false;
+
+    for (int i = 0; i < inst_count; i++)
+    {
+        Instruction *inst = insts[i];
+        int def = operand_table_lookup(&cfg->vars, instruction_def(inst));
+        if (def >= 0)
+        {
+            def_count[def]++;
+            def_index[def] = i;
+        }
+
+        Operand *uses[3];
+        int n = instruction_uses(inst, uses);
+        for (int u = 0; u < n; u++)
+        {
+            int index = operand_table_lookup(&cfg->vars, uses[u]);
+            if (index >= 0)
+                use_count[index]++;
+        }
+        if (inst->op == OP_CALL)
+            has_call = true;
+    }
+
+    // 第一步：识别基本归纳变量
+    BasicIV *bivs = (BasicIV *)malloc((inst_count + 1) * sizeof(BasicIV));
+    int biv_count = 0;
+    IVFamily *family = (IVFamily *)malloc((var_count + 1) * sizeof(IVFamily));
+    for (int v = 0; v < var_count; v++)
+        family[v].basic = -1;
+
+    for (int i = 0; i < inst_count; i++)
+    {
+        Instruction *inst = insts[i];
+        Operand *var = instruction_def(inst);
+        int v = operand_table_lookup(&cfg->vars, var);
+        if (v < 0 || def_count[v] != 1)
+            continue;
+        if (var->type == OPERAND_VARIABLE && is_global_variable(var->u.name))
+            continue;
+
+        int step = 0;
+        Instruction *increment = NULL;
+        if (match_add_constant(inst, var, &step))
+        {
+            increment = NULL;
+        }
+        else if (inst->op == OP_ASSIGN && inst->arg1 && inst->arg1->type == OPERAND_TEMP)
+        {
+            // i := t，其中 t := i + c 只在此处使用
+            int t = operand_table_lookup(&cfg->vars, inst->arg1);
+            if (t < 0 || def_count[t] != 1 || use_count[t] != 1 ||
+                !match_add_constant(insts[def_index[t]], var, &step))
+                continue;
+            increment = insts[def_index[t]];
+        }
+        else
+        {
+            continue;
+        }
+
+        bivs[biv_count].var = var;
+        bivs[biv_count].step = step;
+        bivs[biv_count].update = inst;
+        bivs[biv_count].increment = increment;
+        family[v].basic = biv_count;
+        family[v].scale = 1;
+        family[v].offset = 0;
+        family[v].def = i;
+        biv_count++;
+    }
+
+    if (biv_count == 0)
+    {
+        free(insts);
+        free(inst_block);
+        free(def_count);
+        free(def_index);
+        free(use_count);
+        free(bivs);
+        free(family);
+        return 0;
+    }
+
+    // 第二步：按指令顺序识别派生归纳变量 x := a * i + b
+    for (int i = 0; i < inst_count; i++)
+    {
+        Instruction *inst = insts[i];
+        if (inst->op != OP_ADD && inst->op != OP_SUB && inst->op != OP_MUL)
+            continue;
+
+        int r = operand_table_lookup(&cfg->vars, inst->result);
+        if (r < 0 || def_count[r] != 1 || family[r].basic >= 0)
+            continue;
+        if (inst->result->type == OPERAND_VARIABLE && is_global_variable(inst->result->u.name))
+            continue;
+
+        Operand *x = NULL;
+        Operand *c = NULL;
+        if (inst->arg2 && inst->arg2->type == OPERAND_CONSTANT)
+        {
+            x = inst->arg1;
+            c = inst->arg2;
+        }
+        else if (inst->op != OP_SUB && inst->arg1 && inst->arg1->type == OPERAND_CONSTANT)
+        {
+            x = inst->arg2;
+            c = inst->arg1;
+        }
+        if (x == NULL)
+            continue;
+
+        int xi = operand_table_lookup(&cfg->vars, x);
+        if (xi < 0 || family[xi].basic < 0)
+            continue;
+
+        BasicIV *biv = &bivs[family[xi].basic];
+        if (family[xi].scale != 1 || family[xi].offset != 0 || !operands_equal(x, biv->var))
+        {
+            // 由派生变量再派生：两者须在同一块内，且中间没有更新基本归纳变量
+            int from = family[xi].def;
+            if (from >= i || inst_block[from] != inst_block[i])
+                continue;
+            bool updated = false;
+            for (int k = from + 1; k < i; k++)
+            {
+                if (is_iv_update(biv, insts[k]))
+                    updated = true;
+            }
+            if (updated)
+                continue;
+        }
+
+        int value = c->u.int_value;
+        family[r].basic = family[xi].basic;
+        family[r].def = i;
+        switch (inst->op)
+        {
+        case OP_ADD:
+            family[r].scale = family[xi].scale;
+            family[r].offset = family[xi].offset + value;
+            break;
+        case OP_SUB:
+            family[r].scale = family[xi].scale;
+            family[r].offset = family[xi].offset - value;
+            break;
+        default:
+            family[r].scale = family[xi].scale * value;
+            family[r].offset = family[xi].offset * value;
+            break;
+        }
+    }
+
+    // 第三步：把派生归纳变量的乘法替换为递推加法
+    Instruction *preheader = NULL;
+    Instruction *pos = NULL;
+    ReducedIV *reduced = (ReducedIV *)malloc((inst_count + 1) * sizeof(ReducedIV));
+    int reduced_count = 0;
+    int changes = 0;
+
+    for (int i = 0; i < inst_count; i++)
+    {
+        Instruction *inst = insts[i];
+        if (inst->op != OP_MUL)
+            continue;
+        int r = operand_table_lookup(&cfg->vars, inst->result);
+        if (r < 0 || family[r].basic < 0 || family[r].def != i)
+            continue;
+
+        int basic = family[r].basic;
+        int scale = family[r].scale;
+        int offset = family[r].offset;
+        BasicIV *biv = &bivs[basic];
+
+        ReducedIV *rv = NULL;
+        for (int k = 0; k < reduced_count; k++)
+        {
+            if (reduced[k].basic == basic && reduced[k].scale == scale && reduced[k].offset == offset)
+                rv = &reduced[k];
+        }
+
+        if (rv == NULL)
+        {
+            if (preheader == NULL)
+            {
+                preheader = create_preheader(cfg, loop);
+                if (preheader == NULL)
+                    break;
+                pos = preheader;
+            }
+
+            rv = &reduced[reduced_count++];
+            rv->basic = basic;
+            rv->scale = scale;
+            rv->offset = offset;
+            rv->temp = new_operand_temp();
+
+            // 前置块中初始化 s := a * i + b
+            Instruction *init;
+            if (offset == 0)
+            {
+                init = new_instruction(OP_MUL, copy_operand(rv->temp), copy_operand(biv->var),
+                                       new_operand_constant_int(scale));
+                insert_instruction_after(pos, init);
+                pos = init;
+            }
+            else
+            {
+                Operand *scaled = new_operand_temp();
+                init = new_instruction(OP_MUL, scaled, copy_operand(biv->var), new_operand_constant_int(scale));
+                insert_instruction_after(pos, init);
+                pos = init;
+                init = new_instruction(OP_ADD, copy_operand(rv->temp), copy_operand(scaled),
+                                       new_operand_constant_int(offset));
+                insert_instruction_after(pos, init);
+                pos = init;
+            }
+
+            // 基本归纳变量更新之后同步更新 s := s + a * step
+            Instruction *step = new_instruction(OP_ADD, copy_operand(rv->temp), copy_operand(rv->temp),
+                                                new_operand_constant_int(scale * biv->step));
+            insert_instruction_after(biv->update, step);
+        }
+
+        // x := a * i + b 改为 x := s
+        inst->op = OP_ASSIGN;
+        free_operand(inst->arg1);
+        free_operand(inst->arg2);
+        inst->arg1 = copy_operand(rv->temp);
+        inst->arg2 = NULL;
+        opt_stats.strength_reduction_count++;
+        changes++;
+    }
+
+    // 第四步：线性函数测试替换，基本归纳变量只用于循环判断时将其消除
+    for (int k = 0; k < reduced_count && preheader != NULL; k++)
+    {
+        ReducedIV *rv = &reduced[k];
+        BasicIV *biv = &bivs[rv->basic];
+        if (rv->scale <= 0 || biv->var == NULL)
+            continue;
+
+        // 除自身更新外，基本归纳变量只能被一条比较指令使用
+        Instruction *compare = NULL;
+        bool other_use = false;
+        for (int i = 0; i < inst_count && !other_use; i++)
+        {
+            Instruction *inst = insts[i];
+            if (is_iv_update(biv, inst))
+                continue;
+
+            Operand *uses[3];
+            int n = instruction_uses(inst, uses);
+            bool uses_iv = false;
+            for (int u = 0; u < n; u++)
+            {
+                if (operands_equal(uses[u], biv->var))
+                    uses_iv = true;
+            }
+            if (!uses_iv)
+                continue;
+
+            if (((inst->op >= OP_GT && inst->op <= OP_NE) || is_relational_branch(inst->op)) && compare == NULL)
+                compare = inst;
+            else
+                other_use = true;
+        }
+        if (other_use || compare == NULL)
+            continue;
+
+        // 比较的另一侧必须是循环不变量
+        bool iv_left = operands_equal(compare->arg1, biv->var);
+        Operand *bound = iv_left ? compare->arg2 : compare->arg1;
+        if (operands_equal(bound, biv->var))
+            continue;
+        int bound_index = operand_table_lookup(&cfg->vars, bound);
+        if (bound->type == OPERAND_CONSTANT_FLOAT)
+            continue;
+        if (bound_index >= 0 &&
+            (def_count[bound_index] > 0 ||
+             (has_call && bound->type == OPERAND_VARIABLE && is_global_variable(bound->u.name))))
+            continue;
+
+        // 比较结果只能用于循环内的条件跳转（比较跳转指令本身没有结果）
+        if (!is_relational_branch(compare->op))
+        {
+            int cmp = operand_table_lookup(&cfg->vars, compare->result);
+            if (cmp < 0 || def_count[cmp] != 1 || use_count[cmp] != 1)
+                continue;
+        }
+
+        // 循环退出后不能再使用该归纳变量
+        bool live_after = false;
+        for (int b = 0; b < loop->block_count; b++)
+        {
+            BasicBlock *block = loop->blocks[b];
+            for (int s = 0; s < block->succ_count; s++)
+            {
+                if (!loop_contains(loop, block->succs[s]) && is_live_in(cfg, block->succs[s], biv->var))
+                    live_after = true;
+            }
+        }
+        if (live_after)
+            continue;
+
+        // 前置块中计算新的界 a * n + b
+        Operand *new_bound;
+        if (bound->type == OPERAND_CONSTANT)
+        {
+            new_bound = new_operand_constant_int(rv->scale * bound->u.int_value + rv->offset);
+        }
+        else
+        {
+            Operand *scaled = new_operand_temp();
+            Instruction *mul = new_instruction(OP_MUL, scaled, copy_operand(bound), new_operand_constant_int(rv->scale));
+            insert_instruction_after(pos, mul);
+            pos = mul;
+            new_bound = scaled;
+            if (rv->offset != 0)
+            {
+                new_bound = new_operand_temp();
+                Instruction *add = new_instruction(OP_ADD, copy_operand(new_bound), copy_operand(scaled),
+                                                   new_operand_constant_int(rv->offset));
+                insert_instruction_after(pos, add);
+                pos = add;
+            }
+            new_bound = copy_operand(new_bound);
+        }
+
+        if (iv_left)
+        {
+            free_operand(compare->arg1);
+            free_operand(compare->arg2);
+            compare->arg1 = copy_operand(rv->temp);
+            compare->arg2 = new_bound;
+        }
+        else
+        {
+            free_operand(compare->arg1);
+            free_operand(compare->arg2);
+            compare->arg1 = new_bound;
+            compare->arg2 = copy_operand(rv->temp);
+        }
+
+        // 删除原归纳变量的更新
+        Instruction *prev = find_prev_instruction(cfg->func_def, biv->update);
+        unlink_instruction(prev, biv->update);
+        free_instruction(biv->update);
+        if (biv->increment != NULL)
+        {
+            prev = find_prev_instruction(cfg->func_def, biv->increment);
+            unlink_instruction(prev, biv->increment);
+            free_instruction(biv->increment);
+        }
+        biv->var = NULL;
+        opt_stats.induction_variable_elimination_count++;
+        changes++;
+    }
+
+    free(insts);
+    free(inst_block);
+    free(def_count);
+    free(def_index);
+    free(use_count);
+    free(bivs);
+    free(family);
+    free(reduced);
+    return changes;
+}
+
+// 归纳变量优化：强度削弱 + 线性函数测试替换
+int induction_variable_optimization()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    for (Instruction *func = code_head; func != NULL; func = func->next)
+    {
+        if (func->op != OP_FUNC_DEF)
+            continue;
+
+        bool changed = true;
+        int rounds = 0;
+        while (changed && rounds++ < 100)
+        {
+            changed = false;
+            CFG *cfg = build_cfg(func);
+            compute_dominators(cfg);
+            compute_liveness(cfg);
+
+            Loop **loops = NULL;
+            int loop_count = find_natural_loops(cfg, &loops);
+            for (int i = 0; i < loop_count; i++)
+            {
+                int count = reduce_induction_variables(cfg, loops[i]);
+                if (count > 0)
+                {
+                    total += count;
+                    changed = true;
+                    break;
+                }
+            }
+
+            free_loops(loops, loop_count);
+            free_cfg(cfg);
+        }
+    }
+
+    return total;
+}
+
+// ========================= 循环旋转 =========================
+
+// 循环头允许复制的最大指令数
+#define LOOP_ROTATION_MAX_HEADER 16
+
+// 返回块首标签，没有时在块前创建一个
+static Operand *ensure_block_label(CFG *cfg, BasicBlock *block)
+{
+    if (block->first->op == OP_LABEL)
+        return block->first->result;
+
+    Instruction *label = new_instruction(OP_LABEL, new_operand_label(), NULL, NULL);
+    Instruction *prev = find_prev_instruction(cfg->func_def, block->first);
+    insert_instruction_after(prev, label);
+    block->first = label;
+    return label->result;
+}
+
+// 循环头的比较跳转是否比较浮点值：浮点关系在有 NaN 时两个方向都不成立，不能取反
+static bool has_float_condition(CFG *cfg, BasicBlock *header)
+{
+    Instruction *branch = header->last;
+    if (!is_relational_branch(branch->op))
+        return false;
+
+    const char *function = cfg->func_def->result->u.name;
+    signed char **block_types = infer_temp_types(cfg, function);
+    signed char *types = block_types[header->id];
+    for (Instruction *inst = header->first; inst != branch; inst = inst->next)
+        transfer_temp_types(cfg, function, types, inst);
+    bool result = operand_value_type(cfg, function, types, branch->arg1) == TYPE_FLOAT ||
+                  operand_value_type(cfg, function, types, branch->arg2) == TYPE_FLOAT;
+    free_temp_types(cfg, block_types);
+    return result;
+}
+
+// 将 while 形式的循环旋转为带守卫的 do-while 形式：
+// 保留循环头作为入口前的测试，并在每个回边处复制一份测试，
+// 使每次迭代只执行一条条件跳转作为回边
+static bool rotate_loop(CFG *cfg, Loop *loop)
+{
+    BasicBlock *header = loop->header;
+    Instruction *branch = header->last;
+    if (!is_conditional_branch(branch->op))
+        return false;
+    if (header->first->op != OP_LABEL || header->succ_count != 2)
+        return false;
+
+    // 条件跳转的一个后继在循环内，另一个在循环外
+    BasicBlock *fallthrough = header->id + 1 < cfg->block_count ? cfg->blocks[header->id + 1] : NULL;
+    if (fallthrough == NULL)
+        return false;
+    BasicBlock *target = header->succs[0] == fallthrough ? header->succs[1] : header->succs[0];
+    if (loop_contains(loop, target) == loop_contains(loop, fallthrough))
+        return false;
+
+    // 回边必须都是跳向循环头的无条件跳转
+    int header_size = 0;
+    for (Instruction *inst = header->first;; inst = inst->next)
+    {
+        if (inst->op == OP_CALL || inst->op == OP_ARG)
+            return false;
+        header_size++;
+        if (inst == header->last)
+            break;
+    }
+    if (header_size > LOOP_ROTATION_MAX_HEADER)
+        return false;
+
+    for (int p = 0; p < header->pred_count; p++)
+    {
+        BasicBlock *pred = header->preds[p];
+        if (loop_contains(loop, pred) &&
+            (pred->last->op != OP_GOTO || !operands_equal(pred->last->arg1, header->first->result)))
+            return false;
+    }
+
+    // 条件为假时的去向：落入块只含一条跳转时直接跳到其目标
+    Operand *else_label;
+    if (fallthrough->first->op == OP_GOTO)
+        else_label = fallthrough->first->arg1;
+    else
+        else_label = ensure_block_label(cfg, fallthrough);
+
+    bool negate = !loop_contains(loop, target) && !has_float_condition(cfg, header);
+
+    // 循环头中定义、离开循环头后不再活跃的临时变量在副本中重新编号
+    int var_count = cfg->vars.count;
+    Operand **renamed = (Operand **)calloc(var_count + 1, sizeof(Operand *));
+    for (Instruction *inst = header->first;; inst = inst->next)
+    {
+        Operand *def = instruction_def(inst);
+        int index = operand_table_lookup(&cfg->vars, def);
+        if (index >= 0 && def->type == OPERAND_TEMP && renamed[index] == NULL)
+        {
+            bool live_after = false;
+            for (int s = 0; s < header->succ_count; s++)
+            {
+                if (is_live_in(cfg, header->succs[s], def))
+                    live_after = true;
+            }
+            if (!live_after)
+                renamed[index] = new_operand_temp();
+        }
+        if (inst == header->last)
+            break;
+    }
+
+    for (int p = 0; p < header->pred_count; p++)
+    {
+        BasicBlock *latch = header->preds[p];
+        if (!loop_contains(loop, latch))
+            continue;
+
+        // 用循环头测试的副本替换回边 GOTO
+        Instruction *jump = latch->last;
+        Instruction *pos = find_prev_instruction(cfg->func_def, jump);
+        for (Instruction *inst = header->first->next;; inst = inst->next)
+        {
+            Instruction *copy = new_instruction(inst->op, copy_operand(inst->result),
+                                                copy_operand(inst->arg1), copy_operand(inst->arg2));
+            Operand **slots[3] = {&copy->result, &copy->arg1, &copy->arg2};
+            for (int k = 0; k < 3; k++)
+            {
+                int index = operand_table_lookup(&cfg->vars, *slots[k]);
+                if (index >= 0 && renamed[index] != NULL)
+                {
+                    free_operand(*slots[k]);
+                    *slots[k] = copy_operand(renamed[index]);
+                }
+            }
+            insert_instruction_after(pos, copy);
+            pos = copy;
+            if (inst == header->last)
+                break;
+        }
+
+        // 跳转目标在循环外时取反条件，使条件跳转成为回边，退出走无条件跳转；
+        // 浮点比较不取反，条件成立时照原样跳出循环，否则无条件跳回循环体
+        Operand *exit_label = else_label;
+        if (negate)
+        {
+            exit_label = branch_target(branch);
+            pos->op = negate_branch(pos->op);
+            set_branch_target(pos, copy_operand(else_label));
+        }
+        Instruction *exit_jump = new_instruction(OP_GOTO, NULL, copy_operand(exit_label), NULL);
+        insert_instruction_after(pos, exit_jump);
+        unlink_instruction(exit_jump, jump);
+        free_instruction(jump);
+    }
+
+    for (int i = 0; i < var_count; i++)
+        free_operand(renamed[i]);
+    free(renamed);
+
+    opt_stats.loop_rotation_count++;
+    return true;
+}
+
+// 循环旋转：每个循环只旋转一次，旋转后原循环头成为入口守卫
+int loop_rotation()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    for (Instruction *func = code_head; func != NULL; func = func->next)
+    {
+        if (func->op != OP_FUNC_DEF)
+            continue;
+
+        bool changed = true;
+        int rounds = 0;
+        while (changed && rounds++ < 100)
+        {
+            changed = false;
+            CFG *cfg = build_cfg(func);
+            compute_dominators(cfg);
+            compute_liveness(cfg);
+
+            Loop **loops = NULL;
+            int loop_count = find_natural_loops(cfg, &loops);
+            for (int i = 0; i < loop_count; i++)
+            {
+                if (rotate_loop(cfg, loops[i]))
+                {
+                    total++;
+                    changed = true;
+                    break;
+                }
+            }
+
+            free_loops(loops, loop_count);
+            free_cfg(cfg);
+        }
+    }
+
+    return total;
+}
+
+// ========================= 循环展开 =========================
+
+// 模拟求迭代次数的上限，超过时放弃展开
+#define UNROLL_MAX_TRIP 100000
+
+// 部分展开后循环体的最大指令数
+#define UNROLL_MAX_BODY 256
+
+// 向前查找循环入口处归纳变量初值时最多经过的块数
+#define UNROLL_ENTRY_MAX_HOPS 8
+
+// 交换比较跳转的两个操作数时对应的关系：a < b 即 b > a
+static OpType mirror_branch(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return OP_IF_LT;
+    case OP_IF_LT:
+        return OP_IF_GT;
+    case OP_IF_GE:
+        return OP_IF_LE;
+    case OP_IF_LE:
+        return OP_IF_GE;
+    default:
+        return op;
+    }
+}
+
+static bool evaluate_relation(OpType op, long long a, long long b)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return a > b;
+    case OP_IF_LT:
+        return a < b;
+    case OP_IF_GE:
+        return a >= b;
+    case OP_IF_LE:
+        return a <= b;
+    case OP_IF_EQ:
+        return a == b;
+    case OP_IF_NE:
+        return a != b;
+    default:
+        return false;
+    }
+}
+
+// 计数循环：do-while 形式，回边为 IF v rel #bound GOTO header，
+// v 在回边所在块中按常量步长更新一次，进入循环时 v 为常量
+typedef struct CountedLoop
+{
+    Instruction *header_label;
+    Instruction *latch_branch;
+    Instruction *update;   // v := v + step
+    Operand *var;
+    int init;
+    int step;
+    OpType relation;       // v rel bound
+    int bound;
+    int trip_count;        // 循环体执行次数
+    int body_size;         // 不计标签的指令数
+} CountedLoop;
+
+// 沿唯一前驱向前查找进入循环时变量的常量值
+static bool find_entry_value(CFG *cfg, Loop *loop, Operand *var, int *value)
+{
+    BasicBlock *entry = NULL;
+    for (int p = 0; p < loop->header->pred_count; p++)
+    {
+        BasicBlock *pred = loop->header->preds[p];
+        if (loop_contains(loop, pred))
+            continue;
+        if (entry != NULL)
+            return false;
+        entry = pred;
+    }
+
+    for (int hops = 0; entry != NULL && hops < UNROLL_ENTRY_MAX_HOPS; hops++)
+    {
+        for (Instruction *inst = entry->last;; inst = find_prev_instruction(cfg->func_def, inst))
+        {
+            if (operands_equal(instruction_def(inst), var))
+            {
+                if (inst->op != OP_ASSIGN || inst->arg1->type != OPERAND_CONSTANT)
+                    return false;
+                *value = inst->arg1->u.int_value;
+                return true;
+            }
+            if (inst == entry->first)
+                break;
+        }
+        entry = entry->pred_count == 1 ? entry->preds[0] : NULL;
+    }
+    return false;
+}
+
+// 识别计数循环并求出迭代次数
+static bool analyze_counted_loop(CFG *cfg, Loop *loop, CountedLoop *info)
+{
+    BasicBlock *header = loop->header;
+    if (header->first->op != OP_LABEL)
+        return false;
+
+    // 循环块在指令顺序上连续，最后一块为唯一回边所在块，且是唯一出口
+    int last = header->id + loop->block_count - 1;
+    if (last >= cfg->block_count)
+        return false;
+    for (int b = header->id; b <= last; b++)
+    {
+        if (!loop_contains(loop, cfg->blocks[b]))
+            return false;
+    }
+    BasicBlock *latch = cfg->blocks[last];
+
+    Instruction *branch = latch->last;
+    if (!is_relational_branch(branch->op) || !operands_equal(branch_target(branch), header->first->result))
+        return false;
+    for (int b = header->id; b <= latch->id; b++)
+    {
+        BasicBlock *block = cfg->blocks[b];
+        if (block->last->op == OP_RETURN)
+            return false;
+        for (int s = 0; s < block->succ_count; s++)
+        {
+            if (!loop_contains(loop, block->succs[s]) && block != latch)
+                return false;
+        }
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            Operand *target = branch_target(inst);
+            if (inst != branch && target != NULL && operands_equal(target, header->first->result))
+                return false;
+            if (inst == block->last)
+                break;
+        }
+    }
+
+    // 回边条件规范为 v rel #bound
+    OpType relation = branch->op;
+    Operand *var = branch->arg1;
+    Operand *bound = branch->arg2;
+    if (var->type == OPERAND_CONSTANT)
+    {
+        relation = mirror_branch(relation);
+        var = branch->arg2;
+        bound = branch->arg1;
+    }
+    if (bound->type != OPERAND_CONSTANT || (var->type != OPERAND_VARIABLE && var->type != OPERAND_TEMP))
+        return false;
+    if (var->type == OPERAND_VARIABLE && is_global_variable(var->u.name))
+        return false;
+
+    // v 在循环中只定义一次，且在回边所在块中按常量步长更新
+    Instruction *update = NULL;
+    int body_size = 0;
+    for (Instruction *inst = header->first->next; inst != branch; inst = inst->next)
+    {
+        if (inst->op != OP_LABEL)
+            body_size++;
+        if (!operands_equal(instruction_def(inst), var))
+            continue;
+        if (update != NULL)
+            return false;
+        update = inst;
+    }
+    int step = 0;
+    if (update == NULL || !match_add_constant(update, var, &step) || step == 0)
+        return false;
+    for (Instruction *inst = update; inst != branch; inst = inst->next)
+    {
+        if (inst->op == OP_LABEL)
+            return false;
+    }
+
+    int init = 0;
+    if (!find_entry_value(cfg, loop, var, &init))
+        return false;
+
+    // 按 do-while 语义模拟，进入循环后先执行一次循环体
+    long long value = init;
+    long long trips = 0;
+    do
+    {
+        value += step;
+        trips++;
+        if (trips > UNROLL_MAX_TRIP || value > 2147483647LL || value < -2147483648LL)
+            return false;
+    } while (evaluate_relation(relation, value, bound->u.int_value));
+
+    info->header_label = header->first;
+    info->latch_branch = branch;
+    info->update = update;
+    info->var = var;
+    info->init = init;
+    info->step = step;
+    info->relation = relation;
+    info->bound = bound->u.int_value;
+    info->trip_count = (int)trips;
+    info->body_size = body_size;
+    return true;
+}
+
+// 复制一份循环体插到 pos 之后，返回最后插入的指令。循环体内定义的标签换成新标签；
+// value 非NULL时按已知的归纳变量值替换其使用，更新指令改为常量赋值并推进 *value
+static Instruction *copy_loop_body(CountedLoop *info, Instruction *pos, int *value)
+{
+    // 标签编号 -> 本副本中的新标签
+    int label_limit = label_count + 1;
+    Operand **label_map = (Operand **)calloc(label_limit, sizeof(Operand *));
+    for (Instruction *inst = info->header_label->next; inst != info->latch_branch; inst = inst->next)
+    {
+        if (inst->op == OP_LABEL && inst->result->type == OPERAND_LABEL && inst->result->u.temp_no < label_limit)
+            label_map[inst->result->u.temp_no] = new_operand_label();
+    }
+
+    for (Instruction *inst = info->header_label->next; inst != info->latch_branch; inst = inst->next)
+    {
+        Instruction *copy;
+        if (value != NULL && inst == info->update)
+        {
+            *value += info->step;
+            copy = new_instruction(OP_ASSIGN, copy_operand(info->var), new_operand_constant_int(*value), NULL);
+        }
+        else
+        {
+            copy = new_instruction(inst->op, copy_operand(inst->result), copy_operand(inst->arg1), copy_operand(inst->arg2));
+            Operand **slots[3] = {&copy->result, &copy->arg1, &copy->arg2};
+            for (int k = 0; k < 3; k++)
+            {
+                Operand *op = *slots[k];
+                if (op == NULL)
+                    continue;
+                if (op->type == OPERAND_LABEL && op->u.temp_no < label_limit && label_map[op->u.temp_no] != NULL)
+                {
+                    op->u.temp_no = label_map[op->u.temp_no]->u.temp_no;
+                }
+                else if (value != NULL && operands_equal(op, info->var) &&
+                         (k > 0 || copy->op == OP_ARG || copy->op == OP_RETURN))
+                {
+                    free_operand(op);
+                    *slots[k] = new_operand_constant_int(*value);
+                }
+            }
+        }
+        insert_instruction_after(pos, copy);
+        pos = copy;
+    }
+
+    for (int i = 0; i < label_limit; i++)
+        free_operand(label_map[i]);
+    free(label_map);
+    return pos;
+}
+
+// 删除从循环头标签到回边跳转的整个循环
+static void remove_loop_region(CFG *cfg, CountedLoop *info)
+{
+    Instruction *prev = find_prev_instruction(cfg->func_def, info->header_label);
+    bool last = false;
+    while (!last)
+    {
+        Instruction *inst = prev->next;
+        last = inst == info->latch_branch;
+        unlink_instruction(prev, inst);
+        free_instruction(inst);
+    }
+}
+
+// 完全展开：循环体复制 trip_count 份，每份中的归纳变量都是常量
+static void fully_unroll(CFG *cfg, CountedLoop *info)
+{
+    Instruction *pos = find_prev_instruction(cfg->func_def, info->header_label);
+    int value = info->init;
+    for (int i = 0; i < info->trip_count; i++)
+        pos = copy_loop_body(info, pos, &value);
+    remove_loop_region(cfg, info);
+}
+
+// 部分展开：在原循环前插入循环体复制 factor 份的主循环，执行 trip_count / factor 次；
+// 剩余的迭代由原循环作为余数循环完成，没有剩余时删除原循环。返回主循环头标签
+static Operand *partially_unroll(CFG *cfg, Loop *loop, CountedLoop *info, int factor)
+{
+    int groups = info->trip_count / factor;
+    int remainder = info->trip_count % factor;
+    long long limit = (long long)info->init + (long long)groups * factor * info->step;
+
+    Instruction *prev = find_prev_instruction(cfg->func_def, info->header_label);
+    Instruction *label = new_instruction(OP_LABEL, new_operand_label(), NULL, NULL);
+    insert_instruction_after(prev, label);
+
+    // 循环外跳向原循环头的边改为跳向主循环
+    for (int p = 0; p < loop->header->pred_count; p++)
+    {
+        BasicBlock *pred = loop->header->preds[p];
+        Operand *target = branch_target(pred->last);
+        if (!loop_contains(loop, pred) && target != NULL && operands_equal(target, info->header_label->result))
+            target->u.temp_no = label->result->u.temp_no;
+    }
+
+    Instruction *pos = label;
+    for (int i = 0; i < factor; i++)
+        pos = copy_loop_body(info, pos, NULL);
+
+    Instruction *branch = new_instruction(info->step > 0 ? OP_IF_LT : OP_IF_GT, copy_operand(label->result),
+                                          copy_operand(info->var), new_operand_constant_int((int)limit));
+    insert_instruction_after(pos, branch);
+
+    if (remainder == 0)
+        remove_loop_region(cfg, info);
+    return label->result;
+}
+
+static bool label_processed(int *labels, int count, int label)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (labels[i] == label)
+            return true;
+    }
+    return false;
+}
+
+// 计数循环展开：循环体总大小不超过 unroll_limit 时完全展开，
+// 否则按 unroll_factor 部分展开并保留余数循环。只展开最内层循环，每个循环只处理一次
+int loop_unrolling()
+{
+    int total = 0;
+
+    purge_dead_markers();
+    for (Instruction *func = code_head; func != NULL; func = func->next)
+    {
+        if (func->op != OP_FUNC_DEF)
+            continue;
+
+        int *processed = NULL;
+        int processed_count = 0;
+        bool changed = true;
+        int rounds = 0;
+        while (changed && rounds++ < 100)
+        {
+            changed = false;
+            CFG *cfg = build_cfg(func);
+            compute_dominators(cfg);
+
+            Loop **loops = NULL;
+            int loop_count = find_natural_loops(cfg, &loops);
+            for (int i = 0; i < loop_count && !changed; i++)
+            {
+                Loop *loop = loops[i];
+                bool innermost = true;
+                for (int j = 0; j < loop_count; j++)
+                {
+                    if (j != i && loops[j]->parent == loop)
+                        innermost = false;
+                }
+                if (!innermost || loop->header->first->op != OP_LABEL ||
+                    label_processed(processed, processed_count, loop->header->first->result->u.temp_no))
+                    continue;
+
+                processed = (int *)realloc(processed, (processed_count + 2) * sizeof(int));
+                processed[processed_count++] = loop->header->first->result->u.temp_no;
+
+                CountedLoop info;
+                if (!analyze_counted_loop(cfg, loop, &info))
+                    continue;
+
+                long long full_size = (long long)info.trip_count * info.body_size;
+                int factor = opt_options.unroll_factor;
+                if (full_size <= opt_options.unroll_limit)
+                {
+                    fully_unroll(cfg, &info);
+                    changed = true;
+                }
+                else if (factor > 1 && info.trip_count / factor >= 1 &&
+                         (long long)info.body_size * factor <= UNROLL_MAX_BODY)
+                {
+                    Operand *label = partially_unroll(cfg, loop, &info, factor);
+                    processed[processed_count++] = label->u.temp_no;
+                    changed = true;
+                }
+
+                if (changed)
+                {
+                    opt_stats.loop_unroll_count++;
+                    total++;
+                }
+            }
+
+            free_loops(loops, loop_count);
+            free_cfg(cfg);
+        }
+        free(processed);
+    }
+
+    return total;
+}
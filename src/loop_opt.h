@@ -0,0 +1,17 @@
+#ifndef LOOP_OPT_H
+#define LOOP_OPT_H
+
+#include "cfg.h"
+
+// 循环优化
+int loop_invariant_code_motion();
+int induction_variable_optimization();
+int loop_rotation();
+int loop_unrolling();
+
+// 循环优化辅助函数
+Instruction *create_preheader(CFG *cfg, Loop *loop);
+BasicBlock *block_of_instruction(CFG *cfg, Instruction *inst);
+int collect_loop_instructions(CFG *cfg, Loop *loop, Instruction ***insts_out, BasicBlock ***blocks_out);
+
+#endif
@@ -0,0 +1,842 @@
+#include "machine.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ========================= 操作数 =========================
+
+MOperand mop_none()
+{
+    MOperand op;
+    memset(&op, 0, sizeof(op));
+    op.kind = MOP_NONE;
+    op.reg = REG_NONE;
+    op.index = REG_NONE;
+    op.scale = 1;
+    op.frame_slot = -1;
+    return op;
+}
+
+MOperand mop_reg(int reg)
+{
+    MOperand op = mop_none();
+    op.kind = MOP_REG;
+    op.reg = reg;
+    return op;
+}
+
+MOperand mop_imm(long long value)
+{
+    MOperand op = mop_none();
+    op.kind = MOP_IMM;
+    op.imm = value;
+    return op;
+}
+
+MOperand mop_mem(int base, int disp)
+{
+    MOperand op = mop_none();
+    op.kind = MOP_MEM;
+    op.reg = base;
+    op.disp = disp;
+    return op;
+}
+
+MOperand mop_mem_index(int base, int index, int scale, int disp)
+{
+    MOperand op = mop_mem(base, disp);
+    op.index = index;
+    op.scale = scale;
+    return op;
+}
+
+MOperand mop_frame(int slot, int disp)
+{
+    MOperand op = mop_mem(REG_RBP, disp);
+    op.frame_slot = slot;
+    return op;
+}
+
+MOperand mop_rip(const char *symbol, int disp)
+{
+    MOperand op = mop_mem(REG_NONE, disp);
+    op.symbol = intern_symbol(symbol);
+    return op;
+}
+
+MOperand mop_label(int label)
+{
+    MOperand op = mop_none();
+    op.kind = MOP_LABEL;
+    op.label = label;
+    return op;
+}
+
+MOperand mop_symbol(const char *symbol)
+{
+    MOperand op = mop_none();
+    op.kind = MOP_SYMBOL;
+    op.symbol = intern_symbol(symbol);
+    return op;
+}
+
+bool mop_equal(MOperand a, MOperand b)
+{
+    if (a.kind != b.kind)
+        return false;
+    switch (a.kind)
+    {
+    case MOP_NONE:
+        return true;
+    case MOP_REG:
+        return a.reg == b.reg;
+    case MOP_IMM:
+        return a.imm == b.imm;
+    case MOP_MEM:
+        return a.reg == b.reg && a.index == b.index && (a.index == REG_NONE || a.scale == b.scale) &&
+               a.disp == b.disp && a.frame_slot == b.frame_slot && a.symbol == b.symbol;
+    case MOP_LABEL:
+        return a.label == b.label;
+    case MOP_SYMBOL:
+        return a.symbol == b.symbol;
+    }
+    return false;
+}
+
+// 驻留的符号名，整个编译过程中只增不减
+static char **symbol_pool = NULL;
+static int symbol_pool_count = 0;
+
+const char *intern_symbol(const char *name)
+{
+    for (int i = 0; i < symbol_pool_count; i++)
+    {
+        if (strcmp(symbol_pool[i], name) == 0)
+            return symbol_pool[i];
+    }
+    symbol_pool = (char **)realloc(symbol_pool, (symbol_pool_count + 1) * sizeof(char *));
+    symbol_pool[symbol_pool_count] = strdup(name);
+    return symbol_pool[symbol_pool_count++];
+}
+
+// ========================= 指令与函数 =========================
+
+MInst *new_minst(MOpcode op, int size, MOperand src, MOperand dst)
+{
+    MInst *inst = (MInst *)calloc(1, sizeof(MInst));
+    inst->op = op;
+    inst->size = size;
+    inst->src = src;
+    inst->dst = dst;
+    return inst;
+}
+
+MInst *minst_append(MFunction *mf, MOpcode op, int size, MOperand src, MOperand dst)
+{
+    MInst *inst = new_minst(op, size, src, dst);
+    inst->prev = mf->tail;
+    if (mf->tail)
+        mf->tail->next = inst;
+    else
+        mf->head = inst;
+    mf->tail = inst;
+    return inst;
+}
+
+void minst_insert_before(MFunction *mf, MInst *pos, MInst *inst)
+{
+    inst->next = pos;
+    inst->prev = pos->prev;
+    if (pos->prev)
+        pos->prev->next = inst;
+    else
+        mf->head = inst;
+    pos->prev = inst;
+}
+
+void minst_insert_after(MFunction *mf, MInst *pos, MInst *inst)
+{
+    inst->prev = pos;
+    inst->next = pos->next;
+    if (pos->next)
+        pos->next->prev = inst;
+    else
+        mf->tail = inst;
+    pos->next = inst;
+}
+
+void minst_remove(MFunction *mf, MInst *inst)
+{
+    if (inst->prev)
+        inst->prev->next = inst->next;
+    else
+        mf->head = inst->next;
+    if (inst->next)
+        inst->next->prev = inst->prev;
+    else
+        mf->tail = inst->prev;
+    free(inst);
+}
+
+MFunction *new_mfunction(const char *name)
+{
+    MFunction *mf = (MFunction *)calloc(1, sizeof(MFunction));
+    mf->name = strdup(name);
+    return mf;
+}
+
+int mfunction_new_vreg(MFunction *mf, RegClass rc)
+{
+    if (mf->vreg_count == mf->vreg_capacity)
+    {
+        mf->vreg_capacity = mf->vreg_capacity ? mf->vreg_capacity * 2 : 64;
+        mf->vreg_class = (RegClass *)realloc(mf->vreg_class, mf->vreg_capacity * sizeof(RegClass));
+    }
+    mf->vreg_class[mf->vreg_count] = rc;
+    return FIRST_VREG + mf->vreg_count++;
+}
+
+RegClass mfunction_vreg_class(MFunction *mf, int vreg)
+{
+    if (!IS_VREG(vreg))
+        return IS_XMM(vreg) ? RC_FLOAT : RC_INT;
+    return mf->vreg_class[vreg - FIRST_VREG];
+}
+
+int mfunction_new_object(MFunction *mf, int size, int align)
+{
+    if (mf->object_count == mf->object_capacity)
+    {
+        mf->object_capacity = mf->object_capacity ? mf->object_capacity * 2 : 16;
+        mf->objects = (FrameObject *)realloc(mf->objects, mf->object_capacity * sizeof(FrameObject));
+    }
+    FrameObject *object = &mf->objects[mf->object_count];
+    object->size = size;
+    object->align = align;
+    object->offset = 0;
+    return mf->object_count++;
+}
+
+void mprogram_add_function(MProgram *program, MFunction *mf)
+{
+    if (program->functions_tail)
+        program->functions_tail->next = mf;
+    else
+        program->functions = mf;
+    program->functions_tail = mf;
+}
+
+MGlobal *mprogram_add_global(MProgram *program, const char *name, int size, int align)
+{
+    MGlobal **link = &program->globals;
+    while (*link != NULL)
+    {
+        if (strcmp((*link)->name, name) == 0)
+            return *link;
+        link = &(*link)->next;
+    }
+    MGlobal *global = (MGlobal *)calloc(1, sizeof(MGlobal));
+    global->name = strdup(name);
+    global->size = size;
+    global->align = align;
+    *link = global;
+    return global;
+}
+
+MFunction *mprogram_find_function(MProgram *program, const char *name)
+{
+    for (MFunction *mf = program->functions; mf != NULL; mf = mf->next)
+    {
+        if (strcmp(mf->name, name) == 0)
+            return mf;
+    }
+    return NULL;
+}
+
+static void free_mfunction(MFunction *mf)
+{
+    MInst *inst = mf->head;
+    while (inst != NULL)
+    {
+        MInst *next = inst->next;
+        free(inst);
+        inst = next;
+    }
+    free(mf->name);
+    free(mf->vreg_class);
+    free(mf->objects);
+    free(mf);
+}
+
+void free_mprogram(MProgram *program)
+{
+    if (program == NULL)
+        return;
+    MFunction *mf = program->functions;
+    while (mf != NULL)
+    {
+        MFunction *next = mf->next;
+        free_mfunction(mf);
+        mf = next;
+    }
+    MGlobal *global = program->globals;
+    while (global != NULL)
+    {
+        MGlobal *next = global->next;
+        free(global->name);
+        free(global);
+        global = next;
+    }
+    free(program);
+}
+
+// ========================= 指令属性 =========================
+
+bool minst_is_float(MOpcode op)
+{
+    switch (op)
+    {
+    case M_MOVSS:
+    case M_ADDSS:
+    case M_SUBSS:
+    case M_MULSS:
+    case M_DIVSS:
+    case M_UCOMISS:
+    case M_XORPS:
+    case M_MOVUPS:
+    case M_ADDPS:
+    case M_SUBPS:
+    case M_MULPS:
+    case M_DIVPS:
+    case M_PADDD:
+    case M_PSUBD:
+    case M_PMULLD:
+    case M_BROADCAST:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 指令是否写 dst
+bool minst_writes_dst(MOpcode op)
+{
+    switch (op)
+    {
+    case M_CMP:
+    case M_TEST:
+    case M_UCOMISS:
+    case M_LABEL:
+    case M_JMP:
+    case M_JCC:
+    case M_CALL:
+    case M_RET:
+    case M_PUSH:
+    case M_CDQ:
+    case M_IDIV:
+    case M_LEAVE:
+    case M_VZEROUPPER:
+    case M_CPUID:
+    case M_XGETBV:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// 指令是否读 dst（双操作数运算与比较）
+bool minst_reads_dst(MOpcode op)
+{
+    switch (op)
+    {
+    case M_ADD:
+    case M_SUB:
+    case M_IMUL:
+    case M_AND:
+    case M_OR:
+    case M_XOR:
+    case M_NEG:
+    case M_SHL:
+    case M_SAR:
+    case M_CMP:
+    case M_TEST:
+    case M_ADDSS:
+    case M_SUBSS:
+    case M_MULSS:
+    case M_DIVSS:
+    case M_UCOMISS:
+    case M_XORPS:
+    case M_ADDPS:
+    case M_SUBPS:
+    case M_MULPS:
+    case M_DIVPS:
+    case M_PADDD:
+    case M_PSUBD:
+    case M_PMULLD:
+        return true;
+    default:
+        return false;
+    }
+}
+
+CondCode negate_cond(CondCode cc)
+{
+    switch (cc)
+    {
+    case CC_E:
+        return CC_NE;
+    case CC_NE:
+        return CC_E;
+    case CC_L:
+        return CC_GE;
+    case CC_LE:
+        return CC_G;
+    case CC_G:
+        return CC_LE;
+    case CC_GE:
+        return CC_L;
+    case CC_B:
+        return CC_AE;
+    case CC_BE:
+        return CC_A;
+    case CC_A:
+        return CC_BE;
+    case CC_AE:
+        return CC_B;
+    case CC_P:
+        return CC_NP;
+    case CC_NP:
+        return CC_P;
+    case CC_FE:
+        return CC_FNE;
+    case CC_FNE:
+        return CC_FE;
+    }
+    return cc;
+}
+
+// 交换比较的两个操作数后对应的条件码
+CondCode swap_cond(CondCode cc)
+{
+    switch (cc)
+    {
+    case CC_L:
+        return CC_G;
+    case CC_LE:
+        return CC_GE;
+    case CC_G:
+        return CC_L;
+    case CC_GE:
+        return CC_LE;
+    case CC_B:
+        return CC_A;
+    case CC_BE:
+        return CC_AE;
+    case CC_A:
+        return CC_B;
+    case CC_AE:
+        return CC_BE;
+    default:
+        return cc;
+    }
+}
+
+// ========================= 栈帧布局 =========================
+
+static const int callee_saved_regs[] = {REG_RBX, REG_R12, REG_R13, REG_R14, REG_R15};
+#define CALLEE_SAVED_COUNT ((int)(sizeof(callee_saved_regs) / sizeof(callee_saved_regs[0])))
+
+static void resolve_frame_operand(MFunction *mf, MOperand *op)
+{
+    if (op->kind == MOP_MEM && op->frame_slot >= 0)
+    {
+        op->disp += mf->objects[op->frame_slot].offset;
+        op->frame_slot = -1;
+    }
+}
+
+void layout_frame(MFunction *mf)
+{
+    // 被调用者保存寄存器的保存槽
+    int save_slot[CALLEE_SAVED_COUNT];
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++)
+        save_slot[i] = mf->used_callee_saved[callee_saved_regs[i]] ? mfunction_new_object(mf, 8, 8) : -1;
+
+    // 对象从 rbp 向低地址依次排列
+    int offset = 0;
+    for (int i = 0; i < mf->object_count; i++)
+    {
+        FrameObject *object = &mf->objects[i];
+        offset += object->size;
+        offset = (offset + object->align - 1) / object->align * object->align;
+        object->offset = -offset;
+    }
+    mf->frame_size = (offset + 15) / 16 * 16;
+
+    for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+    {
+        resolve_frame_operand(mf, &inst->src);
+        resolve_frame_operand(mf, &inst->dst);
+    }
+
+    // 序言：建立帧指针，分配栈帧，保存用到的被调用者保存寄存器
+    MInst *first = mf->head;
+    MInst *prologue[3 + CALLEE_SAVED_COUNT];
+    int count = 0;
+    prologue[count++] = new_minst(M_PUSH, 8, mop_reg(REG_RBP), mop_none());
+    prologue[count++] = new_minst(M_MOV, 8, mop_reg(REG_RSP), mop_reg(REG_RBP));
+    if (mf->frame_size > 0)
+        prologue[count++] = new_minst(M_SUB, 8, mop_imm(mf->frame_size), mop_reg(REG_RSP));
+    for (int i = 0; i < CALLEE_SAVED_COUNT; i++)
+    {
+        if (save_slot[i] >= 0)
+            prologue[count++] = new_minst(M_MOV, 8, mop_reg(callee_saved_regs[i]),
+                                          mop_mem(REG_RBP, mf->objects[save_slot[i]].offset));
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (first != NULL)
+            minst_insert_before(mf, first, prologue[i]);
+        else
+        {
+            prologue[i]->prev = mf->tail;
+            if (mf->tail)
+                mf->tail->next = prologue[i];
+            else
+                mf->head = prologue[i];
+            mf->tail = prologue[i];
+        }
+    }
+
+    // 尾声：每个 ret 之前恢复寄存器并拆除栈帧
+    for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != M_RET)
+            continue;
+        for (int i = 0; i < CALLEE_SAVED_COUNT; i++)
+        {
+            if (save_slot[i] >= 0)
+                minst_insert_before(mf, inst, new_minst(M_MOV, 8, mop_mem(REG_RBP, mf->objects[save_slot[i]].offset),
+                                                        mop_reg(callee_saved_regs[i])));
+        }
+        minst_insert_before(mf, inst, new_minst(M_LEAVE, 8, mop_none(), mop_none()));
+    }
+}
+
+// ========================= 汇编输出 =========================
+
+static const char *reg_names64[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+                                    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"};
+static const char *reg_names32[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+                                    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"};
+static const char *reg_names8[] = {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+                                   "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"};
+static const char *cond_names[] = {"e", "ne", "l", "le", "g", "ge", "b", "be", "a", "ae", "p", "np"};
+
+static char size_suffix(int size)
+{
+    return size == 1 ? 'b' : (size == 8 ? 'q' : 'l');
+}
+
+static void print_reg(FILE *fp, int reg, int size)
+{
+    if (IS_VREG(reg))
+        fprintf(fp, "%%v%d", reg - FIRST_VREG);
+    else if (IS_XMM(reg))
+        fprintf(fp, "%%%cmm%d", size == 32 ? 'y' : 'x', reg - REG_XMM0);
+    else if (size == 8)
+        fprintf(fp, "%%%s", reg_names64[reg]);
+    else if (size == 1)
+        fprintf(fp, "%%%s", reg_names8[reg]);
+    else
+        fprintf(fp, "%%%s", reg_names32[reg]);
+}
+
+static bool is_external_symbol(MProgram *program, const char *symbol)
+{
+    return program != NULL && mprogram_find_function(program, symbol) == NULL;
+}
+
+static void print_mop(FILE *fp, MProgram *program, MOperand op, int size)
+{
+    switch (op.kind)
+    {
+    case MOP_NONE:
+        break;
+    case MOP_REG:
+        print_reg(fp, op.reg, size);
+        break;
+    case MOP_IMM:
+        fprintf(fp, "$%lld", op.imm);
+        break;
+    case MOP_MEM:
+        if (op.symbol != NULL)
+        {
+            if (op.disp != 0)
+                fprintf(fp, "%s%+d(%%rip)", op.symbol, op.disp);
+            else
+                fprintf(fp, "%s(%%rip)", op.symbol);
+            break;
+        }
+        if (op.frame_slot >= 0)
+            fprintf(fp, "slot%d", op.frame_slot);
+        if (op.disp != 0 || (op.reg == REG_NONE && op.index == REG_NONE))
+            fprintf(fp, "%d", op.disp);
+        fprintf(fp, "(");
+        if (op.reg != REG_NONE)
+            print_reg(fp, op.reg, 8);
+        if (op.index != REG_NONE)
+        {
+            fprintf(fp, ",");
+            print_reg(fp, op.index, 8);
+            fprintf(fp, ",%d", op.scale);
+        }
+        fprintf(fp, ")");
+        break;
+    case MOP_LABEL:
+        fprintf(fp, ".L%d", op.label);
+        break;
+    case MOP_SYMBOL:
+        fprintf(fp, "%s%s", op.symbol, is_external_symbol(program, op.symbol) ? "@PLT" : "");
+        break;
+    }
+}
+
+// 输出 "助记符 src, dst"
+static void print_binary(FILE *fp, MProgram *program, const char *mnemonic, MInst *inst, int src_size, int dst_size)
+{
+    fprintf(fp, "\t%s\t", mnemonic);
+    print_mop(fp, program, inst->src, src_size);
+    fprintf(fp, ", ");
+    print_mop(fp, program, inst->dst, dst_size);
+    fprintf(fp, "\n");
+}
+
+static void print_sized(FILE *fp, MProgram *program, const char *base, MInst *inst)
+{
+    char mnemonic[16];
+    snprintf(mnemonic, sizeof(mnemonic), "%s%c", base, size_suffix(inst->size));
+    print_binary(fp, program, mnemonic, inst, inst->size, inst->size);
+}
+
+static void print_unary(FILE *fp, MProgram *program, const char *mnemonic, MOperand op, int size)
+{
+    fprintf(fp, "\t%s\t", mnemonic);
+    print_mop(fp, program, op, size);
+    fprintf(fp, "\n");
+}
+
+// 向量指令：XMM 形式为 "助记符 src, dst"；YMM 形式使用 AVX 编码，双操作数运算写成 "v助记符 src, dst, dst"
+static void print_vector(FILE *fp, MProgram *program, const char *mnemonic, MInst *inst)
+{
+    if (inst->size != 32)
+    {
+        print_binary(fp, program, mnemonic, inst, 16, 16);
+        return;
+    }
+    fprintf(fp, "\tv%s\t", mnemonic);
+    print_mop(fp, program, inst->src, 32);
+    fprintf(fp, ", ");
+    if (minst_reads_dst(inst->op))
+    {
+        print_mop(fp, program, inst->dst, 32);
+        fprintf(fp, ", ");
+    }
+    print_mop(fp, program, inst->dst, 32);
+    fprintf(fp, "\n");
+}
+
+void print_minst(FILE *fp, MProgram *program, MInst *inst)
+{
+    char mnemonic[16];
+    switch (inst->op)
+    {
+    case M_LABEL:
+        fprintf(fp, ".L%d:\n", inst->src.label);
+        break;
+    case M_MOV:
+        print_sized(fp, program, "mov", inst);
+        break;
+    case M_MOVSXD:
+        print_binary(fp, program, "movslq", inst, 4, 8);
+        break;
+    case M_MOVZB:
+        print_binary(fp, program, "movzbl", inst, 1, 4);
+        break;
+    case M_LEA:
+        print_binary(fp, program, inst->size == 8 ? "leaq" : "leal", inst, 8, inst->size);
+        break;
+    case M_ADD:
+        print_sized(fp, program, "add", inst);
+        break;
+    case M_SUB:
+        print_sized(fp, program, "sub", inst);
+        break;
+    case M_IMUL:
+        print_sized(fp, program, "imul", inst);
+        break;
+    case M_AND:
+        print_sized(fp, program, "and", inst);
+        break;
+    case M_OR:
+        print_sized(fp, program, "or", inst);
+        break;
+    case M_XOR:
+        print_sized(fp, program, "xor", inst);
+        break;
+    case M_SHL:
+        print_sized(fp, program, "shl", inst);
+        break;
+    case M_SAR:
+        print_sized(fp, program, "sar", inst);
+        break;
+    case M_CMP:
+        print_sized(fp, program, "cmp", inst);
+        break;
+    case M_TEST:
+        print_sized(fp, program, "test", inst);
+        break;
+    case M_NEG:
+        snprintf(mnemonic, sizeof(mnemonic), "neg%c", size_suffix(inst->size));
+        print_unary(fp, program, mnemonic, inst->dst, inst->size);
+        break;
+    case M_CDQ:
+        fprintf(fp, "\t%s\n", inst->size == 8 ? "cqto" : "cltd");
+        break;
+    case M_IDIV:
+        snprintf(mnemonic, sizeof(mnemonic), "idiv%c", size_suffix(inst->size));
+        print_unary(fp, program, mnemonic, inst->src, inst->size);
+        break;
+    case M_SETCC:
+        snprintf(mnemonic, sizeof(mnemonic), "set%s", cond_names[inst->cc]);
+        print_unary(fp, program, mnemonic, inst->dst, 1);
+        break;
+    case M_JMP:
+        print_unary(fp, program, "jmp", inst->src, 8);
+        break;
+    case M_JCC:
+        snprintf(mnemonic, sizeof(mnemonic), "j%s", cond_names[inst->cc]);
+        print_unary(fp, program, mnemonic, inst->src, 8);
+        break;
+    case M_CALL:
+        print_unary(fp, program, "call", inst->src, 8);
+        break;
+    case M_RET:
+        fprintf(fp, "\tret\n");
+        break;
+    case M_PUSH:
+        print_unary(fp, program, "pushq", inst->src, 8);
+        break;
+    case M_POP:
+        print_unary(fp, program, "popq", inst->dst, 8);
+        break;
+    case M_LEAVE:
+        fprintf(fp, "\tleave\n");
+        break;
+    case M_MOVSS:
+        print_binary(fp, program, "movss", inst, 4, 4);
+        break;
+    case M_ADDSS:
+        print_binary(fp, program, "addss", inst, 4, 4);
+        break;
+    case M_SUBSS:
+        print_binary(fp, program, "subss", inst, 4, 4);
+        break;
+    case M_MULSS:
+        print_binary(fp, program, "mulss", inst, 4, 4);
+        break;
+    case M_DIVSS:
+        print_binary(fp, program, "divss", inst, 4, 4);
+        break;
+    case M_UCOMISS:
+        print_binary(fp, program, "ucomiss", inst, 4, 4);
+        break;
+    case M_XORPS:
+        print_binary(fp, program, "xorps", inst, 4, 4);
+        break;
+    case M_CVTSI2SS:
+        print_binary(fp, program, "cvtsi2ssl", inst, 4, 4);
+        break;
+    case M_CVTTSS2SI:
+        print_binary(fp, program, "cvttss2si", inst, 4, 4);
+        break;
+    case M_MOVD:
+        print_binary(fp, program, "movd", inst, 4, 4);
+        break;
+    case M_MOVUPS:
+        print_vector(fp, program, "movups", inst);
+        break;
+    case M_ADDPS:
+        print_vector(fp, program, "addps", inst);
+        break;
+    case M_SUBPS:
+        print_vector(fp, program, "subps", inst);
+        break;
+    case M_MULPS:
+        print_vector(fp, program, "mulps", inst);
+        break;
+    case M_DIVPS:
+        print_vector(fp, program, "divps", inst);
+        break;
+    case M_PADDD:
+        print_vector(fp, program, "paddd", inst);
+        break;
+    case M_PSUBD:
+        print_vector(fp, program, "psubd", inst);
+        break;
+    case M_PMULLD:
+        print_vector(fp, program, "pmulld", inst);
+        break;
+    case M_BROADCAST:
+        if (inst->size == 32)
+            print_binary(fp, program, "vpbroadcastd", inst, 16, 32);
+        else
+        {
+            fprintf(fp, "\tpshufd\t$0, ");
+            print_mop(fp, program, inst->src, 16);
+            fprintf(fp, ", ");
+            print_mop(fp, program, inst->dst, 16);
+            fprintf(fp, "\n");
+        }
+        break;
+    case M_VZEROUPPER:
+        fprintf(fp, "\tvzeroupper\n");
+        break;
+    case M_CPUID:
+        fprintf(fp, "\tcpuid\n");
+        break;
+    case M_XGETBV:
+        fprintf(fp, "\txgetbv\n");
+        break;
+    default:
+        fprintf(fp, "\t# unknown opcode %d\n", inst->op);
+        break;
+    }
+}
+
+void print_mprogram(FILE *fp, MProgram *program)
+{
+    fprintf(fp, "\t.text\n");
+    for (MFunction *mf = program->functions; mf != NULL; mf = mf->next)
+    {
+        fprintf(fp, "\n\t%s\t%s\n", mf->weak ? ".weak" : ".globl", mf->name);
+        fprintf(fp, "\t.type\t%s, @function\n", mf->name);
+        fprintf(fp, "%s:\n", mf->name);
+        for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+            print_minst(fp, program, inst);
+        fprintf(fp, "\t.size\t%s, .-%s\n", mf->name, mf->name);
+    }
+
+    if (program->globals != NULL)
+        fprintf(fp, "\n\t.bss\n");
+    for (MGlobal *global = program->globals; global != NULL; global = global->next)
+    {
+        fprintf(fp, "\t%s\t%s\n", global->weak ? ".weak" : ".globl", global->name);
+        fprintf(fp, "\t.align\t%d\n", global->align);
+        fprintf(fp, "\t.type\t%s, @object\n", global->name);
+        fprintf(fp, "\t.size\t%s, %d\n", global->name, global->size);
+        fprintf(fp, "%s:\n", global->name);
+        fprintf(fp, "\t.zero\t%d\n", global->size);
+    }
+
+    fprintf(fp, "\n\t.section\t.note.GNU-stack,\"\",@progbits\n");
+}
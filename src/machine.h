@@ -0,0 +1,261 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// x86-64 物理寄存器，编号与指令编码中的寄存器号一致（XMM 寄存器减去 REG_XMM0）
+typedef enum
+{
+    REG_RAX,
+    REG_RCX,
+    REG_RDX,
+    REG_RBX,
+    REG_RSP,
+    REG_RBP,
+    REG_RSI,
+    REG_RDI,
+    REG_R8,
+    REG_R9,
+    REG_R10,
+    REG_R11,
+    REG_R12,
+    REG_R13,
+    REG_R14,
+    REG_R15,
+    REG_XMM0,
+    REG_XMM1,
+    REG_XMM2,
+    REG_XMM3,
+    REG_XMM4,
+    REG_XMM5,
+    REG_XMM6,
+    REG_XMM7,
+    REG_XMM8,
+    REG_XMM9,
+    REG_XMM10,
+    REG_XMM11,
+    REG_XMM12,
+    REG_XMM13,
+    REG_XMM14,
+    REG_XMM15,
+    PHYS_REG_COUNT
+} PhysReg;
+
+#define REG_NONE -1
+
+// 虚拟寄存器从 FIRST_VREG 开始编号，寄存器分配后全部替换为物理寄存器或栈槽
+#define FIRST_VREG 64
+#define IS_VREG(r) ((r) >= FIRST_VREG)
+#define IS_XMM(r) ((r) >= REG_XMM0 && (r) <= REG_XMM15)
+
+// 寄存器类别：整数（含指针）与 SSE 浮点
+typedef enum
+{
+    RC_INT,
+    RC_FLOAT
+} RegClass;
+
+// 条件码，用于 jcc / setcc
+typedef enum
+{
+    CC_E,
+    CC_NE,
+    CC_L,
+    CC_LE,
+    CC_G,
+    CC_GE,
+    CC_B,
+    CC_BE,
+    CC_A,
+    CC_AE,
+    CC_P,
+    CC_NP,
+    // 浮点相等（ZF=1 且 PF=0）与不等（ZF=0 或 PF=1），由后端展开为两条 jcc/setcc
+    CC_FE,
+    CC_FNE
+} CondCode;
+
+// 机器操作数
+typedef enum
+{
+    MOP_NONE,
+    MOP_REG,    // 寄存器
+    MOP_IMM,    // 立即数
+    MOP_MEM,    // 内存：disp(base, index, scale)，或 symbol+disp(%rip)
+    MOP_LABEL,  // 函数内标签
+    MOP_SYMBOL  // 函数名（call 的目标）
+} MOperandKind;
+
+typedef struct MOperand
+{
+    MOperandKind kind;
+    int reg;            // MOP_REG：寄存器；MOP_MEM：基址寄存器（REG_NONE 表示无）
+    int index;          // MOP_MEM：变址寄存器（REG_NONE 表示无）
+    int scale;          // MOP_MEM：变址比例 1/2/4/8
+    int disp;           // MOP_MEM：偏移
+    int frame_slot;     // MOP_MEM：相对的栈帧对象（-1 表示无），栈帧布局后并入 disp
+    long long imm;      // MOP_IMM
+    int label;          // MOP_LABEL
+    const char *symbol; // MOP_SYMBOL；MOP_MEM 中非NULL表示 RIP 相对寻址
+} MOperand;
+
+// 机器指令操作码（AT&T 语义：src 在前，dst 在后）
+typedef enum
+{
+    M_LABEL,     // 标签
+    M_MOV,       // dst = src
+    M_MOVSXD,    // dst(64) = 符号扩展 src(32)
+    M_MOVZB,     // dst(32) = 零扩展 src(8)
+    M_LEA,       // dst = &src
+    M_ADD,       // dst += src
+    M_SUB,       // dst -= src
+    M_IMUL,      // dst *= src（dst 必须是寄存器）
+    M_AND,       // dst &= src
+    M_OR,        // dst |= src
+    M_XOR,       // dst ^= src
+    M_NEG,       // dst = -dst
+    M_SHL,       // dst <<= src（src 为立即数）
+    M_SAR,       // dst >>= src（算术右移，src 为立即数）
+    M_CMP,       // 比较 dst - src，设置标志
+    M_TEST,      // 比较 dst & src，设置标志
+    M_CDQ,       // edx:eax = 符号扩展 eax
+    M_IDIV,      // eax = edx:eax / src，edx = 余数
+    M_SETCC,     // dst(8) = cc
+    M_JMP,       // 跳转到 src
+    M_JCC,       // 条件成立时跳转到 src
+    M_CALL,      // 调用 src
+    M_RET,       // 返回，src 为存放返回值的寄存器（MOP_NONE 表示无返回值）
+    M_PUSH,      // 压栈 src
+    M_POP,       // 出栈到 dst
+    M_LEAVE,     // rsp = rbp; pop rbp
+    M_MOVSS,     // 单精度浮点传送
+    M_ADDSS,
+    M_SUBSS,
+    M_MULSS,
+    M_DIVSS,
+    M_UCOMISS,   // 比较 dst 与 src，按无符号条件码设置标志
+    M_XORPS,
+    M_CVTSI2SS,  // dst(xmm) = (float)src(32)
+    M_CVTTSS2SI, // dst(32) = (int)src(xmm)，向零截断
+    M_MOVD,      // dst(xmm) = src(32) 的位模式
+    M_MOVUPS,    // 向量传送（非对齐），以下向量指令的 size 为 16（XMM）或 32（YMM，AVX 编码）
+    M_ADDPS,     // 单精度浮点逐通道运算
+    M_SUBPS,
+    M_MULPS,
+    M_DIVPS,
+    M_PADDD,     // 32 位整数逐通道运算
+    M_PSUBD,
+    M_PMULLD,    // 只有 YMM 形式（SSE2 没有 32 位整数乘法）
+    M_BROADCAST, // 把 src（XMM）低 32 位复制到 dst 的每个通道：pshufd $0 / vpbroadcastd
+    M_VZEROUPPER,// 清除 YMM 的高半部分，避免之后的 SSE 指令付出状态切换的代价
+    M_CPUID,     // eax、ebx、ecx、edx = cpuid(eax, ecx)
+    M_XGETBV,    // edx:eax = XCR[ecx]
+    M_OPCODE_COUNT
+} MOpcode;
+
+// 机器指令
+typedef struct MInst
+{
+    MOpcode op;
+    int size;           // 整数操作宽度（1/4/8 字节），标量浮点指令为4，向量指令为16/32
+    CondCode cc;        // M_JCC / M_SETCC
+    MOperand src;
+    MOperand dst;
+    int int_args;       // M_CALL：经整数寄存器传递的参数个数
+    int float_args;     // M_CALL：经 XMM 寄存器传递的参数个数
+    struct MInst *prev;
+    struct MInst *next;
+} MInst;
+
+// 栈帧对象：局部数组、溢出槽、被调用者保存寄存器的保存槽
+typedef struct FrameObject
+{
+    int size;
+    int align;
+    int offset;         // 相对 rbp 的偏移，布局后有效
+} FrameObject;
+
+// 机器函数
+typedef struct MFunction
+{
+    char *name;
+    bool weak;          // 弱符号（缺省运行时函数）
+    MInst *head;
+    MInst *tail;
+    RegClass *vreg_class;   // 按虚拟寄存器编号减 FIRST_VREG 索引
+    int vreg_count;
+    int vreg_capacity;
+    FrameObject *objects;
+    int object_count;
+    int object_capacity;
+    int frame_size;
+    bool used_callee_saved[PHYS_REG_COUNT];
+    struct MFunction *next;
+} MFunction;
+
+// 全局数据对象，存放在 .bss 中
+typedef struct MGlobal
+{
+    char *name;
+    int size;
+    int align;
+    bool weak;          // 弱符号（运行时函数使用的缓存）
+    struct MGlobal *next;
+} MGlobal;
+
+// 机器级程序
+typedef struct MProgram
+{
+    MFunction *functions;
+    MFunction *functions_tail;
+    MGlobal *globals;
+} MProgram;
+
+// 操作数构造
+MOperand mop_none();
+MOperand mop_reg(int reg);
+MOperand mop_imm(long long value);
+MOperand mop_mem(int base, int disp);
+MOperand mop_mem_index(int base, int index, int scale, int disp);
+MOperand mop_frame(int slot, int disp);
+MOperand mop_rip(const char *symbol, int disp);
+MOperand mop_label(int label);
+MOperand mop_symbol(const char *symbol);
+bool mop_equal(MOperand a, MOperand b);
+
+// 符号名驻留：操作数中的符号名指向驻留的字符串，不单独释放
+const char *intern_symbol(const char *name);
+
+// 指令构造与链表操作
+MInst *new_minst(MOpcode op, int size, MOperand src, MOperand dst);
+MInst *minst_append(MFunction *mf, MOpcode op, int size, MOperand src, MOperand dst);
+void minst_insert_before(MFunction *mf, MInst *pos, MInst *inst);
+void minst_insert_after(MFunction *mf, MInst *pos, MInst *inst);
+void minst_remove(MFunction *mf, MInst *inst);
+
+// 函数与程序
+MFunction *new_mfunction(const char *name);
+int mfunction_new_vreg(MFunction *mf, RegClass rc);
+RegClass mfunction_vreg_class(MFunction *mf, int vreg);
+int mfunction_new_object(MFunction *mf, int size, int align);
+void mprogram_add_function(MProgram *program, MFunction *mf);
+MGlobal *mprogram_add_global(MProgram *program, const char *name, int size, int align);
+MFunction *mprogram_find_function(MProgram *program, const char *name);
+void free_mprogram(MProgram *program);
+
+// 指令属性
+bool minst_is_float(MOpcode op);
+bool minst_writes_dst(MOpcode op);
+bool minst_reads_dst(MOpcode op);
+CondCode negate_cond(CondCode cc);
+CondCode swap_cond(CondCode cc);
+
+// 栈帧布局：为栈帧对象分配 rbp 偏移，把栈帧操作数改写为 rbp 相对寻址，插入序言与尾声
+void layout_frame(MFunction *mf);
+
+// 输出 GNU as（AT&T 语法）汇编
+void print_minst(FILE *fp, MProgram *program, MInst *inst);
+void print_mprogram(FILE *fp, MProgram *program);
+
+#endif
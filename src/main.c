@@ -1,8 +1,15 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "tree.h"
 #include "semantic.h"
 #include "codegen.h"
+#include "x86_backend.h"
+#include "interp.h"
+#include "jit.h"
+#include "elf_writer.h"
+#include "c_backend.h"
+#include "llvm_backend.h"
 
 extern int yyparse();
 extern void yyrestart(FILE *);
@@ -15,6 +22,25 @@ void print_usage(const char *program_name)
     printf("Usage: %s [options] input_file\n", program_name);
     printf("Options:\n");
     printf("  -O, --optimize    Enable code optimization\n");
+    printf("  --inline-threshold=N  Inline functions with at most N instructions (0 disables, default %d)\n",
+           DEFAULT_INLINE_THRESHOLD);
+    printf("  --specialize-budget=N  Allow function specialization to grow code by N%% (0 disables, default %d)\n",
+           DEFAULT_SPECIALIZE_BUDGET);
+    printf("  --unroll-factor=N  Partially unroll counted loops N times (1 disables, default %d)\n",
+           DEFAULT_UNROLL_FACTOR);
+    printf("  --unroll-limit=N  Fully unroll counted loops up to N instructions (0 disables, default %d)\n",
+           DEFAULT_UNROLL_LIMIT);
+    printf("  --remove-dead-functions  Drop functions unreachable from main\n");
+    printf("  --roots=f,g,...   Drop functions unreachable from the given root functions\n");
+    printf("  --bounds-check    Check array indices at run time (call %s on failure)\n", BOUNDS_CHECK_FAIL_FUNCTION);
+    printf("  -S                Generate x86-64 assembly (GNU as, System V ABI)\n");
+    printf("  -c                Generate an ELF64 relocatable object file (no assembler needed)\n");
+    printf("  -o FILE           Write the assembly or object file to FILE (default output.s / output.o)\n");
+    printf("  --emit-c=FILE     Translate the intermediate code to C source (compile with gcc -O2)\n");
+    printf("  --emit-llvm=FILE  Write the intermediate code as textual LLVM IR (.ll)\n");
+    printf("  --llvm-typed-pointers  Use typed pointers in the LLVM IR (LLVM 14 and older)\n");
+    printf("  --run             Interpret the intermediate code and exit with main's return value\n");
+    printf("  --jit             Compile to machine code in memory, run it and exit with main's return value\n");
     printf("  -h, --help        Show this help message\n");
     printf("  -v, --verbose     Verbose output\n");
 }
@@ -23,7 +49,16 @@ int main(int argc, char **argv)
 {
     bool enable_optimization = false;
     bool verbose = false;
+    bool emit_assembly = false;
+    bool emit_object = false;
+    bool run = false;
+    bool jit = false;
+    int exit_code = 0;
     char *input_file = NULL;
+    char *output_file = NULL;
+    char *c_file = NULL;
+    char *llvm_file = NULL;
+    bool llvm_typed_pointers = false;
 
     // 解析命令行参数
     for (int i = 1; i < argc; i++)
@@ -32,6 +67,75 @@ int main(int argc, char **argv)
         {
             enable_optimization = true;
         }
+        else if (strncmp(argv[i], "--inline-threshold=", 19) == 0)
+        {
+            opt_options.inline_threshold = atoi(argv[i] + 19);
+        }
+        else if (strncmp(argv[i], "--specialize-budget=", 20) == 0)
+        {
+            opt_options.specialize_budget = atoi(argv[i] + 20);
+        }
+        else if (strncmp(argv[i], "--unroll-factor=", 16) == 0)
+        {
+            opt_options.unroll_factor = atoi(argv[i] + 16);
+        }
+        else if (strncmp(argv[i], "--unroll-limit=", 15) == 0)
+        {
+            opt_options.unroll_limit = atoi(argv[i] + 15);
+        }
+        else if (strcmp(argv[i], "--remove-dead-functions") == 0)
+        {
+            opt_options.remove_dead_functions = true;
+        }
+        else if (strcmp(argv[i], "--bounds-check") == 0)
+        {
+            array_bounds_check = true;
+        }
+        else if (strncmp(argv[i], "--roots=", 8) == 0)
+        {
+            // 逗号分隔的根函数列表
+            opt_options.remove_dead_functions = true;
+            char *list = strdup(argv[i] + 8);
+            for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ","))
+            {
+                opt_options.function_roots = (char **)realloc(opt_options.function_roots,
+                                                              (opt_options.function_root_count + 1) * sizeof(char *));
+                opt_options.function_roots[opt_options.function_root_count++] = strdup(name);
+            }
+            free(list);
+        }
+        else if (strcmp(argv[i], "-S") == 0)
+        {
+            emit_assembly = true;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            emit_object = true;
+        }
+        else if (strncmp(argv[i], "--emit-c=", 9) == 0)
+        {
+            c_file = argv[i] + 9;
+        }
+        else if (strncmp(argv[i], "--emit-llvm=", 12) == 0)
+        {
+            llvm_file = argv[i] + 12;
+        }
+        else if (strcmp(argv[i], "--llvm-typed-pointers") == 0)
+        {
+            llvm_typed_pointers = true;
+        }
+        else if (strcmp(argv[i], "--run") == 0)
+        {
+            run = true;
+        }
+        else if (strcmp(argv[i], "--jit") == 0)
+        {
+            jit = true;
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            output_file = argv[++i];
+        }
         else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
         {
             verbose = true;
@@ -118,8 +222,70 @@ int main(int argc, char **argv)
                 save_code_to_file("output.ir");
                 printf("\nIntermediate code saved to output.ir\n");
             }
+
+            // 生成 x86-64 汇编
+            if (emit_assembly)
+            {
+                const char *asm_file = output_file ? output_file : "output.s";
+                if (!write_x86_assembly(asm_file))
+                    return 1;
+                printf("Assembly saved to %s\n", asm_file);
+                print_register_allocation_stats();
+            }
+
+            // 直接编码为机器代码，写出 ELF 目标文件
+            if (emit_object)
+            {
+                const char *object_file = output_file ? output_file : "output.o";
+                if (!write_elf_object(object_file))
+                    return 1;
+                printf("Object file saved to %s\n", object_file);
+            }
+
+            // 生成 C 源代码
+            if (c_file != NULL)
+            {
+                if (!write_c_source(c_file))
+                    return 1;
+                printf("C source saved to %s\n", c_file);
+            }
+
+            // 生成 LLVM IR
+            if (llvm_file != NULL)
+            {
+                if (!write_llvm_ir(llvm_file, llvm_typed_pointers))
+                    return 1;
+                printf("LLVM IR saved to %s\n", llvm_file);
+            }
+
+            // 解释执行（优化前后各自运行一次可比较执行的指令数）
+            if (run)
+            {
+                InterpResult result;
+                printf("\n=== Program Execution ===\n");
+                if (!run_program(&result))
+                    return 1;
+                printf("Return value: %d\n", result.return_value);
+                printf("Executed instructions: %lld\n", result.step_count);
+                printf("Execution time: %.3f ms\n", result.elapsed_ms);
+                exit_code = result.return_value;
+            }
+
+            // 即时编译为机器代码后在本进程中执行
+            if (jit)
+            {
+                JitResult result;
+                printf("\n=== JIT Execution ===\n");
+                if (!jit_run_program(&result))
+                    return 1;
+                printf("Return value: %d\n", result.return_value);
+                printf("Code size: %d bytes\n", result.code_size);
+                printf("Compile time: %.3f ms\n", result.compile_ms);
+                printf("Execution time: %.3f ms\n", result.elapsed_ms);
+                exit_code = result.return_value;
+            }
         }
     }
 
-    return 0;
+    return exit_code;
 }
\ No newline at end of file
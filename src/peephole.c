@@ -0,0 +1,379 @@
+#include "peephole.h"
+#include "cfg.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========================= 规则描述宏 =========================
+
+#define NONE {PAT_NONE, 0}
+#define ANY(n) {PAT_ANY, n}
+#define CONST(n) {PAT_CONST, n}
+#define INT(v) {PAT_INT, v}
+#define TEMP(n) {PAT_TEMP, n}
+#define ONCE(n) {PAT_ONCE, n}
+
+#define R_NONE {REP_NONE, 0, 0, OP_ASSIGN}
+#define META(n) {REP_META, n, 0, OP_ASSIGN}
+#define R_INT(v) {REP_INT, v, 0, OP_ASSIGN}
+#define FOLD(op, a, b) {REP_FOLD, a, b, op}
+
+// x := c1 op c2  ->  x := fold(c1 op c2)
+#define FOLD_BINARY(name, op, guard) \
+    {name, 1, {{op, ANY(0), CONST(1), CONST(2)}}, guard, 1, {{OP_ASSIGN, META(0), FOLD(op, 1, 2), R_NONE}}, &opt_stats.constant_folding_count}
+
+// t := a op b; x := t（t只在此处使用）  ->  x := a op b
+#define MERGE_TEMP(name, op) \
+    {name, 2, {{op, ONCE(0), ANY(1), ANY(2)}, {OP_ASSIGN, ANY(3), ONCE(0), NONE}}, NULL, 1, {{op, META(3), META(1), META(2)}}, &opt_stats.peephole_count}
+
+#define MERGE_TEMP_UNARY(name, op) \
+    {name, 2, {{op, ONCE(0), ANY(1), NONE}, {OP_ASSIGN, ANY(3), ONCE(0), NONE}}, NULL, 1, {{op, META(3), META(1), R_NONE}}, &opt_stats.peephole_count}
+
+// ========================= 规则条件 =========================
+
+// 除数非零且不会溢出
+static bool division_foldable(Operand **meta)
+{
+    int a = meta[1]->u.int_value;
+    int b = meta[2]->u.int_value;
+    return b != 0 && !(a == INT_MIN && b == -1);
+}
+
+// x := a; x := b 中 b 不读取 x
+static bool second_assign_independent(Operand **meta)
+{
+    return !operands_equal(meta[0], meta[2]);
+}
+
+// ========================= 规则表 =========================
+
+// 同一首条操作码的规则按表中顺序尝试，先列出更具体的规则
+static PeepholeRule peephole_rules[] = {
+    // 代数恒等式
+    {"add-zero", 1, {{OP_ADD, ANY(0), ANY(1), INT(0)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"zero-add", 1, {{OP_ADD, ANY(0), INT(0), ANY(1)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"sub-zero", 1, {{OP_SUB, ANY(0), ANY(1), INT(0)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"zero-sub", 1, {{OP_SUB, ANY(0), INT(0), ANY(1)}}, NULL, 1, {{OP_NEG, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"sub-self", 1, {{OP_SUB, ANY(0), ANY(1), ANY(1)}}, NULL, 1, {{OP_ASSIGN, META(0), R_INT(0), R_NONE}}, &opt_stats.constant_folding_count},
+    {"mul-one", 1, {{OP_MUL, ANY(0), ANY(1), INT(1)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"one-mul", 1, {{OP_MUL, ANY(0), INT(1), ANY(1)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"mul-zero", 1, {{OP_MUL, ANY(0), ANY(1), INT(0)}}, NULL, 1, {{OP_ASSIGN, META(0), R_INT(0), R_NONE}}, &opt_stats.constant_folding_count},
+    {"zero-mul", 1, {{OP_MUL, ANY(0), INT(0), ANY(1)}}, NULL, 1, {{OP_ASSIGN, META(0), R_INT(0), R_NONE}}, &opt_stats.constant_folding_count},
+    {"mul-minus-one", 1, {{OP_MUL, ANY(0), ANY(1), INT(-1)}}, NULL, 1, {{OP_NEG, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"div-one", 1, {{OP_DIV, ANY(0), ANY(1), INT(1)}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"and-zero", 1, {{OP_AND, ANY(0), ANY(1), INT(0)}}, NULL, 1, {{OP_ASSIGN, META(0), R_INT(0), R_NONE}}, &opt_stats.constant_folding_count},
+    {"zero-and", 1, {{OP_AND, ANY(0), INT(0), ANY(1)}}, NULL, 1, {{OP_ASSIGN, META(0), R_INT(0), R_NONE}}, &opt_stats.constant_folding_count},
+
+    // 常量折叠
+    FOLD_BINARY("fold-add", OP_ADD, NULL),
+    FOLD_BINARY("fold-sub", OP_SUB, NULL),
+    FOLD_BINARY("fold-mul", OP_MUL, NULL),
+    FOLD_BINARY("fold-div", OP_DIV, division_foldable),
+    FOLD_BINARY("fold-gt", OP_GT, NULL),
+    FOLD_BINARY("fold-lt", OP_LT, NULL),
+    FOLD_BINARY("fold-ge", OP_GE, NULL),
+    FOLD_BINARY("fold-le", OP_LE, NULL),
+    FOLD_BINARY("fold-eq", OP_EQ, NULL),
+    FOLD_BINARY("fold-ne", OP_NE, NULL),
+    FOLD_BINARY("fold-and", OP_AND, NULL),
+    FOLD_BINARY("fold-or", OP_OR, NULL),
+    {"fold-neg", 1, {{OP_NEG, ANY(0), CONST(1), NONE}}, NULL, 1, {{OP_ASSIGN, META(0), FOLD(OP_NEG, 1, 1), R_NONE}}, &opt_stats.constant_folding_count},
+    {"fold-not", 1, {{OP_NOT, ANY(0), CONST(1), NONE}}, NULL, 1, {{OP_ASSIGN, META(0), FOLD(OP_NOT, 1, 1), R_NONE}}, &opt_stats.constant_folding_count},
+
+    // 强度削弱
+    {"mul-two", 1, {{OP_MUL, ANY(0), ANY(1), INT(2)}}, NULL, 1, {{OP_ADD, META(0), META(1), META(1)}}, &opt_stats.strength_reduction_count},
+    {"two-mul", 1, {{OP_MUL, ANY(0), INT(2), ANY(1)}}, NULL, 1, {{OP_ADD, META(0), META(1), META(1)}}, &opt_stats.strength_reduction_count},
+
+    // 连续取负、取反
+    {"double-neg", 2, {{OP_NEG, ONCE(0), ANY(1), NONE}, {OP_NEG, ANY(2), ONCE(0), NONE}}, NULL, 1, {{OP_ASSIGN, META(2), META(1), R_NONE}}, &opt_stats.peephole_count},
+    {"double-not", 2, {{OP_NOT, ONCE(0), ANY(1), NONE}, {OP_NOT, ANY(2), ONCE(0), NONE}}, NULL, 1, {{OP_NE, META(2), META(1), R_INT(0)}}, &opt_stats.peephole_count},
+
+    // 运算结果经临时变量转存
+    MERGE_TEMP("merge-add", OP_ADD),
+    MERGE_TEMP("merge-sub", OP_SUB),
+    MERGE_TEMP("merge-mul", OP_MUL),
+    MERGE_TEMP("merge-div", OP_DIV),
+    MERGE_TEMP("merge-gt", OP_GT),
+    MERGE_TEMP("merge-lt", OP_LT),
+    MERGE_TEMP("merge-ge", OP_GE),
+    MERGE_TEMP("merge-le", OP_LE),
+    MERGE_TEMP("merge-eq", OP_EQ),
+    MERGE_TEMP("merge-ne", OP_NE),
+    MERGE_TEMP("merge-and", OP_AND),
+    MERGE_TEMP("merge-or", OP_OR),
+    MERGE_TEMP("merge-array-get", OP_ARRAY_GET),
+    MERGE_TEMP_UNARY("merge-neg", OP_NEG),
+    MERGE_TEMP_UNARY("merge-not", OP_NOT),
+    MERGE_TEMP_UNARY("merge-call", OP_CALL),
+    MERGE_TEMP_UNARY("merge-copy", OP_ASSIGN),
+
+    // 冗余赋值
+    {"copy-back", 2, {{OP_ASSIGN, ANY(0), ANY(1), NONE}, {OP_ASSIGN, ANY(1), ANY(0), NONE}}, NULL, 1, {{OP_ASSIGN, META(0), META(1), R_NONE}}, &opt_stats.redundant_assignment_count},
+    {"overwritten-copy", 2, {{OP_ASSIGN, ANY(0), ANY(1), NONE}, {OP_ASSIGN, ANY(0), ANY(2), NONE}}, second_assign_independent, 1, {{OP_ASSIGN, META(0), META(2), R_NONE}}, &opt_stats.redundant_assignment_count},
+};
+
+#define PEEPHOLE_RULE_COUNT ((int)(sizeof(peephole_rules) / sizeof(peephole_rules[0])))
+
+// ========================= 规则编译 =========================
+
+// 按首条指令操作码分派：rules_by_op[op] 为以 op 开头的规则下标列表
+static int *rules_by_op[OP_FUNC_END + 1];
+static int rule_count_by_op[OP_FUNC_END + 1];
+static bool rules_compiled = false;
+
+static void compile_rules()
+{
+    if (rules_compiled)
+        return;
+
+    for (int r = 0; r < PEEPHOLE_RULE_COUNT; r++)
+        rule_count_by_op[peephole_rules[r].pattern[0].op]++;
+    for (int op = 0; op <= OP_FUNC_END; op++)
+    {
+        rules_by_op[op] = rule_count_by_op[op] ? (int *)malloc(rule_count_by_op[op] * sizeof(int)) : NULL;
+        rule_count_by_op[op] = 0;
+    }
+    for (int r = 0; r < PEEPHOLE_RULE_COUNT; r++)
+    {
+        OpType op = peephole_rules[r].pattern[0].op;
+        rules_by_op[op][rule_count_by_op[op]++] = r;
+    }
+    rules_compiled = true;
+}
+
+// ========================= 匹配 =========================
+
+// 匹配状态：元变量绑定及临时变量使用计数
+typedef struct PeepholeMatch
+{
+    Operand *meta[PEEPHOLE_MAX_META];
+    int *temp_uses;
+    int temp_limit;
+} PeepholeMatch;
+
+static int temp_use_count(PeepholeMatch *match, Operand *op)
+{
+    if (op->u.temp_no < 0 || op->u.temp_no >= match->temp_limit)
+        return INT_MAX;
+    return match->temp_uses[op->u.temp_no];
+}
+
+static bool match_operand(PeepholeMatch *match, OperandPattern *pattern, Operand *op)
+{
+    switch (pattern->kind)
+    {
+    case PAT_NONE:
+        return op == NULL;
+    case PAT_INT:
+        return op != NULL && op->type == OPERAND_CONSTANT && op->u.int_value == pattern->value;
+    case PAT_CONST:
+        if (op == NULL || op->type != OPERAND_CONSTANT)
+            return false;
+        break;
+    case PAT_TEMP:
+        if (op == NULL || op->type != OPERAND_TEMP)
+            return false;
+        break;
+    case PAT_ONCE:
+        if (op == NULL || op->type != OPERAND_TEMP || temp_use_count(match, op) != 1)
+            return false;
+        break;
+    case PAT_ANY:
+        if (op == NULL)
+            return false;
+        break;
+    }
+
+    // 绑定元变量，已绑定时要求相同
+    Operand **slot = &match->meta[pattern->value];
+    if (*slot != NULL)
+        return operands_equal(*slot, op);
+    *slot = op;
+    return true;
+}
+
+static bool match_rule(PeepholeMatch *match, PeepholeRule *rule, Instruction *first)
+{
+    memset(match->meta, 0, sizeof(match->meta));
+    Instruction *inst = first;
+    for (int i = 0; i < rule->length; i++, inst = inst->next)
+    {
+        InstructionPattern *pattern = &rule->pattern[i];
+        if (inst == NULL || inst->op != pattern->op ||
+            !match_operand(match, &pattern->result, inst->result) ||
+            !match_operand(match, &pattern->arg1, inst->arg1) ||
+            !match_operand(match, &pattern->arg2, inst->arg2))
+            return false;
+    }
+    return rule->guard == NULL || rule->guard(match->meta);
+}
+
+// ========================= 替换 =========================
+
+static int fold_constant(OpType op, int a, int b)
+{
+    switch (op)
+    {
+    case OP_ADD:
+        return (int)((unsigned int)a + (unsigned int)b);
+    case OP_SUB:
+        return (int)((unsigned int)a - (unsigned int)b);
+    case OP_MUL:
+        return (int)((unsigned int)a * (unsigned int)b);
+    case OP_DIV:
+        return a / b;
+    case OP_GT:
+        return a > b;
+    case OP_LT:
+        return a < b;
+    case OP_GE:
+        return a >= b;
+    case OP_LE:
+        return a <= b;
+    case OP_EQ:
+        return a == b;
+    case OP_NE:
+        return a != b;
+    case OP_AND:
+        return a && b;
+    case OP_OR:
+        return a || b;
+    case OP_NEG:
+        return (int)(0u - (unsigned int)a);
+    case OP_NOT:
+        return !a;
+    default:
+        return 0;
+    }
+}
+
+static Operand *instantiate_operand(PeepholeMatch *match, OperandTemplate *tmpl)
+{
+    switch (tmpl->kind)
+    {
+    case REP_META:
+        return copy_operand(match->meta[tmpl->value]);
+    case REP_INT:
+        return new_operand_constant_int(tmpl->value);
+    case REP_FOLD:
+        return new_operand_constant_int(fold_constant(tmpl->fold_op, match->meta[tmpl->value]->u.int_value,
+                                                      match->meta[tmpl->value2]->u.int_value));
+    default:
+        return NULL;
+    }
+}
+
+static void count_uses(PeepholeMatch *match, Instruction *inst, int delta)
+{
+    Operand *uses[3];
+    int use_count = instruction_uses(inst, uses);
+    for (int i = 0; i < use_count; i++)
+    {
+        if (uses[i]->type == OPERAND_TEMP && uses[i]->u.temp_no >= 0 && uses[i]->u.temp_no < match->temp_limit)
+            match->temp_uses[uses[i]->u.temp_no] += delta;
+    }
+}
+
+// 用规则的替换模板替换 prev 之后的窗口，返回替换后的第一条指令
+static Instruction *apply_rule(PeepholeMatch *match, PeepholeRule *rule, Instruction *prev)
+{
+    // 先按模板生成新指令（元变量指向旧指令中的操作数），再摘除旧窗口
+    Instruction *replacement[PEEPHOLE_MAX_WINDOW];
+    for (int i = 0; i < rule->replacement_length; i++)
+    {
+        InstructionTemplate *tmpl = &rule->replacement[i];
+        replacement[i] = new_instruction(tmpl->op, instantiate_operand(match, &tmpl->result),
+                                         instantiate_operand(match, &tmpl->arg1), instantiate_operand(match, &tmpl->arg2));
+        count_uses(match, replacement[i], 1);
+    }
+
+    for (int i = 0; i < rule->length; i++)
+    {
+        Instruction *old = prev->next;
+        count_uses(match, old, -1);
+        unlink_instruction(prev, old);
+        free_instruction(old);
+    }
+
+    Instruction *pos = prev;
+    for (int i = 0; i < rule->replacement_length; i++)
+    {
+        insert_instruction_after(pos, replacement[i]);
+        pos = replacement[i];
+    }
+
+    if (rule->counter != NULL)
+        (*rule->counter)++;
+    return prev->next;
+}
+
+// ========================= 扫描 =========================
+
+static int peephole_function(PeepholeMatch *match, Instruction *func_def)
+{
+    // 最近经过的指令，改写后据此回退，使新指令与前面的指令组成的窗口也能匹配
+    Instruction *history[PEEPHOLE_MAX_WINDOW];
+    int history_count = 1;
+    history[0] = func_def;
+
+    int rewritten = 0;
+    Instruction *inst = func_def->next;
+    while (inst != NULL && inst->op != OP_FUNC_END)
+    {
+        Instruction *prev = history[history_count - 1];
+        bool applied = false;
+
+        for (int i = 0; i < rule_count_by_op[inst->op]; i++)
+        {
+            PeepholeRule *rule = &peephole_rules[rules_by_op[inst->op][i]];
+            if (!match_rule(match, rule, inst))
+                continue;
+
+            inst = apply_rule(match, rule, prev);
+            rewritten++;
+            applied = true;
+            break;
+        }
+
+        if (applied)
+        {
+            // 回退窗口长度减一条指令，但保留至少一条作为前驱
+            for (int back = 0; back < PEEPHOLE_MAX_WINDOW - 1 && history_count > 1; back++)
+                inst = history[--history_count];
+            continue;
+        }
+
+        if (history_count == PEEPHOLE_MAX_WINDOW)
+        {
+            memmove(history, history + 1, (PEEPHOLE_MAX_WINDOW - 1) * sizeof(Instruction *));
+            history_count--;
+        }
+        history[history_count++] = inst;
+        inst = inst->next;
+    }
+    return rewritten;
+}
+
+// 窥孔优化：规则按首条操作码编译为分派表，每个函数一遍线性扫描，
+// 改写后回退窗口长度以便级联匹配。返回改写次数
+int peephole_optimize()
+{
+    compile_rules();
+
+    PeepholeMatch match;
+    match.temp_limit = temp_count + 1;
+    match.temp_uses = (int *)calloc(match.temp_limit, sizeof(int));
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+        count_uses(&match, inst, 1);
+
+    int total = 0;
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            total += peephole_function(&match, inst);
+    }
+
+    free(match.temp_uses);
+    return total;
+}
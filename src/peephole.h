@@ -0,0 +1,81 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "codegen.h"
+
+// 窥孔规则窗口的最大指令数
+#define PEEPHOLE_MAX_WINDOW 3
+
+// 操作数模式
+typedef enum
+{
+    PAT_NONE,  // 操作数为空
+    PAT_ANY,   // 任意操作数，绑定到元变量
+    PAT_CONST, // 整数常量，绑定到元变量
+    PAT_INT,   // 等于指定值的整数常量
+    PAT_TEMP,  // 临时变量，绑定到元变量
+    PAT_ONCE   // 全程序只被使用一次的临时变量，绑定到元变量
+} OperandPatternKind;
+
+// 同一元变量在窗口内多次出现时要求操作数相同
+typedef struct OperandPattern
+{
+    OperandPatternKind kind;
+    int value; // 元变量编号，或 PAT_INT 的常量值
+} OperandPattern;
+
+typedef struct InstructionPattern
+{
+    OpType op;
+    OperandPattern result;
+    OperandPattern arg1;
+    OperandPattern arg2;
+} InstructionPattern;
+
+// 替换模板中的操作数
+typedef enum
+{
+    REP_NONE, // 空
+    REP_META, // 元变量绑定的操作数
+    REP_INT,  // 整数常量
+    REP_FOLD  // 对两个常量元变量按 fold_op 求值
+} OperandTemplateKind;
+
+typedef struct OperandTemplate
+{
+    OperandTemplateKind kind;
+    int value;     // 元变量编号或常量值；REP_FOLD 时为左操作数的元变量
+    int value2;    // REP_FOLD 的右操作数元变量（一元运算忽略）
+    OpType fold_op;
+} OperandTemplate;
+
+typedef struct InstructionTemplate
+{
+    OpType op;
+    OperandTemplate result;
+    OperandTemplate arg1;
+    OperandTemplate arg2;
+} InstructionTemplate;
+
+// 元变量个数上限
+#define PEEPHOLE_MAX_META 4
+
+// 规则的附加条件：参数为已绑定的元变量
+typedef bool (*PeepholeGuard)(Operand **meta);
+
+// 窥孔规则：length 条指令的窗口替换为 replacement_length 条指令
+typedef struct PeepholeRule
+{
+    const char *name;
+    int length;
+    InstructionPattern pattern[PEEPHOLE_MAX_WINDOW];
+    PeepholeGuard guard;
+    int replacement_length;
+    InstructionTemplate replacement[PEEPHOLE_MAX_WINDOW];
+    int *counter; // 命中时累加的统计项
+} PeepholeRule;
+
+// 按规则表做一遍线性扫描，返回改写次数
+int peephole_optimize();
+
+#endif
@@ -0,0 +1,695 @@
+#include "pre.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORD_BITS ((int)(sizeof(BitWord) * 8))
+
+// 候选表达式：op arg1 arg2，选中后所有计算都经由 temp 保存
+typedef struct Expression
+{
+    OpType op;
+    Operand *arg1;         // 操作数副本
+    Operand *arg2;         // 一元运算为NULL
+    Operand *temp;         // 保存表达式值的新临时变量
+    bool local_redundant;  // 同一块内两次计算之间操作数未被修改
+} Expression;
+
+// 插入位置
+typedef enum
+{
+    INSERT_AT_END,    // 前驱块只有这一个后继：插在前驱块末尾
+    INSERT_AT_START,  // 后继块只有这一个前驱：插在后继块开头
+    INSERT_FALLTHROUGH, // 关键边且为顺序落入：插在两块之间，后继块的标签之前
+    INSERT_SPLIT      // 关键边且为跳转：新建跳板块，改写跳转目标
+} InsertKind;
+
+// 边上需要插入的表达式集合
+typedef struct EdgeInsertion
+{
+    BasicBlock *from;
+    BasicBlock *to;
+    InsertKind kind;
+    BitWord *set;
+} EdgeInsertion;
+
+// 单个函数的惰性代码移动状态
+typedef struct LcmState
+{
+    CFG *cfg;
+    Expression *exprs;
+    int expr_count;
+    int expr_capacity;
+    int words;
+    // 以下位集合按块编号索引
+    BitWord **antloc;   // 块内向上暴露的计算
+    BitWord **comp;     // 块内向下暴露的计算
+    BitWord **transp;   // 块内不修改操作数
+    BitWord **avout;    // 出口可用
+    BitWord **antin;    // 入口可预期
+    BitWord **antout;   // 出口可预期
+    BitWord **laterin;  // 入口处插入还可以推迟
+    BitWord *selected;  // 实际进行变换的表达式
+    Operand **garbage;  // 被替换下来的操作数，变量表的键可能指向它们，最后统一释放
+    int garbage_count;
+    int garbage_capacity;
+} LcmState;
+
+// ========================= 表达式 =========================
+
+static bool is_global_operand(Operand *op)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE && is_global_variable(op->u.name);
+}
+
+static bool is_value_operand(Operand *op)
+{
+    return op->type == OPERAND_VARIABLE || op->type == OPERAND_TEMP || is_constant_operand(op);
+}
+
+// 可以参与部分冗余消除的计算。数组读取涉及内存，不在此处理
+static bool is_candidate(Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+    case OP_AND:
+    case OP_OR:
+        break;
+    case OP_DIV:
+        // 与循环不变量外提一致，只移动除数为非零常量的除法
+        if (inst->arg2 == NULL || inst->arg2->type != OPERAND_CONSTANT || inst->arg2->u.int_value == 0)
+            return false;
+        break;
+    case OP_NEG:
+    case OP_NOT:
+        return inst->result != NULL && inst->arg1 != NULL && is_value_operand(inst->arg1) &&
+               !is_constant_operand(inst->arg1);
+    default:
+        return false;
+    }
+    if (inst->result == NULL || inst->arg1 == NULL || inst->arg2 == NULL)
+        return false;
+    if (!is_value_operand(inst->arg1) || !is_value_operand(inst->arg2))
+        return false;
+    return !(is_constant_operand(inst->arg1) && is_constant_operand(inst->arg2));
+}
+
+static bool same_operand(Operand *a, Operand *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return operands_equal(a, b);
+}
+
+static int find_expression(LcmState *state, Instruction *inst)
+{
+    if (!is_candidate(inst))
+        return -1;
+    for (int i = 0; i < state->expr_count; i++)
+    {
+        Expression *expr = &state->exprs[i];
+        if (expr->op == inst->op && same_operand(expr->arg1, inst->arg1) && same_operand(expr->arg2, inst->arg2))
+            return i;
+    }
+    return -1;
+}
+
+static void collect_expressions(LcmState *state)
+{
+    for (int b = 0; b < state->cfg->block_count; b++)
+    {
+        BasicBlock *block = state->cfg->blocks[b];
+        for (Instruction *inst = block->first; inst != NULL; inst = inst->next)
+        {
+            if (is_candidate(inst) && find_expression(state, inst) < 0)
+            {
+                if (state->expr_count == state->expr_capacity)
+                {
+                    state->expr_capacity = state->expr_capacity ? state->expr_capacity * 2 : 16;
+                    state->exprs = (Expression *)realloc(state->exprs, state->expr_capacity * sizeof(Expression));
+                }
+                Expression *expr = &state->exprs[state->expr_count++];
+                expr->op = inst->op;
+                expr->arg1 = copy_operand(inst->arg1);
+                expr->arg2 = copy_operand(inst->arg2);
+                expr->temp = NULL;
+                expr->local_redundant = false;
+            }
+            if (inst == block->last)
+                break;
+        }
+    }
+}
+
+// inst 是否修改表达式的操作数（调用可能修改全局变量）
+static bool kills(Expression *expr, Instruction *inst)
+{
+    Operand *def = instruction_def(inst);
+    if (def != NULL && (operands_equal(expr->arg1, def) || operands_equal(expr->arg2, def)))
+        return true;
+    return inst->op == OP_CALL && (is_global_operand(expr->arg1) || is_global_operand(expr->arg2));
+}
+
+// ========================= 数据流 =========================
+
+static BitWord **new_block_sets(LcmState *state)
+{
+    BitWord **sets = (BitWord **)malloc(state->cfg->block_count * sizeof(BitWord *));
+    for (int b = 0; b < state->cfg->block_count; b++)
+        sets[b] = bitset_new(state->words);
+    return sets;
+}
+
+static void free_block_sets(LcmState *state, BitWord **sets)
+{
+    for (int b = 0; b < state->cfg->block_count; b++)
+        free(sets[b]);
+    free(sets);
+}
+
+static void fill_ones(BitWord *set, int words)
+{
+    for (int w = 0; w < words; w++)
+        set[w] = ~0u;
+}
+
+// 局部性质：ANTLOC、COMP、TRANSP
+static void compute_local_properties(LcmState *state)
+{
+    BitWord *killed = bitset_new(state->words);
+    for (int b = 0; b < state->cfg->block_count; b++)
+    {
+        BasicBlock *block = state->cfg->blocks[b];
+        memset(killed, 0, state->words * sizeof(BitWord));
+        fill_ones(state->transp[b], state->words);
+
+        for (Instruction *inst = block->first; inst != NULL; inst = inst->next)
+        {
+            int e = find_expression(state, inst);
+            if (e >= 0)
+            {
+                if (bitset_test(state->comp[b], e))
+                    state->exprs[e].local_redundant = true;
+                if (!bitset_test(killed, e))
+                    bitset_set(state->antloc[b], e);
+                bitset_set(state->comp[b], e);
+            }
+
+            for (int i = 0; i < state->expr_count; i++)
+            {
+                if (kills(&state->exprs[i], inst))
+                {
+                    bitset_set(killed, i);
+                    bitset_clear(state->comp[b], i);
+                    bitset_clear(state->transp[b], i);
+                }
+            }
+            if (inst == block->last)
+                break;
+        }
+    }
+    free(killed);
+}
+
+// 可用表达式（前向，交汇取交集）
+static void compute_availability(LcmState *state)
+{
+    CFG *cfg = state->cfg;
+    BitWord *in = bitset_new(state->words);
+    for (int r = 1; r < cfg->rpo_count; r++)
+        fill_ones(state->avout[cfg->rpo_order[r]->id], state->words);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < cfg->rpo_count; r++)
+        {
+            BasicBlock *block = cfg->rpo_order[r];
+            int b = block->id;
+            if (r == 0)
+                memset(in, 0, state->words * sizeof(BitWord));
+            else
+                fill_ones(in, state->words);
+            for (int p = 0; r > 0 && p < block->pred_count; p++)
+            {
+                if (block->preds[p]->rpo < 0)
+                    continue;
+                for (int w = 0; w < state->words; w++)
+                    in[w] &= state->avout[block->preds[p]->id][w];
+            }
+            for (int w = 0; w < state->words; w++)
+            {
+                BitWord out = state->comp[b][w] | (in[w] & state->transp[b][w]);
+                if (out != state->avout[b][w])
+                {
+                    state->avout[b][w] = out;
+                    changed = true;
+                }
+            }
+        }
+    }
+    free(in);
+}
+
+// 可预期表达式（后向，交汇取交集）。到达不了函数出口的块（死循环）出口处不可预期，
+// 避免把计算移到原本永远不会执行它的路径上
+static void compute_anticipability(LcmState *state)
+{
+    CFG *cfg = state->cfg;
+    bool *reaches_exit = (bool *)calloc(cfg->block_count, sizeof(bool));
+    BasicBlock **worklist = (BasicBlock **)malloc(cfg->block_count * sizeof(BasicBlock *));
+    int top = 0;
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        BasicBlock *block = cfg->rpo_order[r];
+        if (block->succ_count == 0)
+        {
+            reaches_exit[block->id] = true;
+            worklist[top++] = block;
+        }
+    }
+    while (top > 0)
+    {
+        BasicBlock *block = worklist[--top];
+        for (int p = 0; p < block->pred_count; p++)
+        {
+            BasicBlock *pred = block->preds[p];
+            if (pred->rpo >= 0 && !reaches_exit[pred->id])
+            {
+                reaches_exit[pred->id] = true;
+                worklist[top++] = pred;
+            }
+        }
+    }
+
+    for (int r = 0; r < cfg->rpo_count; r++)
+        fill_ones(state->antin[cfg->rpo_order[r]->id], state->words);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = cfg->rpo_count - 1; r >= 0; r--)
+        {
+            BasicBlock *block = cfg->rpo_order[r];
+            int b = block->id;
+            BitWord *out = state->antout[b];
+            if (block->succ_count == 0 || !reaches_exit[b])
+                memset(out, 0, state->words * sizeof(BitWord));
+            else
+                fill_ones(out, state->words);
+            for (int s = 0; s < block->succ_count && reaches_exit[b]; s++)
+            {
+                for (int w = 0; w < state->words; w++)
+                    out[w] &= state->antin[block->succs[s]->id][w];
+            }
+            for (int w = 0; w < state->words; w++)
+            {
+                BitWord in = state->antloc[b][w] | (out[w] & state->transp[b][w]);
+                if (in != state->antin[b][w])
+                {
+                    state->antin[b][w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    free(reaches_exit);
+    free(worklist);
+}
+
+// EARLIEST(i,j) = ANTIN(j) ∩ ¬AVOUT(i) ∩ (¬TRANSP(i) ∪ ¬ANTOUT(i))
+// LATER(i,j) = EARLIEST(i,j) ∪ (LATERIN(i) ∩ ¬ANTLOC(i))
+static BitWord later_word(LcmState *state, BasicBlock *from, BasicBlock *to, int w)
+{
+    int i = from->id;
+    BitWord earliest = state->antin[to->id][w] & ~state->avout[i][w] &
+                       (~state->transp[i][w] | ~state->antout[i][w]);
+    return earliest | (state->laterin[i][w] & ~state->antloc[i][w]);
+}
+
+// LATERIN(j) = ∩ LATER(i,j)；入口块另有一条来自虚拟起点的边，其上 LATER = ANTIN(入口)
+static void compute_later(LcmState *state)
+{
+    CFG *cfg = state->cfg;
+    for (int r = 0; r < cfg->rpo_count; r++)
+        fill_ones(state->laterin[cfg->rpo_order[r]->id], state->words);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < cfg->rpo_count; r++)
+        {
+            BasicBlock *block = cfg->rpo_order[r];
+            for (int w = 0; w < state->words; w++)
+            {
+                BitWord in = r == 0 ? state->antin[block->id][w] : ~0u;
+                for (int p = 0; p < block->pred_count; p++)
+                {
+                    if (block->preds[p]->rpo >= 0)
+                        in &= later_word(state, block->preds[p], block, w);
+                }
+                if (in != state->laterin[block->id][w])
+                {
+                    state->laterin[block->id][w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// ========================= 变换 =========================
+
+static void add_garbage(LcmState *state, Operand *op)
+{
+    if (op == NULL)
+        return;
+    if (state->garbage_count == state->garbage_capacity)
+    {
+        state->garbage_capacity = state->garbage_capacity ? state->garbage_capacity * 2 : 32;
+        state->garbage = (Operand **)realloc(state->garbage, state->garbage_capacity * sizeof(Operand *));
+    }
+    state->garbage[state->garbage_count++] = op;
+}
+
+static Instruction *new_computation(Expression *expr)
+{
+    return new_instruction(expr->op, copy_operand(expr->temp), copy_operand(expr->arg1), copy_operand(expr->arg2));
+}
+
+static bool single_successor(BasicBlock *block)
+{
+    return block->succ_count == 1 || (block->succ_count == 2 && block->succs[0] == block->succs[1]);
+}
+
+// 不同的可达前驱块个数，入口块额外计入虚拟起点
+static int distinct_preds(CFG *cfg, BasicBlock *block)
+{
+    int count = block == cfg->rpo_order[0] ? 1 : 0;
+    for (int p = 0; p < block->pred_count; p++)
+    {
+        BasicBlock *pred = block->preds[p];
+        bool seen = pred->rpo < 0;
+        for (int q = 0; q < p && !seen; q++)
+            seen = block->preds[q] == pred;
+        if (!seen)
+            count++;
+    }
+    return count;
+}
+
+static InsertKind classify_edge(CFG *cfg, BasicBlock *from, BasicBlock *to)
+{
+    if (single_successor(from))
+        return INSERT_AT_END;
+    if (distinct_preds(cfg, to) == 1)
+        return INSERT_AT_START;
+
+    Operand *target = branch_target(from->last);
+    if (target != NULL && target->u.temp_no < cfg->label_limit && cfg->label_block[target->u.temp_no] == to)
+        return INSERT_SPLIT;
+    return INSERT_FALLTHROUGH;
+}
+
+static void insert_before(Instruction *func_def, Instruction *pos, Instruction *inst)
+{
+    insert_instruction_after(find_prev_instruction(func_def, pos), inst);
+}
+
+// 在块内改写选中表达式的每一次计算，返回删除的计算条数
+static int rewrite_block(LcmState *state, BasicBlock *block)
+{
+    int deleted = 0;
+    BitWord *valid = bitset_new(state->words);
+    for (int w = 0; w < state->words; w++)
+        valid[w] = state->antloc[block->id][w] & ~state->laterin[block->id][w] & state->selected[w];
+
+    Instruction *stop = block->last->next;
+    Instruction *inst = block->first;
+    while (inst != stop)
+    {
+        Instruction *next = inst->next;
+        Instruction *def_inst = inst;
+        int e = find_expression(state, inst);
+        if (e >= 0 && bitset_test(state->selected, e))
+        {
+            Expression *expr = &state->exprs[e];
+            if (bitset_test(valid, e))
+            {
+                // x := a op b  =>  x := h
+                add_garbage(state, inst->arg1);
+                add_garbage(state, inst->arg2);
+                inst->op = OP_ASSIGN;
+                inst->arg1 = copy_operand(expr->temp);
+                inst->arg2 = NULL;
+                deleted++;
+            }
+            else
+            {
+                // x := a op b  =>  h := a op b; x := h
+                Instruction *copy = new_instruction(OP_ASSIGN, inst->result, copy_operand(expr->temp), NULL);
+                inst->result = copy_operand(expr->temp);
+                insert_instruction_after(inst, copy);
+                bitset_set(valid, e);
+                def_inst = copy;
+                next = copy->next;
+            }
+        }
+
+        for (int i = 0; i < state->expr_count; i++)
+        {
+            if (kills(&state->exprs[i], def_inst))
+                bitset_clear(valid, i);
+        }
+        inst = next;
+    }
+
+    free(valid);
+    return deleted;
+}
+
+// 执行边上的插入
+static void apply_insertion(LcmState *state, EdgeInsertion *edge, Instruction *anchor)
+{
+    CFG *cfg = state->cfg;
+    Instruction *pos = NULL;      // 插在其后
+    Instruction *before = NULL;   // 或插在其前
+
+    switch (edge->kind)
+    {
+    case INSERT_AT_END:
+        if (is_block_terminator(edge->from->last))
+            before = edge->from->last;
+        else
+            before = edge->to->first;
+        break;
+    case INSERT_AT_START:
+        if (edge->to->first->op == OP_LABEL)
+            pos = edge->to->first;
+        else
+            before = edge->to->first;
+        break;
+    case INSERT_FALLTHROUGH:
+        before = edge->to->first;
+        break;
+    case INSERT_SPLIT:
+    {
+        // 跳板块放在无条件跳转或返回之后，不会被顺序落入
+        Instruction *label = new_instruction(OP_LABEL, new_operand_label(), NULL, NULL);
+        Instruction *jump = new_instruction(OP_GOTO, NULL, copy_operand(branch_target(edge->from->last)), NULL);
+        insert_instruction_after(anchor, label);
+        insert_instruction_after(label, jump);
+        set_branch_target(edge->from->last, copy_operand(label->result));
+        pos = label;
+        break;
+    }
+    }
+
+    for (int e = 0; e < state->expr_count; e++)
+    {
+        if (!bitset_test(edge->set, e))
+            continue;
+        Instruction *inst = new_computation(&state->exprs[e]);
+        if (pos != NULL)
+        {
+            insert_instruction_after(pos, inst);
+            pos = inst;
+        }
+        else
+        {
+            insert_before(cfg->func_def, before, inst);
+        }
+    }
+}
+
+static int optimize_function(Instruction *func_def)
+{
+    LcmState state;
+    memset(&state, 0, sizeof(LcmState));
+    state.cfg = build_cfg(func_def);
+    CFG *cfg = state.cfg;
+
+    collect_expressions(&state);
+    if (state.expr_count == 0 || cfg->rpo_count == 0)
+    {
+        free(state.exprs);
+        free_cfg(cfg);
+        return 0;
+    }
+
+    state.words = (state.expr_count + WORD_BITS - 1) / WORD_BITS;
+    state.antloc = new_block_sets(&state);
+    state.comp = new_block_sets(&state);
+    state.transp = new_block_sets(&state);
+    state.avout = new_block_sets(&state);
+    state.antin = new_block_sets(&state);
+    state.antout = new_block_sets(&state);
+    state.laterin = new_block_sets(&state);
+    state.selected = bitset_new(state.words);
+
+    compute_local_properties(&state);
+    compute_availability(&state);
+    compute_anticipability(&state);
+    compute_later(&state);
+
+    // 只变换确有冗余的表达式：某块删除了计算，或块内有重复计算
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        int b = cfg->rpo_order[r]->id;
+        for (int e = 0; e < state.expr_count; e++)
+        {
+            if (bitset_test(state.antloc[b], e) && !bitset_test(state.laterin[b], e))
+                bitset_set(state.selected, e);
+        }
+    }
+    for (int e = 0; e < state.expr_count; e++)
+    {
+        if (state.exprs[e].local_redundant)
+            bitset_set(state.selected, e);
+    }
+
+    // 跳板块需要一个之后不会被顺序落入的位置
+    Instruction *anchor = NULL;
+    for (Instruction *inst = func_def->next; inst != cfg->func_end; inst = inst->next)
+    {
+        if (inst->op == OP_GOTO || inst->op == OP_RETURN)
+            anchor = inst;
+    }
+
+    // 先确定所有边上的插入（改写跳转目标之前完成分类）
+    EdgeInsertion *edges = NULL;
+    int edge_count = 0;
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        BasicBlock *to = cfg->rpo_order[r];
+        for (int p = 0; p < to->pred_count; p++)
+        {
+            BasicBlock *from = to->preds[p];
+            bool seen = from->rpo < 0;
+            for (int q = 0; q < p && !seen; q++)
+                seen = to->preds[q] == from;
+            if (seen)
+                continue;
+
+            BitWord *set = bitset_new(state.words);
+            bool any = false;
+            for (int w = 0; w < state.words; w++)
+            {
+                set[w] = later_word(&state, from, to, w) & ~state.laterin[to->id][w] & state.selected[w];
+                any = any || set[w] != 0;
+            }
+            if (!any)
+            {
+                free(set);
+                continue;
+            }
+
+            edges = (EdgeInsertion *)realloc(edges, (edge_count + 1) * sizeof(EdgeInsertion));
+            EdgeInsertion *edge = &edges[edge_count++];
+            edge->from = from;
+            edge->to = to;
+            edge->kind = classify_edge(cfg, from, to);
+            edge->set = set;
+
+            // 无处放置跳板块时放弃这些表达式
+            if (edge->kind == INSERT_SPLIT && anchor == NULL)
+            {
+                for (int w = 0; w < state.words; w++)
+                    state.selected[w] &= ~set[w];
+            }
+        }
+    }
+
+    for (int e = 0; e < state.expr_count; e++)
+    {
+        if (bitset_test(state.selected, e))
+            state.exprs[e].temp = new_operand_temp();
+    }
+
+    int deleted = 0;
+    for (int r = 0; r < cfg->rpo_count; r++)
+        deleted += rewrite_block(&state, cfg->rpo_order[r]);
+
+    for (int i = 0; i < edge_count; i++)
+    {
+        bool any = false;
+        for (int w = 0; w < state.words; w++)
+        {
+            edges[i].set[w] &= state.selected[w];
+            any = any || edges[i].set[w] != 0;
+        }
+        if (any)
+            apply_insertion(&state, &edges[i], anchor);
+        free(edges[i].set);
+    }
+    free(edges);
+
+    free_block_sets(&state, state.antloc);
+    free_block_sets(&state, state.comp);
+    free_block_sets(&state, state.transp);
+    free_block_sets(&state, state.avout);
+    free_block_sets(&state, state.antin);
+    free_block_sets(&state, state.antout);
+    free_block_sets(&state, state.laterin);
+    free(state.selected);
+    free_cfg(cfg);
+
+    for (int i = 0; i < state.garbage_count; i++)
+        free_operand(state.garbage[i]);
+    free(state.garbage);
+    for (int e = 0; e < state.expr_count; e++)
+    {
+        free_operand(state.exprs[e].arg1);
+        free_operand(state.exprs[e].arg2);
+        free_operand(state.exprs[e].temp);
+    }
+    free(state.exprs);
+    return deleted;
+}
+
+// 部分冗余消除：对每个函数做一遍惰性代码移动
+int partial_redundancy_elimination()
+{
+    int total = 0;
+    purge_dead_markers();
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            total += optimize_function(inst);
+    }
+    opt_stats.pre_count += total;
+    return total;
+}
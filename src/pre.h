@@ -0,0 +1,10 @@
+#ifndef PRE_H
+#define PRE_H
+
+#include "cfg.h"
+
+// 部分冗余消除（惰性代码移动）：基于可预期与可用表达式的位向量数据流，
+// 在最晚的安全位置插入计算，删除冗余的计算，返回删除的计算条数
+int partial_redundancy_elimination();
+
+#endif
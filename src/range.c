@@ -0,0 +1,659 @@
+#include "range.h"
+#include "type_infer.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RANGE_MIN ((long long)INT_MIN)
+#define RANGE_MAX ((long long)INT_MAX)
+
+// 循环头上先做几轮普通迭代，之后再加宽
+#define RANGE_WIDEN_DELAY 2
+
+// 加宽收敛之后的收紧轮数
+#define RANGE_NARROW_ROUNDS 2
+
+// 条件跳转的判定结果
+#define OUTCOME_FALSE 0
+#define OUTCOME_TRUE 1
+#define OUTCOME_UNKNOWN -1
+
+// ========================= 区间运算 =========================
+
+static Range range_full()
+{
+    Range r = {RANGE_MIN, RANGE_MAX};
+    return r;
+}
+
+static Range range_make(long long lo, long long hi)
+{
+    // 超出 int 的结果会回绕，无法用一个区间表示
+    if (lo < RANGE_MIN || hi > RANGE_MAX)
+        return range_full();
+    Range r = {lo, hi};
+    return r;
+}
+
+static Range range_const(long long value)
+{
+    Range r = {value, value};
+    return r;
+}
+
+static bool range_is_full(Range r)
+{
+    return r.lo == RANGE_MIN && r.hi == RANGE_MAX;
+}
+
+static bool range_is_empty(Range r)
+{
+    return r.lo > r.hi;
+}
+
+static bool range_contains(Range r, long long value)
+{
+    return r.lo <= value && value <= r.hi;
+}
+
+static Range range_hull(Range a, Range b)
+{
+    if (range_is_empty(a))
+        return b;
+    if (range_is_empty(b))
+        return a;
+    Range r = {a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi};
+    return r;
+}
+
+static Range range_intersect(Range a, Range b)
+{
+    Range r = {a.lo > b.lo ? a.lo : b.lo, a.hi < b.hi ? a.hi : b.hi};
+    return r;
+}
+
+// 加宽：增长的端点直接推到无界
+static Range range_widen(Range old, Range now)
+{
+    if (range_is_empty(old))
+        return now;
+    Range r = {now.lo < old.lo ? RANGE_MIN : old.lo, now.hi > old.hi ? RANGE_MAX : old.hi};
+    return r;
+}
+
+static Range range_from_candidates(long long *values, int count)
+{
+    long long lo = values[0];
+    long long hi = values[0];
+    for (int i = 1; i < count; i++)
+    {
+        if (values[i] < lo)
+            lo = values[i];
+        if (values[i] > hi)
+            hi = values[i];
+    }
+    return range_make(lo, hi);
+}
+
+static Range range_arith(OpType op, Range a, Range b)
+{
+    if (range_is_full(a) || range_is_full(b))
+        return range_full();
+
+    switch (op)
+    {
+    case OP_ADD:
+        return range_make(a.lo + b.lo, a.hi + b.hi);
+    case OP_SUB:
+        return range_make(a.lo - b.hi, a.hi - b.lo);
+    case OP_MUL:
+    {
+        long long values[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+        return range_from_candidates(values, 4);
+    }
+    case OP_DIV:
+    {
+        // 除数区间跨过0时无法确定
+        if (range_contains(b, 0))
+            return range_full();
+        long long values[4] = {a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi};
+        return range_from_candidates(values, 4);
+    }
+    default:
+        return range_full();
+    }
+}
+
+// 关系 a op b 在区间上的判定
+static int relation_outcome(OpType op, Range a, Range b)
+{
+    switch (op)
+    {
+    case OP_LT:
+        if (a.hi < b.lo)
+            return OUTCOME_TRUE;
+        if (a.lo >= b.hi)
+            return OUTCOME_FALSE;
+        return OUTCOME_UNKNOWN;
+    case OP_LE:
+        if (a.hi <= b.lo)
+            return OUTCOME_TRUE;
+        if (a.lo > b.hi)
+            return OUTCOME_FALSE;
+        return OUTCOME_UNKNOWN;
+    case OP_GT:
+        return relation_outcome(OP_LT, b, a);
+    case OP_GE:
+        return relation_outcome(OP_LE, b, a);
+    case OP_EQ:
+        if (a.lo == a.hi && b.lo == b.hi && a.lo == b.lo)
+            return OUTCOME_TRUE;
+        if (a.hi < b.lo || b.hi < a.lo)
+            return OUTCOME_FALSE;
+        return OUTCOME_UNKNOWN;
+    case OP_NE:
+    {
+        int eq = relation_outcome(OP_EQ, a, b);
+        return eq == OUTCOME_UNKNOWN ? eq : !eq;
+    }
+    default:
+        return OUTCOME_UNKNOWN;
+    }
+}
+
+static Range outcome_range(int outcome)
+{
+    if (outcome == OUTCOME_UNKNOWN)
+    {
+        Range r = {0, 1};
+        return r;
+    }
+    return range_const(outcome);
+}
+
+static OpType negate_relation(OpType op)
+{
+    switch (op)
+    {
+    case OP_LT:
+        return OP_GE;
+    case OP_LE:
+        return OP_GT;
+    case OP_GT:
+        return OP_LE;
+    case OP_GE:
+        return OP_LT;
+    case OP_EQ:
+        return OP_NE;
+    default:
+        return OP_EQ;
+    }
+}
+
+// 融合比较跳转对应的关系运算
+static OpType branch_relation(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return OP_GT;
+    case OP_IF_LT:
+        return OP_LT;
+    case OP_IF_GE:
+        return OP_GE;
+    case OP_IF_LE:
+        return OP_LE;
+    case OP_IF_EQ:
+        return OP_EQ;
+    default:
+        return OP_NE;
+    }
+}
+
+// ========================= 传递函数 =========================
+
+static int tracked_index(RangeInfo *info, Operand *op)
+{
+    if (op == NULL || (op->type != OPERAND_TEMP && op->type != OPERAND_VARIABLE))
+        return -1;
+    int index = operand_table_lookup(&info->cfg->vars, op);
+    return index >= 0 && info->tracked[index] ? index : -1;
+}
+
+static Range eval_operand(RangeInfo *info, Range *state, Operand *op)
+{
+    if (op != NULL && op->type == OPERAND_CONSTANT)
+        return range_const(op->u.int_value);
+    int index = tracked_index(info, op);
+    return index >= 0 ? state[index] : range_full();
+}
+
+static void transfer(RangeInfo *info, Range *state, Instruction *inst)
+{
+    int def = tracked_index(info, instruction_def(inst));
+    if (def < 0)
+        return;
+
+    Range a = eval_operand(info, state, inst->arg1);
+    Range b = eval_operand(info, state, inst->arg2);
+    Range value;
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+        value = a;
+        break;
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+        value = range_arith(inst->op, a, b);
+        break;
+    case OP_NEG:
+        value = range_is_full(a) ? a : range_make(-a.hi, -a.lo);
+        break;
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        value = outcome_range(relation_outcome(inst->op, a, b));
+        break;
+    case OP_NOT:
+        value = outcome_range(relation_outcome(OP_EQ, a, range_const(0)));
+        break;
+    case OP_AND:
+    {
+        int left = relation_outcome(OP_NE, a, range_const(0));
+        int right = relation_outcome(OP_NE, b, range_const(0));
+        if (left == OUTCOME_FALSE || right == OUTCOME_FALSE)
+            value = range_const(0);
+        else
+            value = outcome_range(left == OUTCOME_TRUE && right == OUTCOME_TRUE ? OUTCOME_TRUE : OUTCOME_UNKNOWN);
+        break;
+    }
+    case OP_OR:
+    {
+        int left = relation_outcome(OP_NE, a, range_const(0));
+        int right = relation_outcome(OP_NE, b, range_const(0));
+        if (left == OUTCOME_TRUE || right == OUTCOME_TRUE)
+            value = range_const(1);
+        else
+            value = outcome_range(left == OUTCOME_FALSE && right == OUTCOME_FALSE ? OUTCOME_FALSE : OUTCOME_UNKNOWN);
+        break;
+    }
+    default:
+        value = range_full();
+        break;
+    }
+    state[def] = value;
+}
+
+// 按 x op y 成立收窄两边的区间，出现空区间时返回false（该边不可能经过）
+static bool refine(RangeInfo *info, Range *state, OpType op, Operand *x, Operand *y)
+{
+    if (op == OP_GT || op == OP_GE)
+    {
+        Operand *swap = x;
+        x = y;
+        y = swap;
+        op = op == OP_GT ? OP_LT : OP_LE;
+    }
+
+    Range a = eval_operand(info, state, x);
+    Range b = eval_operand(info, state, y);
+    Range na = a;
+    Range nb = b;
+    switch (op)
+    {
+    case OP_LT:
+        na.hi = a.hi < b.hi - 1 ? a.hi : b.hi - 1;
+        nb.lo = b.lo > a.lo + 1 ? b.lo : a.lo + 1;
+        break;
+    case OP_LE:
+        na.hi = a.hi < b.hi ? a.hi : b.hi;
+        nb.lo = b.lo > a.lo ? b.lo : a.lo;
+        break;
+    case OP_EQ:
+        na = range_intersect(a, b);
+        nb = na;
+        break;
+    case OP_NE:
+        if (b.lo == b.hi)
+        {
+            if (na.lo == b.lo)
+                na.lo++;
+            if (na.hi == b.lo)
+                na.hi--;
+        }
+        if (a.lo == a.hi)
+        {
+            if (nb.lo == a.lo)
+                nb.lo++;
+            if (nb.hi == a.lo)
+                nb.hi--;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (range_is_empty(na) || range_is_empty(nb))
+        return false;
+    int ix = tracked_index(info, x);
+    int iy = tracked_index(info, y);
+    if (ix >= 0)
+        state[ix] = na;
+    if (iy >= 0)
+        state[iy] = nb;
+    return true;
+}
+
+// 条件跳转 inst 的跳转条件；不是条件跳转时返回false
+static bool branch_condition(Instruction *inst, OpType *op, Operand **x, Operand **y, Operand *zero)
+{
+    if (is_relational_branch(inst->op))
+    {
+        *op = branch_relation(inst->op);
+        *x = inst->arg1;
+        *y = inst->arg2;
+        return true;
+    }
+    if (inst->op == OP_IF_GOTO || inst->op == OP_IF_NOT_GOTO)
+    {
+        *op = inst->op == OP_IF_GOTO ? OP_NE : OP_EQ;
+        *x = inst->arg1;
+        *y = zero;
+        return true;
+    }
+    return false;
+}
+
+// ========================= 数据流 =========================
+
+static Range *new_state(RangeInfo *info)
+{
+    return (Range *)malloc((info->cfg->vars.count + 1) * sizeof(Range));
+}
+
+// 块出口状态沿 from -> to 边传播后的状态，边不可能经过时返回false
+static bool edge_state(RangeInfo *info, BasicBlock *from, Range *out, BasicBlock *to, Range *result)
+{
+    memcpy(result, out, info->cfg->vars.count * sizeof(Range));
+
+    Operand zero;
+    zero.type = OPERAND_CONSTANT;
+    zero.u.int_value = 0;
+    OpType op;
+    Operand *x;
+    Operand *y;
+    if (from->succ_count != 2 || from->succs[0] == from->succs[1] ||
+        !branch_condition(from->last, &op, &x, &y, &zero))
+        return true;
+
+    // 跳转目标之外的后继是顺序落入的一边
+    Operand *target = branch_target(from->last);
+    bool taken = target->u.temp_no < info->cfg->label_limit && info->cfg->label_block[target->u.temp_no] == to;
+    return refine(info, result, taken ? op : negate_relation(op), x, y);
+}
+
+static void block_out(RangeInfo *info, BasicBlock *block, Range *in, Range *out)
+{
+    memcpy(out, in, info->cfg->vars.count * sizeof(Range));
+    for (Instruction *inst = block->first;; inst = inst->next)
+    {
+        transfer(info, out, inst);
+        if (inst == block->last)
+            break;
+    }
+}
+
+static bool is_loop_header(BasicBlock *block)
+{
+    for (int p = 0; p < block->pred_count; p++)
+    {
+        if (block->preds[p]->rpo >= block->rpo)
+            return true;
+    }
+    return false;
+}
+
+// 沿逆后序计算一轮入口状态，widen 为true时在循环头上加宽，返回是否有变化
+static bool iterate(RangeInfo *info, Range **out, int *visits, bool widen)
+{
+    CFG *cfg = info->cfg;
+    int count = cfg->vars.count;
+    Range *in = new_state(info);
+    Range *incoming = new_state(info);
+    bool changed = false;
+
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        BasicBlock *block = cfg->rpo_order[r];
+        bool reached = false;
+        if (r == 0)
+        {
+            // 形参与未初始化的局部变量的值未知
+            for (int i = 0; i < count; i++)
+                in[i] = range_full();
+            reached = true;
+        }
+        for (int p = 0; p < block->pred_count; p++)
+        {
+            BasicBlock *pred = block->preds[p];
+            if (pred->rpo < 0 || out[pred->id] == NULL)
+                continue;
+            if (!edge_state(info, pred, out[pred->id], block, incoming))
+                continue;
+            for (int i = 0; i < count; i++)
+                in[i] = reached ? range_hull(in[i], incoming[i]) : incoming[i];
+            reached = true;
+        }
+        if (!reached)
+            continue;
+
+        Range *old = info->block_in[block->id];
+        if (old != NULL && widen && is_loop_header(block) && ++visits[block->id] > RANGE_WIDEN_DELAY)
+        {
+            for (int i = 0; i < count; i++)
+                in[i] = range_widen(old[i], in[i]);
+        }
+
+        if (old != NULL && memcmp(old, in, count * sizeof(Range)) == 0)
+            continue;
+        if (old == NULL)
+        {
+            old = new_state(info);
+            info->block_in[block->id] = old;
+            out[block->id] = new_state(info);
+        }
+        memcpy(old, in, count * sizeof(Range));
+        block_out(info, block, old, out[block->id]);
+        changed = true;
+    }
+
+    free(in);
+    free(incoming);
+    return changed;
+}
+
+// 任一位置上被定值为浮点数的临时变量不跟踪（合并后的临时变量可能在别处存放整数）
+static void exclude_float_temps(RangeInfo *info, const char *function)
+{
+    CFG *cfg = info->cfg;
+    signed char **types = infer_temp_types(cfg, function);
+    signed char *state = (signed char *)malloc(cfg->vars.count + 1);
+    for (int b = 0; b < cfg->block_count; b++)
+    {
+        BasicBlock *block = cfg->blocks[b];
+        memcpy(state, types[b], cfg->vars.count + 1);
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            transfer_temp_types(cfg, function, state, inst);
+            int def = tracked_index(info, instruction_def(inst));
+            if (def >= 0 && state[def] == TYPE_FLOAT)
+                info->tracked[def] = false;
+            if (inst == block->last)
+                break;
+        }
+    }
+    free(state);
+    free_temp_types(cfg, types);
+}
+
+// 区间分析：沿控制流图传播区间，条件跳转的两条出边按条件收窄，
+// 循环头上先加宽保证收敛，再做两轮收紧
+RangeInfo *compute_ranges(CFG *cfg)
+{
+    RangeInfo *info = (RangeInfo *)calloc(1, sizeof(RangeInfo));
+    info->cfg = cfg;
+    info->block_in = (Range **)calloc(cfg->block_count, sizeof(Range *));
+
+    // 只跟踪整型的临时变量和声明为 int 的局部标量；全局变量可能被调用修改，浮点变量不能按整数运算
+    const char *function = cfg->func_def->result->u.name;
+    info->tracked = (bool *)calloc(cfg->vars.count + 1, sizeof(bool));
+    for (int i = 0; i < cfg->vars.count; i++)
+    {
+        Operand *key = cfg->vars.keys[i];
+        info->tracked[i] = key->type == OPERAND_TEMP ||
+                           (key->type == OPERAND_VARIABLE && !is_global_variable(key->u.name) &&
+                            is_int_scalar(function, key->u.name));
+    }
+    exclude_float_temps(info, function);
+
+    Range **out = (Range **)calloc(cfg->block_count, sizeof(Range *));
+    int *visits = (int *)calloc(cfg->block_count, sizeof(int));
+    while (iterate(info, out, visits, true))
+        ;
+    for (int round = 0; round < RANGE_NARROW_ROUNDS; round++)
+    {
+        if (!iterate(info, out, visits, false))
+            break;
+    }
+
+    for (int b = 0; b < cfg->block_count; b++)
+        free(out[b]);
+    free(out);
+    free(visits);
+    return info;
+}
+
+void free_range_info(RangeInfo *info)
+{
+    if (info == NULL)
+        return;
+    for (int b = 0; b < info->cfg->block_count; b++)
+        free(info->block_in[b]);
+    free(info->block_in);
+    free(info->tracked);
+    free(info);
+}
+
+// 块内指令 inst 执行之前 op 的区间
+Range range_before(RangeInfo *info, BasicBlock *block, Instruction *inst, Operand *op)
+{
+    if (info->block_in[block->id] == NULL)
+    {
+        Range empty = {1, 0};
+        return empty;
+    }
+
+    Range *state = new_state(info);
+    memcpy(state, info->block_in[block->id], info->cfg->vars.count * sizeof(Range));
+    for (Instruction *cur = block->first; cur != inst; cur = cur->next)
+    {
+        transfer(info, state, cur);
+        if (cur == block->last)
+            break;
+    }
+    Range result = eval_operand(info, state, op);
+    free(state);
+    return result;
+}
+
+// ========================= 冗余条件跳转消除 =========================
+
+typedef struct BranchDecision
+{
+    Instruction *branch;
+    bool taken;
+} BranchDecision;
+
+static int eliminate_in_function(Instruction *func_def)
+{
+    CFG *cfg = build_cfg(func_def);
+    if (cfg->rpo_count == 0)
+    {
+        free_cfg(cfg);
+        return 0;
+    }
+    RangeInfo *info = compute_ranges(cfg);
+
+    BranchDecision *decisions = (BranchDecision *)malloc((cfg->block_count + 1) * sizeof(BranchDecision));
+    int decision_count = 0;
+    Operand zero;
+    zero.type = OPERAND_CONSTANT;
+    zero.u.int_value = 0;
+
+    for (int r = 0; r < cfg->rpo_count; r++)
+    {
+        BasicBlock *block = cfg->rpo_order[r];
+        OpType op;
+        Operand *x;
+        Operand *y;
+        if (info->block_in[block->id] == NULL || !branch_condition(block->last, &op, &x, &y, &zero))
+            continue;
+
+        int outcome = relation_outcome(op, range_before(info, block, block->last, x),
+                                       range_before(info, block, block->last, y));
+        if (outcome == OUTCOME_UNKNOWN)
+            continue;
+        decisions[decision_count].branch = block->last;
+        decisions[decision_count].taken = outcome == OUTCOME_TRUE;
+        decision_count++;
+    }
+
+    // 变量表的键指向指令中的操作数，释放控制流图之后再改写
+    free_range_info(info);
+    free_cfg(cfg);
+
+    for (int i = 0; i < decision_count; i++)
+    {
+        Instruction *branch = decisions[i].branch;
+        if (decisions[i].taken)
+        {
+            Operand *target = copy_operand(branch_target(branch));
+            free_operand(branch->result);
+            free_operand(branch->arg1);
+            free_operand(branch->arg2);
+            branch->op = OP_GOTO;
+            branch->result = NULL;
+            branch->arg1 = target;
+            branch->arg2 = NULL;
+        }
+        else
+        {
+            unlink_instruction(find_prev_instruction(func_def, branch), branch);
+            free_instruction(branch);
+        }
+    }
+
+    free(decisions);
+    return decision_count;
+}
+
+// 冗余条件跳转消除：结果已由值域确定的条件跳转改为无条件跳转或删除，
+// 随后的控制流图化简会删掉不再可达的块（包括被证明不会越界的越界处理块）
+int range_branch_elimination()
+{
+    int total = 0;
+    purge_dead_markers();
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            total += eliminate_in_function(inst);
+    }
+    opt_stats.range_branch_count += total;
+    return total;
+}
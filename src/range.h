@@ -0,0 +1,32 @@
+#ifndef RANGE_H
+#define RANGE_H
+
+#include "cfg.h"
+
+// 整数区间 [lo, hi]，端点取 int 的最值表示该方向无界；lo > hi 表示空区间
+typedef struct Range
+{
+    long long lo;
+    long long hi;
+} Range;
+
+// 单个函数的值域分析结果
+typedef struct RangeInfo
+{
+    CFG *cfg;
+    Range **block_in;   // 按块编号索引的入口区间（按变量表下标），不可达块为NULL
+    bool *tracked;      // 按变量表下标：是否为按整数跟踪的临时变量或局部整型变量
+} RangeInfo;
+
+// 对 cfg 所在函数做值域分析，结果用 free_range_info 释放
+RangeInfo *compute_ranges(CFG *cfg);
+void free_range_info(RangeInfo *info);
+
+// 块内指令 inst 执行之前 op 的区间（inst 为NULL时取块出口）；不跟踪的操作数为整个 int 范围，
+// 不可达块上为空区间
+Range range_before(RangeInfo *info, BasicBlock *block, Instruction *inst, Operand *op);
+
+// 删除结果由支配条件和值域确定的条件跳转，返回删除或改为无条件跳转的条数
+int range_branch_elimination();
+
+#endif
@@ -0,0 +1,654 @@
+#include "regalloc.h"
+#include "cfg.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS_PER_WORD (8 * (int)sizeof(BitWord))
+
+// 一条指令最多读写的寄存器个数（call 破坏全部调用者保存寄存器）
+#define MAX_INST_REGS 32
+
+// 调用者保存的整数寄存器（XMM 寄存器全部由调用者保存）
+static const int caller_saved_int[] = {REG_RAX, REG_RCX, REG_RDX, REG_RSI, REG_RDI,
+                                       REG_R8, REG_R9, REG_R10, REG_R11};
+#define CALLER_SAVED_INT_COUNT ((int)(sizeof(caller_saved_int) / sizeof(caller_saved_int[0])))
+
+static const int int_arg_regs[] = {REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9};
+
+// 分配顺序：先用调用者保存寄存器（不需要保存恢复），再用被调用者保存寄存器；
+// rdx 被除法隐含使用，排在调用者保存寄存器的最后；临时寄存器不参与分配
+static const int int_allocation_order[] = {REG_RCX, REG_RSI, REG_RDI, REG_R8, REG_R9, REG_RDX,
+                                           REG_RBX, REG_R12, REG_R13, REG_R14, REG_R15};
+static const int float_allocation_order[] = {REG_XMM8, REG_XMM9, REG_XMM10, REG_XMM11, REG_XMM12, REG_XMM13,
+                                             REG_XMM1, REG_XMM2, REG_XMM3, REG_XMM4, REG_XMM5, REG_XMM6,
+                                             REG_XMM7, REG_XMM0};
+#define INT_ALLOCATION_COUNT ((int)(sizeof(int_allocation_order) / sizeof(int_allocation_order[0])))
+#define FLOAT_ALLOCATION_COUNT ((int)(sizeof(float_allocation_order) / sizeof(float_allocation_order[0])))
+
+static bool is_callee_saved(int reg)
+{
+    return reg == REG_RBX || (reg >= REG_R12 && reg <= REG_R15);
+}
+
+// ========================= 指令读写的寄存器 =========================
+
+static void add_reg(int *regs, int *count, int reg)
+{
+    // rsp、rbp 由栈帧管理，不参与活跃分析
+    if (reg == REG_NONE || reg == REG_RSP || reg == REG_RBP)
+        return;
+    regs[(*count)++] = reg;
+}
+
+static void add_address(int *regs, int *count, MOperand op)
+{
+    if (op.kind != MOP_MEM)
+        return;
+    add_reg(regs, count, op.reg);
+    add_reg(regs, count, op.index);
+}
+
+// xor r, r / xorps r, r 只写不读
+static bool is_zero_idiom(MInst *inst)
+{
+    return (inst->op == M_XOR || inst->op == M_XORPS) && inst->src.kind == MOP_REG &&
+           inst->dst.kind == MOP_REG && inst->src.reg == inst->dst.reg;
+}
+
+int minst_uses(MInst *inst, int *regs)
+{
+    int count = 0;
+    switch (inst->op)
+    {
+    case M_LABEL:
+    case M_JMP:
+    case M_JCC:
+    case M_LEAVE:
+        return 0;
+    case M_CALL:
+        for (int i = 0; i < inst->int_args; i++)
+            add_reg(regs, &count, int_arg_regs[i]);
+        for (int i = 0; i < inst->float_args; i++)
+            add_reg(regs, &count, REG_XMM0 + i);
+        return count;
+    case M_CDQ:
+        add_reg(regs, &count, REG_RAX);
+        return count;
+    case M_IDIV:
+        add_reg(regs, &count, REG_RAX);
+        add_reg(regs, &count, REG_RDX);
+        break;
+    case M_CPUID:
+        add_reg(regs, &count, REG_RAX);
+        add_reg(regs, &count, REG_RCX);
+        return count;
+    case M_XGETBV:
+        add_reg(regs, &count, REG_RCX);
+        return count;
+    default:
+        break;
+    }
+
+    if (inst->src.kind == MOP_REG)
+        add_reg(regs, &count, inst->src.reg);
+    add_address(regs, &count, inst->src);
+    add_address(regs, &count, inst->dst);
+    // setcc 只写低字节，高位保留之前清零的结果
+    if (inst->dst.kind == MOP_REG && (minst_reads_dst(inst->op) || inst->op == M_SETCC) && !is_zero_idiom(inst))
+        add_reg(regs, &count, inst->dst.reg);
+    return count;
+}
+
+int minst_defs(MInst *inst, int *regs)
+{
+    int count = 0;
+    switch (inst->op)
+    {
+    case M_CALL:
+        for (int i = 0; i < CALLER_SAVED_INT_COUNT; i++)
+            add_reg(regs, &count, caller_saved_int[i]);
+        for (int i = REG_XMM0; i <= REG_XMM15; i++)
+            add_reg(regs, &count, i);
+        return count;
+    case M_CDQ:
+        add_reg(regs, &count, REG_RDX);
+        return count;
+    case M_IDIV:
+        add_reg(regs, &count, REG_RAX);
+        add_reg(regs, &count, REG_RDX);
+        return count;
+    case M_CPUID:
+        add_reg(regs, &count, REG_RAX);
+        add_reg(regs, &count, REG_RBX);
+        add_reg(regs, &count, REG_RCX);
+        add_reg(regs, &count, REG_RDX);
+        return count;
+    case M_XGETBV:
+        add_reg(regs, &count, REG_RAX);
+        add_reg(regs, &count, REG_RDX);
+        return count;
+    default:
+        break;
+    }
+    if (inst->dst.kind == MOP_REG && minst_writes_dst(inst->op))
+        add_reg(regs, &count, inst->dst.reg);
+    return count;
+}
+
+// ========================= 活跃区间 =========================
+
+// 机器基本块（按指令下标）
+typedef struct MBlock
+{
+    int first;
+    int last;
+    int succs[2];
+    int succ_count;
+    BitWord *live_in;
+    BitWord *live_out;
+    BitWord *use;   // 块内先读后写的寄存器
+    BitWord *def;   // 块内写过的寄存器
+} MBlock;
+
+// 物理寄存器被占用的区段
+typedef struct Segment
+{
+    int start;
+    int end;
+} Segment;
+
+typedef struct FixedRanges
+{
+    Segment *segments;
+    int count;
+    int capacity;
+} FixedRanges;
+
+// 虚拟寄存器的活跃区间：覆盖全部活跃位置的单个区间
+typedef struct LiveInterval
+{
+    int vreg;
+    RegClass rc;
+    int start;
+    int end;
+    int *refs;      // 读写位置（升序）
+    int ref_count;
+    int ref_capacity;
+    int hint;       // 偏好的物理寄存器（来自与物理寄存器之间的传送）
+    int partner;    // 与之传送的另一个虚拟寄存器，-1 表示无
+    int reg;        // 分配结果，REG_NONE 表示溢出
+} LiveInterval;
+
+typedef struct Allocator
+{
+    MFunction *mf;
+    MInst **insts;
+    int inst_count;
+    MBlock *blocks;
+    int block_count;
+    int reg_count;          // 物理寄存器与虚拟寄存器的总数（活跃分析的下标空间）
+    int words;
+    LiveInterval *intervals;
+    FixedRanges fixed[PHYS_REG_COUNT];
+} Allocator;
+
+// 寄存器在活跃分析中的下标：物理寄存器在前，虚拟寄存器在后
+static int reg_index(int reg)
+{
+    return IS_VREG(reg) ? PHYS_REG_COUNT + (reg - FIRST_VREG) : reg;
+}
+
+static void build_blocks(Allocator *A)
+{
+    MFunction *mf = A->mf;
+    for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+        A->inst_count++;
+    A->insts = (MInst **)malloc((A->inst_count + 1) * sizeof(MInst *));
+
+    int max_label = 0;
+    int index = 0;
+    for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+    {
+        A->insts[index++] = inst;
+        if (inst->op == M_LABEL && inst->src.label > max_label)
+            max_label = inst->src.label;
+    }
+
+    // 划分基本块：标签开始新块，跳转和返回结束当前块
+    A->blocks = (MBlock *)calloc(A->inst_count + 1, sizeof(MBlock));
+    int *label_block = (int *)malloc((max_label + 1) * sizeof(int));
+    for (int i = 0; i <= max_label; i++)
+        label_block[i] = -1;
+    bool open = false;
+    for (int i = 0; i < A->inst_count; i++)
+    {
+        MInst *inst = A->insts[i];
+        if (!open || inst->op == M_LABEL)
+        {
+            if (open)
+                A->blocks[A->block_count - 1].last = i - 1;
+            A->blocks[A->block_count].first = i;
+            A->block_count++;
+            open = true;
+        }
+        if (inst->op == M_LABEL)
+            label_block[inst->src.label] = A->block_count - 1;
+        if (inst->op == M_JMP || inst->op == M_JCC || inst->op == M_RET)
+        {
+            A->blocks[A->block_count - 1].last = i;
+            open = false;
+        }
+    }
+    if (open)
+        A->blocks[A->block_count - 1].last = A->inst_count - 1;
+
+    for (int b = 0; b < A->block_count; b++)
+    {
+        MBlock *block = &A->blocks[b];
+        MInst *last = A->insts[block->last];
+        if (last->op == M_JMP || last->op == M_JCC)
+        {
+            int target = last->src.label <= max_label ? label_block[last->src.label] : -1;
+            if (target >= 0)
+                block->succs[block->succ_count++] = target;
+        }
+        if (last->op != M_JMP && last->op != M_RET && b + 1 < A->block_count)
+            block->succs[block->succ_count++] = b + 1;
+    }
+    free(label_block);
+}
+
+static void compute_block_liveness(Allocator *A)
+{
+    A->reg_count = PHYS_REG_COUNT + A->mf->vreg_count;
+    A->words = (A->reg_count + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    int regs[MAX_INST_REGS];
+
+    for (int b = 0; b < A->block_count; b++)
+    {
+        MBlock *block = &A->blocks[b];
+        block->live_in = bitset_new(A->words);
+        block->live_out = bitset_new(A->words);
+        block->use = bitset_new(A->words);
+        block->def = bitset_new(A->words);
+        for (int i = block->first; i <= block->last; i++)
+        {
+            int count = minst_uses(A->insts[i], regs);
+            for (int k = 0; k < count; k++)
+            {
+                int r = reg_index(regs[k]);
+                if (!bitset_test(block->def, r))
+                    bitset_set(block->use, r);
+            }
+            count = minst_defs(A->insts[i], regs);
+            for (int k = 0; k < count; k++)
+                bitset_set(block->def, reg_index(regs[k]));
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int b = A->block_count - 1; b >= 0; b--)
+        {
+            MBlock *block = &A->blocks[b];
+            for (int s = 0; s < block->succ_count; s++)
+            {
+                BitWord *succ_in = A->blocks[block->succs[s]].live_in;
+                for (int w = 0; w < A->words; w++)
+                    block->live_out[w] |= succ_in[w];
+            }
+            for (int w = 0; w < A->words; w++)
+            {
+                BitWord in = block->use[w] | (block->live_out[w] & ~block->def[w]);
+                if (in != block->live_in[w])
+                {
+                    block->live_in[w] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+static void add_ref(LiveInterval *interval, int pos)
+{
+    if (interval->ref_count == interval->ref_capacity)
+    {
+        interval->ref_capacity = interval->ref_capacity ? interval->ref_capacity * 2 : 8;
+        interval->refs = (int *)realloc(interval->refs, interval->ref_capacity * sizeof(int));
+    }
+    interval->refs[interval->ref_count++] = pos;
+}
+
+// 寄存器 index 在 [start, end] 上活跃
+static void add_range(Allocator *A, int index, int start, int end)
+{
+    if (index >= PHYS_REG_COUNT)
+    {
+        LiveInterval *interval = &A->intervals[index - PHYS_REG_COUNT];
+        if (start < interval->start)
+            interval->start = start;
+        if (end > interval->end)
+            interval->end = end;
+        return;
+    }
+
+    FixedRanges *fixed = &A->fixed[index];
+    if (fixed->count == fixed->capacity)
+    {
+        fixed->capacity = fixed->capacity ? fixed->capacity * 2 : 8;
+        fixed->segments = (Segment *)realloc(fixed->segments, fixed->capacity * sizeof(Segment));
+    }
+    fixed->segments[fixed->count].start = start;
+    fixed->segments[fixed->count].end = end;
+    fixed->count++;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+// 指令 i 的读位置为 2i，写位置为 2i+1；逐块倒序扫描得到区间
+static void build_intervals(Allocator *A)
+{
+    MFunction *mf = A->mf;
+    A->intervals = (LiveInterval *)calloc(mf->vreg_count + 1, sizeof(LiveInterval));
+    for (int v = 0; v < mf->vreg_count; v++)
+    {
+        LiveInterval *interval = &A->intervals[v];
+        interval->vreg = FIRST_VREG + v;
+        interval->rc = mf->vreg_class[v];
+        interval->start = INT_MAX;
+        interval->end = -1;
+        interval->hint = REG_NONE;
+        interval->partner = -1;
+        interval->reg = REG_NONE;
+    }
+
+    BitWord *live = bitset_new(A->words);
+    int *range_end = (int *)malloc(A->reg_count * sizeof(int));
+    int regs[MAX_INST_REGS];
+
+    for (int b = 0; b < A->block_count; b++)
+    {
+        MBlock *block = &A->blocks[b];
+        int block_start = 2 * block->first;
+        int block_end = 2 * block->last + 1;
+        memcpy(live, block->live_out, A->words * sizeof(BitWord));
+        for (int r = 0; r < A->reg_count; r++)
+        {
+            if (bitset_test(live, r))
+                range_end[r] = block_end;
+        }
+
+        for (int i = block->last; i >= block->first; i--)
+        {
+            int pos = 2 * i;
+            int count = minst_defs(A->insts[i], regs);
+            for (int k = 0; k < count; k++)
+            {
+                int r = reg_index(regs[k]);
+                if (bitset_test(live, r))
+                {
+                    add_range(A, r, pos + 1, range_end[r]);
+                    bitset_clear(live, r);
+                }
+                else
+                    add_range(A, r, pos + 1, pos + 1);
+                if (r >= PHYS_REG_COUNT)
+                    add_ref(&A->intervals[r - PHYS_REG_COUNT], pos + 1);
+            }
+            count = minst_uses(A->insts[i], regs);
+            for (int k = 0; k < count; k++)
+            {
+                int r = reg_index(regs[k]);
+                if (!bitset_test(live, r))
+                {
+                    bitset_set(live, r);
+                    range_end[r] = pos;
+                }
+                if (r >= PHYS_REG_COUNT)
+                    add_ref(&A->intervals[r - PHYS_REG_COUNT], pos);
+            }
+        }
+
+        for (int r = 0; r < A->reg_count; r++)
+        {
+            if (bitset_test(live, r))
+                add_range(A, r, block_start, range_end[r]);
+        }
+    }
+
+    for (int v = 0; v < mf->vreg_count; v++)
+        qsort(A->intervals[v].refs, A->intervals[v].ref_count, sizeof(int), compare_ints);
+    free(live);
+    free(range_end);
+}
+
+// 传送指令给出的偏好：与物理寄存器之间的传送偏好该寄存器，虚拟寄存器之间的传送偏好对方的寄存器
+static void collect_hints(Allocator *A)
+{
+    for (int i = 0; i < A->inst_count; i++)
+    {
+        MInst *inst = A->insts[i];
+        if ((inst->op != M_MOV && inst->op != M_MOVSS && inst->op != M_MOVUPS) || inst->src.kind != MOP_REG ||
+            inst->dst.kind != MOP_REG)
+            continue;
+        int src = inst->src.reg;
+        int dst = inst->dst.reg;
+        if (IS_VREG(src) && IS_VREG(dst))
+        {
+            A->intervals[src - FIRST_VREG].partner = dst - FIRST_VREG;
+            A->intervals[dst - FIRST_VREG].partner = src - FIRST_VREG;
+        }
+        else if (IS_VREG(dst))
+            A->intervals[dst - FIRST_VREG].hint = src;
+        else if (IS_VREG(src))
+            A->intervals[src - FIRST_VREG].hint = dst;
+    }
+}
+
+// ========================= 线性扫描 =========================
+
+static bool fixed_conflict(Allocator *A, int reg, LiveInterval *interval)
+{
+    FixedRanges *fixed = &A->fixed[reg];
+    for (int i = 0; i < fixed->count; i++)
+    {
+        if (fixed->segments[i].start <= interval->end && interval->start <= fixed->segments[i].end)
+            return true;
+    }
+    return false;
+}
+
+static bool in_class(int reg, RegClass rc)
+{
+    if (rc == RC_FLOAT)
+        return IS_XMM(reg) && reg != SCRATCH_FLOAT && reg != SCRATCH_FLOAT2;
+    return reg >= REG_RAX && reg <= REG_R15 && reg != REG_RSP && reg != REG_RBP && reg != SCRATCH_INT &&
+           reg != SCRATCH_BASE && reg != SCRATCH_INDEX;
+}
+
+// pos 之后第一次读写的位置，之后不再使用时视为无穷远
+static int next_use(LiveInterval *interval, int pos)
+{
+    for (int i = 0; i < interval->ref_count; i++)
+    {
+        if (interval->refs[i] >= pos)
+            return interval->refs[i];
+    }
+    return INT_MAX;
+}
+
+static int compare_interval_start(const void *a, const void *b)
+{
+    const LiveInterval *x = *(LiveInterval *const *)a;
+    const LiveInterval *y = *(LiveInterval *const *)b;
+    if (x->start != y->start)
+        return x->start < y->start ? -1 : 1;
+    return x->vreg - y->vreg;
+}
+
+static bool can_take(Allocator *A, LiveInterval **owner, int reg, LiveInterval *interval)
+{
+    return reg != REG_NONE && in_class(reg, interval->rc) && owner[reg] == NULL &&
+           !fixed_conflict(A, reg, interval);
+}
+
+static void linear_scan(Allocator *A)
+{
+    MFunction *mf = A->mf;
+    LiveInterval **order = (LiveInterval **)malloc((mf->vreg_count + 1) * sizeof(LiveInterval *));
+    int count = 0;
+    for (int v = 0; v < mf->vreg_count; v++)
+    {
+        if (A->intervals[v].end >= 0)
+            order[count++] = &A->intervals[v];
+    }
+    qsort(order, count, sizeof(LiveInterval *), compare_interval_start);
+
+    LiveInterval *owner[PHYS_REG_COUNT];
+    memset(owner, 0, sizeof(owner));
+
+    for (int i = 0; i < count; i++)
+    {
+        LiveInterval *current = order[i];
+
+        // 结束的区间释放寄存器
+        for (int r = 0; r < PHYS_REG_COUNT; r++)
+        {
+            if (owner[r] != NULL && owner[r]->end < current->start)
+                owner[r] = NULL;
+        }
+
+        const int *candidates = current->rc == RC_FLOAT ? float_allocation_order : int_allocation_order;
+        int candidate_count = current->rc == RC_FLOAT ? FLOAT_ALLOCATION_COUNT : INT_ALLOCATION_COUNT;
+
+        int chosen = REG_NONE;
+        int partner_reg = current->partner >= 0 ? A->intervals[current->partner].reg : REG_NONE;
+        if (can_take(A, owner, current->hint, current))
+            chosen = current->hint;
+        else if (can_take(A, owner, partner_reg, current))
+            chosen = partner_reg;
+        for (int c = 0; c < candidate_count && chosen == REG_NONE; c++)
+        {
+            if (can_take(A, owner, candidates[c], current))
+                chosen = candidates[c];
+        }
+
+        if (chosen == REG_NONE)
+        {
+            // 没有空闲寄存器：在占用可用寄存器的区间和当前区间中溢出下次使用最远的一个
+            LiveInterval *victim = NULL;
+            int furthest = next_use(current, current->start);
+            for (int c = 0; c < candidate_count; c++)
+            {
+                LiveInterval *occupant = owner[candidates[c]];
+                if (occupant == NULL || fixed_conflict(A, candidates[c], current))
+                    continue;
+                int use = next_use(occupant, current->start);
+                if (use > furthest)
+                {
+                    furthest = use;
+                    victim = occupant;
+                }
+            }
+            if (victim != NULL)
+            {
+                chosen = victim->reg;
+                victim->reg = REG_NONE;
+                owner[chosen] = NULL;
+            }
+        }
+
+        if (chosen != REG_NONE)
+        {
+            current->reg = chosen;
+            owner[chosen] = current;
+            if (is_callee_saved(chosen))
+                mf->used_callee_saved[chosen] = true;
+        }
+    }
+    free(order);
+}
+
+// 虚拟寄存器的宽度：出现在向量指令中的为向量的字节数，否则为8
+static int *vreg_widths(Allocator *A)
+{
+    int *widths = (int *)malloc((A->mf->vreg_count + 1) * sizeof(int));
+    for (int v = 0; v < A->mf->vreg_count; v++)
+        widths[v] = 8;
+    for (int i = 0; i < A->inst_count; i++)
+    {
+        MInst *inst = A->insts[i];
+        if (inst->size <= 8)
+            continue;
+        if (inst->src.kind == MOP_REG && IS_VREG(inst->src.reg) && widths[inst->src.reg - FIRST_VREG] < inst->size)
+            widths[inst->src.reg - FIRST_VREG] = inst->size;
+        if (inst->dst.kind == MOP_REG && IS_VREG(inst->dst.reg) && widths[inst->dst.reg - FIRST_VREG] < inst->size)
+            widths[inst->dst.reg - FIRST_VREG] = inst->size;
+    }
+    return widths;
+}
+
+VRegAssignment linear_scan_allocate(MFunction *mf)
+{
+    Allocator A;
+    memset(&A, 0, sizeof(A));
+    A.mf = mf;
+    build_blocks(&A);
+    compute_block_liveness(&A);
+    build_intervals(&A);
+    collect_hints(&A);
+    linear_scan(&A);
+
+    // 向量寄存器的溢出槽按向量大小分配，16字节对齐（SSE 指令的内存操作数要求对齐）
+    int *widths = vreg_widths(&A);
+    VRegAssignment assignment;
+    assignment.reg = (int *)malloc((mf->vreg_count + 1) * sizeof(int));
+    assignment.slot = (int *)malloc((mf->vreg_count + 1) * sizeof(int));
+    for (int v = 0; v < mf->vreg_count; v++)
+    {
+        LiveInterval *interval = &A.intervals[v];
+        assignment.reg[v] = interval->reg;
+        assignment.slot[v] = -1;
+        if (interval->end < 0)
+            continue;
+        if (interval->reg == REG_NONE)
+        {
+            assignment.slot[v] = mfunction_new_object(mf, widths[v], widths[v] > 8 ? 16 : 8);
+            opt_stats.spilled_value_count++;
+        }
+        else
+            opt_stats.allocated_value_count++;
+    }
+
+    free(widths);
+    for (int v = 0; v < mf->vreg_count; v++)
+        free(A.intervals[v].refs);
+    free(A.intervals);
+    for (int r = 0; r < PHYS_REG_COUNT; r++)
+        free(A.fixed[r].segments);
+    for (int b = 0; b < A.block_count; b++)
+    {
+        free(A.blocks[b].live_in);
+        free(A.blocks[b].live_out);
+        free(A.blocks[b].use);
+        free(A.blocks[b].def);
+    }
+    free(A.blocks);
+    free(A.insts);
+    return assignment;
+}
+
+void free_vreg_assignment(VRegAssignment *assignment)
+{
+    free(assignment->reg);
+    free(assignment->slot);
+    assignment->reg = NULL;
+    assignment->slot = NULL;
+}
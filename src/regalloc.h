@@ -0,0 +1,30 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "machine.h"
+
+// 寄存器分配结果：每个虚拟寄存器分到的物理寄存器，或溢出到的栈帧对象
+typedef struct VRegAssignment
+{
+    int *reg;   // 按虚拟寄存器编号减 FIRST_VREG 索引，REG_NONE 表示溢出
+    int *slot;  // 溢出时的栈帧对象，否则为 -1
+} VRegAssignment;
+
+// 改写溢出操作数时使用的临时寄存器，不参与分配
+#define SCRATCH_INT REG_RAX
+#define SCRATCH_BASE REG_R11
+#define SCRATCH_INDEX REG_R10
+#define SCRATCH_FLOAT REG_XMM15
+#define SCRATCH_FLOAT2 REG_XMM14
+
+// 线性扫描寄存器分配：在线性化的机器指令上计算活跃区间，整数与 SSE 寄存器分别分配；
+// 调用点上调用者保存寄存器被破坏，跨调用的区间只能使用被调用者保存寄存器；
+// 寄存器不足时溢出下次使用最远的区间。用到的被调用者保存寄存器记录在 mf 中
+VRegAssignment linear_scan_allocate(MFunction *mf);
+void free_vreg_assignment(VRegAssignment *assignment);
+
+// 指令读写的寄存器（含内存操作数的基址与变址、调用与除法的隐含寄存器），返回个数
+int minst_uses(MInst *inst, int *regs);
+int minst_defs(MInst *inst, int *regs);
+
+#endif
@@ -285,6 +285,11 @@ DataType get_exp_type(TreeNode *exp)
         {
             return TYPE_INT;
         }
+        // 函数调用 (ID LP Args RP) 的类型是函数的返回类型
+        if (sym->sym_type == SYMBOL_FUNCTION)
+        {
+            return sym->return_type;
+        }
         return sym->data_type;
     }
     case NODE_LP:
@@ -577,6 +582,24 @@ void analyze_variable_def(TreeNode *def)
     }
 }
 
+// 分析全局变量定义：ExtDecList 为 VarDec 或 VarDec COMMA ExtDecList，变量登记在全局作用域
+void analyze_global_variable_def(TreeNode *extdef)
+{
+    TreeNode *specifier = extdef->child;
+    DataType var_type = get_specifier_type(specifier);
+
+    for (TreeNode *list = specifier->sibling; list && list->type == NODE_EXTDECLIST;)
+    {
+        TreeNode *vardec = list->child;
+        char *var_name = get_identifier_name(vardec);
+        if (var_name)
+        {
+            insert_symbol(var_name, SYMBOL_VARIABLE, var_type, vardec->lineno);
+        }
+        list = vardec->sibling ? vardec->sibling->sibling : NULL;
+    }
+}
+
 // 分析函数定义
 void analyze_function_def(TreeNode *extdef)
 {
@@ -750,9 +773,14 @@ void analyze_node(TreeNode *node)
             // 函数定义
             analyze_function_def(node);
         }
+        else if (second && second->type == NODE_EXTDECLIST)
+        {
+            // 全局变量定义
+            analyze_global_variable_def(node);
+        }
         else
         {
-            // 变量定义
+            // 结构体定义等
             TreeNode *child = node->child;
             while (child)
             {
@@ -7,6 +7,7 @@
 // 类型定义
 typedef enum
 {
+    TYPE_UNKNOWN = -1, // 类型未知（如尚无到达定值的临时变量），小于其他类型
     TYPE_INT,
     TYPE_FLOAT,
     TYPE_STRUCT,
@@ -83,6 +84,7 @@ char *get_identifier_name(TreeNode *node);
 DataType get_specifier_type(TreeNode *specifier);
 void analyze_function_def(TreeNode *extdef);
 void analyze_variable_def(TreeNode *def);
+void analyze_global_variable_def(TreeNode *extdef);
 void analyze_expression(TreeNode *exp);
 void analyze_statement(TreeNode *stmt);
 void analyze_function_call(TreeNode *exp);
@@ -0,0 +1,222 @@
+#include "tail_recursion.h"
+#include "cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 判断尾调用时沿 GOTO 跟随的最大次数
+#define TAIL_CALL_MAX_HOPS 8
+
+// ========================= 辅助函数 =========================
+
+static bool is_variable_named(Operand *op, const char *name)
+{
+    return op != NULL && op->type == OPERAND_VARIABLE && strcmp(op->u.name, name) == 0;
+}
+
+// 形参是否在函数体中按数组使用（数组按名传递，不能重新赋值）
+static bool param_is_array(Instruction *func_def, const char *name)
+{
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if ((inst->op == OP_ARRAY_GET && is_variable_named(inst->arg1, name)) ||
+            (inst->op == OP_ARRAY_SET && is_variable_named(inst->result, name)))
+            return true;
+    }
+    return false;
+}
+
+// 操作数是否为本函数的形参
+static bool is_param(Instruction **params, int param_count, Operand *op)
+{
+    for (int i = 0; i < param_count; i++)
+    {
+        if (operands_equal(params[i]->result, op))
+            return true;
+    }
+    return false;
+}
+
+// 变量是否在(first, last)之间被赋值
+static bool defined_between(Instruction *first, Instruction *last, Operand *op)
+{
+    for (Instruction *inst = first->next; inst != NULL && inst != last; inst = inst->next)
+    {
+        if (operands_equal(instruction_def(inst), op))
+            return true;
+    }
+    return false;
+}
+
+static Instruction *find_label(Instruction *func_def, Operand *label)
+{
+    for (Instruction *inst = func_def->next; inst != NULL && inst->op != OP_FUNC_END; inst = inst->next)
+    {
+        if (inst->op == OP_LABEL && operands_equal(inst->result, label))
+            return inst;
+    }
+    return NULL;
+}
+
+// CALL 之后（跳过标签、沿无条件跳转）是否直接返回调用结果
+static bool is_tail_call(Instruction *func_def, Instruction *call)
+{
+    if (call->result == NULL)
+        return false;
+
+    Instruction *inst = call->next;
+    for (int hops = 0; inst != NULL && hops <= TAIL_CALL_MAX_HOPS;)
+    {
+        if (inst->op == OP_LABEL)
+        {
+            inst = inst->next;
+        }
+        else if (inst->op == OP_GOTO)
+        {
+            inst = find_label(func_def, inst->arg1);
+            hops++;
+        }
+        else
+        {
+            return inst->op == OP_RETURN && operands_equal(inst->result, call->result);
+        }
+    }
+    return false;
+}
+
+// ========================= 尾调用改写 =========================
+
+// 把一个自身尾调用改写为形参赋值加跳转：
+//   ARG x1 ... ARG xn; t := CALL f; RETURN t
+// 变为
+//   p1 := v1 ... pn := vn; GOTO entry
+// 实参在原 ARG 处求值；实参引用形参或在 ARG 与 CALL 之间被改写时先复制到新临时变量，
+// 保证形参的并行赋值不会读到已更新的值
+static void rewrite_tail_call(Instruction *func_def, CallSite *site, Instruction **params,
+                              bool *array_params, Operand *entry_label)
+{
+    int n = site->arg_count;
+    Operand **values = (Operand **)calloc(n + 1, sizeof(Operand *));
+
+    for (int i = 0; i < n; i++)
+    {
+        Instruction *arg = site->args[i];
+        Operand *value = arg->result;
+
+        if (array_params[i] || (operands_equal(value, params[i]->result) && !defined_between(arg, site->call, value)))
+        {
+            // 原样传回的形参无需赋值
+            values[i] = NULL;
+        }
+        else if (value->type == OPERAND_CONSTANT || value->type == OPERAND_CONSTANT_FLOAT ||
+                 (!is_param(params, n, value) && !defined_between(arg, site->call, value)))
+        {
+            values[i] = copy_operand(value);
+        }
+        else
+        {
+            Instruction *copy = new_instruction(OP_ASSIGN, new_operand_temp(), copy_operand(value), NULL);
+            values[i] = copy_operand(copy->result);
+            insert_instruction_after(arg, copy);
+        }
+
+        unlink_instruction(find_prev_instruction(func_def, arg), arg);
+        free_instruction(arg);
+    }
+
+    // CALL 原位替换为赋值序列与回跳
+    Instruction *call = site->call;
+    Instruction *pos = find_prev_instruction(func_def, call);
+    for (int i = 0; i < n; i++)
+    {
+        if (values[i] == NULL)
+            continue;
+        Instruction *assign = new_instruction(OP_ASSIGN, copy_operand(params[i]->result), values[i], NULL);
+        insert_instruction_after(pos, assign);
+        pos = assign;
+    }
+    Instruction *jump = new_instruction(OP_GOTO, NULL, copy_operand(entry_label), NULL);
+    insert_instruction_after(pos, jump);
+
+    // 紧随其后的 RETURN 已不可达，一并删除；经跳转到达的 RETURN 可能被其他路径共用，留给CFG化简
+    Instruction *next = call->next;
+    unlink_instruction(jump, call);
+    free_instruction(call);
+    if (next != NULL && next->op == OP_RETURN)
+    {
+        unlink_instruction(jump, next);
+        free_instruction(next);
+    }
+
+    free(values);
+}
+
+// 处理一个函数中的全部自身尾调用，返回改写个数
+static int eliminate_in_function(CallGraph *graph, int f, CallSite *sites, int site_count)
+{
+    Instruction *func_def = graph->nodes[f].func_def;
+    int param_count = graph->nodes[f].param_count;
+    Instruction **params = (Instruction **)malloc((param_count + 1) * sizeof(Instruction *));
+    bool *array_params = (bool *)calloc(param_count + 1, sizeof(bool));
+
+    Instruction *inst = func_def->next;
+    for (int i = 0; i < param_count; i++, inst = inst->next)
+    {
+        params[i] = inst;
+        array_params[i] = param_is_array(func_def, inst->result->u.name);
+    }
+
+    Operand *entry_label = NULL;
+    int rewritten = 0;
+    for (int s = 0; s < site_count; s++)
+    {
+        CallSite *site = &sites[s];
+        if (site->caller != f || site->callee != f || !is_tail_call(func_def, site->call))
+            continue;
+
+        // 数组形参只能原样传回
+        bool ok = true;
+        for (int i = 0; i < param_count && ok; i++)
+        {
+            if (array_params[i] && !operands_equal(site->args[i]->result, params[i]->result))
+                ok = false;
+        }
+        if (!ok)
+            continue;
+
+        // 在形参之后插入入口标签，作为回跳目标
+        if (entry_label == NULL)
+        {
+            entry_label = new_operand_label();
+            Instruction *pos = param_count > 0 ? params[param_count - 1] : func_def;
+            insert_instruction_after(pos, new_instruction(OP_LABEL, entry_label, NULL, NULL));
+        }
+
+        rewrite_tail_call(func_def, site, params, array_params, entry_label);
+        rewritten++;
+    }
+
+    free(params);
+    free(array_params);
+    return rewritten;
+}
+
+// 尾递归消除，返回改写的尾调用个数
+int eliminate_tail_recursion()
+{
+    CallGraph *graph = build_call_graph();
+    CallSite *sites = NULL;
+    int site_count = collect_call_sites(graph, &sites);
+
+    int total = 0;
+    for (int f = 0; f < graph->node_count; f++)
+    {
+        if (graph->nodes[f].recursive)
+            total += eliminate_in_function(graph, f, sites, site_count);
+    }
+
+    free_call_sites(sites, site_count);
+    free_call_graph(graph);
+    opt_stats.tail_recursion_count += total;
+    return total;
+}
@@ -0,0 +1,9 @@
+#ifndef TAIL_RECURSION_H
+#define TAIL_RECURSION_H
+
+#include "callgraph.h"
+
+// 尾递归消除：自身尾调用改为形参重新赋值并跳回函数入口
+int eliminate_tail_recursion();
+
+#endif
@@ -0,0 +1,127 @@
+#include "type_infer.h"
+#include <stdlib.h>
+#include <string.h>
+
+DataType declared_variable_type(const char *function, const char *name)
+{
+    VariableInfo *info = lookup_variable_info(function, name);
+    return info != NULL && info->type == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+}
+
+DataType operand_value_type(CFG *cfg, const char *function, const signed char *types, Operand *op)
+{
+    switch (op->type)
+    {
+    case OPERAND_CONSTANT_FLOAT:
+        return TYPE_FLOAT;
+    case OPERAND_TEMP:
+    {
+        int index = operand_table_lookup(&cfg->vars, op);
+        return index >= 0 && types[index] == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+    }
+    case OPERAND_VARIABLE:
+        return declared_variable_type(function, op->u.name);
+    default:
+        return TYPE_INT;
+    }
+}
+
+DataType instruction_result_type(CFG *cfg, const char *function, const signed char *types, Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+    case OP_NEG:
+        return operand_value_type(cfg, function, types, inst->arg1);
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+        if (operand_value_type(cfg, function, types, inst->arg1) == TYPE_FLOAT ||
+            operand_value_type(cfg, function, types, inst->arg2) == TYPE_FLOAT)
+            return TYPE_FLOAT;
+        return TYPE_INT;
+    case OP_CALL:
+        return lookup_function_type(inst->arg1->u.name) == TYPE_FLOAT ? TYPE_FLOAT : TYPE_INT;
+    case OP_ARRAY_GET:
+        if (inst->arg1->type == OPERAND_VARIABLE)
+            return declared_variable_type(function, inst->arg1->u.name);
+        return TYPE_INT;
+    case OP_PARAM:
+        return declared_variable_type(function, inst->result->u.name);
+    default:
+        return TYPE_INT;
+    }
+}
+
+void transfer_temp_types(CFG *cfg, const char *function, signed char *types, Instruction *inst)
+{
+    Operand *def = instruction_def(inst);
+    if (def == NULL || def->type != OPERAND_TEMP)
+        return;
+    int index = operand_table_lookup(&cfg->vars, def);
+    if (index >= 0)
+        types[index] = (signed char)instruction_result_type(cfg, function, types, inst);
+}
+
+signed char **infer_temp_types(CFG *cfg, const char *function)
+{
+    int count = cfg->vars.count + 1;
+    signed char **in = (signed char **)calloc(cfg->block_count, sizeof(signed char *));
+    signed char **out = (signed char **)calloc(cfg->block_count, sizeof(signed char *));
+    for (int b = 0; b < cfg->block_count; b++)
+    {
+        in[b] = (signed char *)malloc(count);
+        out[b] = (signed char *)malloc(count);
+        memset(in[b], TYPE_UNKNOWN, count);
+        memset(out[b], TYPE_UNKNOWN, count);
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < cfg->rpo_count; r++)
+        {
+            BasicBlock *block = cfg->rpo_order[r];
+            signed char *state = in[block->id];
+            for (int p = 0; p < block->pred_count; p++)
+            {
+                signed char *pred = out[block->preds[p]->id];
+                for (int i = 0; i < count; i++)
+                {
+                    // 两条路径上类型不同的值在汇合处一定不再使用，取哪一个都可以
+                    if (pred[i] > state[i])
+                        state[i] = pred[i];
+                }
+            }
+
+            signed char *result = (signed char *)malloc(count);
+            memcpy(result, state, count);
+            for (Instruction *inst = block->first;; inst = inst->next)
+            {
+                transfer_temp_types(cfg, function, result, inst);
+                if (inst == block->last)
+                    break;
+            }
+            if (memcmp(result, out[block->id], count) != 0)
+            {
+                memcpy(out[block->id], result, count);
+                changed = true;
+            }
+            free(result);
+        }
+    }
+
+    for (int b = 0; b < cfg->block_count; b++)
+        free(out[b]);
+    free(out);
+    return in;
+}
+
+void free_temp_types(CFG *cfg, signed char **types)
+{
+    for (int b = 0; b < cfg->block_count; b++)
+        free(types[b]);
+    free(types);
+}
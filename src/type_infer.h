@@ -0,0 +1,20 @@
+#ifndef TYPE_INFER_H
+#define TYPE_INFER_H
+
+#include "cfg.h"
+
+// 变量（或数组元素）的声明类型，结构体成员等未登记的变量按 int 处理
+DataType declared_variable_type(const char *function, const char *name);
+
+// types 为当前位置上各临时变量的类型（按 cfg->vars 下标），由 infer_temp_types 的块入口状态
+// 经 transfer_temp_types 逐条推进得到
+DataType operand_value_type(CFG *cfg, const char *function, const signed char *types, Operand *op);
+DataType instruction_result_type(CFG *cfg, const char *function, const signed char *types, Instruction *inst);
+void transfer_temp_types(CFG *cfg, const char *function, signed char *types, Instruction *inst);
+
+// 临时变量的类型由到达的定值决定（合并后的临时变量在不同位置可能存放不同类型的值），
+// 沿控制流图前向传播，返回按块编号索引的入口状态；尚无到达定值的临时变量为 TYPE_UNKNOWN
+signed char **infer_temp_types(CFG *cfg, const char *function);
+void free_temp_types(CFG *cfg, signed char **types);
+
+#endif
@@ -0,0 +1,388 @@
+#include "vectorize.h"
+#include "type_infer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 循环体的分析状态
+typedef struct BodyScan
+{
+    CFG *cfg;
+    const char *function;
+    VectorLoop *loop;
+    signed char *types;  // 当前位置上各临时变量的类型
+    bool *body_defs;     // 按变量表下标：在循环体块中有定值
+    bool *defined;       // 按变量表下标：本次迭代中已经定值
+    bool has_store;
+} BodyScan;
+
+// 一维数组，type 返回元素类型
+static bool array_type(const char *function, Operand *op, DataType *type)
+{
+    if (op->type != OPERAND_VARIABLE)
+        return false;
+    VariableInfo *info = lookup_variable_info(function, op->u.name);
+    if (info == NULL || info->array_size <= 0)
+        return false;
+    *type = info->type;
+    return true;
+}
+
+// 标量变量（局部或全局）
+static bool is_scalar_variable(const char *function, Operand *op)
+{
+    if (op->type != OPERAND_VARIABLE)
+        return false;
+    VariableInfo *info = lookup_variable_info(function, op->u.name);
+    return info == NULL || info->array_size == 0;
+}
+
+static bool is_local_scalar(const char *function, Operand *op)
+{
+    if (!is_scalar_variable(function, op))
+        return false;
+    VariableInfo *info = lookup_variable_info(function, op->u.name);
+    return info != NULL ? info->function != NULL : !is_global_variable(op->u.name);
+}
+
+static bool is_one(Operand *op)
+{
+    return op->type == OPERAND_CONSTANT && op->u.int_value == 1;
+}
+
+// ========================= 循环形状 =========================
+
+// block 可由前一块顺序执行进入
+static bool falls_into(CFG *cfg, BasicBlock *block)
+{
+    if (block->id == 0)
+        return false;
+    BasicBlock *prev = cfg->blocks[block->id - 1];
+    if (prev->last->op == OP_GOTO || prev->last->op == OP_RETURN)
+        return false;
+    for (int i = 0; i < block->pred_count; i++)
+    {
+        if (block->preds[i] == prev)
+            return true;
+    }
+    return false;
+}
+
+static BasicBlock *target_block(CFG *cfg, Operand *label)
+{
+    if (label == NULL || label->u.temp_no < 0 || label->u.temp_no >= cfg->label_limit)
+        return NULL;
+    return cfg->label_block[label->u.temp_no];
+}
+
+// 把比较跳转给出的继续条件化为 counter < bound 或 counter <= bound；continues 为false时跳转表示退出循环
+static bool set_condition(VectorLoop *loop, Instruction *branch, bool continues)
+{
+    OpType op = continues ? branch->op : negate_branch(branch->op);
+    switch (op)
+    {
+    case OP_IF_LT:
+    case OP_IF_LE:
+        loop->counter = branch->arg1;
+        loop->bound = branch->arg2;
+        loop->inclusive = op == OP_IF_LE;
+        return true;
+    case OP_IF_GT:
+    case OP_IF_GE:
+        loop->counter = branch->arg2;
+        loop->bound = branch->arg1;
+        loop->inclusive = op == OP_IF_GE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ========================= 循环体 =========================
+
+// inst 为 result := counter + 1（常量可在任一边）
+static bool is_increment(Instruction *inst, Operand *result, Operand *counter)
+{
+    return inst->op == OP_ADD && operands_equal(inst->result, result) &&
+           ((operands_equal(inst->arg1, counter) && is_one(inst->arg2)) ||
+            (is_one(inst->arg1) && operands_equal(inst->arg2, counter)));
+}
+
+// 循环体末尾（跳转之前）的循环变量自增：counter := counter + 1，或 t := counter + 1; counter := t。
+// insts[0..count) 为跳转之前的指令，返回自增第一条指令的下标，没有时返回-1
+static int find_increment(Instruction **insts, int count, Operand *counter)
+{
+    if (count < 1)
+        return -1;
+    Instruction *last = insts[count - 1];
+    if (is_increment(last, counter, counter))
+        return count - 1;
+    if (count >= 2 && last->op == OP_ASSIGN && operands_equal(last->result, counter) &&
+        last->arg1->type == OPERAND_TEMP && is_increment(insts[count - 2], last->arg1, counter))
+        return count - 2;
+    return -1;
+}
+
+// 值操作数：本次迭代中的定值，或循环不变量（常量、循环体中没有定值的标量）。
+// 在本次迭代定值之前使用、又在循环体中定值的操作数取的是上一次迭代的值，不能向量化
+static bool scan_value(BodyScan *S, Operand *op)
+{
+    if (operands_equal(op, S->loop->counter))
+        return false;
+    if (op->type == OPERAND_CONSTANT || op->type == OPERAND_CONSTANT_FLOAT)
+        return true;
+    if (op->type != OPERAND_TEMP && !is_scalar_variable(S->function, op))
+        return false;
+    int index = operand_table_lookup(&S->cfg->vars, op);
+    return index >= 0 && (S->defined[index] || !S->body_defs[index]);
+}
+
+// 定值只能写临时变量或局部标量，值的类型与元素类型一致
+static bool scan_def(BodyScan *S, Instruction *inst)
+{
+    Operand *x = inst->result;
+    if (x->type != OPERAND_TEMP && !is_local_scalar(S->function, x))
+        return false;
+    if (operands_equal(x, S->loop->counter) || operands_equal(x, S->loop->bound))
+        return false;
+    if (instruction_result_type(S->cfg, S->function, S->types, inst) != S->loop->element_type)
+        return false;
+    int index = operand_table_lookup(&S->cfg->vars, x);
+    if (index < 0)
+        return false;
+    S->defined[index] = true;
+    return true;
+}
+
+static bool scan_array(BodyScan *S, Operand *array)
+{
+    DataType type;
+    return array_type(S->function, array, &type) && type == S->loop->element_type;
+}
+
+static bool scan_instruction(BodyScan *S, Instruction *inst)
+{
+    Operand *counter = S->loop->counter;
+    switch (inst->op)
+    {
+    case OP_ARRAY_GET:
+        if (!scan_array(S, inst->arg1) || !operands_equal(inst->arg2, counter))
+            return false;
+        break;
+    case OP_ARRAY_SET:
+        S->has_store = true;
+        return scan_array(S, inst->result) && operands_equal(inst->arg1, counter) && scan_value(S, inst->arg2);
+    case OP_DIV:
+        // 整数除法没有向量指令
+        if (S->loop->element_type != TYPE_FLOAT)
+            return false;
+        if (!scan_value(S, inst->arg1) || !scan_value(S, inst->arg2))
+            return false;
+        break;
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+        if (!scan_value(S, inst->arg1) || !scan_value(S, inst->arg2))
+            return false;
+        if (inst->op == OP_MUL && S->loop->element_type == TYPE_INT)
+            S->loop->int_multiply = true;
+        break;
+    case OP_ASSIGN:
+        if (!scan_value(S, inst->arg1))
+            return false;
+        break;
+    default:
+        return false;
+    }
+    return scan_def(S, inst);
+}
+
+// 元素类型取循环体中第一个数组的元素类型
+static bool find_element_type(const char *function, VectorLoop *loop)
+{
+    for (Instruction *inst = loop->first;; inst = inst->next)
+    {
+        Operand *array = inst->op == OP_ARRAY_GET ? inst->arg1 : (inst->op == OP_ARRAY_SET ? inst->result : NULL);
+        DataType type;
+        if (array != NULL && array_type(function, array, &type))
+        {
+            loop->element_type = type;
+            return type == TYPE_INT || type == TYPE_FLOAT;
+        }
+        if (inst == loop->last)
+            return false;
+    }
+}
+
+// 循环变量为 int 标量，上界为 int 常量或循环内不变的 int 值
+static bool check_counter(BodyScan *S, signed char *entry_types)
+{
+    VectorLoop *loop = S->loop;
+    if (!is_scalar_variable(S->function, loop->counter) ||
+        declared_variable_type(S->function, loop->counter->u.name) != TYPE_INT)
+        return false;
+    if (loop->bound->type == OPERAND_CONSTANT)
+        return true;
+    if (loop->bound->type != OPERAND_TEMP && !is_scalar_variable(S->function, loop->bound))
+        return false;
+    int index = operand_table_lookup(&S->cfg->vars, loop->bound);
+    return index >= 0 && !S->body_defs[index] && !operands_equal(loop->bound, loop->counter) &&
+           operand_value_type(S->cfg, S->function, entry_types, loop->bound) == TYPE_INT;
+}
+
+// 分析循环体，exit 为退出循环后到达的块
+static bool analyze_body(CFG *cfg, const char *function, signed char **block_types, VectorLoop *loop,
+                         BasicBlock *exit)
+{
+    BasicBlock *body = loop->body;
+    int count = 0;
+    for (Instruction *inst = body->first;; inst = inst->next)
+    {
+        count++;
+        if (inst == body->last)
+            break;
+    }
+    Instruction **insts = (Instruction **)malloc(count * sizeof(Instruction *));
+    int k = 0;
+    for (Instruction *inst = body->first; k < count; inst = inst->next)
+        insts[k++] = inst;
+
+    int start = insts[0]->op == OP_LABEL ? 1 : 0;
+    int increment = find_increment(insts + start, count - 1 - start, loop->counter);
+    if (increment <= 0)
+    {
+        free(insts);
+        return false;
+    }
+    increment += start;
+    loop->first = insts[start];
+    loop->last = insts[increment - 1];
+
+    int vars = cfg->vars.count + 1;
+    BodyScan S;
+    S.cfg = cfg;
+    S.function = function;
+    S.loop = loop;
+    S.types = (signed char *)malloc(vars);
+    memcpy(S.types, block_types[body->id], vars);
+    S.body_defs = (bool *)calloc(vars, sizeof(bool));
+    S.defined = (bool *)calloc(vars, sizeof(bool));
+    S.has_store = false;
+    for (int i = 0; i < count; i++)
+    {
+        int index = operand_table_lookup(&cfg->vars, instruction_def(insts[i]));
+        if (index >= 0)
+            S.body_defs[index] = true;
+    }
+
+    bool ok = check_counter(&S, block_types[loop->entry->id]) && find_element_type(function, loop);
+    for (int i = start; i < increment && ok; i++)
+    {
+        ok = scan_instruction(&S, insts[i]);
+        transfer_temp_types(cfg, function, S.types, insts[i]);
+    }
+    ok = ok && S.has_store;
+
+    // 循环体中的定值（含自增经过的临时变量）不能在下一次迭代或循环之后使用：向量循环不写它们的标量值
+    if (increment + 1 < count - 1 && ok)
+        S.defined[operand_table_lookup(&cfg->vars, insts[increment]->result)] = true;
+    for (int i = 0; i < vars && ok; i++)
+    {
+        if (S.defined[i] && (bitset_test(loop->entry->live_in, i) || bitset_test(exit->live_in, i)))
+            ok = false;
+    }
+
+    free(S.types);
+    free(S.body_defs);
+    free(S.defined);
+    free(insts);
+    return ok;
+}
+
+// ========================= 识别 =========================
+
+// while 形式：H: IF i < n GOTO B; GOTO E; B: ...; GOTO H（或 H: IF i >= n GOTO E 之后顺序进入 B）
+static bool match_while_loop(CFG *cfg, BasicBlock *header, VectorLoop *loop, BasicBlock **exit)
+{
+    Instruction *branch = header->last;
+    if (header->first->op != OP_LABEL || header->first->next != branch || !is_relational_branch(branch->op) ||
+        header->pred_count != 2 || !falls_into(cfg, header) || header->id + 1 >= cfg->block_count)
+        return false;
+
+    BasicBlock *target = target_block(cfg, branch_target(branch));
+    BasicBlock *next = cfg->blocks[header->id + 1];
+    bool continues;
+    if (next->first == next->last && next->first->op == OP_GOTO && header->id + 2 < cfg->block_count &&
+        cfg->blocks[header->id + 2] == target)
+    {
+        loop->body = target;
+        *exit = target_block(cfg, next->first->arg1);
+        continues = true;
+    }
+    else
+    {
+        loop->body = next;
+        *exit = target;
+        continues = false;
+    }
+
+    BasicBlock *body = loop->body;
+    if (*exit == NULL || body->pred_count != 1 || body->last->op != OP_GOTO ||
+        body->last->arg1->u.temp_no != header->first->result->u.temp_no)
+        return false;
+    loop->entry = header;
+    loop->rotated = false;
+    return set_condition(loop, branch, continues);
+}
+
+// do-while 形式（循环旋转之后）：B: ...; IF i < n GOTO B，之后顺序执行到 E
+static bool match_rotated_loop(CFG *cfg, BasicBlock *body, VectorLoop *loop, BasicBlock **exit)
+{
+    Instruction *branch = body->last;
+    if (body->first->op != OP_LABEL || !is_relational_branch(branch->op) ||
+        branch_target(branch)->u.temp_no != body->first->result->u.temp_no || body->pred_count != 2 ||
+        !falls_into(cfg, body) || body->id + 1 >= cfg->block_count)
+        return false;
+    loop->entry = body;
+    loop->body = body;
+    loop->rotated = true;
+    *exit = cfg->blocks[body->id + 1];
+    return set_condition(loop, branch, true);
+}
+
+VectorLoop *find_vector_loops(CFG *cfg, const char *function)
+{
+    compute_liveness(cfg);
+    signed char **block_types = infer_temp_types(cfg, function);
+
+    VectorLoop *head = NULL;
+    VectorLoop **link = &head;
+    for (int b = 0; b < cfg->block_count; b++)
+    {
+        BasicBlock *block = cfg->blocks[b];
+        if (block->rpo < 0)
+            continue;
+        VectorLoop *loop = (VectorLoop *)calloc(1, sizeof(VectorLoop));
+        BasicBlock *exit = NULL;
+        bool matched = match_while_loop(cfg, block, loop, &exit) || match_rotated_loop(cfg, block, loop, &exit);
+        if (matched && analyze_body(cfg, function, block_types, loop, exit))
+        {
+            *link = loop;
+            link = &loop->next;
+        }
+        else
+            free(loop);
+    }
+
+    free_temp_types(cfg, block_types);
+    return head;
+}
+
+void free_vector_loops(VectorLoop *loops)
+{
+    while (loops != NULL)
+    {
+        VectorLoop *next = loops->next;
+        free(loops);
+        loops = next;
+    }
+}
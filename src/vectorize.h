@@ -0,0 +1,28 @@
+#ifndef VECTORIZE_H
+#define VECTORIZE_H
+
+#include "cfg.h"
+
+// 可向量化的计数循环：循环体是单个基本块，循环变量每次迭代加1；循环体只读写下标恰为循环变量的
+// 一维数组元素，其余运算是逐元素的加减乘除与赋值，操作数为本次迭代中的定值或循环不变量。
+// 各次迭代只访问各自下标上的元素，迭代之间没有依赖，可以按任意宽度成组执行
+typedef struct VectorLoop
+{
+    BasicBlock *entry;     // 向量循环插在该块之前，由前一块顺序执行进入
+    BasicBlock *body;      // 循环体所在的块
+    Instruction *first;    // 逐元素运算的第一条与最后一条指令（不含循环变量自增与跳转）
+    Instruction *last;
+    Operand *counter;      // 循环变量
+    Operand *bound;        // 上界，循环内不变
+    bool inclusive;        // 继续条件为 counter <= bound，否则为 counter < bound
+    bool rotated;          // do-while 形式：向量循环之后要重新检查条件才能进入标量循环
+    DataType element_type; // 循环内各数组的元素类型（一致）
+    bool int_multiply;     // 含 32 位整数乘法
+    struct VectorLoop *next;
+} VectorLoop;
+
+// 找出函数中的可向量化循环，按 entry 的块顺序排列
+VectorLoop *find_vector_loops(CFG *cfg, const char *function);
+void free_vector_loops(VectorLoop *loops);
+
+#endif
@@ -0,0 +1,2039 @@
+#include "x86_backend.h"
+#include "regalloc.h"
+#include "type_infer.h"
+#include "isel.h"
+#include "x86_peephole.h"
+#include "vectorize.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 值的种类：整数、单精度浮点、数组首地址
+typedef enum
+{
+    VALUE_INT,
+    VALUE_FLOAT,
+    VALUE_POINTER
+} ValueKind;
+
+// 变量的存放方式
+typedef enum
+{
+    VAR_SCALAR,        // 局部标量（含形参），放在虚拟寄存器中
+    VAR_GLOBAL_SCALAR, // 全局标量，RIP 相对寻址
+    VAR_LOCAL_ARRAY,   // 局部数组，栈帧对象
+    VAR_GLOBAL_ARRAY,  // 全局数组
+    VAR_ARRAY_PARAM,   // 数组形参，虚拟寄存器中存放首地址
+    VAR_UNSUPPORTED    // 多维数组
+} VarKind;
+
+// 函数签名：按顺序的形参种类与返回类型
+typedef struct Signature
+{
+    const char *name;
+    int param_count;
+    ValueKind *params;
+} Signature;
+
+// 已求值、等待 CALL 的实参
+typedef struct PendingArg
+{
+    MOperand value;
+    ValueKind kind;
+} PendingArg;
+
+// 推迟到使用处的定值
+typedef struct PendingDef
+{
+    Instruction *inst;
+    bool folded;  // 已并入当前的表达式树
+} PendingDef;
+
+// 单个函数的翻译状态
+typedef struct Lowering
+{
+    MProgram *program;
+    MFunction *mf;
+    CFG *cfg;
+    const char *function;
+    DataType return_type;
+    signed char *types;  // 当前位置上各临时变量的类型（按变量表下标），-1 表示未定义
+    int *vregs[2];       // 按寄存器类别与变量表下标：对应的虚拟寄存器，0 表示尚未分配
+    int *array_slots;    // 按变量表下标：局部数组的栈帧对象，-1 表示尚未分配
+    PendingArg *args;
+    int arg_count;
+    int arg_capacity;
+    int param_int;
+    int param_float;
+    int param_stack;
+    IselFunction *isel;
+    PendingDef *pending;
+    int pending_count;
+    int pending_capacity;
+    VectorLoop *vector_loops;  // 尚未翻译的可向量化循环，按块顺序排列
+    bool failed;
+} Lowering;
+
+// System V 传参寄存器
+static const int int_arg_regs[] = {REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9};
+#define INT_ARG_REG_COUNT 6
+#define FLOAT_ARG_REG_COUNT 8
+
+// 越界检查失败时的缺省处理：终止程序
+#define ABORT_FUNCTION "abort"
+
+static Signature *signatures = NULL;
+static int signature_count = 0;
+
+static void lowering_error(Lowering *L, const char *message)
+{
+    if (!L->failed)
+        fprintf(stderr, "Error: x86-64 backend: %s in function %s\n", message, L->function);
+    L->failed = true;
+}
+
+// ========================= 类型与变量 =========================
+
+static VarKind variable_kind(const char *function, const char *name, VariableInfo **info_out)
+{
+    VariableInfo *info = lookup_variable_info(function, name);
+    if (info_out)
+        *info_out = info;
+
+    // 与全局变量同名的局部变量以局部声明为准
+    bool global = info != NULL ? info->function == NULL : is_global_variable(name);
+    if (info != NULL && info->array_size < 0)
+        return VAR_UNSUPPORTED;
+    if (global)
+        return info != NULL && info->array_size > 0 ? VAR_GLOBAL_ARRAY : VAR_GLOBAL_SCALAR;
+    if (info != NULL && info->array_size > 0)
+        return info->is_param ? VAR_ARRAY_PARAM : VAR_LOCAL_ARRAY;
+    return VAR_SCALAR;
+}
+
+static bool is_array_kind(VarKind kind)
+{
+    return kind == VAR_LOCAL_ARRAY || kind == VAR_GLOBAL_ARRAY || kind == VAR_ARRAY_PARAM;
+}
+
+static RegClass type_class(DataType type)
+{
+    return type == TYPE_FLOAT ? RC_FLOAT : RC_INT;
+}
+
+static ValueKind param_kind(const char *function, const char *name)
+{
+    VarKind kind = variable_kind(function, name, NULL);
+    if (is_array_kind(kind))
+        return VALUE_POINTER;
+    return declared_variable_type(function, name) == TYPE_FLOAT ? VALUE_FLOAT : VALUE_INT;
+}
+
+static int table_index(Lowering *L, Operand *op)
+{
+    return operand_table_lookup(&L->cfg->vars, op);
+}
+
+static DataType value_type(Lowering *L, signed char *types, Operand *op)
+{
+    return operand_value_type(L->cfg, L->function, types, op);
+}
+
+static DataType result_type(Lowering *L, signed char *types, Instruction *inst)
+{
+    return instruction_result_type(L->cfg, L->function, types, inst);
+}
+
+static Signature *find_signature(const char *name)
+{
+    for (int i = 0; i < signature_count; i++)
+    {
+        if (strcmp(signatures[i].name, name) == 0)
+            return &signatures[i];
+    }
+    return NULL;
+}
+
+// 收集程序中定义的函数的形参种类
+static void collect_signatures()
+{
+    for (Instruction *inst = code_head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op != OP_FUNC_DEF)
+            continue;
+        signatures = (Signature *)realloc(signatures, (signature_count + 1) * sizeof(Signature));
+        Signature *sig = &signatures[signature_count++];
+        sig->name = intern_symbol(inst->result->u.name);
+        sig->param_count = 0;
+        sig->params = NULL;
+        for (Instruction *p = inst->next; p != NULL && p->op == OP_PARAM; p = p->next)
+        {
+            sig->params = (ValueKind *)realloc(sig->params, (sig->param_count + 1) * sizeof(ValueKind));
+            sig->params[sig->param_count++] = param_kind(sig->name, p->result->u.name);
+        }
+    }
+}
+
+static void free_signatures()
+{
+    for (int i = 0; i < signature_count; i++)
+        free(signatures[i].params);
+    free(signatures);
+    signatures = NULL;
+    signature_count = 0;
+}
+
+// ========================= 操作数求值 =========================
+
+static MInst *emit_m(Lowering *L, MOpcode op, int size, MOperand src, MOperand dst)
+{
+    return minst_append(L->mf, op, size, src, dst);
+}
+
+static int new_vreg(Lowering *L, RegClass rc)
+{
+    return mfunction_new_vreg(L->mf, rc);
+}
+
+static void emit_move(Lowering *L, RegClass rc, MOperand src, MOperand dst)
+{
+    if (mop_equal(src, dst))
+        return;
+    emit_m(L, rc == RC_FLOAT ? M_MOVSS : M_MOV, 4, src, dst);
+}
+
+// 临时变量或局部标量在指定类别下的虚拟寄存器
+static int value_vreg(Lowering *L, Operand *op, RegClass rc)
+{
+    int index = table_index(L, op);
+    if (index < 0)
+    {
+        lowering_error(L, "unknown operand");
+        return new_vreg(L, rc);
+    }
+    if (L->vregs[rc][index] == 0)
+        L->vregs[rc][index] = new_vreg(L, rc);
+    return L->vregs[rc][index];
+}
+
+// 把浮点常量装入新的 XMM 虚拟寄存器
+static MOperand float_constant(Lowering *L, float value)
+{
+    int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int temp = new_vreg(L, RC_INT);
+    int result = new_vreg(L, RC_FLOAT);
+    emit_m(L, M_MOV, 4, mop_imm(bits), mop_reg(temp));
+    emit_m(L, M_MOVD, 4, mop_reg(temp), mop_reg(result));
+    return mop_reg(result);
+}
+
+// 数组形参的首地址寄存器
+static int array_param_vreg(Lowering *L, Operand *op)
+{
+    return value_vreg(L, op, RC_INT);
+}
+
+// 标量操作数按自身类型所在的位置
+static MOperand raw_operand(Lowering *L, Operand *op)
+{
+    switch (op->type)
+    {
+    case OPERAND_CONSTANT:
+        return mop_imm(op->u.int_value);
+    case OPERAND_CONSTANT_FLOAT:
+        return float_constant(L, op->u.float_value);
+    case OPERAND_TEMP:
+        return mop_reg(value_vreg(L, op, type_class(value_type(L, L->types, op))));
+    case OPERAND_VARIABLE:
+    {
+        VarKind kind = variable_kind(L->function, op->u.name, NULL);
+        if (kind == VAR_GLOBAL_SCALAR)
+        {
+            mprogram_add_global(L->program, op->u.name, 4, 4);
+            return mop_rip(op->u.name, 0);
+        }
+        if (kind != VAR_SCALAR)
+        {
+            lowering_error(L, "array used as a scalar value");
+            return mop_imm(0);
+        }
+        return mop_reg(value_vreg(L, op, type_class(declared_variable_type(L->function, op->u.name))));
+    }
+    default:
+        lowering_error(L, "unexpected operand");
+        return mop_imm(0);
+    }
+}
+
+// 在 int 与 float 之间转换
+static MOperand convert_value(Lowering *L, MOperand value, RegClass from, RegClass to)
+{
+    if (from == to)
+        return value;
+    if (to == RC_FLOAT)
+    {
+        if (value.kind == MOP_IMM)
+            return float_constant(L, (float)value.imm);
+        int result = new_vreg(L, RC_FLOAT);
+        emit_m(L, M_CVTSI2SS, 4, value, mop_reg(result));
+        return mop_reg(result);
+    }
+    int result = new_vreg(L, RC_INT);
+    emit_m(L, M_CVTTSS2SI, 4, value, mop_reg(result));
+    return mop_reg(result);
+}
+
+// 读取 op 的值，按需要转换为 rc 类别
+static MOperand read_value(Lowering *L, Operand *op, RegClass rc)
+{
+    RegClass from = type_class(value_type(L, L->types, op));
+    return convert_value(L, raw_operand(L, op), from, rc);
+}
+
+// 把 rc 类别的值 value 写入 x（临时变量取该类别，变量按声明类型转换）
+static void write_value(Lowering *L, Operand *x, MOperand value, RegClass rc)
+{
+    if (x->type == OPERAND_TEMP)
+    {
+        int index = table_index(L, x);
+        if (index >= 0)
+            L->types[index] = (signed char)(rc == RC_FLOAT ? TYPE_FLOAT : TYPE_INT);
+        emit_move(L, rc, value, mop_reg(value_vreg(L, x, rc)));
+        return;
+    }
+
+    RegClass to = type_class(declared_variable_type(L->function, x->u.name));
+    value = convert_value(L, value, rc, to);
+    emit_move(L, to, value, raw_operand(L, x));
+}
+
+// 运算结果的存放位置：与 x 的类别一致时直接写入 x，否则写入新的虚拟寄存器再由 finish_result 转换
+static MOperand result_target(Lowering *L, Operand *x, RegClass rc, bool *direct)
+{
+    if (x->type == OPERAND_TEMP)
+    {
+        int index = table_index(L, x);
+        if (index >= 0)
+            L->types[index] = (signed char)(rc == RC_FLOAT ? TYPE_FLOAT : TYPE_INT);
+        *direct = true;
+        return mop_reg(value_vreg(L, x, rc));
+    }
+    if (x->type == OPERAND_VARIABLE && type_class(declared_variable_type(L->function, x->u.name)) == rc)
+    {
+        *direct = true;
+        return raw_operand(L, x);
+    }
+    *direct = false;
+    return mop_reg(new_vreg(L, rc));
+}
+
+static void finish_result(Lowering *L, Operand *x, MOperand target, RegClass rc, bool direct)
+{
+    if (!direct)
+        write_value(L, x, target, rc);
+}
+
+// ========================= 数组 =========================
+
+static int local_array_slot(Lowering *L, Operand *array)
+{
+    int index = table_index(L, array);
+    if (L->array_slots[index] < 0)
+    {
+        VariableInfo *info = lookup_variable_info(L->function, array->u.name);
+        L->array_slots[index] = mfunction_new_object(L->mf, 4 * info->array_size, 16);
+    }
+    return L->array_slots[index];
+}
+
+static void ensure_global_array(Lowering *L, Operand *array)
+{
+    VariableInfo *info = lookup_variable_info(L->function, array->u.name);
+    mprogram_add_global(L->program, array->u.name, 4 * info->array_size, 16);
+}
+
+// 数组首地址装入新的虚拟寄存器
+static MOperand array_address(Lowering *L, Operand *array, VarKind kind)
+{
+    int result = new_vreg(L, RC_INT);
+    if (kind == VAR_LOCAL_ARRAY)
+        emit_m(L, M_LEA, 8, mop_frame(local_array_slot(L, array), 0), mop_reg(result));
+    else if (kind == VAR_GLOBAL_ARRAY)
+    {
+        ensure_global_array(L, array);
+        emit_m(L, M_LEA, 8, mop_rip(array->u.name, 0), mop_reg(result));
+    }
+    else
+        emit_m(L, M_MOV, 8, mop_reg(array_param_vreg(L, array)), mop_reg(result));
+    return mop_reg(result);
+}
+
+// 数组元素的内存操作数：disp 为字节偏移，index_reg 为符号扩展到64位的下标（REG_NONE 表示没有）
+static MOperand array_element_at(Lowering *L, Operand *array, int disp, int index_reg)
+{
+    VarKind kind = array->type == OPERAND_VARIABLE ? variable_kind(L->function, array->u.name, NULL)
+                                                   : VAR_UNSUPPORTED;
+    if (!is_array_kind(kind))
+    {
+        lowering_error(L, "multi-dimensional or unknown array access is not supported");
+        return mop_mem(REG_RSP, 0);
+    }
+
+    if (kind == VAR_LOCAL_ARRAY)
+    {
+        MOperand mem = mop_frame(local_array_slot(L, array), disp);
+        mem.index = index_reg;
+        mem.scale = 4;
+        return mem;
+    }
+    if (kind == VAR_GLOBAL_ARRAY && index_reg == REG_NONE)
+    {
+        ensure_global_array(L, array);
+        return mop_rip(array->u.name, disp);
+    }
+    int base = kind == VAR_ARRAY_PARAM ? array_param_vreg(L, array) : array_address(L, array, kind).reg;
+    return mop_mem_index(base, index_reg, 4, disp);
+}
+
+// 下标值符号扩展到新的64位虚拟寄存器
+static int sign_extend_index(Lowering *L, MOperand value)
+{
+    int index_reg = new_vreg(L, RC_INT);
+    emit_m(L, M_MOVSXD, 8, value, mop_reg(index_reg));
+    return index_reg;
+}
+
+// 数组元素 array[index] 的内存操作数，元素均为4字节
+static MOperand array_element(Lowering *L, Operand *array, Operand *index)
+{
+    if (index->type == OPERAND_CONSTANT)
+        return array_element_at(L, array, 4 * index->u.int_value, REG_NONE);
+    return array_element_at(L, array, 0, sign_extend_index(L, read_value(L, index, RC_INT)));
+}
+
+// ========================= 比较与跳转 =========================
+
+static OpType branch_to_relation(OpType op)
+{
+    switch (op)
+    {
+    case OP_IF_GT:
+        return OP_GT;
+    case OP_IF_LT:
+        return OP_LT;
+    case OP_IF_GE:
+        return OP_GE;
+    case OP_IF_LE:
+        return OP_LE;
+    case OP_IF_EQ:
+        return OP_EQ;
+    default:
+        return OP_NE;
+    }
+}
+
+// 整数比较用有符号条件码。浮点比较（ucomiss）在无序（有 NaN）时置 ZF、PF、CF，
+// 只有 A/AE 在无序时不成立：< 与 <= 由调用者交换两边后用 A/AE，相等与不等另外检查 PF
+static CondCode relation_cond(OpType rel, bool is_float)
+{
+    switch (rel)
+    {
+    case OP_GT:
+        return is_float ? CC_A : CC_G;
+    case OP_LT:
+        return is_float ? CC_A : CC_L;
+    case OP_GE:
+        return is_float ? CC_AE : CC_GE;
+    case OP_LE:
+        return is_float ? CC_AE : CC_LE;
+    case OP_EQ:
+        return is_float ? CC_FE : CC_E;
+    default:
+        return is_float ? CC_FNE : CC_NE;
+    }
+}
+
+// 浮点 < 与 <= 比较时交换两边
+static bool swaps_float_operands(OpType rel, bool is_float)
+{
+    return is_float && (rel == OP_LT || rel == OP_LE);
+}
+
+static bool evaluate_relation(OpType rel, int a, int b)
+{
+    switch (rel)
+    {
+    case OP_GT:
+        return a > b;
+    case OP_LT:
+        return a < b;
+    case OP_GE:
+        return a >= b;
+    case OP_LE:
+        return a <= b;
+    case OP_EQ:
+        return a == b;
+    default:
+        return a != b;
+    }
+}
+
+// 生成 a rel b 的比较，返回条件成立时的条件码
+static CondCode emit_compare(Lowering *L, OpType rel, Operand *a, Operand *b)
+{
+    bool is_float = value_type(L, L->types, a) == TYPE_FLOAT || value_type(L, L->types, b) == TYPE_FLOAT;
+    RegClass rc = is_float ? RC_FLOAT : RC_INT;
+    MOperand left = read_value(L, a, rc);
+    MOperand right = read_value(L, b, rc);
+    CondCode cc = relation_cond(rel, is_float);
+    if (swaps_float_operands(rel, is_float))
+    {
+        MOperand swap = left;
+        left = right;
+        right = swap;
+    }
+
+    if (left.kind == MOP_IMM)
+    {
+        // cmp 的目的操作数不能是立即数
+        if (right.kind != MOP_IMM)
+        {
+            MOperand swap = left;
+            left = right;
+            right = swap;
+            cc = swap_cond(cc);
+        }
+        else
+        {
+            int temp = new_vreg(L, RC_INT);
+            emit_m(L, M_MOV, 4, left, mop_reg(temp));
+            left = mop_reg(temp);
+        }
+    }
+    emit_m(L, is_float ? M_UCOMISS : M_CMP, 4, right, left);
+    return cc;
+}
+
+// op 与零比较，返回 op 不为零时的条件码
+static CondCode emit_test_zero(Lowering *L, Operand *op)
+{
+    if (value_type(L, L->types, op) == TYPE_FLOAT)
+    {
+        MOperand value = read_value(L, op, RC_FLOAT);
+        int zero = new_vreg(L, RC_FLOAT);
+        emit_m(L, M_XORPS, 4, mop_reg(zero), mop_reg(zero));
+        emit_m(L, M_UCOMISS, 4, mop_reg(zero), value);
+        return CC_FNE;
+    }
+    emit_m(L, M_CMP, 4, mop_imm(0), read_value(L, op, RC_INT));
+    return CC_NE;
+}
+
+// 条件码的值（0/1）装入新的整数虚拟寄存器；清零必须在比较之前。
+// 浮点相等与不等先按 ZF 取值，无序（PF=1）时改为不相等的结果
+static MOperand emit_flag_value(Lowering *L, int result, CondCode cc)
+{
+    if (cc == CC_FE || cc == CC_FNE)
+    {
+        int ordered = label_count++;
+        emit_m(L, M_SETCC, 1, mop_none(), mop_reg(result))->cc = cc == CC_FE ? CC_E : CC_NE;
+        emit_m(L, M_JCC, 8, mop_label(ordered), mop_none())->cc = CC_NP;
+        emit_m(L, M_MOV, 4, mop_imm(cc == CC_FNE), mop_reg(result));
+        emit_m(L, M_LABEL, 0, mop_label(ordered), mop_none());
+        return mop_reg(result);
+    }
+    emit_m(L, M_SETCC, 1, mop_none(), mop_reg(result))->cc = cc;
+    return mop_reg(result);
+}
+
+// 条件成立时跳转到 label；浮点相等与不等展开为两条 jcc
+static void emit_jcc(Lowering *L, CondCode cc, int label)
+{
+    if (cc == CC_FE)
+    {
+        int unordered = label_count++;
+        emit_m(L, M_JCC, 8, mop_label(unordered), mop_none())->cc = CC_P;
+        emit_m(L, M_JCC, 8, mop_label(label), mop_none())->cc = CC_E;
+        emit_m(L, M_LABEL, 0, mop_label(unordered), mop_none());
+        return;
+    }
+    if (cc == CC_FNE)
+    {
+        emit_m(L, M_JCC, 8, mop_label(label), mop_none())->cc = CC_NE;
+        emit_m(L, M_JCC, 8, mop_label(label), mop_none())->cc = CC_P;
+        return;
+    }
+    emit_m(L, M_JCC, 8, mop_label(label), mop_none())->cc = cc;
+}
+
+// op 的真值（0/1），negate 为true时取反
+static MOperand truth_value(Lowering *L, Operand *op, bool negate)
+{
+    if (op->type == OPERAND_CONSTANT)
+        return mop_imm((op->u.int_value != 0) != negate);
+    if (op->type == OPERAND_CONSTANT_FLOAT)
+        return mop_imm((op->u.float_value != 0) != negate);
+
+    int result = new_vreg(L, RC_INT);
+    emit_m(L, M_MOV, 4, mop_imm(0), mop_reg(result));
+    CondCode cc = emit_test_zero(L, op);
+    return emit_flag_value(L, result, negate ? negate_cond(cc) : cc);
+}
+
+static void lower_conditional_branch(Lowering *L, Instruction *inst)
+{
+    Operand *target = branch_target(inst);
+    if (is_relational_branch(inst->op))
+    {
+        OpType rel = branch_to_relation(inst->op);
+        if (inst->arg1->type == OPERAND_CONSTANT && inst->arg2->type == OPERAND_CONSTANT)
+        {
+            if (evaluate_relation(rel, inst->arg1->u.int_value, inst->arg2->u.int_value))
+                emit_m(L, M_JMP, 8, mop_label(target->u.temp_no), mop_none());
+            return;
+        }
+        CondCode cc = emit_compare(L, rel, inst->arg1, inst->arg2);
+        emit_jcc(L, cc, target->u.temp_no);
+        return;
+    }
+
+    bool when_true = inst->op == OP_IF_GOTO;
+    if (inst->arg1->type == OPERAND_CONSTANT || inst->arg1->type == OPERAND_CONSTANT_FLOAT)
+    {
+        bool value = inst->arg1->type == OPERAND_CONSTANT ? inst->arg1->u.int_value != 0
+                                                          : inst->arg1->u.float_value != 0;
+        if (value == when_true)
+            emit_m(L, M_JMP, 8, mop_label(target->u.temp_no), mop_none());
+        return;
+    }
+    CondCode cc = emit_test_zero(L, inst->arg1);
+    emit_jcc(L, when_true ? cc : negate_cond(cc), target->u.temp_no);
+}
+
+// ========================= 运算 =========================
+
+static bool is_commutative(MOpcode op)
+{
+    return op == M_ADD || op == M_IMUL || op == M_ADDSS || op == M_MULSS || op == M_AND || op == M_OR;
+}
+
+// target = y op z（双操作数形式：target = y; target op= z）
+static void emit_binary(Lowering *L, RegClass rc, MOpcode op, MOperand y, MOperand z, MOperand target)
+{
+    if (mop_equal(target, z) && !mop_equal(target, y))
+    {
+        if (is_commutative(op))
+        {
+            z = y;
+            y = target;
+        }
+        else
+        {
+            // x := y - x，不能先覆盖 x
+            MOperand temp = mop_reg(new_vreg(L, rc));
+            emit_move(L, rc, y, temp);
+            emit_m(L, op, 4, z, temp);
+            emit_move(L, rc, temp, target);
+            return;
+        }
+    }
+    emit_move(L, rc, y, target);
+    emit_m(L, op, 4, z, target);
+}
+
+// x := y op z
+static void lower_binary(Lowering *L, Instruction *inst, MOpcode int_op, MOpcode float_op)
+{
+    RegClass rc = type_class(result_type(L, L->types, inst));
+    MOperand y = read_value(L, inst->arg1, rc);
+    MOperand z = read_value(L, inst->arg2, rc);
+
+    bool direct;
+    MOperand target = result_target(L, inst->result, rc, &direct);
+    emit_binary(L, rc, rc == RC_FLOAT ? float_op : int_op, y, z, target);
+    finish_result(L, inst->result, target, rc, direct);
+}
+
+static void lower_divide(Lowering *L, Instruction *inst)
+{
+    RegClass rc = type_class(result_type(L, L->types, inst));
+    if (rc == RC_FLOAT)
+    {
+        lower_binary(L, inst, M_DIVSS, M_DIVSS);
+        return;
+    }
+
+    MOperand y = read_value(L, inst->arg1, RC_INT);
+    MOperand z = read_value(L, inst->arg2, RC_INT);
+    if (z.kind == MOP_IMM)
+    {
+        // idiv 不接受立即数
+        int temp = new_vreg(L, RC_INT);
+        emit_m(L, M_MOV, 4, z, mop_reg(temp));
+        z = mop_reg(temp);
+    }
+    emit_m(L, M_MOV, 4, y, mop_reg(REG_RAX));
+    emit_m(L, M_CDQ, 4, mop_none(), mop_none());
+    emit_m(L, M_IDIV, 4, z, mop_none());
+    write_value(L, inst->result, mop_reg(REG_RAX), RC_INT);
+}
+
+static void lower_negate(Lowering *L, Instruction *inst)
+{
+    RegClass rc = type_class(result_type(L, L->types, inst));
+    MOperand y = read_value(L, inst->arg1, rc);
+    bool direct;
+    MOperand target = result_target(L, inst->result, rc, &direct);
+    emit_move(L, rc, y, target);
+    if (rc == RC_INT)
+        emit_m(L, M_NEG, 4, mop_none(), target);
+    else
+    {
+        // 翻转符号位
+        int bits = new_vreg(L, RC_INT);
+        int mask = new_vreg(L, RC_FLOAT);
+        emit_m(L, M_MOV, 4, mop_imm((int)0x80000000), mop_reg(bits));
+        emit_m(L, M_MOVD, 4, mop_reg(bits), mop_reg(mask));
+        emit_m(L, M_XORPS, 4, mop_reg(mask), target);
+    }
+    finish_result(L, inst->result, target, rc, direct);
+}
+
+static void lower_compare(Lowering *L, Instruction *inst)
+{
+    if (inst->arg1->type == OPERAND_CONSTANT && inst->arg2->type == OPERAND_CONSTANT)
+    {
+        bool value = evaluate_relation(inst->op, inst->arg1->u.int_value, inst->arg2->u.int_value);
+        write_value(L, inst->result, mop_imm(value), RC_INT);
+        return;
+    }
+    int result = new_vreg(L, RC_INT);
+    emit_m(L, M_MOV, 4, mop_imm(0), mop_reg(result));
+    CondCode cc = emit_compare(L, inst->op, inst->arg1, inst->arg2);
+    write_value(L, inst->result, emit_flag_value(L, result, cc), RC_INT);
+}
+
+static void lower_logical(Lowering *L, Instruction *inst)
+{
+    if (inst->op == OP_NOT)
+    {
+        write_value(L, inst->result, truth_value(L, inst->arg1, true), RC_INT);
+        return;
+    }
+
+    MOperand a = truth_value(L, inst->arg1, false);
+    MOperand b = truth_value(L, inst->arg2, false);
+    if (a.kind == MOP_IMM && b.kind == MOP_IMM)
+    {
+        bool value = inst->op == OP_AND ? (a.imm && b.imm) : (a.imm || b.imm);
+        write_value(L, inst->result, mop_imm(value), RC_INT);
+        return;
+    }
+    if (a.kind == MOP_IMM)
+    {
+        MOperand swap = a;
+        a = b;
+        b = swap;
+    }
+    emit_m(L, inst->op == OP_AND ? M_AND : M_OR, 4, b, a);
+    write_value(L, inst->result, a, RC_INT);
+}
+
+// ========================= 函数调用 =========================
+
+static void lower_arg(Lowering *L, Instruction *inst)
+{
+    Operand *op = inst->result;
+    PendingArg arg;
+
+    VarKind kind = op->type == OPERAND_VARIABLE ? variable_kind(L->function, op->u.name, NULL) : VAR_SCALAR;
+    if (kind == VAR_UNSUPPORTED)
+    {
+        lowering_error(L, "multi-dimensional array argument is not supported");
+        return;
+    }
+    if (is_array_kind(kind))
+    {
+        arg.kind = VALUE_POINTER;
+        arg.value = array_address(L, op, kind);
+    }
+    else
+    {
+        DataType type = value_type(L, L->types, op);
+        RegClass rc = type_class(type);
+        arg.kind = type == TYPE_FLOAT ? VALUE_FLOAT : VALUE_INT;
+        arg.value = read_value(L, op, rc);
+        if (arg.value.kind != MOP_IMM)
+        {
+            // 实参在 ARG 处求值，之后到 CALL 之间变量可能被修改
+            MOperand copy = mop_reg(new_vreg(L, rc));
+            emit_move(L, rc, arg.value, copy);
+            arg.value = copy;
+        }
+    }
+
+    if (L->arg_count == L->arg_capacity)
+    {
+        L->arg_capacity = L->arg_capacity ? L->arg_capacity * 2 : 8;
+        L->args = (PendingArg *)realloc(L->args, L->arg_capacity * sizeof(PendingArg));
+    }
+    L->args[L->arg_count++] = arg;
+}
+
+// 实参按形参种类转换
+static MOperand coerce_arg(Lowering *L, PendingArg *arg, ValueKind kind)
+{
+    if (kind == VALUE_POINTER || arg->kind == VALUE_POINTER || kind == arg->kind)
+        return arg->value;
+    return convert_value(L, arg->value, arg->kind == VALUE_FLOAT ? RC_FLOAT : RC_INT,
+                         kind == VALUE_FLOAT ? RC_FLOAT : RC_INT);
+}
+
+static void emit_arg_move(Lowering *L, ValueKind kind, MOperand value, MOperand dst)
+{
+    if (kind == VALUE_FLOAT)
+        emit_m(L, M_MOVSS, 4, value, dst);
+    else
+        emit_m(L, M_MOV, kind == VALUE_POINTER ? 8 : 4, value, dst);
+}
+
+static void lower_call(Lowering *L, Instruction *inst)
+{
+    const char *name = inst->arg1->u.name;
+    Signature *sig = find_signature(name);
+
+    // 被调函数的形参个数决定消耗多少个待传实参，外部函数取全部
+    int count = sig != NULL ? sig->param_count : L->arg_count;
+    if (count > L->arg_count)
+    {
+        lowering_error(L, "call has fewer arguments than parameters");
+        count = L->arg_count;
+    }
+    PendingArg *args = L->args + (L->arg_count - count);
+    L->arg_count -= count;
+
+    ValueKind *kinds = (ValueKind *)malloc((count + 1) * sizeof(ValueKind));
+    MOperand *values = (MOperand *)malloc((count + 1) * sizeof(MOperand));
+    int *locations = (int *)malloc((count + 1) * sizeof(int));
+    int int_regs = 0;
+    int float_regs = 0;
+    int stack_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        kinds[i] = sig != NULL ? sig->params[i] : args[i].kind;
+        values[i] = coerce_arg(L, &args[i], kinds[i]);
+        if (kinds[i] == VALUE_FLOAT && float_regs < FLOAT_ARG_REG_COUNT)
+            locations[i] = REG_XMM0 + float_regs++;
+        else if (kinds[i] != VALUE_FLOAT && int_regs < INT_ARG_REG_COUNT)
+            locations[i] = int_arg_regs[int_regs++];
+        else
+            locations[i] = -1 - stack_count++;
+    }
+
+    // 栈上传递的实参，调用时 rsp 保持16字节对齐
+    int stack_bytes = (stack_count * 8 + 15) / 16 * 16;
+    if (stack_bytes > 0)
+        emit_m(L, M_SUB, 8, mop_imm(stack_bytes), mop_reg(REG_RSP));
+    for (int i = 0; i < count; i++)
+    {
+        if (locations[i] < 0)
+            emit_arg_move(L, kinds[i], values[i], mop_mem(REG_RSP, 8 * (-1 - locations[i])));
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (locations[i] >= 0)
+            emit_arg_move(L, kinds[i], values[i], mop_reg(locations[i]));
+    }
+    // 外部函数可能是变参函数，al 给出使用的向量寄存器个数
+    if (sig == NULL)
+        emit_m(L, M_MOV, 4, mop_imm(float_regs), mop_reg(REG_RAX));
+
+    MInst *call = emit_m(L, M_CALL, 8, mop_symbol(name), mop_none());
+    call->int_args = int_regs;
+    call->float_args = float_regs;
+    if (stack_bytes > 0)
+        emit_m(L, M_ADD, 8, mop_imm(stack_bytes), mop_reg(REG_RSP));
+
+    if (inst->result != NULL)
+    {
+        RegClass rc = type_class(result_type(L, L->types, inst));
+        write_value(L, inst->result, mop_reg(rc == RC_FLOAT ? REG_XMM0 : REG_RAX), rc);
+    }
+
+    free(kinds);
+    free(values);
+    free(locations);
+}
+
+static void lower_param(Lowering *L, Instruction *inst)
+{
+    Operand *param = inst->result;
+    ValueKind kind = param_kind(L->function, param->u.name);
+
+    MOperand source;
+    if (kind == VALUE_FLOAT && L->param_float < FLOAT_ARG_REG_COUNT)
+        source = mop_reg(REG_XMM0 + L->param_float++);
+    else if (kind != VALUE_FLOAT && L->param_int < INT_ARG_REG_COUNT)
+        source = mop_reg(int_arg_regs[L->param_int++]);
+    else
+        source = mop_mem(REG_RBP, 16 + 8 * L->param_stack++);
+
+    if (kind == VALUE_POINTER)
+        emit_m(L, M_MOV, 8, source, mop_reg(array_param_vreg(L, param)));
+    else
+        emit_move(L, kind == VALUE_FLOAT ? RC_FLOAT : RC_INT, source, raw_operand(L, param));
+}
+
+static void lower_return(Lowering *L, Instruction *inst)
+{
+    RegClass rc = type_class(L->return_type);
+    int reg = rc == RC_FLOAT ? REG_XMM0 : REG_RAX;
+    if (inst != NULL && inst->result != NULL)
+        emit_move(L, rc, read_value(L, inst->result, rc), mop_reg(reg));
+    else if (rc == RC_FLOAT)
+        emit_m(L, M_XORPS, 4, mop_reg(reg), mop_reg(reg));
+    else
+        emit_m(L, M_MOV, 4, mop_imm(0), mop_reg(reg));
+    emit_m(L, M_RET, 8, mop_reg(reg), mop_none());
+}
+
+// ========================= 函数翻译 =========================
+
+static void lower_instruction(Lowering *L, Instruction *inst)
+{
+    switch (inst->op)
+    {
+    case OP_LABEL:
+        emit_m(L, M_LABEL, 0, mop_label(inst->result->u.temp_no), mop_none());
+        break;
+    case OP_GOTO:
+        emit_m(L, M_JMP, 8, mop_label(inst->arg1->u.temp_no), mop_none());
+        break;
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+        lower_conditional_branch(L, inst);
+        break;
+    case OP_ASSIGN:
+    {
+        RegClass rc = type_class(result_type(L, L->types, inst));
+        write_value(L, inst->result, read_value(L, inst->arg1, rc), rc);
+        break;
+    }
+    case OP_ADD:
+        lower_binary(L, inst, M_ADD, M_ADDSS);
+        break;
+    case OP_SUB:
+        lower_binary(L, inst, M_SUB, M_SUBSS);
+        break;
+    case OP_MUL:
+        lower_binary(L, inst, M_IMUL, M_MULSS);
+        break;
+    case OP_DIV:
+        lower_divide(L, inst);
+        break;
+    case OP_NEG:
+        lower_negate(L, inst);
+        break;
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        lower_compare(L, inst);
+        break;
+    case OP_NOT:
+    case OP_AND:
+    case OP_OR:
+        lower_logical(L, inst);
+        break;
+    case OP_ARRAY_GET:
+    {
+        RegClass rc = type_class(result_type(L, L->types, inst));
+        MOperand element = array_element(L, inst->arg1, inst->arg2);
+        bool direct;
+        MOperand target = result_target(L, inst->result, rc, &direct);
+        emit_m(L, rc == RC_FLOAT ? M_MOVSS : M_MOV, 4, element, target);
+        finish_result(L, inst->result, target, rc, direct);
+        break;
+    }
+    case OP_ARRAY_SET:
+    {
+        if (inst->result->type != OPERAND_VARIABLE)
+        {
+            lowering_error(L, "multi-dimensional array access is not supported");
+            break;
+        }
+        RegClass rc = type_class(declared_variable_type(L->function, inst->result->u.name));
+        MOperand value = read_value(L, inst->arg2, rc);
+        emit_m(L, rc == RC_FLOAT ? M_MOVSS : M_MOV, 4, value, array_element(L, inst->result, inst->arg1));
+        break;
+    }
+    case OP_ARG:
+        lower_arg(L, inst);
+        break;
+    case OP_CALL:
+        lower_call(L, inst);
+        break;
+    case OP_PARAM:
+        lower_param(L, inst);
+        break;
+    case OP_RETURN:
+        lower_return(L, inst);
+        break;
+    default:
+        lowering_error(L, "unsupported instruction");
+        break;
+    }
+}
+
+// ========================= 树模式指令选择 =========================
+
+// 表达式树根的结果：规则需要写入目的位置时才取得（子树求值之后），否则由根写回
+typedef struct Destination
+{
+    Operand *x;
+    bool taken;
+    bool direct;
+    RegClass rc;
+    MOperand target;
+} Destination;
+
+static bool is_relation(OpType op)
+{
+    return op == OP_GT || op == OP_LT || op == OP_GE || op == OP_LE || op == OP_EQ || op == OP_NE;
+}
+
+// user 的操作数 op 由尚未折叠的推迟定值给出时返回该定值
+static PendingDef *find_pending(Lowering *L, Instruction *user, Operand *op)
+{
+    if (op->type != OPERAND_TEMP)
+        return NULL;
+    int index = table_index(L, op);
+    for (int i = L->pending_count - 1; i >= 0; i--)
+    {
+        PendingDef *def = &L->pending[i];
+        if (!def->folded && table_index(L, def->inst->result) == index && isel_fold_user(L->isel, def->inst) == user)
+            return def;
+    }
+    return NULL;
+}
+
+static IselNode *build_expression(Lowering *L, Instruction *inst);
+
+// 以 rc 类别读取 user 的操作数 op：类别相同的推迟定值展开为子树，其余为叶子
+static IselNode *build_operand(Lowering *L, Instruction *user, Operand *op, RegClass rc)
+{
+    PendingDef *def = find_pending(L, user, op);
+    if (def != NULL && type_class(result_type(L, L->types, def->inst)) == rc)
+    {
+        def->folded = true;
+        return build_expression(L, def->inst);
+    }
+
+    IselNode *leaf;
+    if (op->type == OPERAND_CONSTANT && rc == RC_INT)
+        leaf = isel_new_node(IN_CONST, rc);
+    else if (op->type == OPERAND_VARIABLE && variable_kind(L->function, op->u.name, NULL) == VAR_GLOBAL_SCALAR &&
+             type_class(declared_variable_type(L->function, op->u.name)) == rc)
+        leaf = isel_new_node(IN_GLOBAL, rc);
+    else
+        leaf = isel_new_node(IN_REG, rc);
+    leaf->leaf = op;
+    return leaf;
+}
+
+static IselNode *build_compare(Lowering *L, Instruction *inst, OpType rel, Operand *a, Operand *b)
+{
+    bool is_float = value_type(L, L->types, a) == TYPE_FLOAT || value_type(L, L->types, b) == TYPE_FLOAT;
+    IselNode *node = isel_new_node(IN_CMP, RC_INT);
+    node->operand_rc = is_float ? RC_FLOAT : RC_INT;
+    node->relation = rel;
+    node->kids[0] = build_operand(L, inst, a, node->operand_rc);
+    node->kids[1] = build_operand(L, inst, b, node->operand_rc);
+    return node;
+}
+
+// 运算、数组读取或比较指令的表达式树
+static IselNode *build_expression(Lowering *L, Instruction *inst)
+{
+    if (is_relation(inst->op))
+        return build_compare(L, inst, inst->op, inst->arg1, inst->arg2);
+
+    RegClass rc = type_class(result_type(L, L->types, inst));
+    IselNode *node;
+    if (inst->op == OP_ARRAY_GET)
+    {
+        node = isel_new_node(IN_ELEM, rc);
+        node->leaf = inst->arg1;
+        node->kids[0] = build_operand(L, inst, inst->arg2, RC_INT);
+        return node;
+    }
+    node = isel_new_node(inst->op == OP_ADD ? IN_ADD : inst->op == OP_SUB ? IN_SUB : IN_MUL, rc);
+    node->kids[0] = build_operand(L, inst, inst->arg1, rc);
+    node->kids[1] = build_operand(L, inst, inst->arg2, rc);
+    return node;
+}
+
+// 由选择器翻译的指令的表达式树，*x 为写入结果的操作数；其余指令返回NULL
+static IselNode *build_root(Lowering *L, Instruction *inst, Operand **x)
+{
+    *x = NULL;
+    switch (inst->op)
+    {
+    case OP_ASSIGN:
+        *x = inst->result;
+        return build_operand(L, inst, inst->arg1, type_class(result_type(L, L->types, inst)));
+    case OP_GT:
+    case OP_LT:
+    case OP_GE:
+    case OP_LE:
+    case OP_EQ:
+    case OP_NE:
+        if (inst->arg1->type == OPERAND_CONSTANT && inst->arg2->type == OPERAND_CONSTANT)
+            return NULL;
+        *x = inst->result;
+        return build_expression(L, inst);
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_ARRAY_GET:
+        *x = inst->result;
+        return build_expression(L, inst);
+    case OP_ARRAY_SET:
+    {
+        if (inst->result->type != OPERAND_VARIABLE)
+            return NULL;
+        RegClass rc = type_class(declared_variable_type(L->function, inst->result->u.name));
+        IselNode *element = isel_new_node(IN_ELEM, rc);
+        element->leaf = inst->result;
+        element->kids[0] = build_operand(L, inst, inst->arg1, RC_INT);
+        IselNode *store = isel_new_node(IN_STORE, rc);
+        store->kids[0] = element;
+        store->kids[1] = build_operand(L, inst, inst->arg2, rc);
+        return store;
+    }
+    case OP_IF_GT:
+    case OP_IF_LT:
+    case OP_IF_GE:
+    case OP_IF_LE:
+    case OP_IF_EQ:
+    case OP_IF_NE:
+    {
+        if (inst->arg1->type == OPERAND_CONSTANT && inst->arg2->type == OPERAND_CONSTANT)
+            return NULL;
+        IselNode *branch = isel_new_node(IN_BRANCH, RC_INT);
+        branch->label = branch_target(inst)->u.temp_no;
+        branch->kids[0] = build_compare(L, inst, branch_to_relation(inst->op), inst->arg1, inst->arg2);
+        return branch;
+    }
+    case OP_IF_GOTO:
+    case OP_IF_NOT_GOTO:
+    {
+        // 浮点值与零比较及常量条件仍按原方式翻译
+        if (inst->arg1->type == OPERAND_CONSTANT || inst->arg1->type == OPERAND_CONSTANT_FLOAT ||
+            value_type(L, L->types, inst->arg1) == TYPE_FLOAT)
+            return NULL;
+        IselNode *branch = isel_new_node(IN_BRANCH, RC_INT);
+        branch->label = branch_target(inst)->u.temp_no;
+        branch->negate = inst->op == OP_IF_NOT_GOTO;
+        branch->kids[0] = build_operand(L, inst, inst->arg1, RC_INT);
+        return branch;
+    }
+    default:
+        return NULL;
+    }
+}
+
+static MOperand take_target(Lowering *L, Destination *dest, RegClass rc)
+{
+    if (dest == NULL)
+        return mop_reg(new_vreg(L, rc));
+    dest->taken = true;
+    dest->rc = rc;
+    dest->target = result_target(L, dest->x, rc, &dest->direct);
+    return dest->target;
+}
+
+static MOpcode binary_opcode(IselNode *node)
+{
+    bool is_float = node->rc == RC_FLOAT;
+    if (node->op == IN_ADD)
+        return is_float ? M_ADDSS : M_ADD;
+    if (node->op == IN_SUB)
+        return is_float ? M_SUBSS : M_SUB;
+    return is_float ? M_MULSS : M_IMUL;
+}
+
+static int constant_kid(const IselRule *rule, IselNode *node, int i)
+{
+    return isel_kid(rule, node, i)->leaf->u.int_value;
+}
+
+// 按 32 位回绕相加，lea 只保留结果的低 32 位
+static int wrap_add(int a, int b)
+{
+    return (int)((unsigned)a + (unsigned)b);
+}
+
+static MOperand reduce(Lowering *L, IselNode *node, Nonterm nt, Destination *dest);
+
+static MOperand reduce_kid(Lowering *L, const IselRule *rule, IselNode *node, int i)
+{
+    return reduce(L, isel_kid(rule, node, i), rule->kids[i], NULL);
+}
+
+// 生成比较，返回条件成立时的条件码
+static CondCode reduce_compare(Lowering *L, IselNode *node)
+{
+    const IselRule *rule = isel_rule(node, NT_COND);
+    MOperand left = reduce_kid(L, rule, node, 0);
+    MOperand right = reduce_kid(L, rule, node, 1);
+    bool is_float = node->operand_rc == RC_FLOAT;
+    if (swaps_float_operands(node->relation, is_float))
+        emit_m(L, M_UCOMISS, 4, left, right);
+    else
+        emit_m(L, is_float ? M_UCOMISS : M_CMP, 4, right, left);
+    CondCode cc = relation_cond(node->relation, is_float);
+    return rule->swap ? swap_cond(cc) : cc;
+}
+
+// 按标注的规则为结点生成代码，返回非终结符 nt 形式的值
+static MOperand reduce(Lowering *L, IselNode *node, Nonterm nt, Destination *dest)
+{
+    const IselRule *rule = isel_rule(node, nt);
+    switch (rule->action)
+    {
+    case ACT_PASS:
+        return reduce(L, node, rule->kids[0], dest);
+    case ACT_IMM:
+        return mop_imm(node->leaf->u.int_value);
+    case ACT_LEAF:
+        return read_value(L, node->leaf, node->rc);
+    case ACT_GLOBAL:
+        return raw_operand(L, node->leaf);
+    case ACT_ELEM:
+        if (rule->kids[0] == NT_IMM)
+            return array_element_at(L, node->leaf, 4 * constant_kid(rule, node, 0), REG_NONE);
+        return array_element_at(L, node->leaf, 0, sign_extend_index(L, reduce_kid(L, rule, node, 0)));
+    case ACT_LOAD:
+    {
+        MOperand value = reduce(L, node, rule->kids[0], NULL);
+        MOperand target = take_target(L, dest, node->rc);
+        emit_move(L, node->rc, value, target);
+        return target;
+    }
+    case ACT_BINARY:
+    {
+        MOperand y = reduce_kid(L, rule, node, 0);
+        MOperand z = reduce_kid(L, rule, node, 1);
+        MOperand target = take_target(L, dest, node->rc);
+        emit_binary(L, node->rc, binary_opcode(node), y, z, target);
+        return target;
+    }
+    case ACT_INDEX:
+        return mop_mem_index(REG_NONE, reduce_kid(L, rule, node, 0).reg, constant_kid(rule, node, 1), 0);
+    case ACT_ADDR_BASE:
+    {
+        MOperand base = reduce_kid(L, rule, node, 0);
+        MOperand index = reduce_kid(L, rule, node, 1);
+        if (index.kind == MOP_REG)
+            return mop_mem_index(base.reg, index.reg, 1, 0);
+        return mop_mem_index(base.reg, index.index, index.scale, 0);
+    }
+    case ACT_ADDR_DISP:
+    {
+        MOperand address = reduce_kid(L, rule, node, 0);
+        if (address.kind == MOP_REG)
+            address = mop_mem(address.reg, 0);
+        int disp = constant_kid(rule, node, 1);
+        address.disp = wrap_add(address.disp, node->op == IN_SUB ? (int)(0u - (unsigned)disp) : disp);
+        return address;
+    }
+    case ACT_ADDR_MUL:
+    {
+        int reg = reduce_kid(L, rule, node, 0).reg;
+        return mop_mem_index(reg, reg, constant_kid(rule, node, 1) - 1, 0);
+    }
+    case ACT_LEA:
+    {
+        MOperand address = reduce(L, node, NT_ADDR, NULL);
+        MOperand target = take_target(L, dest, RC_INT);
+        emit_m(L, M_LEA, 4, address, target);
+        return target;
+    }
+    case ACT_SETCC:
+    {
+        // 清零必须在比较之前
+        int result = new_vreg(L, RC_INT);
+        emit_m(L, M_MOV, 4, mop_imm(0), mop_reg(result));
+        return emit_flag_value(L, result, reduce_compare(L, node));
+    }
+    case ACT_BRANCH_COND:
+    {
+        CondCode cc = reduce_compare(L, node->kids[0]);
+        emit_jcc(L, node->negate ? negate_cond(cc) : cc, node->label);
+        return mop_none();
+    }
+    case ACT_BRANCH_TEST:
+    {
+        emit_m(L, M_CMP, 4, mop_imm(0), reduce_kid(L, rule, node, 0));
+        emit_m(L, M_JCC, 8, mop_label(node->label), mop_none())->cc = node->negate ? CC_E : CC_NE;
+        return mop_none();
+    }
+    case ACT_STORE:
+    {
+        MOperand element = reduce_kid(L, rule, node, 0);
+        MOperand value = reduce_kid(L, rule, node, 1);
+        emit_m(L, node->rc == RC_FLOAT ? M_MOVSS : M_MOV, 4, value, element);
+        return mop_none();
+    }
+    default:
+        return mop_none();
+    }
+}
+
+// 按原顺序翻译未并入表达式树的推迟定值
+static void flush_pending(Lowering *L)
+{
+    for (int i = 0; i < L->pending_count; i++)
+    {
+        if (!L->pending[i].folded)
+            lower_instruction(L, L->pending[i].inst);
+    }
+    L->pending_count = 0;
+}
+
+static void defer_instruction(Lowering *L, Instruction *inst)
+{
+    if (L->pending_count == L->pending_capacity)
+    {
+        L->pending_capacity = L->pending_capacity ? L->pending_capacity * 2 : 8;
+        L->pending = (PendingDef *)realloc(L->pending, L->pending_capacity * sizeof(PendingDef));
+    }
+    L->pending[L->pending_count].inst = inst;
+    L->pending[L->pending_count].folded = false;
+    L->pending_count++;
+    // 结果类型提前登记，供使用处建树
+    transfer_temp_types(L->cfg, L->function, L->types, inst);
+}
+
+// 建树、标注并按最优覆盖生成代码；不由选择器翻译或无法覆盖时返回false
+static bool select_instruction(Lowering *L, Instruction *inst)
+{
+    Operand *x;
+    IselNode *tree = build_root(L, inst, &x);
+    if (tree == NULL)
+        return false;
+
+    Nonterm goal = x != NULL ? NT_REG : NT_STMT;
+    isel_label(tree);
+    if (isel_rule(tree, goal) == NULL)
+    {
+        for (int i = 0; i < L->pending_count; i++)
+            L->pending[i].folded = false;
+        isel_free_tree(tree);
+        return false;
+    }
+
+    for (int i = 0; i < L->pending_count; i++)
+    {
+        if (L->pending[i].folded)
+            opt_stats.isel_fold_count++;
+    }
+    flush_pending(L);
+
+    Destination dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.x = x;
+    MOperand value = reduce(L, tree, goal, x != NULL ? &dest : NULL);
+    if (dest.taken)
+        finish_result(L, x, dest.target, dest.rc, dest.direct);
+    else if (x != NULL)
+        write_value(L, x, value, tree->rc);
+
+    isel_free_tree(tree);
+    return true;
+}
+
+// ========================= 循环向量化 =========================
+
+// 运行时检测向量指令集的函数与缓存检测结果的全局变量，定义为弱符号，多个目标文件中的副本链接时合并
+#define VECTOR_ISA_FUNCTION "__vector_isa"
+#define VECTOR_ISA_LEVEL "__vector_isa_level"
+#define VECTOR_ISA_SSE2 1
+#define VECTOR_ISA_AVX2 2
+
+// 一种宽度的向量循环体的翻译状态
+typedef struct VectorBody
+{
+    VectorLoop *loop;
+    int size;              // 向量字节数：16（SSE2）或 32（AVX2）
+    int *values;           // 按变量表下标：本次迭代的定值所在的向量寄存器，0 表示没有
+    Operand **invariants;  // 已在循环之前广播的循环不变量
+    int *invariant_regs;
+    int invariant_count;
+    Operand **arrays;      // 已在循环之前装入首地址的全局数组
+    int *array_regs;
+    int array_count;
+} VectorBody;
+
+// 数组元素 array[index] 的内存操作数；全局数组的首地址在循环之前装入寄存器
+static MOperand vector_element(Lowering *L, VectorBody *V, Operand *array, int index)
+{
+    if (variable_kind(L->function, array->u.name, NULL) != VAR_GLOBAL_ARRAY)
+        return array_element_at(L, array, 0, index);
+    for (int i = 0; i < V->array_count; i++)
+    {
+        if (operands_equal(V->arrays[i], array))
+            return mop_mem_index(V->array_regs[i], index, 4, 0);
+    }
+    int base = array_address(L, array, VAR_GLOBAL_ARRAY).reg;
+    V->arrays[V->array_count] = array;
+    V->array_regs[V->array_count++] = base;
+    return mop_mem_index(base, index, 4, 0);
+}
+
+// 把循环不变量复制到向量的每个通道，同一操作数只广播一次
+static void broadcast_invariant(Lowering *L, VectorBody *V, Operand *op)
+{
+    for (int i = 0; i < V->invariant_count; i++)
+    {
+        if (operands_equal(V->invariants[i], op))
+            return;
+    }
+
+    int scalar;
+    if (V->loop->element_type == TYPE_FLOAT)
+    {
+        MOperand value = read_value(L, op, RC_FLOAT);
+        if (value.kind == MOP_REG)
+            scalar = value.reg;
+        else
+        {
+            scalar = new_vreg(L, RC_FLOAT);
+            emit_m(L, M_MOVSS, 4, value, mop_reg(scalar));
+        }
+    }
+    else
+    {
+        MOperand value = read_value(L, op, RC_INT);
+        if (value.kind == MOP_IMM)
+        {
+            int temp = new_vreg(L, RC_INT);
+            emit_m(L, M_MOV, 4, value, mop_reg(temp));
+            value = mop_reg(temp);
+        }
+        scalar = new_vreg(L, RC_FLOAT);
+        emit_m(L, M_MOVD, 4, value, mop_reg(scalar));
+    }
+    int reg = new_vreg(L, RC_FLOAT);
+    emit_m(L, M_BROADCAST, V->size, mop_reg(scalar), mop_reg(reg));
+
+    V->invariants[V->invariant_count] = op;
+    V->invariant_regs[V->invariant_count++] = reg;
+}
+
+// 逐元素运算的值操作数：本次迭代的定值或已广播的循环不变量
+static int vector_operand(Lowering *L, VectorBody *V, Operand *op)
+{
+    int index = table_index(L, op);
+    if (index >= 0 && V->values[index] != 0)
+        return V->values[index];
+    for (int i = 0; i < V->invariant_count; i++)
+    {
+        if (operands_equal(V->invariants[i], op))
+            return V->invariant_regs[i];
+    }
+    lowering_error(L, "unexpected operand in vector loop");
+    return new_vreg(L, RC_FLOAT);
+}
+
+// 指令读取的值操作数，返回个数
+static int vector_uses(Instruction *inst, Operand **uses)
+{
+    switch (inst->op)
+    {
+    case OP_ARRAY_SET:
+    case OP_ASSIGN:
+        uses[0] = inst->op == OP_ASSIGN ? inst->arg1 : inst->arg2;
+        return 1;
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL:
+    case OP_DIV:
+        uses[0] = inst->arg1;
+        uses[1] = inst->arg2;
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static MOpcode vector_opcode(OpType op, bool is_float)
+{
+    switch (op)
+    {
+    case OP_ADD:
+        return is_float ? M_ADDPS : M_PADDD;
+    case OP_SUB:
+        return is_float ? M_SUBPS : M_PSUBD;
+    case OP_MUL:
+        return is_float ? M_MULPS : M_PMULLD;
+    default:
+        return M_DIVPS;
+    }
+}
+
+// 一次处理 size/4 个元素的循环：剩余不足一组的元素留给其后的标量循环。
+// bound 为符号扩展到64位的上界，比较最后一个通道的下标，不会溢出
+static void lower_vector_body(Lowering *L, VectorLoop *loop, int size, MOperand bound)
+{
+    int lanes = size / 4;
+    bool is_float = loop->element_type == TYPE_FLOAT;
+    int count = L->cfg->vars.count + 1;
+    int capacity = 0;
+    for (Instruction *inst = loop->first;; inst = inst->next)
+    {
+        capacity += 2;
+        if (inst == loop->last)
+            break;
+    }
+
+    VectorBody V;
+    V.loop = loop;
+    V.size = size;
+    V.values = (int *)calloc(count, sizeof(int));
+    V.invariants = (Operand **)malloc(capacity * sizeof(Operand *));
+    V.invariant_regs = (int *)malloc(capacity * sizeof(int));
+    V.invariant_count = 0;
+    V.arrays = (Operand **)malloc(capacity * sizeof(Operand *));
+    V.array_regs = (int *)malloc(capacity * sizeof(int));
+    V.array_count = 0;
+
+    // 循环之前广播循环不变量（在本次迭代定值之前读取的操作数），装入全局数组的首地址
+    bool *defined = (bool *)calloc(count, sizeof(bool));
+    for (Instruction *inst = loop->first;; inst = inst->next)
+    {
+        if (inst->op == OP_ARRAY_GET || inst->op == OP_ARRAY_SET)
+            vector_element(L, &V, inst->op == OP_ARRAY_GET ? inst->arg1 : inst->result, REG_NONE);
+        Operand *uses[2];
+        int use_count = vector_uses(inst, uses);
+        for (int i = 0; i < use_count; i++)
+        {
+            int index = table_index(L, uses[i]);
+            if (index < 0 || !defined[index])
+                broadcast_invariant(L, &V, uses[i]);
+        }
+        if (inst->op != OP_ARRAY_SET)
+            defined[table_index(L, inst->result)] = true;
+        if (inst == loop->last)
+            break;
+    }
+    free(defined);
+
+    int top = label_count++;
+    int done = label_count++;
+    emit_m(L, M_LABEL, 0, mop_label(top), mop_none());
+    int index = sign_extend_index(L, read_value(L, loop->counter, RC_INT));
+    int last = new_vreg(L, RC_INT);
+    emit_m(L, M_LEA, 8, mop_mem(index, lanes - 1), mop_reg(last));
+    emit_m(L, M_CMP, 8, bound, mop_reg(last));
+    emit_m(L, M_JCC, 8, mop_label(done), mop_none())->cc = loop->inclusive ? CC_G : CC_GE;
+
+    for (Instruction *inst = loop->first;; inst = inst->next)
+    {
+        int reg;
+        switch (inst->op)
+        {
+        case OP_ARRAY_GET:
+            reg = new_vreg(L, RC_FLOAT);
+            emit_m(L, M_MOVUPS, size, vector_element(L, &V, inst->arg1, index), mop_reg(reg));
+            V.values[table_index(L, inst->result)] = reg;
+            break;
+        case OP_ARRAY_SET:
+            emit_m(L, M_MOVUPS, size, mop_reg(vector_operand(L, &V, inst->arg2)),
+                   vector_element(L, &V, inst->result, index));
+            break;
+        case OP_ASSIGN:
+            V.values[table_index(L, inst->result)] = vector_operand(L, &V, inst->arg1);
+            break;
+        default:
+        {
+            int left = vector_operand(L, &V, inst->arg1);
+            int right = vector_operand(L, &V, inst->arg2);
+            reg = new_vreg(L, RC_FLOAT);
+            emit_m(L, M_MOVUPS, size, mop_reg(left), mop_reg(reg));
+            emit_m(L, vector_opcode(inst->op, is_float), size, mop_reg(right), mop_reg(reg));
+            V.values[table_index(L, inst->result)] = reg;
+            break;
+        }
+        }
+        if (inst == loop->last)
+            break;
+    }
+
+    MOperand counter = raw_operand(L, loop->counter);
+    emit_m(L, M_ADD, 4, mop_imm(lanes), counter);
+    emit_m(L, M_JMP, 8, mop_label(top), mop_none());
+    emit_m(L, M_LABEL, 0, mop_label(done), mop_none());
+
+    free(V.values);
+    free(V.invariants);
+    free(V.invariant_regs);
+    free(V.arrays);
+    free(V.array_regs);
+}
+
+// 在循环的入口块之前生成向量循环：按运行时检测到的指令集选择 AVX2 或 SSE2 的循环体，
+// 剩余的迭代由原来的标量循环完成。do-while 形式的循环在进入标量循环体之前要重新检查条件，
+// 返回条件不成立时跳转的标签（放在循环体块之后），while 形式返回-1
+static int lower_vector_loop(Lowering *L, VectorLoop *loop)
+{
+    int isa = new_vreg(L, RC_INT);
+    MInst *call = emit_m(L, M_CALL, 8, mop_symbol(VECTOR_ISA_FUNCTION), mop_none());
+    call->int_args = 0;
+    call->float_args = 0;
+    emit_m(L, M_MOV, 4, mop_reg(REG_RAX), mop_reg(isa));
+
+    MOperand bound;
+    if (loop->bound->type == OPERAND_CONSTANT)
+        bound = mop_imm(loop->bound->u.int_value);
+    else
+        bound = mop_reg(sign_extend_index(L, read_value(L, loop->bound, RC_INT)));
+
+    // SSE2 没有 32 位整数乘法，含整数乘法的循环只有 AVX2 形式
+    int sse = label_count++;
+    int scalar = label_count++;
+    emit_m(L, M_CMP, 4, mop_imm(VECTOR_ISA_AVX2), mop_reg(isa));
+    emit_m(L, M_JCC, 8, mop_label(loop->int_multiply ? scalar : sse), mop_none())->cc = CC_L;
+    lower_vector_body(L, loop, 32, bound);
+    emit_m(L, M_VZEROUPPER, 0, mop_none(), mop_none());
+    emit_m(L, M_JMP, 8, mop_label(scalar), mop_none());
+    emit_m(L, M_LABEL, 0, mop_label(sse), mop_none());
+    if (!loop->int_multiply)
+        lower_vector_body(L, loop, 16, bound);
+    emit_m(L, M_LABEL, 0, mop_label(scalar), mop_none());
+    opt_stats.vectorized_loop_count++;
+
+    if (!loop->rotated)
+        return -1;
+    int exit = label_count++;
+    CondCode cc = emit_compare(L, loop->inclusive ? OP_LE : OP_LT, loop->counter, loop->bound);
+    emit_jcc(L, negate_cond(cc), exit);
+    return exit;
+}
+
+static MFunction *lower_function(MProgram *program, Instruction *func_def, bool *failed)
+{
+    Lowering L;
+    memset(&L, 0, sizeof(L));
+    L.program = program;
+    L.function = func_def->result->u.name;
+    L.return_type = lookup_function_type(L.function);
+    L.mf = new_mfunction(L.function);
+    L.cfg = build_cfg(func_def);
+
+    int count = L.cfg->vars.count + 1;
+    L.vregs[RC_INT] = (int *)calloc(count, sizeof(int));
+    L.vregs[RC_FLOAT] = (int *)calloc(count, sizeof(int));
+    L.array_slots = (int *)malloc(count * sizeof(int));
+    for (int i = 0; i < count; i++)
+        L.array_slots[i] = -1;
+    L.types = (signed char *)malloc(count);
+
+    signed char **block_types = infer_temp_types(L.cfg, L.function);
+    L.isel = isel_analyze(L.cfg);
+    L.vector_loops = find_vector_loops(L.cfg, L.function);
+
+    // 基本块按指令顺序排列，逐块翻译，块入口处恢复到达的临时变量类型。
+    // 只使用一次的定值推迟到使用处，与使用者合成表达式树后由选择器覆盖
+    for (int b = 0; b < L.cfg->block_count && !L.failed; b++)
+    {
+        BasicBlock *block = L.cfg->blocks[b];
+        memcpy(L.types, block_types[b], count);
+        int exit = -1;
+        if (L.vector_loops != NULL && L.vector_loops->entry == block)
+            exit = lower_vector_loop(&L, L.vector_loops);
+        for (Instruction *inst = block->first;; inst = inst->next)
+        {
+            if (isel_fold_user(L.isel, inst) != NULL)
+                defer_instruction(&L, inst);
+            else if (!select_instruction(&L, inst))
+            {
+                flush_pending(&L);
+                lower_instruction(&L, inst);
+            }
+            if (inst == block->last || L.failed)
+                break;
+        }
+        flush_pending(&L);
+        if (exit >= 0)
+            emit_m(&L, M_LABEL, 0, mop_label(exit), mop_none());
+        if (L.vector_loops != NULL && L.vector_loops->body == block)
+        {
+            VectorLoop *done = L.vector_loops;
+            L.vector_loops = done->next;
+            done->next = NULL;
+            free_vector_loops(done);
+        }
+    }
+
+    // 函数体可能顺序执行到末尾
+    if (L.mf->tail == NULL || (L.mf->tail->op != M_RET && L.mf->tail->op != M_JMP))
+        lower_return(&L, NULL);
+
+    free_vector_loops(L.vector_loops);
+    free_temp_types(L.cfg, block_types);
+    isel_free(L.isel);
+    free(L.pending);
+    free(L.types);
+    free(L.vregs[RC_INT]);
+    free(L.vregs[RC_FLOAT]);
+    free(L.array_slots);
+    free(L.args);
+    free_cfg(L.cfg);
+
+    *failed = L.failed;
+    return L.mf;
+}
+
+// 程序调用了越界处理函数但没有定义时，提供一个调用 abort 的弱定义
+static void add_bounds_fail_handler(MProgram *program)
+{
+    if (mprogram_find_function(program, BOUNDS_CHECK_FAIL_FUNCTION) != NULL)
+        return;
+
+    const char *symbol = intern_symbol(BOUNDS_CHECK_FAIL_FUNCTION);
+    bool used = false;
+    for (MFunction *mf = program->functions; mf != NULL && !used; mf = mf->next)
+    {
+        for (MInst *inst = mf->head; inst != NULL && !used; inst = inst->next)
+            used = inst->op == M_CALL && inst->src.symbol == symbol;
+    }
+    if (!used)
+        return;
+
+    MFunction *handler = new_mfunction(BOUNDS_CHECK_FAIL_FUNCTION);
+    handler->weak = true;
+    minst_append(handler, M_SUB, 8, mop_imm(8), mop_reg(REG_RSP));
+    minst_append(handler, M_CALL, 8, mop_symbol(ABORT_FUNCTION), mop_none());
+    mprogram_add_function(program, handler);
+}
+
+// 程序含向量循环时加入检测函数：返回 VECTOR_ISA_AVX2（CPU 支持 AVX2，且操作系统保存 YMM 状态）或
+// VECTOR_ISA_SSE2，首次调用时检测并缓存。函数直接使用物理寄存器，只保存被 cpuid 改写的 rbx
+static void add_vector_isa_function(MProgram *program)
+{
+    if (mprogram_find_function(program, VECTOR_ISA_FUNCTION) != NULL)
+        return;
+
+    const char *symbol = intern_symbol(VECTOR_ISA_FUNCTION);
+    bool used = false;
+    for (MFunction *mf = program->functions; mf != NULL && !used; mf = mf->next)
+    {
+        for (MInst *inst = mf->head; inst != NULL && !used; inst = inst->next)
+            used = inst->op == M_CALL && inst->src.symbol == symbol;
+    }
+    if (!used)
+        return;
+
+    mprogram_add_global(program, VECTOR_ISA_LEVEL, 4, 4)->weak = true;
+    MFunction *mf = new_mfunction(VECTOR_ISA_FUNCTION);
+    mf->weak = true;
+    int store = label_count++;
+    int done = label_count++;
+    MOperand level = mop_rip(VECTOR_ISA_LEVEL, 0);
+    minst_append(mf, M_MOV, 4, level, mop_reg(REG_RAX));
+    minst_append(mf, M_TEST, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    minst_append(mf, M_JCC, 8, mop_label(done), mop_none())->cc = CC_NE;
+    minst_append(mf, M_PUSH, 8, mop_reg(REG_RBX), mop_none());
+    minst_append(mf, M_MOV, 4, mop_imm(VECTOR_ISA_SSE2), mop_reg(REG_R8));
+
+    // 最大功能号至少为7
+    minst_append(mf, M_XOR, 4, mop_reg(REG_RAX), mop_reg(REG_RAX));
+    minst_append(mf, M_CPUID, 0, mop_none(), mop_none());
+    minst_append(mf, M_CMP, 4, mop_imm(7), mop_reg(REG_RAX));
+    minst_append(mf, M_JCC, 8, mop_label(store), mop_none())->cc = CC_L;
+
+    // 功能号1：ecx 的 OSXSAVE（位27）与 AVX（位28）
+    minst_append(mf, M_MOV, 4, mop_imm(1), mop_reg(REG_RAX));
+    minst_append(mf, M_CPUID, 0, mop_none(), mop_none());
+    minst_append(mf, M_AND, 4, mop_imm(0x18000000), mop_reg(REG_RCX));
+    minst_append(mf, M_CMP, 4, mop_imm(0x18000000), mop_reg(REG_RCX));
+    minst_append(mf, M_JCC, 8, mop_label(store), mop_none())->cc = CC_NE;
+
+    // XCR0：操作系统保存 XMM（位1）与 YMM（位2）状态
+    minst_append(mf, M_XOR, 4, mop_reg(REG_RCX), mop_reg(REG_RCX));
+    minst_append(mf, M_XGETBV, 0, mop_none(), mop_none());
+    minst_append(mf, M_AND, 4, mop_imm(6), mop_reg(REG_RAX));
+    minst_append(mf, M_CMP, 4, mop_imm(6), mop_reg(REG_RAX));
+    minst_append(mf, M_JCC, 8, mop_label(store), mop_none())->cc = CC_NE;
+
+    // 功能号7子功能0：ebx 的 AVX2（位5）
+    minst_append(mf, M_MOV, 4, mop_imm(7), mop_reg(REG_RAX));
+    minst_append(mf, M_XOR, 4, mop_reg(REG_RCX), mop_reg(REG_RCX));
+    minst_append(mf, M_CPUID, 0, mop_none(), mop_none());
+    minst_append(mf, M_TEST, 4, mop_imm(0x20), mop_reg(REG_RBX));
+    minst_append(mf, M_JCC, 8, mop_label(store), mop_none())->cc = CC_E;
+    minst_append(mf, M_MOV, 4, mop_imm(VECTOR_ISA_AVX2), mop_reg(REG_R8));
+
+    minst_append(mf, M_LABEL, 0, mop_label(store), mop_none());
+    minst_append(mf, M_POP, 8, mop_none(), mop_reg(REG_RBX));
+    minst_append(mf, M_MOV, 4, mop_reg(REG_R8), level);
+    minst_append(mf, M_MOV, 4, mop_reg(REG_R8), mop_reg(REG_RAX));
+    minst_append(mf, M_LABEL, 0, mop_label(done), mop_none());
+    minst_append(mf, M_RET, 8, mop_reg(REG_RAX), mop_none());
+    mprogram_add_function(program, mf);
+}
+
+MProgram *lower_to_x86()
+{
+    purge_dead_markers();
+    collect_signatures();
+
+    MProgram *program = (MProgram *)calloc(1, sizeof(MProgram));
+    bool failed = false;
+    for (Instruction *inst = code_head; inst != NULL && !failed; inst = inst->next)
+    {
+        if (inst->op == OP_FUNC_DEF)
+            mprogram_add_function(program, lower_function(program, inst, &failed));
+    }
+    free_signatures();
+
+    if (failed)
+    {
+        free_mprogram(program);
+        return NULL;
+    }
+    return program;
+}
+
+// ========================= 虚拟寄存器改写 =========================
+
+static void insert_before(MFunction *mf, MInst *pos, MOpcode op, int size, MOperand src, MOperand dst)
+{
+    minst_insert_before(mf, pos, new_minst(op, size, src, dst));
+}
+
+static void insert_after(MFunction *mf, MInst *pos, MOpcode op, int size, MOperand src, MOperand dst)
+{
+    minst_insert_after(mf, pos, new_minst(op, size, src, dst));
+}
+
+// 内存操作数中的基址、变址寄存器：溢出时先装入临时寄存器
+static void rewrite_address(MFunction *mf, MInst *inst, MOperand *op, VRegAssignment *assignment)
+{
+    if (op->kind != MOP_MEM)
+        return;
+    if (IS_VREG(op->reg))
+    {
+        int v = op->reg - FIRST_VREG;
+        if (assignment->reg[v] != REG_NONE)
+            op->reg = assignment->reg[v];
+        else
+        {
+            insert_before(mf, inst, M_MOV, 8, mop_frame(assignment->slot[v], 0), mop_reg(SCRATCH_BASE));
+            op->reg = SCRATCH_BASE;
+            opt_stats.spill_access_count++;
+        }
+    }
+    if (IS_VREG(op->index))
+    {
+        int v = op->index - FIRST_VREG;
+        if (assignment->reg[v] != REG_NONE)
+            op->index = assignment->reg[v];
+        else
+        {
+            insert_before(mf, inst, M_MOV, 8, mop_frame(assignment->slot[v], 0), mop_reg(SCRATCH_INDEX));
+            op->index = SCRATCH_INDEX;
+            opt_stats.spill_access_count++;
+        }
+    }
+}
+
+static void rewrite_register(MOperand *op, VRegAssignment *assignment)
+{
+    if (op->kind != MOP_REG || !IS_VREG(op->reg))
+        return;
+    int v = op->reg - FIRST_VREG;
+    if (assignment->reg[v] != REG_NONE)
+        op->reg = assignment->reg[v];
+    else
+    {
+        *op = mop_frame(assignment->slot[v], 0);
+        opt_stats.spill_access_count++;
+    }
+}
+
+// 分配后源与目的相同的传送（分配器合并了传送的两端）
+static bool is_self_move(MInst *inst)
+{
+    return (inst->op == M_MOV || inst->op == M_MOVSS || inst->op == M_MOVUPS) && inst->src.kind == MOP_REG &&
+           inst->dst.kind == MOP_REG && inst->src.reg == inst->dst.reg;
+}
+
+// 目的操作数必须是寄存器的指令：改用临时寄存器，按需先装入、后写回
+static void legalize_register_dst(MFunction *mf, MInst *inst, int scratch, int size)
+{
+    MOperand memory = inst->dst;
+    MOpcode move = IS_XMM(scratch) ? (size > 4 ? M_MOVUPS : M_MOVSS) : M_MOV;
+    if (minst_reads_dst(inst->op))
+        insert_before(mf, inst, move, size, memory, mop_reg(scratch));
+    inst->dst = mop_reg(scratch);
+    if (minst_writes_dst(inst->op))
+        insert_after(mf, inst, move, size, mop_reg(scratch), memory);
+}
+
+// 改写后检查操作数约束：x86 指令最多一个内存操作数，部分指令的目的操作数必须是寄存器
+static void legalize_instruction(MFunction *mf, MInst *inst)
+{
+    bool src_mem = inst->src.kind == MOP_MEM;
+    bool dst_mem = inst->dst.kind == MOP_MEM;
+
+    switch (inst->op)
+    {
+    case M_MOV:
+    case M_ADD:
+    case M_SUB:
+    case M_AND:
+    case M_OR:
+    case M_XOR:
+    case M_CMP:
+    case M_TEST:
+        if (src_mem && dst_mem)
+        {
+            insert_before(mf, inst, M_MOV, inst->size, inst->src, mop_reg(SCRATCH_INT));
+            inst->src = mop_reg(SCRATCH_INT);
+        }
+        break;
+    case M_MOVSS:
+        if (src_mem && dst_mem)
+        {
+            insert_before(mf, inst, M_MOVSS, 4, inst->src, mop_reg(SCRATCH_FLOAT));
+            inst->src = mop_reg(SCRATCH_FLOAT);
+        }
+        break;
+    case M_IMUL:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_INT, inst->size);
+        break;
+    case M_MOVSXD:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_INT, 8);
+        break;
+    case M_LEA:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_INT, inst->size);
+        break;
+    case M_MOVZB:
+    case M_CVTTSS2SI:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_INT, 4);
+        break;
+    case M_XORPS:
+        if (src_mem)
+        {
+            insert_before(mf, inst, M_MOVSS, 4, inst->src, mop_reg(SCRATCH_FLOAT2));
+            inst->src = mop_reg(SCRATCH_FLOAT2);
+        }
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_FLOAT, 4);
+        break;
+    case M_ADDSS:
+    case M_SUBSS:
+    case M_MULSS:
+    case M_DIVSS:
+    case M_UCOMISS:
+    case M_CVTSI2SS:
+    case M_MOVD:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_FLOAT, 4);
+        break;
+    case M_MOVUPS:
+        if (src_mem && dst_mem)
+        {
+            insert_before(mf, inst, M_MOVUPS, inst->size, inst->src, mop_reg(SCRATCH_FLOAT));
+            inst->src = mop_reg(SCRATCH_FLOAT);
+        }
+        break;
+    case M_ADDPS:
+    case M_SUBPS:
+    case M_MULPS:
+    case M_DIVPS:
+    case M_PADDD:
+    case M_PSUBD:
+    case M_PMULLD:
+    case M_BROADCAST:
+        if (dst_mem)
+            legalize_register_dst(mf, inst, SCRATCH_FLOAT, inst->size);
+        break;
+    default:
+        break;
+    }
+}
+
+static void rewrite_virtual_registers(MFunction *mf, VRegAssignment *assignment)
+{
+    MInst *inst = mf->head;
+    while (inst != NULL)
+    {
+        MInst *next = inst->next;
+        rewrite_address(mf, inst, &inst->src, assignment);
+        rewrite_address(mf, inst, &inst->dst, assignment);
+        rewrite_register(&inst->src, assignment);
+        rewrite_register(&inst->dst, assignment);
+        if (is_self_move(inst))
+            minst_remove(mf, inst);
+        else
+            legalize_instruction(mf, inst);
+        inst = next;
+    }
+}
+
+MProgram *compile_to_x86()
+{
+    MProgram *program = lower_to_x86();
+    if (program == NULL)
+        return NULL;
+
+    for (MFunction *mf = program->functions; mf != NULL; mf = mf->next)
+    {
+        VRegAssignment assignment = linear_scan_allocate(mf);
+        rewrite_virtual_registers(mf, &assignment);
+        free_vreg_assignment(&assignment);
+        opt_stats.machine_peephole_count += x86_peephole(mf);
+        layout_frame(mf);
+    }
+
+    // 缺省的越界处理函数与向量指令集检测函数不建立栈帧，在布局之后加入
+    add_bounds_fail_handler(program);
+    add_vector_isa_function(program);
+    return program;
+}
+
+bool write_x86_assembly(const char *filename)
+{
+    MProgram *program = compile_to_x86();
+    if (program == NULL)
+        return false;
+
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL)
+    {
+        perror(filename);
+        free_mprogram(program);
+        return false;
+    }
+    print_mprogram(fp, program);
+    fclose(fp);
+    free_mprogram(program);
+    return true;
+}
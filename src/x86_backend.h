@@ -0,0 +1,17 @@
+#ifndef X86_BACKEND_H
+#define X86_BACKEND_H
+
+#include "machine.h"
+#include "codegen.h"
+
+// 把三地址代码翻译为使用虚拟寄存器的 x86-64 机器指令（System V 调用约定），
+// 不支持的构造（多维数组等）报错并返回NULL
+MProgram *lower_to_x86();
+
+// 完整的后端流程：指令选择、寄存器分配、栈帧布局，得到可以输出或编码的机器代码
+MProgram *compile_to_x86();
+
+// 生成 GNU as 汇编文件，成功返回true
+bool write_x86_assembly(const char *filename);
+
+#endif
@@ -0,0 +1,864 @@
+#include "x86_encode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 跳转到函数内标签的偏移（短跳转 8 位，近跳转 32 位），函数编码结束后填写
+typedef struct LabelFixup
+{
+    int offset;
+    int label;
+    int jump;    // 函数内跳转指令的序号
+    bool near;
+} LabelFixup;
+
+// 调用的 32 位偏移，全部函数编码结束后填写（外部函数转为重定位）
+typedef struct CallFixup
+{
+    int offset;
+    const char *symbol;
+} CallFixup;
+
+typedef struct Encoder
+{
+    CodeBuffer *out;
+    MFunction *mf;
+    int *label_offsets;     // 按标签编号：标签在代码中的位置，-1 表示未定义
+    int label_limit;
+    LabelFixup *label_fixups;
+    int label_fixup_count;
+    int label_fixup_capacity;
+    bool *near_jumps;       // 按函数内跳转指令的序号：是否需要 32 位偏移
+    int near_capacity;
+    int jump_count;
+    CallFixup *call_fixups;
+    int call_fixup_count;
+    int call_fixup_capacity;
+    int rip_field;          // 当前指令中 RIP 相对字段的位置，-1 表示无
+    const char *rip_symbol;
+    int rip_disp;
+    bool failed;
+} Encoder;
+
+// 条件码在 jcc / setcc 操作码中的编号
+static const int cond_codes[] = {0x4, 0x5, 0xC, 0xE, 0xF, 0xD, 0x2, 0x6, 0x7, 0x3, 0xA, 0xB};
+
+// ModRM 中 /digit 形式的扩展操作码
+#define EXT_ADD 0
+#define EXT_OR 1
+#define EXT_AND 4
+#define EXT_SUB 5
+#define EXT_XOR 6
+#define EXT_CMP 7
+
+static const char *opcode_names[] = {
+    "label", "mov", "movsxd", "movzb", "lea", "add", "sub", "imul", "and", "or", "xor", "neg",
+    "shl", "sar", "cmp", "test", "cdq", "idiv", "setcc", "jmp", "jcc", "call", "ret", "push",
+    "pop", "leave", "movss", "addss", "subss", "mulss", "divss", "ucomiss", "xorps", "cvtsi2ss",
+    "cvttss2si", "movd"};
+
+static void encode_error(Encoder *E, MInst *inst)
+{
+    if (!E->failed)
+        fprintf(stderr, "Error: x86-64 encoder: cannot encode %s in function %s\n",
+                inst->op < M_OPCODE_COUNT ? opcode_names[inst->op] : "instruction", E->mf->name);
+    E->failed = true;
+}
+
+// ========================= 字节输出 =========================
+
+static void put_byte(CodeBuffer *b, int value)
+{
+    if (b->size == b->capacity)
+    {
+        b->capacity = b->capacity ? b->capacity * 2 : 4096;
+        b->bytes = (unsigned char *)realloc(b->bytes, b->capacity);
+    }
+    b->bytes[b->size++] = (unsigned char)value;
+}
+
+static void put_int32(CodeBuffer *b, int value)
+{
+    unsigned int v = (unsigned int)value;
+    for (int i = 0; i < 4; i++)
+        put_byte(b, (v >> (8 * i)) & 0xFF);
+}
+
+static void put_int64(CodeBuffer *b, long long value)
+{
+    unsigned long long v = (unsigned long long)value;
+    for (int i = 0; i < 8; i++)
+        put_byte(b, (int)((v >> (8 * i)) & 0xFF));
+}
+
+static void patch_int32(CodeBuffer *b, int offset, int value)
+{
+    unsigned int v = (unsigned int)value;
+    for (int i = 0; i < 4; i++)
+        b->bytes[offset + i] = (unsigned char)((v >> (8 * i)) & 0xFF);
+}
+
+static bool fits_int8(long long value)
+{
+    return value >= -128 && value <= 127;
+}
+
+static bool fits_int32(long long value)
+{
+    return value >= -2147483648LL && value <= 2147483647LL;
+}
+
+static void add_relocation(CodeBuffer *b, int offset, const char *symbol, RelocKind kind, int addend)
+{
+    if (b->reloc_count == b->reloc_capacity)
+    {
+        b->reloc_capacity = b->reloc_capacity ? b->reloc_capacity * 2 : 16;
+        b->relocs = (Relocation *)realloc(b->relocs, b->reloc_capacity * sizeof(Relocation));
+    }
+    Relocation *r = &b->relocs[b->reloc_count++];
+    r->offset = offset;
+    r->symbol = symbol;
+    r->kind = kind;
+    r->addend = addend;
+}
+
+// ========================= 操作数编码 =========================
+
+// 寄存器在指令编码中的编号（0～15），虚拟寄存器无法编码
+static int reg_code(Encoder *E, MInst *inst, int reg)
+{
+    if (reg == REG_NONE || IS_VREG(reg))
+    {
+        encode_error(E, inst);
+        return 0;
+    }
+    return IS_XMM(reg) ? reg - REG_XMM0 : reg;
+}
+
+static int scale_bits(int scale)
+{
+    switch (scale)
+    {
+    case 2:
+        return 1;
+    case 4:
+        return 2;
+    case 8:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+// 操作数 rm 在 REX 前缀中需要的位：寄存器或基址为 r8～r15 时的 B 位、变址为 r8～r15 时的 X 位；
+// byte_regs 表示按 8 位访问寄存器，编号 4～7 的寄存器（spl、bpl、sil、dil）需要 REX 前缀
+static int rm_rex(Encoder *E, MInst *inst, MOperand rm, bool byte_regs)
+{
+    int rex = 0;
+    if (rm.kind == MOP_REG)
+    {
+        int code = reg_code(E, inst, rm.reg);
+        if (code >= 8)
+            rex |= 0x41;
+        if (byte_regs && code >= 4 && code <= 7)
+            rex |= 0x40;
+    }
+    else if (rm.kind == MOP_MEM && rm.symbol == NULL)
+    {
+        if (rm.frame_slot >= 0)
+            encode_error(E, inst);
+        if (rm.reg != REG_NONE && reg_code(E, inst, rm.reg) >= 8)
+            rex |= 0x41;
+        if (rm.index != REG_NONE && reg_code(E, inst, rm.index) >= 8)
+            rex |= 0x42;
+    }
+    return rex;
+}
+
+// 发出 ModRM [SIB] [偏移]，reg 为 ModRM.reg 字段（寄存器编号或扩展操作码）
+static void emit_modrm(Encoder *E, int reg, MOperand rm)
+{
+    CodeBuffer *b = E->out;
+    int r = (reg & 7) << 3;
+    if (rm.kind == MOP_REG)
+    {
+        int code = IS_XMM(rm.reg) ? rm.reg - REG_XMM0 : rm.reg;
+        put_byte(b, 0xC0 | r | (code & 7));
+        return;
+    }
+    if (rm.symbol != NULL)
+    {
+        // RIP 相对：偏移相对指令末尾，指令编码完成后记为重定位
+        put_byte(b, r | 5);
+        E->rip_field = b->size;
+        E->rip_symbol = rm.symbol;
+        E->rip_disp = rm.disp;
+        put_int32(b, 0);
+        return;
+    }
+    int base = rm.reg;
+    int index = rm.index == REG_NONE ? 4 : rm.index;
+    if (rm.reg == REG_NONE)
+    {
+        // 无基址：SIB 的 base 为 101 且 mod 为 00 时只带 32 位偏移
+        put_byte(b, r | 4);
+        put_byte(b, (scale_bits(rm.scale) << 6) | ((index & 7) << 3) | 5);
+        put_int32(b, rm.disp);
+        return;
+    }
+
+    // rbp/r13 作基址时没有无偏移的形式，rsp/r12 作基址时必须用 SIB
+    int mod = rm.disp == 0 && (base & 7) != 5 ? 0 : (fits_int8(rm.disp) ? 1 : 2);
+    bool sib = rm.index != REG_NONE || (base & 7) == 4;
+    put_byte(b, (mod << 6) | r | (sib ? 4 : (base & 7)));
+    if (sib)
+        put_byte(b, (scale_bits(rm.scale) << 6) | ((index & 7) << 3) | (base & 7));
+    if (mod == 1)
+        put_byte(b, rm.disp);
+    else if (mod == 2)
+        put_int32(b, rm.disp);
+}
+
+// 发出 [前缀] [REX] 操作码 ModRM [SIB] [偏移]。opcode 为 1～2 字节（高字节在前），
+// reg 为 ModRM.reg 字段（寄存器编号或扩展操作码），rm 为寄存器或内存操作数
+static void emit_rm(Encoder *E, MInst *inst, int prefix, bool rex_w, int opcode, int reg, MOperand rm, bool byte_regs)
+{
+    if (rm.kind != MOP_REG && rm.kind != MOP_MEM)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    CodeBuffer *b = E->out;
+    int rex = (rex_w ? 0x48 : 0) | rm_rex(E, inst, rm, byte_regs);
+    if (reg >= 8)
+        rex |= 0x44;
+    if (byte_regs && reg >= 4 && reg <= 7)
+        rex |= 0x40;
+
+    if (prefix)
+        put_byte(b, prefix);
+    if (rex)
+        put_byte(b, rex);
+    if (opcode > 0xFF)
+        put_byte(b, opcode >> 8);
+    put_byte(b, opcode & 0xFF);
+    emit_modrm(E, reg, rm);
+}
+
+// VEX 前缀的 AVX 指令。pp 为隐含的前缀（0 无、1 为 66、2 为 F3），map 为操作码表（1 为 0F、2 为 0F38），
+// vvvv 为第二个源寄存器的编号（没有时为 0）。与 GNU as 一致，能用 2 字节 VEX 时不用 3 字节形式
+static void emit_vex(Encoder *E, MInst *inst, int pp, int map, bool l256, int opcode, int reg, int vvvv, MOperand rm)
+{
+    if (rm.kind != MOP_REG && rm.kind != MOP_MEM)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    CodeBuffer *b = E->out;
+    int rex = rm_rex(E, inst, rm, false);
+    int tail = ((~vvvv & 15) << 3) | (l256 ? 4 : 0) | pp;
+    int r_bar = reg >= 8 ? 0 : 0x80;
+    if (map == 1 && (rex & 3) == 0)
+    {
+        put_byte(b, 0xC5);
+        put_byte(b, r_bar | tail);
+    }
+    else
+    {
+        put_byte(b, 0xC4);
+        put_byte(b, r_bar | (rex & 2 ? 0 : 0x40) | (rex & 1 ? 0 : 0x20) | map);
+        put_byte(b, tail);
+    }
+    put_byte(b, opcode);
+    emit_modrm(E, reg, rm);
+}
+
+// 操作码中含寄存器编号的单字节指令（push、pop、mov 立即数到寄存器）
+static void emit_plus_reg(Encoder *E, MInst *inst, bool rex_w, int opcode, int reg, bool byte_regs)
+{
+    int code = reg_code(E, inst, reg);
+    int rex = (rex_w ? 0x48 : 0) | (code >= 8 ? 0x41 : 0);
+    if (byte_regs && code >= 4 && code <= 7)
+        rex |= 0x40;
+    if (rex)
+        put_byte(E->out, rex);
+    put_byte(E->out, opcode + (code & 7));
+}
+
+static void add_label_fixup(Encoder *E, int label, int jump, bool near)
+{
+    if (E->label_fixup_count == E->label_fixup_capacity)
+    {
+        E->label_fixup_capacity = E->label_fixup_capacity ? E->label_fixup_capacity * 2 : 32;
+        E->label_fixups = (LabelFixup *)realloc(E->label_fixups, E->label_fixup_capacity * sizeof(LabelFixup));
+    }
+    LabelFixup *fixup = &E->label_fixups[E->label_fixup_count++];
+    fixup->offset = E->out->size;
+    fixup->label = label;
+    fixup->jump = jump;
+    fixup->near = near;
+    if (near)
+        put_int32(E->out, 0);
+    else
+        put_byte(E->out, 0);
+}
+
+// 跳转到函数内标签：短形式为 short_opcode rel8，近形式为 near_opcode rel32（1～2 字节操作码）
+static void emit_jump(Encoder *E, int label, int short_opcode, int near_opcode)
+{
+    int jump = E->jump_count++;
+    bool near = E->near_jumps[jump];
+    if (!near)
+        put_byte(E->out, short_opcode);
+    else if (near_opcode > 0xFF)
+    {
+        put_byte(E->out, near_opcode >> 8);
+        put_byte(E->out, near_opcode & 0xFF);
+    }
+    else
+        put_byte(E->out, near_opcode);
+    add_label_fixup(E, label, jump, near);
+}
+
+static void add_call_fixup(Encoder *E, const char *symbol)
+{
+    if (E->call_fixup_count == E->call_fixup_capacity)
+    {
+        E->call_fixup_capacity = E->call_fixup_capacity ? E->call_fixup_capacity * 2 : 32;
+        E->call_fixups = (CallFixup *)realloc(E->call_fixups, E->call_fixup_capacity * sizeof(CallFixup));
+    }
+    E->call_fixups[E->call_fixup_count].offset = E->out->size;
+    E->call_fixups[E->call_fixup_count].symbol = symbol;
+    E->call_fixup_count++;
+    put_int32(E->out, 0);
+}
+
+// ========================= 指令编码 =========================
+
+static void encode_mov(Encoder *E, MInst *inst)
+{
+    bool w = inst->size == 8;
+    bool byte = inst->size == 1;
+    MOperand src = inst->src;
+    MOperand dst = inst->dst;
+
+    if (src.kind == MOP_IMM)
+    {
+        if (dst.kind == MOP_REG && byte)
+        {
+            emit_plus_reg(E, inst, false, 0xB0, dst.reg, true);
+            put_byte(E->out, (int)src.imm);
+        }
+        else if (dst.kind == MOP_REG && (!w || !fits_int32(src.imm)))
+        {
+            // 32 位传送清零高位；超出 32 位的 64 位立即数用 movabs
+            emit_plus_reg(E, inst, w, 0xB8, dst.reg, false);
+            if (w)
+                put_int64(E->out, src.imm);
+            else
+                put_int32(E->out, (int)src.imm);
+        }
+        else if (byte)
+        {
+            emit_rm(E, inst, 0, false, 0xC6, 0, dst, true);
+            put_byte(E->out, (int)src.imm);
+        }
+        else if (fits_int32(src.imm))
+        {
+            emit_rm(E, inst, 0, w, 0xC7, 0, dst, false);
+            put_int32(E->out, (int)src.imm);
+        }
+        else
+            encode_error(E, inst);
+    }
+    else if (src.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, byte ? 0x88 : 0x89, reg_code(E, inst, src.reg), dst, byte);
+    else if (dst.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, byte ? 0x8A : 0x8B, reg_code(E, inst, dst.reg), src, byte);
+    else
+        encode_error(E, inst);
+}
+
+// 算术逻辑指令：ADD/OR/AND/SUB/XOR/CMP 共用 80/81/83 与 00～3B 的编码规律
+static void encode_alu(Encoder *E, MInst *inst, int ext)
+{
+    bool w = inst->size == 8;
+    bool byte = inst->size == 1;
+    MOperand src = inst->src;
+    MOperand dst = inst->dst;
+
+    if (src.kind == MOP_IMM)
+    {
+        if (!fits_int32(src.imm))
+            encode_error(E, inst);
+        else if (byte)
+        {
+            emit_rm(E, inst, 0, false, 0x80, ext, dst, true);
+            put_byte(E->out, (int)src.imm);
+        }
+        else if (fits_int8(src.imm))
+        {
+            emit_rm(E, inst, 0, w, 0x83, ext, dst, false);
+            put_byte(E->out, (int)src.imm);
+        }
+        else
+        {
+            emit_rm(E, inst, 0, w, 0x81, ext, dst, false);
+            put_int32(E->out, (int)src.imm);
+        }
+    }
+    else if (src.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, ext * 8 + (byte ? 0 : 1), reg_code(E, inst, src.reg), dst, byte);
+    else if (dst.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, ext * 8 + (byte ? 2 : 3), reg_code(E, inst, dst.reg), src, byte);
+    else
+        encode_error(E, inst);
+}
+
+static void encode_test(Encoder *E, MInst *inst)
+{
+    bool w = inst->size == 8;
+    bool byte = inst->size == 1;
+    if (inst->src.kind == MOP_IMM)
+    {
+        emit_rm(E, inst, 0, w, byte ? 0xF6 : 0xF7, 0, inst->dst, byte);
+        if (byte)
+            put_byte(E->out, (int)inst->src.imm);
+        else
+            put_int32(E->out, (int)inst->src.imm);
+    }
+    else if (inst->src.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, byte ? 0x84 : 0x85, reg_code(E, inst, inst->src.reg), inst->dst, byte);
+    else if (inst->dst.kind == MOP_REG)
+        emit_rm(E, inst, 0, w, byte ? 0x84 : 0x85, reg_code(E, inst, inst->dst.reg), inst->src, byte);
+    else
+        encode_error(E, inst);
+}
+
+static void encode_imul(Encoder *E, MInst *inst)
+{
+    bool w = inst->size == 8;
+    if (inst->dst.kind != MOP_REG)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    int dst = reg_code(E, inst, inst->dst.reg);
+    if (inst->src.kind == MOP_IMM)
+    {
+        bool short_imm = fits_int8(inst->src.imm);
+        emit_rm(E, inst, 0, w, short_imm ? 0x6B : 0x69, dst, inst->dst, false);
+        if (short_imm)
+            put_byte(E->out, (int)inst->src.imm);
+        else
+            put_int32(E->out, (int)inst->src.imm);
+    }
+    else
+        emit_rm(E, inst, 0, w, 0x0FAF, dst, inst->src, false);
+}
+
+static void encode_shift(Encoder *E, MInst *inst, int ext)
+{
+    if (inst->src.kind != MOP_IMM)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    emit_rm(E, inst, 0, inst->size == 8, 0xC1, ext, inst->dst, false);
+    put_byte(E->out, (int)inst->src.imm);
+}
+
+// SSE 指令：dst 为 XMM 寄存器，src 为寄存器或内存
+static void encode_sse(Encoder *E, MInst *inst, int prefix, int opcode)
+{
+    if (inst->dst.kind != MOP_REG)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    emit_rm(E, inst, prefix, false, opcode, reg_code(E, inst, inst->dst.reg), inst->src, false);
+}
+
+// 向量运算：XMM 形式为 SSE 编码的 dst op= src，pp 为 1 时带 66 前缀；
+// YMM 形式为 VEX.256 编码的 dst = dst op src，map 为操作码表（SSE 形式只用 0F 表）
+static void encode_vector(Encoder *E, MInst *inst, int pp, int map, int opcode)
+{
+    if (inst->dst.kind != MOP_REG)
+    {
+        encode_error(E, inst);
+        return;
+    }
+    int dst = reg_code(E, inst, inst->dst.reg);
+    if (inst->size == 32)
+        emit_vex(E, inst, pp, map, true, opcode, dst, dst, inst->src);
+    else if (inst->size == 16 && map == 1)
+        emit_rm(E, inst, pp == 1 ? 0x66 : 0, false, 0x0F00 | opcode, dst, inst->src, false);
+    else
+        encode_error(E, inst);
+}
+
+static void encode_movups(Encoder *E, MInst *inst)
+{
+    bool ymm = inst->size == 32;
+    if (inst->dst.kind == MOP_REG)
+    {
+        int dst = reg_code(E, inst, inst->dst.reg);
+        if (ymm)
+            emit_vex(E, inst, 0, 1, true, 0x10, dst, 0, inst->src);
+        else
+            emit_rm(E, inst, 0, false, 0x0F10, dst, inst->src, false);
+    }
+    else if (inst->src.kind == MOP_REG)
+    {
+        int src = reg_code(E, inst, inst->src.reg);
+        if (ymm)
+            emit_vex(E, inst, 0, 1, true, 0x11, src, 0, inst->dst);
+        else
+            emit_rm(E, inst, 0, false, 0x0F11, src, inst->dst, false);
+    }
+    else
+        encode_error(E, inst);
+}
+
+static void encode_instruction(Encoder *E, MInst *inst)
+{
+    CodeBuffer *b = E->out;
+    switch (inst->op)
+    {
+    case M_LABEL:
+        if (inst->src.label >= 0 && inst->src.label < E->label_limit)
+            E->label_offsets[inst->src.label] = b->size;
+        else
+            encode_error(E, inst);
+        break;
+    case M_MOV:
+        encode_mov(E, inst);
+        break;
+    case M_MOVSXD:
+        emit_rm(E, inst, 0, true, 0x63, reg_code(E, inst, inst->dst.reg), inst->src, false);
+        break;
+    case M_MOVZB:
+        emit_rm(E, inst, 0, false, 0x0FB6, reg_code(E, inst, inst->dst.reg), inst->src, true);
+        break;
+    case M_LEA:
+        if (inst->src.kind != MOP_MEM)
+            encode_error(E, inst);
+        else
+            emit_rm(E, inst, 0, inst->size == 8, 0x8D, reg_code(E, inst, inst->dst.reg), inst->src, false);
+        break;
+    case M_ADD:
+        encode_alu(E, inst, EXT_ADD);
+        break;
+    case M_SUB:
+        encode_alu(E, inst, EXT_SUB);
+        break;
+    case M_AND:
+        encode_alu(E, inst, EXT_AND);
+        break;
+    case M_OR:
+        encode_alu(E, inst, EXT_OR);
+        break;
+    case M_XOR:
+        encode_alu(E, inst, EXT_XOR);
+        break;
+    case M_CMP:
+        encode_alu(E, inst, EXT_CMP);
+        break;
+    case M_TEST:
+        encode_test(E, inst);
+        break;
+    case M_IMUL:
+        encode_imul(E, inst);
+        break;
+    case M_NEG:
+        emit_rm(E, inst, 0, inst->size == 8, 0xF7, 3, inst->dst, false);
+        break;
+    case M_SHL:
+        encode_shift(E, inst, 4);
+        break;
+    case M_SAR:
+        encode_shift(E, inst, 7);
+        break;
+    case M_CDQ:
+        if (inst->size == 8)
+            put_byte(b, 0x48);
+        put_byte(b, 0x99);
+        break;
+    case M_IDIV:
+        emit_rm(E, inst, 0, inst->size == 8, 0xF7, 7, inst->src, false);
+        break;
+    case M_SETCC:
+        emit_rm(E, inst, 0, false, 0x0F90 + cond_codes[inst->cc], 0, inst->dst, true);
+        break;
+    case M_JMP:
+        if (inst->src.kind != MOP_LABEL)
+        {
+            encode_error(E, inst);
+            break;
+        }
+        emit_jump(E, inst->src.label, 0xEB, 0xE9);
+        break;
+    case M_JCC:
+        if (inst->src.kind != MOP_LABEL)
+        {
+            encode_error(E, inst);
+            break;
+        }
+        emit_jump(E, inst->src.label, 0x70 + cond_codes[inst->cc], 0x0F80 + cond_codes[inst->cc]);
+        break;
+    case M_CALL:
+        if (inst->src.kind != MOP_SYMBOL)
+        {
+            encode_error(E, inst);
+            break;
+        }
+        put_byte(b, 0xE8);
+        add_call_fixup(E, inst->src.symbol);
+        break;
+    case M_RET:
+        put_byte(b, 0xC3);
+        break;
+    case M_PUSH:
+        if (inst->src.kind != MOP_REG)
+            encode_error(E, inst);
+        else
+            emit_plus_reg(E, inst, false, 0x50, inst->src.reg, false);
+        break;
+    case M_POP:
+        if (inst->dst.kind != MOP_REG)
+            encode_error(E, inst);
+        else
+            emit_plus_reg(E, inst, false, 0x58, inst->dst.reg, false);
+        break;
+    case M_LEAVE:
+        put_byte(b, 0xC9);
+        break;
+    case M_MOVSS:
+        if (inst->dst.kind == MOP_REG)
+            emit_rm(E, inst, 0xF3, false, 0x0F10, reg_code(E, inst, inst->dst.reg), inst->src, false);
+        else if (inst->src.kind == MOP_REG)
+            emit_rm(E, inst, 0xF3, false, 0x0F11, reg_code(E, inst, inst->src.reg), inst->dst, false);
+        else
+            encode_error(E, inst);
+        break;
+    case M_ADDSS:
+        encode_sse(E, inst, 0xF3, 0x0F58);
+        break;
+    case M_SUBSS:
+        encode_sse(E, inst, 0xF3, 0x0F5C);
+        break;
+    case M_MULSS:
+        encode_sse(E, inst, 0xF3, 0x0F59);
+        break;
+    case M_DIVSS:
+        encode_sse(E, inst, 0xF3, 0x0F5E);
+        break;
+    case M_UCOMISS:
+        encode_sse(E, inst, 0, 0x0F2E);
+        break;
+    case M_XORPS:
+        encode_sse(E, inst, 0, 0x0F57);
+        break;
+    case M_CVTSI2SS:
+        encode_sse(E, inst, 0xF3, 0x0F2A);
+        break;
+    case M_CVTTSS2SI:
+        encode_sse(E, inst, 0xF3, 0x0F2C);
+        break;
+    case M_MOVD:
+        if (inst->dst.kind == MOP_REG && IS_XMM(inst->dst.reg))
+            emit_rm(E, inst, 0x66, false, 0x0F6E, reg_code(E, inst, inst->dst.reg), inst->src, false);
+        else if (inst->src.kind == MOP_REG && IS_XMM(inst->src.reg))
+            emit_rm(E, inst, 0x66, false, 0x0F7E, reg_code(E, inst, inst->src.reg), inst->dst, false);
+        else
+            encode_error(E, inst);
+        break;
+    case M_MOVUPS:
+        encode_movups(E, inst);
+        break;
+    case M_ADDPS:
+        encode_vector(E, inst, 0, 1, 0x58);
+        break;
+    case M_SUBPS:
+        encode_vector(E, inst, 0, 1, 0x5C);
+        break;
+    case M_MULPS:
+        encode_vector(E, inst, 0, 1, 0x59);
+        break;
+    case M_DIVPS:
+        encode_vector(E, inst, 0, 1, 0x5E);
+        break;
+    case M_PADDD:
+        encode_vector(E, inst, 1, 1, 0xFE);
+        break;
+    case M_PSUBD:
+        encode_vector(E, inst, 1, 1, 0xFA);
+        break;
+    case M_PMULLD:
+        encode_vector(E, inst, 1, 2, 0x40);
+        break;
+    case M_BROADCAST:
+        if (inst->dst.kind != MOP_REG)
+            encode_error(E, inst);
+        else if (inst->size == 32)
+            emit_vex(E, inst, 1, 2, true, 0x58, reg_code(E, inst, inst->dst.reg), 0, inst->src);
+        else
+        {
+            emit_rm(E, inst, 0x66, false, 0x0F70, reg_code(E, inst, inst->dst.reg), inst->src, false);
+            put_byte(b, 0);
+        }
+        break;
+    case M_VZEROUPPER:
+        put_byte(b, 0xC5);
+        put_byte(b, 0xF8);
+        put_byte(b, 0x77);
+        break;
+    case M_CPUID:
+        put_byte(b, 0x0F);
+        put_byte(b, 0xA2);
+        break;
+    case M_XGETBV:
+        put_byte(b, 0x0F);
+        put_byte(b, 0x01);
+        put_byte(b, 0xD0);
+        break;
+    default:
+        encode_error(E, inst);
+        break;
+    }
+
+    // RIP 相对的偏移相对指令末尾（其后可能还有立即数）
+    if (E->rip_field >= 0)
+    {
+        add_relocation(b, E->rip_field, E->rip_symbol, RELOC_PC32, E->rip_disp - (b->size - E->rip_field));
+        E->rip_field = -1;
+    }
+}
+
+// 分支缩短：先把所有跳转按 2 字节的短形式编码，偏移超出 8 位的改为近形式后重新编码。
+// 跳转只会由短变长，代码只增不减，迭代必然终止
+static void encode_function(Encoder *E, MFunction *mf)
+{
+    CodeBuffer *b = E->out;
+    E->mf = mf;
+
+    int limit = 0;
+    int jumps = 0;
+    for (MInst *inst = mf->head; inst != NULL; inst = inst->next)
+    {
+        if ((inst->op == M_LABEL || inst->op == M_JMP || inst->op == M_JCC) && inst->src.label >= limit)
+            limit = inst->src.label + 1;
+        if ((inst->op == M_JMP || inst->op == M_JCC) && inst->src.kind == MOP_LABEL)
+            jumps++;
+    }
+    if (limit > E->label_limit)
+    {
+        E->label_offsets = (int *)realloc(E->label_offsets, limit * sizeof(int));
+        E->label_limit = limit;
+    }
+    if (jumps > E->near_capacity)
+    {
+        E->near_jumps = (bool *)realloc(E->near_jumps, jumps * sizeof(bool));
+        E->near_capacity = jumps;
+    }
+    for (int i = 0; i < jumps; i++)
+        E->near_jumps[i] = false;
+
+    int start = b->size;
+    int reloc_start = b->reloc_count;
+    int call_fixup_start = E->call_fixup_count;
+    bool grown = true;
+    while (grown && !E->failed)
+    {
+        b->size = start;
+        b->reloc_count = reloc_start;
+        E->call_fixup_count = call_fixup_start;
+        E->label_fixup_count = 0;
+        E->jump_count = 0;
+        for (int i = 0; i < E->label_limit; i++)
+            E->label_offsets[i] = -1;
+
+        for (MInst *inst = mf->head; inst != NULL && !E->failed; inst = inst->next)
+            encode_instruction(E, inst);
+
+        grown = false;
+        for (int i = 0; i < E->label_fixup_count && !E->failed; i++)
+        {
+            LabelFixup *fixup = &E->label_fixups[i];
+            int target = E->label_offsets[fixup->label];
+            if (target < 0)
+            {
+                fprintf(stderr, "Error: x86-64 encoder: undefined label .L%d in function %s\n", fixup->label, mf->name);
+                E->failed = true;
+                break;
+            }
+            if (!fixup->near && !fits_int8(target - (fixup->offset + 1)))
+            {
+                E->near_jumps[fixup->jump] = true;
+                grown = true;
+            }
+        }
+    }
+
+    for (int i = 0; i < E->label_fixup_count && !E->failed; i++)
+    {
+        LabelFixup *fixup = &E->label_fixups[i];
+        int target = E->label_offsets[fixup->label];
+        if (fixup->near)
+            patch_int32(b, fixup->offset, target - (fixup->offset + 4));
+        else
+            b->bytes[fixup->offset] = (unsigned char)(target - (fixup->offset + 1));
+    }
+
+    b->symbols = (CodeSymbol *)realloc(b->symbols, (b->symbol_count + 1) * sizeof(CodeSymbol));
+    CodeSymbol *symbol = &b->symbols[b->symbol_count++];
+    symbol->name = intern_symbol(mf->name);
+    symbol->offset = start;
+    symbol->size = b->size - start;
+    symbol->weak = mf->weak;
+}
+
+bool encode_mprogram(MProgram *program, CodeBuffer *out)
+{
+    memset(out, 0, sizeof(CodeBuffer));
+    Encoder E;
+    memset(&E, 0, sizeof(E));
+    E.out = out;
+    E.rip_field = -1;
+
+    for (MFunction *mf = program->functions; mf != NULL && !E.failed; mf = mf->next)
+        encode_function(&E, mf);
+
+    // 程序内的调用直接填写偏移，外部函数的调用留作重定位。
+    // 弱定义的函数（缺省的越界处理函数）可能在链接时被其他目标文件中的定义取代，同样留作重定位
+    for (int i = 0; i < E.call_fixup_count && !E.failed; i++)
+    {
+        CallFixup *fixup = &E.call_fixups[i];
+        int target = -1;
+        for (int s = 0; s < out->symbol_count; s++)
+        {
+            if (out->symbols[s].name == fixup->symbol && !out->symbols[s].weak)
+                target = out->symbols[s].offset;
+        }
+        if (target >= 0)
+            patch_int32(out, fixup->offset, target - (fixup->offset + 4));
+        else
+            add_relocation(out, fixup->offset, fixup->symbol, RELOC_CALL, -4);
+    }
+
+    free(E.label_offsets);
+    free(E.label_fixups);
+    free(E.near_jumps);
+    free(E.call_fixups);
+    if (E.failed)
+        free_code_buffer(out);
+    return !E.failed;
+}
+
+void free_code_buffer(CodeBuffer *buffer)
+{
+    free(buffer->bytes);
+    free(buffer->symbols);
+    free(buffer->relocs);
+    memset(buffer, 0, sizeof(CodeBuffer));
+}
@@ -0,0 +1,49 @@
+#ifndef X86_ENCODE_H
+#define X86_ENCODE_H
+
+#include "machine.h"
+
+// 重定位类型
+typedef enum
+{
+    RELOC_CALL,  // call rel32，目标为外部函数或弱定义的函数
+    RELOC_PC32   // RIP 相对的 32 位偏移，目标为全局数据
+} RelocKind;
+
+// 编码后仍需链接时填写的位置：目标地址 = 符号地址 + addend - 所在位置
+typedef struct Relocation
+{
+    int offset;          // 32 位字段在代码中的位置
+    const char *symbol;  // 驻留的符号名
+    RelocKind kind;
+    int addend;
+} Relocation;
+
+// 代码中定义的函数
+typedef struct CodeSymbol
+{
+    const char *name;
+    int offset;
+    int size;
+    bool weak;
+} CodeSymbol;
+
+// 编码结果：函数依次排列的机器代码。程序内的跳转与调用已经解析，
+// 外部函数与弱定义函数的调用、全局数据的访问留作重定位
+typedef struct CodeBuffer
+{
+    unsigned char *bytes;
+    int size;
+    int capacity;
+    CodeSymbol *symbols;
+    int symbol_count;
+    Relocation *relocs;
+    int reloc_count;
+    int reloc_capacity;
+} CodeBuffer;
+
+// 把栈帧布局后的机器程序编码为 x86-64 机器代码，遇到无法编码的指令报错并返回false
+bool encode_mprogram(MProgram *program, CodeBuffer *out);
+void free_code_buffer(CodeBuffer *buffer);
+
+#endif
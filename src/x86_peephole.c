@@ -0,0 +1,289 @@
+#include "x86_peephole.h"
+#include <stdlib.h>
+
+// 跳转链最多追踪的层数，超过时视为环，不改目标
+#define MAX_JUMP_CHAIN 8
+
+typedef struct Peephole
+{
+    MFunction *mf;
+    MInst **labels;   // 按标签编号：标签指令，NULL 表示未定义
+    int label_limit;
+    int removed;
+} Peephole;
+
+static void remove_inst(Peephole *P, MInst *inst)
+{
+    minst_remove(P->mf, inst);
+    P->removed++;
+}
+
+// 操作数是否读取寄存器 reg（含内存操作数的基址与变址）
+static bool refers_to(MOperand op, int reg)
+{
+    if (op.kind == MOP_REG)
+        return op.reg == reg;
+    if (op.kind == MOP_MEM)
+        return op.reg == reg || op.index == reg;
+    return false;
+}
+
+// 跳过标签，返回其后第一条指令
+static MInst *skip_labels(MInst *inst)
+{
+    while (inst != NULL && inst->op == M_LABEL)
+        inst = inst->next;
+    return inst;
+}
+
+// inst 之后只隔着标签就到达 label
+static bool label_follows(MInst *inst, int label)
+{
+    for (MInst *p = inst->next; p != NULL && p->op == M_LABEL; p = p->next)
+    {
+        if (p->src.label == label)
+            return true;
+    }
+    return false;
+}
+
+static void index_labels(Peephole *P)
+{
+    int limit = 0;
+    for (MInst *inst = P->mf->head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == M_LABEL && inst->src.label >= limit)
+            limit = inst->src.label + 1;
+    }
+    P->label_limit = limit;
+    P->labels = (MInst **)calloc(limit + 1, sizeof(MInst *));
+    for (MInst *inst = P->mf->head; inst != NULL; inst = inst->next)
+    {
+        if (inst->op == M_LABEL && inst->src.label >= 0)
+            P->labels[inst->src.label] = inst;
+    }
+}
+
+// 跳到 label 后经过一串无条件跳转最终到达的标签
+static int final_target(Peephole *P, int label)
+{
+    int target = label;
+    for (int hops = 0; hops < MAX_JUMP_CHAIN; hops++)
+    {
+        if (target < 0 || target >= P->label_limit || P->labels[target] == NULL)
+            return target;
+        MInst *first = skip_labels(P->labels[target]->next);
+        if (first == NULL || first->op != M_JMP || first->src.label == target)
+            return target;
+        target = first->src.label;
+    }
+    return label;
+}
+
+// ========================= 传送 =========================
+
+// 紧随存储之后读取同一位置的指令：读到的值就是存入的寄存器或立即数
+static bool forwards_from_store(MInst *store, MInst *next)
+{
+    if (store->src.kind == MOP_REG)
+    {
+        if (store->op == M_MOVSS)
+        {
+            switch (next->op)
+            {
+            case M_MOVSS:
+            case M_ADDSS:
+            case M_SUBSS:
+            case M_MULSS:
+            case M_DIVSS:
+            case M_UCOMISS:
+                return true;
+            default:
+                return false;
+            }
+        }
+        if (next->op == M_MOVSXD)
+            return store->size == 4;
+    }
+    switch (next->op)
+    {
+    case M_MOV:
+    case M_ADD:
+    case M_SUB:
+    case M_AND:
+    case M_OR:
+    case M_XOR:
+    case M_CMP:
+    case M_IMUL:
+        return store->op == M_MOV && next->size == store->size;
+    default:
+        return false;
+    }
+}
+
+static bool simplify_move(Peephole *P, MInst *inst)
+{
+    // mov x, x
+    if (mop_equal(inst->src, inst->dst))
+    {
+        remove_inst(P, inst);
+        return true;
+    }
+
+    MInst *next = inst->next;
+    if (next == NULL)
+        return false;
+
+    // mov a, b; mov b, a：第二条不改变任何值（a 的地址不能依赖 b）
+    if (next->op == inst->op && next->size == inst->size && mop_equal(next->src, inst->dst) &&
+        mop_equal(next->dst, inst->src) && !(inst->dst.kind == MOP_REG && refers_to(inst->src, inst->dst.reg)))
+    {
+        remove_inst(P, next);
+        return true;
+    }
+
+    // mov r, M; op M, s => op r, s
+    if (inst->dst.kind == MOP_MEM && mop_equal(next->src, inst->dst) && forwards_from_store(inst, next))
+    {
+        next->src = inst->src;
+        return true;
+    }
+
+    // mov x, r; mov y, r：第一条的结果被覆盖
+    if (inst->op == M_MOV && inst->dst.kind == MOP_REG && next->op == M_MOV && next->size >= 4 &&
+        next->dst.kind == MOP_REG && next->dst.reg == inst->dst.reg && !refers_to(next->src, inst->dst.reg))
+    {
+        remove_inst(P, inst);
+        return true;
+    }
+    return false;
+}
+
+// ========================= 跳转 =========================
+
+static bool simplify_jump(Peephole *P, MInst *inst)
+{
+    int label = inst->src.label;
+
+    // 跳到紧随其后的标签
+    if (label_follows(inst, label))
+    {
+        remove_inst(P, inst);
+        return true;
+    }
+
+    // jcc L1; jmp L2; L1: => j!cc L2
+    MInst *next = inst->next;
+    if (inst->op == M_JCC && next != NULL && next->op == M_JMP && label_follows(next, label))
+    {
+        inst->cc = negate_cond(inst->cc);
+        inst->src.label = next->src.label;
+        remove_inst(P, next);
+        return true;
+    }
+
+    // 目标处是无条件跳转时直接跳到最终目标
+    int target = final_target(P, label);
+    if (target != label)
+    {
+        inst->src.label = target;
+        return true;
+    }
+
+    // jmp 之后到下一个标签之前的指令不可达
+    if (inst->op == M_JMP && next != NULL && next->op != M_LABEL)
+    {
+        remove_inst(P, next);
+        return true;
+    }
+    return false;
+}
+
+// ========================= 标志 =========================
+
+// 运算设置的标志与 cmp $0 的结果在条件码 cc 下是否一致：
+// 逻辑运算清除 OF 与 CF，与 cmp $0 完全一致；加减与取负的 OF、CF 不同，只有 ZF 可用
+static bool flags_match_zero_compare(MOpcode op, CondCode cc)
+{
+    switch (op)
+    {
+    case M_AND:
+    case M_OR:
+    case M_XOR:
+        return cc != CC_P && cc != CC_NP;
+    case M_ADD:
+    case M_SUB:
+    case M_NEG:
+        return cc == CC_E || cc == CC_NE;
+    default:
+        return false;
+    }
+}
+
+// op x, d; cmp $0, d; jcc/setcc => op x, d; jcc/setcc。
+// 后端生成的比较只由紧随其后的 jcc/setcc 读取标志
+static bool simplify_zero_compare(Peephole *P, MInst *inst)
+{
+    MInst *prev = inst->prev;
+    if (inst->src.kind != MOP_IMM || inst->src.imm != 0 || prev == NULL || prev->size != inst->size ||
+        !mop_equal(prev->dst, inst->dst))
+        return false;
+
+    MInst *reader = inst->next;
+    if (reader == NULL || (reader->op != M_JCC && reader->op != M_SETCC))
+        return false;
+    for (; reader != NULL && (reader->op == M_JCC || reader->op == M_SETCC); reader = reader->next)
+    {
+        if (!flags_match_zero_compare(prev->op, reader->cc))
+            return false;
+    }
+    remove_inst(P, inst);
+    return true;
+}
+
+static bool simplify(Peephole *P, MInst *inst)
+{
+    switch (inst->op)
+    {
+    case M_MOV:
+    case M_MOVSS:
+        return simplify_move(P, inst);
+    case M_JMP:
+    case M_JCC:
+        return inst->src.kind == MOP_LABEL && simplify_jump(P, inst);
+    case M_RET:
+        // ret 之后到下一个标签之前的指令不可达
+        if (inst->next != NULL && inst->next->op != M_LABEL)
+        {
+            remove_inst(P, inst->next);
+            return true;
+        }
+        return false;
+    case M_CMP:
+        return simplify_zero_compare(P, inst);
+    default:
+        return false;
+    }
+}
+
+int x86_peephole(MFunction *mf)
+{
+    Peephole P;
+    P.mf = mf;
+    P.removed = 0;
+    index_labels(&P);
+
+    // 改写只删除当前指令或其后的指令，改写后从前一条指令重新检查，使新形成的模式也能匹配
+    MInst *inst = mf->head;
+    while (inst != NULL)
+    {
+        MInst *prev = inst->prev;
+        if (simplify(&P, inst))
+            inst = prev != NULL ? prev : mf->head;
+        else
+            inst = inst->next;
+    }
+
+    free(P.labels);
+    return P.removed;
+}
@@ -0,0 +1,12 @@
+#ifndef X86_PEEPHOLE_H
+#define X86_PEEPHOLE_H
+
+#include "machine.h"
+
+// 寄存器分配之后、栈帧布局之前的机器级窥孔优化：删除自身传送与互逆的传送、被覆盖的传送、
+// 跳到下一条指令的 jmp 与 jmp 之后的不可达指令，把跳到 jmp 的跳转改到最终目标，
+// 条件跳转越过 jmp 时取反条件合并，删除运算已设置好标志的与零比较，
+// 把紧随存储之后对同一位置的读取改为直接使用存入的寄存器。返回删除的指令条数
+int x86_peephole(MFunction *mf);
+
+#endif
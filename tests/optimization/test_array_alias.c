@@ -0,0 +1,104 @@
+// 数组别名分析测试
+// 不同名的局部数组互不重叠；同一数组比较常量下标和仿射下标 i+c；
+// 形参数组之间可能重叠，函数调用之后传出去的数组内容不再已知
+
+int forward(int v)
+{
+    int a[8];
+    int b[8];
+    int x;
+    int y;
+    a[2] = v;
+    b[2] = v * 3;
+    a[3] = 7;
+    x = a[2];
+    y = a[3] + b[2];
+    return x + y;
+}
+
+int affine(int i)
+{
+    int a[16];
+    int s;
+    a[i] = 10;
+    a[i + 1] = 20;
+    a[i + 2] = a[i] + a[i + 1];
+    s = a[i + 2] + a[i];
+    return s;
+}
+
+int redundant(int i)
+{
+    int a[10];
+    int k;
+    int s;
+    k = 0;
+    while (k < 10)
+    {
+        a[k] = k * k;
+        k = k + 1;
+    }
+    s = a[i] + a[i] * a[i];
+    return s;
+}
+
+int dead_store(int v)
+{
+    int a[4];
+    a[0] = 1;
+    a[1] = 2;
+    a[0] = v;
+    a[1] = a[0] + 1;
+    a[1] = a[1] * 2;
+    return a[0] + a[1];
+}
+
+int maybe_same(int p[4], int q[4])
+{
+    int x;
+    p[0] = 5;
+    q[0] = 9;
+    x = p[0];
+    return x;
+}
+
+int clobber(int c[4])
+{
+    c[1] = c[1] + 100;
+    return c[1];
+}
+
+int escape()
+{
+    int a[4];
+    int r;
+    a[1] = 1;
+    r = clobber(a);
+    return r + a[1];
+}
+
+int unknown_index(int i, int j)
+{
+    int a[8];
+    int k;
+    k = 0;
+    while (k < 8)
+    {
+        a[k] = 0;
+        k = k + 1;
+    }
+    a[i] = 3;
+    a[j] = 4;
+    return a[i];
+}
+
+int main()
+{
+    int a[4];
+    int r;
+    a[0] = 0;
+    r = forward(2) + affine(3) + redundant(4) + dead_store(6);
+    r = r + maybe_same(a, a) + escape();
+    r = r + unknown_index(1, 1) + unknown_index(1, 2);
+    return r;
+}
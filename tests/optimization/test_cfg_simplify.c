@@ -0,0 +1,57 @@
+int classify(int x)
+{
+    int r;
+    // 嵌套 if-else 的出口形成跳转链，穿透后直接跳到最终目标
+    if (x < 10)
+    {
+        if (x < 5)
+        {
+            r = 1;
+        }
+        else
+        {
+            r = 2;
+        }
+    }
+    else
+    {
+        if (x < 20)
+        {
+            r = 3;
+        }
+        else
+        {
+            r = 4;
+        }
+    }
+    return r;
+}
+
+int main()
+{
+    int i;
+    int sum;
+
+    sum = 0;
+    i = 0;
+    while (i < 25)
+    {
+        sum = sum + classify(i);
+        // 常量条件：分支被折叠，不可达的块被删除
+        if (1)
+        {
+            sum = sum + 1;
+        }
+        if (0)
+        {
+            sum = sum + 1000;
+        }
+        i = i + 1;
+    }
+    while (0)
+    {
+        sum = sum - 1;
+    }
+
+    return sum;
+}
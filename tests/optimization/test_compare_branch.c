@@ -0,0 +1,60 @@
+// 浮点比较不能取反关系：n 为 NaN 时 n < 1.0 与 n >= 1.0 都不成立
+int nan_branches(float z)
+{
+    float n;
+    int r;
+    n = z / z;
+    r = 0;
+    if (n < 1.0)
+    {
+        r = r + 1;
+    }
+    else
+    {
+        r = r + 2;
+    }
+    if (n >= 1.0)
+    {
+        r = r + 10;
+    }
+    else
+    {
+        r = r + 20;
+    }
+    return r;
+}
+
+int main()
+{
+    int a;
+    int b;
+    int i;
+    int result;
+
+    // 关系条件直接生成 IF x relop y GOTO L，假出口紧随其后时省去 GOTO
+    a = 3;
+    b = 7;
+    result = 0;
+    i = 0;
+    while (i < 10)
+    {
+        if (i == a)
+        {
+            result = result + 10;
+        }
+        else
+        {
+            if (i != b && i >= 2)
+            {
+                result = result + i;
+            }
+        }
+        if (!(i <= 5) || i > 8)
+        {
+            result = result + 1;
+        }
+        i = i + 1;
+    }
+
+    return result + nan_branches(0.0);
+}
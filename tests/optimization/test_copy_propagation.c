@@ -0,0 +1,106 @@
+// 全局复制传播与临时变量合并测试
+// 复制链应被消去，跨基本块可用的复制在汇合点之后仍可传播，输出的临时变量编号应稠密；
+// int 与 float 之间的赋值带类型转换，不是复制
+
+int chain(int a)
+{
+    int b;
+    int c;
+    int d;
+    b = a;
+    c = b;
+    d = c;
+    return d + c + b;
+}
+
+// 两个分支给出相同的复制，汇合后仍可用
+int join(int x, int flag)
+{
+    int y;
+    int z;
+    if (flag > 0)
+    {
+        y = x;
+        z = 1;
+    }
+    else
+    {
+        y = x;
+        z = 2;
+    }
+    return y * z;
+}
+
+// 循环中被重新赋值的变量，复制不能越过回边传播
+int loop(int n)
+{
+    int i = 0;
+    int s = 0;
+    int last = 0;
+    while (i < n)
+    {
+        last = s;
+        s = s + i;
+        i = i + 1;
+    }
+    return s + last;
+}
+
+// 交换：两个复制互相使对方失效
+int swap(int p, int q, int k)
+{
+    int tmp;
+    while (k > 0)
+    {
+        tmp = p;
+        p = q;
+        q = tmp;
+        k = k - 1;
+    }
+    return p * 10 + q;
+}
+
+// i := x 把 2.5 截断为 2，后面的 i 不能换成 x
+int truncate(float x)
+{
+    int i;
+    float f;
+    i = x;
+    f = i;
+    i = f * 4;
+    return i;
+}
+
+// 中间隔着别的赋值，复制传播同样不能把 i 换成 x
+int truncate_later(float x)
+{
+    int i;
+    int k;
+    float f;
+    i = x;
+    k = 3;
+    f = i;
+    i = f * 4 + k;
+    return i;
+}
+
+// f := n 之后 f / 2 是浮点除法，不能换成 n / 2
+int halve(int n)
+{
+    float f;
+    int r;
+    f = n;
+    f = f / 2;
+    r = f * 4;
+    return r;
+}
+
+int main()
+{
+    int r1 = chain(7);
+    int r2 = join(5, 1) + join(5, 0);
+    int r3 = loop(10);
+    int r4 = swap(3, 4, 3);
+    int r5 = truncate(2.5) + truncate_later(2.5) + halve(5);
+    return r1 + r2 + r3 + r4 + r5;
+}
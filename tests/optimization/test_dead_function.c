@@ -0,0 +1,38 @@
+int helper(int x)
+{
+    return x + 1;
+}
+
+int count_down(int n)
+{
+    // 直接递归，构成自环的强连通分量，但从 main 不可达
+    if (n == 0)
+    {
+        return 0;
+    }
+    return count_down(n - 1);
+}
+
+int unused_library(int a, int b)
+{
+    int r;
+    r = helper(a) * helper(b);
+    return r;
+}
+
+int gcd(int a, int b)
+{
+    // 直接递归：可达，保留
+    if (b == 0)
+    {
+        return a;
+    }
+    return gcd(b, a - a / b * b);
+}
+
+int main()
+{
+    int r;
+    r = gcd(84, 36);
+    return helper(r);
+}
@@ -0,0 +1,33 @@
+int main()
+{
+    int a[40];
+    int b[40];
+    int i;
+    int n;
+    int k;
+    int sum;
+
+    n = 10;
+    k = 3;
+
+    // a[i * 4 + 1] 的下标是派生归纳变量，乘法可削弱为每次迭代加4
+    i = 0;
+    while (i < n)
+    {
+        a[i * 4 + 1] = i;
+        b[i] = i * k;
+        i = i + 1;
+    }
+
+    // 此循环中 i 只用于计算下标，经线性函数测试替换后可以消除
+    i = 0;
+    sum = 0;
+    while (i < n)
+    {
+        a[i * 4 + 1] = a[i * 4 + 1] * 2;
+        sum = sum + a[i * 4 + 1];
+        i = i + 1;
+    }
+
+    return sum + b[3];
+}
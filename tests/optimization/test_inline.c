@@ -0,0 +1,67 @@
+int square(int x)
+{
+    return x * x;
+}
+
+int clamp(int v, int lo, int hi)
+{
+    if (v < lo)
+    {
+        return lo;
+    }
+    if (v > hi)
+    {
+        return hi;
+    }
+    return v;
+}
+
+int bump(int step, int base)
+{
+    // 形参被重新赋值：展开时形参复制到新的局部变量
+    step = step * 2;
+    return base + step;
+}
+
+int sum_array(int a[5], int n)
+{
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < n)
+    {
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+int fact(int n)
+{
+    // 递归函数不内联
+    if (n <= 1)
+    {
+        return 1;
+    }
+    return n * fact(n - 1);
+}
+
+int main()
+{
+    int data[5];
+    int i;
+    int total;
+
+    i = 0;
+    while (i < 5)
+    {
+        data[i] = clamp(square(i), 1, 10);
+        i = i + 1;
+    }
+    total = sum_array(data, 5);
+    total = total + clamp(bump(total, 3), 0, square(9));
+    total = total + bump(1, total) + fact(4);
+
+    return total;
+}
@@ -0,0 +1,63 @@
+struct Point
+{
+    int x;
+    int y;
+};
+
+// 形参数组可能是同一块存储：a 与 b 同为 arr 时，b[i] 的写入会改变 a[2]，a[2] 不能外提
+int shared(int a[10], int b[10])
+{
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < 4)
+    {
+        b[i] = 10;
+        s = s + a[2];
+        i = i + 1;
+    }
+    return s;
+}
+
+// 一次都不执行的循环不能读取 a[k]（k 可能越界）：读取在循环旋转之后才外提到守卫之后
+int guarded(int a[10], int n, int k)
+{
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < n)
+    {
+        s = s + a[k];
+        i = i + 1;
+    }
+    return s;
+}
+
+int main()
+{
+    int arr[10];
+    int i;
+    int n;
+    int a;
+    int b;
+    int sum;
+    struct Point p;
+
+    // 循环内的 a * b、arr[2] + p.x 与 i 无关，应外提到循环前置块
+    arr[2] = 7;
+    p.x = 3;
+    a = 4;
+    b = 5;
+    n = 10;
+    i = 0;
+    sum = 0;
+    while (i < n)
+    {
+        sum = sum + a * b + (arr[2] + p.x) * i;
+        i = i + 1;
+    }
+
+    return sum + shared(arr, arr) + guarded(arr, 0, 100000000) + guarded(arr, 3, 2);
+}
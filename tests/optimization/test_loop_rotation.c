@@ -0,0 +1,41 @@
+// 浮点条件的循环旋转后不能取反比较：n 为 NaN 时 x < n 不成立，循环体一次也不执行
+int steps(float x, float n)
+{
+    int r;
+    r = 0;
+    while (x < n)
+    {
+        x = x + 1.0;
+        r = r + 1;
+        if (r > 5)
+        {
+            return 100;
+        }
+    }
+    return r;
+}
+
+int main()
+{
+    int i;
+    int j;
+    int n;
+    int count;
+
+    // 旋转后每次迭代只在循环底部执行一次条件跳转
+    n = 8;
+    count = 0;
+    i = 0;
+    while (i < n)
+    {
+        j = 0;
+        while (j < i && count < 100)
+        {
+            count = count + 1;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+
+    return count + steps(0.0, 0.0 / 0.0) + steps(0.0, 3.0);
+}
@@ -0,0 +1,58 @@
+// 计数循环展开测试
+// 迭代次数为常量的循环：小循环完全展开，大循环按展开因子部分展开并保留余数循环
+
+int main()
+{
+    int a[16];
+    int i = 0;
+    int s = 0;
+    int p = 1;
+
+    // 8次迭代，完全展开后下标都是常量
+    while (i < 8)
+    {
+        a[i] = i * i;
+        i = i + 1;
+    }
+
+    // 递减计数，步长为2
+    i = 14;
+    while (i >= 8)
+    {
+        a[i] = i;
+        i = i - 2;
+    }
+
+    // 循环体含分支：展开时分支标签逐份重命名
+    i = 0;
+    while (i < 6)
+    {
+        if (a[i] > 10)
+        {
+            s = s + a[i];
+        }
+        else
+        {
+            p = p + 1;
+        }
+        i = i + 1;
+    }
+
+    // 迭代次数较多，部分展开，主循环之后由余数循环完成剩余的迭代
+    i = 0;
+    while (i < 103)
+    {
+        s = s + i;
+        i = i + 1;
+    }
+
+    // 迭代次数正好是展开因子的倍数，不需要余数循环
+    i = 0;
+    while (i != 200)
+    {
+        p = p + 3;
+        i = i + 5;
+    }
+
+    return s + p + i;
+}
@@ -0,0 +1,46 @@
+// 窥孔优化测试
+// 代数恒等式、常量折叠、连续取负、临时变量转存与冗余赋值都由规则表完成
+
+int identities(int a)
+{
+    int b;
+    int c;
+    int d;
+    b = a + 0;
+    c = 1 * b - 0;
+    d = (c - c) + c / 1;
+    return 0 - d + a * 2;
+}
+
+int folding()
+{
+    int x;
+    int y;
+    x = (12 / 4) * (7 - 2);
+    y = (x > 10) + (x == 15) * 2 + (3 != 3);
+    return -(-x) + y;
+}
+
+int negations(int p)
+{
+    int q;
+    q = -(-(p * -1));
+    return q;
+}
+
+int overwrite(int n)
+{
+    int m;
+    int k;
+    m = n;
+    m = n + 1;
+    k = m;
+    m = k;
+    return m + k;
+}
+
+int main()
+{
+    int r = identities(9) + folding() + negations(4) + overwrite(20);
+    return r;
+}
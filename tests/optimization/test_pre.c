@@ -0,0 +1,74 @@
+// 部分冗余消除测试
+// 只在部分路径上计算过的表达式在汇合后再次计算：在另一条路径上补一份计算，
+// 汇合处直接使用保存的值
+
+int diamond(int a, int b, int c)
+{
+    int x;
+    int y;
+    x = 0;
+    if (c > 0)
+    {
+        x = a * b;
+    }
+    y = a * b;
+    return x + y;
+}
+
+int in_loop(int a, int b, int n)
+{
+    int i;
+    int s;
+    int t;
+    i = 0;
+    s = 0;
+    while (i < n)
+    {
+        if (i > 3)
+        {
+            t = a * b + i;
+            s = s + t;
+        }
+        s = s + a * b;
+        i = i + 1;
+    }
+    return s;
+}
+
+int killed(int a, int b, int c)
+{
+    int x;
+    int y;
+    x = a + b;
+    if (c > 0)
+    {
+        a = a + 1;
+    }
+    y = a + b;
+    return x * 10 + y;
+}
+
+int both_paths(int a, int b, int c)
+{
+    int x;
+    if (c > 0)
+    {
+        x = a - b;
+    }
+    else
+    {
+        x = (a - b) * 2;
+    }
+    return x + (a - b);
+}
+
+int main()
+{
+    int r;
+    // 每个函数用不同的实参调用，避免过程间常量传播把表达式折叠掉
+    r = diamond(3, 4, 1) + diamond(5, 6, 0);
+    r = r + in_loop(2, 5, 8) + in_loop(3, 1, 6);
+    r = r + killed(1, 2, 1) + killed(3, 5, 0);
+    r = r + both_paths(9, 4, 1) + both_paths(7, 2, 0);
+    return r;
+}
@@ -0,0 +1,110 @@
+// 值域分析测试
+// 支配条件已经确定结果的条件跳转被删除：循环变量的区间由循环条件收窄，
+// 重复的判断、与常量矛盾的判断都不再保留；加 --bounds-check 时数组下标检查也随之消除
+// 浮点值不按整数区间收窄：2 < x < 3 对浮点数可以成立
+
+int nested_check(int x)
+{
+    int r;
+    r = 0;
+    if (x > 10)
+    {
+        if (x > 5)
+        {
+            r = 1;
+        }
+        else
+        {
+            r = 2;
+        }
+    }
+    if (x < 0)
+    {
+        if (x == 3)
+        {
+            r = r + 100;
+        }
+        r = r + 4;
+    }
+    return r;
+}
+
+int loop_bounds(int n)
+{
+    int a[10];
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < 10)
+    {
+        if (i >= 0)
+        {
+            a[i] = i * 2;
+        }
+        if (i > 20)
+        {
+            s = s + 1000;
+        }
+        i = i + 1;
+    }
+    i = 0;
+    while (i < 10)
+    {
+        s = s + a[i];
+        i = i + 1;
+    }
+    if (n > 0)
+    {
+        if (n != 0)
+        {
+            s = s + n;
+        }
+    }
+    return s;
+}
+
+int count_down(int n)
+{
+    int k;
+    int c;
+    k = 8;
+    c = 0;
+    while (k > 0)
+    {
+        if (k <= 8)
+        {
+            c = c + k;
+        }
+        k = k - 2;
+    }
+    if (k < 0)
+    {
+        c = c + 50;
+    }
+    return c + n;
+}
+
+int float_between(float x)
+{
+    int r;
+    r = 0;
+    if (x * 1.0 < 3)
+    {
+        if (x * 1.0 > 2)
+        {
+            r = 1;
+        }
+    }
+    return r;
+}
+
+int main()
+{
+    int r;
+    r = nested_check(12) + nested_check(-3) + nested_check(7);
+    r = r + loop_bounds(3) + loop_bounds(-1);
+    r = r + count_down(1);
+    r = r + float_between(2.5) + float_between(7.0) * 10;
+    return r;
+}
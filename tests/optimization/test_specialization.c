@@ -0,0 +1,74 @@
+int scale(int x, int factor)
+{
+    // 所有调用点都传入 factor = 3：过程间常量传播后形参被常量替换
+    int r;
+    r = x * factor;
+    if (factor > 10)
+    {
+        r = r / factor;
+    }
+    return r;
+}
+
+int apply(int mode, int a, int b)
+{
+    // 通用的多分支函数，超过内联阈值；循环内以常量 mode 调用时被特化
+    int r;
+    int k;
+    r = 0;
+    k = 0;
+    if (mode == 0)
+    {
+        r = a + b;
+    }
+    else
+    {
+        if (mode == 1)
+        {
+            r = a - b;
+        }
+        else
+        {
+            if (mode == 2)
+            {
+                r = a * b;
+            }
+            else
+            {
+                while (k < b)
+                {
+                    r = r + a;
+                    k = k + 1;
+                }
+            }
+        }
+    }
+    if (r > 1000)
+    {
+        r = r - 1000;
+    }
+    if (r < 0)
+    {
+        r = 0 - r;
+    }
+    return r;
+}
+
+int main()
+{
+    int i;
+    int total;
+
+    total = 0;
+    i = 0;
+    while (i < 10)
+    {
+        total = total + apply(2, i, 3);
+        total = total + apply(1, total, i);
+        total = total + scale(i, 3);
+        i = i + 1;
+    }
+    total = total + apply(3, total, 2) + scale(total, 3);
+
+    return total;
+}
@@ -0,0 +1,65 @@
+// 尾递归消除测试
+// 自身尾调用应改写为形参赋值加跳转，递归变为循环
+
+// 累加器风格的尾递归
+int sum(int n, int acc)
+{
+    if (n == 0)
+        return acc;
+    return sum(n - 1, acc + n);
+}
+
+// 辗转相除：实参引用其他形参，需要并行赋值
+int gcd(int a, int b)
+{
+    if (b == 0)
+        return a;
+    return gcd(b, a - (a / b) * b);
+}
+
+// 形参交换：两个实参互相引用
+int swap_count(int x, int y, int k)
+{
+    if (k == 0)
+        return x * 10 + y;
+    return swap_count(y, x, k - 1);
+}
+
+// 数组形参原样传回
+int array_sum(int a[10], int i, int acc)
+{
+    if (i >= 10)
+        return acc;
+    return array_sum(a, i + 1, acc + a[i]);
+}
+
+// 非尾调用的递归保持不变
+int fact(int n)
+{
+    if (n <= 1)
+        return 1;
+    return n * fact(n - 1);
+}
+
+int main()
+{
+    int data[10];
+    int i = 0;
+    int s;
+    int g;
+    int w;
+    int a;
+    int f;
+    while (i < 10)
+    {
+        data[i] = i * 3;
+        i = i + 1;
+    }
+
+    s = sum(100000, 0);
+    g = gcd(1071, 462);
+    w = swap_count(1, 2, 5);
+    a = array_sum(data, 0, 0);
+    f = fact(5);
+    return (s - (s / 1000) * 1000) + g + w + a + f;
+}
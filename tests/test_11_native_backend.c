@@ -0,0 +1,77 @@
+// 测试用例11: x86-64 汇编生成（-S）
+// 覆盖整数/浮点运算与类型转换、超过6个的整数实参和超过8个的浮点实参（栈上传递）、
+// 局部数组与数组形参、递归调用；生成的 .s 用 gcc 链接后运行，退出码应与 gcc 编译的结果一致
+float mix(float a, int b, float c, int d)
+{
+    float r;
+    r = a * b + c / d;
+    return r;
+}
+
+int many(int a, int b, int c, int d, int e, int f, int g, int h)
+{
+    return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8;
+}
+
+float fmany(float a, float b, float c, float d, float e, float f, float g, float h, float i, float j, int k)
+{
+    return a + b + c + d + e + f + g + h + i * 2.0 + j * 3.0 + k;
+}
+
+int fill(int a[5], int n)
+{
+    int i;
+    i = 0;
+    while (i < n)
+    {
+        a[i] = i * i;
+        i = i + 1;
+    }
+    return a[n - 1];
+}
+
+int fib(int n)
+{
+    if (n < 2)
+    {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+int main()
+{
+    float x;
+    float y;
+    float scale;
+    float arr[4];
+    int counts[5];
+    int i;
+    int s;
+    scale = 1.5;
+    x = mix(2.5, 3, 7.0, 2);
+    i = x;
+    s = i + many(1, 2, 3, 4, 5, 6, 7, 8);
+    y = fmany(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11);
+    s = s + y;
+    counts[0] = 0;
+    s = s + fill(counts, 5);
+    arr[0] = 0.5;
+    arr[1] = arr[0] * scale;
+    arr[2] = -arr[1];
+    if (arr[2] < 0.0)
+    {
+        s = s + 1;
+    }
+    if (arr[1] > scale)
+    {
+        s = s + 100;
+    }
+    i = 7;
+    x = i / 2;
+    y = 7.0 / 2;
+    s = s + x * 2 + y * 2;
+    s = s + (x < y) + (x >= y) * 3 + !x + (x && y);
+    s = s - (-s / 3);
+    return s - counts[4] + fib(10) - 50;
+}
@@ -0,0 +1,103 @@
+// 测试用例12: 线性扫描寄存器分配（-S）
+// 同时活跃的整数与浮点值超过可分配寄存器数，迫使分配器按最远下次使用溢出；
+// 跨调用活跃的值不能留在调用者保存寄存器中；运行结果应与 gcc 编译的结果一致
+int twice(int x)
+{
+    return x + x;
+}
+
+float half(float x)
+{
+    return x / 2.0;
+}
+
+int pressure(int a, int b)
+{
+    int v1;
+    int v2;
+    int v3;
+    int v4;
+    int v5;
+    int v6;
+    int v7;
+    int v8;
+    int v9;
+    int v10;
+    int v11;
+    int v12;
+    int v13;
+    int v14;
+    v1 = a + 1;
+    v2 = b + 2;
+    v3 = a * 3;
+    v4 = b * 4;
+    v5 = a - b;
+    v6 = a + b;
+    v7 = v1 * v2;
+    v8 = v3 - v4;
+    v9 = v5 + v6 * 2;
+    v10 = twice(v7);
+    v11 = v8 * v9;
+    v12 = twice(v1 + v2);
+    v13 = v10 - v11;
+    v14 = v12 + v3;
+    return v1 + v2 + v3 + v4 + v5 + v6 + v7 + v8 + v9 + v10 + v11 + v12 + v13 + v14;
+}
+
+float fpressure(float a, float b)
+{
+    float f1;
+    float f2;
+    float f3;
+    float f4;
+    float f5;
+    float f6;
+    float f7;
+    float f8;
+    float f9;
+    float f10;
+    float f11;
+    float f12;
+    float f13;
+    float f14;
+    float f15;
+    float f16;
+    f1 = a + 1.0;
+    f2 = b + 2.0;
+    f3 = a * 3.0;
+    f4 = b * 4.0;
+    f5 = a - b;
+    f6 = a + b;
+    f7 = f1 * f2;
+    f8 = f3 - f4;
+    f9 = f5 + f6;
+    f10 = half(f7);
+    f11 = f8 * f9;
+    f12 = half(f1 + f2);
+    f13 = f10 - f11;
+    f14 = f12 + f3;
+    f15 = f13 * f14;
+    f16 = f15 + f1 + f2 + f3 + f4 + f5 + f6 + f7 + f8 + f9;
+    return f16 + f10 + f11 + f12 + f13 + f14;
+}
+
+int main()
+{
+    int i;
+    int sum;
+    float x;
+    float acc;
+    i = 0;
+    sum = 0;
+    x = 0.0;
+    acc = 0.0;
+    while (i < 10)
+    {
+        sum = sum + pressure(i, 10 - i) / 7;
+        acc = acc + fpressure(x, 2.0) / 64.0;
+        x = x + 1.0;
+        i = i + 1;
+    }
+    sum = sum - acc;
+    return sum / 4;
+}
@@ -0,0 +1,67 @@
+// 测试用例13: 中间代码解释执行（--run）
+// 覆盖整数/浮点运算与赋值时的类型转换、局部数组与数组形参、嵌套调用的实参、递归；
+// 以 main 的返回值退出，应与 gcc 编译的结果一致
+float average(int a[8], int n)
+{
+    int i;
+    int total;
+    i = 0;
+    total = 0;
+    while (i < n)
+    {
+        total = total + a[i];
+        i = i + 1;
+    }
+    return total / (n * 1.0);
+}
+
+int scale(float x, int k)
+{
+    int r;
+    r = x * k;
+    return r;
+}
+
+int ackermann(int m, int n)
+{
+    if (m == 0)
+    {
+        return n + 1;
+    }
+    if (n == 0)
+    {
+        return ackermann(m - 1, 1);
+    }
+    return ackermann(m - 1, ackermann(m, n - 1));
+}
+
+int main()
+{
+    int values[8];
+    float weights[8];
+    int i;
+    int s;
+    float w;
+    i = 0;
+    while (i < 8)
+    {
+        values[i] = i * i - 3;
+        weights[i] = i / 2.0;
+        i = i + 1;
+    }
+    w = 0.0;
+    i = 0;
+    while (i < 8)
+    {
+        w = w + weights[i] * values[i];
+        i = i + 1;
+    }
+    s = w;
+    s = s + scale(average(values, 8), 4);
+    s = s + scale(7.5, 3) + ackermann(2, 3);
+    if (w > 100.0 && !(s < 0))
+    {
+        s = s + 1;
+    }
+    return s;
+}
@@ -0,0 +1,58 @@
+// 测试用例14: 即时编译执行（--jit）
+// 覆盖需要特殊编码的情形：大数组带来的 32 位栈偏移、超出 8 位的立即数、除法与取负、
+// 比较结果写入字节寄存器、足以用到 r8～r15 与 xmm8 以上寄存器的同时活跃值；
+// 以 main 的返回值退出，应与 gcc 编译的结果一致
+int mix(int a, int b, int c, int d, int e, int f)
+{
+    int p;
+    int q;
+    int r;
+    p = a * 100000 + b;
+    q = (c - d) / (e + 1);
+    r = -(f / 7 * 7 == f);
+    return p + q * 3 - r + (a < b) + (c >= d) * 2;
+}
+
+float blend(float x, float y, int k)
+{
+    float t;
+    t = x * k - y / 4.0;
+    if (t > x)
+    {
+        return t - x;
+    }
+    return -t;
+}
+
+int main()
+{
+    int big[300];
+    float part[40];
+    int i;
+    int sum;
+    float acc;
+    i = 0;
+    while (i < 300)
+    {
+        big[i] = i * 3 - 250;
+        i = i + 1;
+    }
+    i = 0;
+    acc = 0.0;
+    while (i < 40)
+    {
+        part[i] = blend(i * 0.5, big[i * 7] * 1.0, i - 20);
+        acc = acc + part[i];
+        i = i + 1;
+    }
+    sum = 0;
+    i = 0;
+    while (i < 300)
+    {
+        sum = sum + big[i] / 7 - big[299 - i] / 5;
+        i = i + 1;
+    }
+    sum = sum + mix(3, 4, 50, 8, 6, 21) / 1000;
+    sum = sum + acc;
+    return sum - sum / 256 * 256;
+}
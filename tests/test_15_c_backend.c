@@ -0,0 +1,53 @@
+// 测试用例15: 生成 C 源代码（--emit-c=FILE）
+// 覆盖同一临时变量先后存放整数与浮点值、数组形参、实参求值后形参变量被改写、
+// 赋值时的整数/浮点转换；生成的文件用 gcc -O2 编译后运行，退出码应与 gcc 直接编译源程序一致
+int sum(int v[10], int n)
+{
+    int i;
+    int s;
+    i = 0;
+    s = 0;
+    while (i < n)
+    {
+        s = s + v[i] * (i + 1);
+        i = i + 1;
+    }
+    return s;
+}
+
+float ratio(int a, int b)
+{
+    return a / (b * 1.0);
+}
+
+int pick(int a, int b)
+{
+    if (a > b)
+    {
+        return a - b;
+    }
+    return b - a;
+}
+
+int main()
+{
+    int data[10];
+    int i;
+    int k;
+    float r;
+    i = 0;
+    while (i < 10)
+    {
+        data[i] = 10 - i * 3;
+        i = i + 1;
+    }
+    k = 7;
+    k = pick(k, k * 2 - 20) + pick(k + 1, k);
+    r = ratio(sum(data, 10), 3) + ratio(k, 4);
+    i = r;
+    if (r > 10.5 || !(k < 3))
+    {
+        i = i + k;
+    }
+    return i;
+}
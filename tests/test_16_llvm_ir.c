@@ -0,0 +1,56 @@
+// 测试用例16: 生成 LLVM IR（--emit-llvm=FILE）
+// 覆盖整数与浮点的 icmp/fcmp 比较与条件跳转、浮点值的逻辑运算、跨基本块使用的临时变量、
+// 数组形参与局部数组；生成的 .ll 经 opt -O2 与 llc 编译后运行，退出码应与 gcc 直接编译源程序一致
+float dot(float x[6], float y[6], int n)
+{
+    int i;
+    float s;
+    i = 0;
+    s = 0.0;
+    while (i < n)
+    {
+        s = s + x[i] * y[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+int classify(float v)
+{
+    if (v != v)
+    {
+        return 0;
+    }
+    if (v >= 10.0 && !(v > 50.0))
+    {
+        return 2;
+    }
+    if (v < 0.0 || v == 0.0)
+    {
+        return 1;
+    }
+    return 3;
+}
+
+int main()
+{
+    float a[6];
+    float b[6];
+    int i;
+    int total;
+    i = 0;
+    while (i < 6)
+    {
+        a[i] = i * 1.5;
+        b[i] = 4 - i;
+        i = i + 1;
+    }
+    total = dot(a, b, 6);
+    total = total * 10 + classify(dot(a, a, 3)) + classify(-2.5) * 4;
+    i = 0;
+    while (i < 6 && a[i] < 5.0)
+    {
+        i = i + 1;
+    }
+    return total + i;
+}
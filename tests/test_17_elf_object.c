@@ -0,0 +1,48 @@
+// 测试用例17: 直接生成 ELF 目标文件（-c）
+// 全局变量与全局数组放在 .bss，访问它们需要 PC32 重定位；函数之间的调用在编码时直接解析。
+// 生成的 .o 用 gcc 链接后运行，退出码应与 gcc 直接编译源程序一致
+int counter;
+int table[8];
+float scale;
+
+int bump(int by)
+{
+    counter = counter + by;
+    return counter;
+}
+
+int fill(int n)
+{
+    int i;
+    i = 0;
+    while (i < n)
+    {
+        table[i] = bump(i) * 2;
+        i = i + 1;
+    }
+    return table[n - 1];
+}
+
+float weighted(int n)
+{
+    int i;
+    float s;
+    i = 0;
+    s = 0.0;
+    while (i < n)
+    {
+        s = s + table[i] * scale;
+        i = i + 1;
+    }
+    return s;
+}
+
+int main()
+{
+    int last;
+    int w;
+    scale = 0.5;
+    last = fill(8);
+    w = weighted(8);
+    return last + w + counter;
+}
@@ -0,0 +1,69 @@
+// 测试用例18: 树模式指令选择（-S）
+// 只使用一次的中间结果与使用者合成表达式树：按行展开的下标 i * 4 + j 由一条 lea 计算，
+// 常量下标的数组元素直接作内存操作数，数组元素与常量的比较合成 cmp + jcc，
+// 乘以 3/5/9 的运算改用 lea。统计信息中给出并入表达式树的中间代码指令数
+int grid[16];
+
+int checksum(int m[16])
+{
+    int i;
+    int j;
+    int s;
+    s = 0;
+    i = 0;
+    while (i < 4)
+    {
+        j = 0;
+        while (j < 4)
+        {
+            s = s + m[i * 4 + j] * 5;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    return s;
+}
+
+int count_below(int a[16], int n, int limit)
+{
+    int i;
+    int c;
+    c = 0;
+    i = 0;
+    while (i < n)
+    {
+        if (a[i] < limit)
+        {
+            c = c + 1;
+        }
+        i = i + 1;
+    }
+    return c;
+}
+
+float scale(float a[4], int k)
+{
+    a[k + 1] = a[k] * 3.0 + a[0];
+    return a[k + 1];
+}
+
+int main()
+{
+    int i;
+    int w;
+    int local[16];
+    float f[4];
+    i = 0;
+    while (i < 16)
+    {
+        grid[i] = i * 9 - 7;
+        local[i] = grid[i] * 3 + grid[3];
+        i = i + 1;
+    }
+    f[0] = 1.5;
+    f[1] = 2.0;
+    f[2] = 0.5;
+    f[3] = 0.0;
+    w = scale(f, 1);
+    return checksum(grid) / 100 + count_below(local, 16, 40) + w;
+}
@@ -0,0 +1,58 @@
+// 测试用例19: 机器级窥孔优化与分支缩短（-S / -c）
+// 寄存器分配后删除自身传送、被覆盖的传送、跳到下一条指令的 jmp 与 jmp 之后的不可达指令，
+// 存储后立即读取同一位置时直接使用寄存器；
+// -c 直接编码时偏移落在 8 位范围内的跳转使用 2 字节短形式。统计信息中给出删除的机器指令数
+int countdown(int n)
+{
+    int s;
+    s = 0;
+    while (n != 0)
+    {
+        s = s + n;
+        n = n - 1;
+    }
+    return s;
+}
+
+int pick(int a, int b)
+{
+    int r;
+    if (a > b)
+    {
+        r = a;
+    }
+    else
+    {
+        r = b;
+    }
+    return r;
+}
+
+float average(float a[8], int n)
+{
+    int i;
+    float s;
+    s = 0.0;
+    i = 0;
+    while (i < n)
+    {
+        s = s + a[i];
+        i = i + 1;
+    }
+    return s / n;
+}
+
+int main()
+{
+    int i;
+    int w;
+    float f[8];
+    i = 0;
+    while (i < 8)
+    {
+        f[i] = i * 2;
+        i = i + 1;
+    }
+    w = average(f, 8);
+    return countdown(10) + pick(w, 3) + pick(2, 9);
+}
@@ -0,0 +1,79 @@
+// 测试用例20: 数组循环的自动向量化（-S / --jit）
+// 逐元素读写数组的计数循环生成 AVX2（每次8个元素）与 SSE2（每次4个元素）两种向量循环体，
+// 运行时检测 CPU 选择其一，剩余不足一组的元素由标量循环完成；
+// 含32位整数乘法的循环只有 AVX2 形式。累加（跨迭代依赖）的循环保持标量。
+// 统计信息中给出向量化的循环数
+int a[100];
+int b[100];
+int c[100];
+float x[100];
+float y[100];
+
+int add(int n)
+{
+    int i;
+    i = 0;
+    while (i < n)
+    {
+        c[i] = a[i] + b[i];
+        i = i + 1;
+    }
+    return i;
+}
+
+int scale(float p[100], float q[100], float k, int n)
+{
+    int i;
+    i = 0;
+    while (i < n)
+    {
+        q[i] = p[i] * k + 0.5;
+        i = i + 1;
+    }
+    return i;
+}
+
+int weight(int n)
+{
+    int i;
+    i = 1;
+    while (i <= n)
+    {
+        c[i] = c[i] * 3 - a[i];
+        i = i + 1;
+    }
+    return i;
+}
+
+int total(int n)
+{
+    int i;
+    int s;
+    s = 0;
+    i = 0;
+    while (i < n)
+    {
+        s = s + c[i];
+        i = i + 1;
+    }
+    return s;
+}
+
+int main()
+{
+    int i;
+    int w;
+    i = 0;
+    while (i < 100)
+    {
+        a[i] = i;
+        b[i] = 100 - i * 2;
+        x[i] = i;
+        i = i + 1;
+    }
+    add(99);
+    scale(x, y, 2.0, 37);
+    weight(61);
+    w = y[36];
+    return total(100) / 100 + w;
+}
@@ -0,0 +1,48 @@
+// 测试用例21: 全局变量与全局数组（--run）
+// 全局变量零初始化，在各函数之间共享：被调函数的写入在返回后可见，递归调用共用同一份存储；
+// 与全局变量同名的局部变量遮蔽全局变量（内联展开时两者不能混淆）。以 main 的返回值退出，各执行途径应与 gcc 一致
+int count;
+int hist[10];
+float total;
+
+int record(int v)
+{
+    hist[v] = hist[v] + 1;
+    count = count + 1;
+    total = total + v * 0.5;
+    return count;
+}
+
+int depth(int n)
+{
+    if (n > 0)
+    {
+        record(n);
+        depth(n - 1);
+    }
+    return count;
+}
+
+int shadow(int v)
+{
+    int count;
+    count = v * 100;
+    record(v);
+    return count;
+}
+
+int main()
+{
+    int i;
+    int half;
+    i = 0;
+    while (i < 6)
+    {
+        record(i / 2);
+        i = i + 1;
+    }
+    depth(4);
+    shadow(7);
+    half = total;
+    return count * 10 + hist[1] + hist[7] + half;
+}
@@ -0,0 +1,55 @@
+// 测试用例22: 浮点比较与 NaN（-S / --jit）
+// 0.0/0.0 得到 NaN：与 NaN 的 <、<=、>、== 都不成立，!= 成立，NaN 作为条件为真；
+// 比较的值与分支、while 循环条件都要按无序处理。以 main 的返回值退出，应与 gcc 一致（18）
+float mk(float z)
+{
+    return z / z;
+}
+int main()
+{
+    float n;
+    float x;
+    int r;
+    int k;
+    n = mk(0.0);
+    r = 0;
+    if (n < 1.0)
+    {
+        r = r + 1;
+    }
+    else
+    {
+        r = r + 2;
+    }
+    if (n <= 1.0)
+    {
+        r = r + 100;
+    }
+    if (n == n)
+    {
+        r = r + 4;
+    }
+    if (n != n)
+    {
+        r = r + 8;
+    }
+    if (n > 1.0)
+    {
+        r = r + 100;
+    }
+    k = n == n;
+    r = r + k * 50;
+    k = n != n;
+    r = r + k * 3;
+    x = 0.0;
+    while (x < n)
+    {
+        x = x + 1.0;
+        r = r + 100;
+    }
+    if (n)
+    {
+        r = r + 5;
+    }
+    return r;
+}